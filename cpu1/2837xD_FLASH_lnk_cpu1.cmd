@@ -69,8 +69,8 @@ PAGE 1 : /* Data Memory */
 
 //   RAMGS11_RSVD : origin = 0x017FF8, length = 0x000008    /* Reserve and do not use for code as per the errata advisory "Memory: Prefetching Beyond Valid Memory" */
 
-   RAMGS11     : origin = 0x017000, length = 0x001000     /* Only Available on F28379D, F28377D, F28375D devices. Remove line on other devices. */
-   RAMGS12     : origin = 0x018000, length = 0x001000     /* Only Available on F28379D, F28377D, F28375D devices. Remove line on other devices. */
+   RAMGS11     : origin = 0x017000, length = 0x001000     /* CPU1-R / CPU2-RW, fuel cell data */
+   RAMGS12     : origin = 0x018000, length = 0x001000     /* CPU1-R / CPU2-RW, fuel cell link statistics */
    RAMGS13     : origin = 0x019000, length = 0x001000     /* Only Available on F28379D, F28377D, F28375D devices. Remove line on other devices. */
 
    CPU2TOCPU1RAM   : origin = 0x03F800, length = 0x000400
@@ -126,6 +126,7 @@ SECTIONS
       SHARED_UCANOPEN_CAN2_TSDO_DATA
       SHARED_SYSLOG_DATA_CPU1
       SHARED_SYSLOG_MESSAGES
+      SHARED_SYSLOG_MESSAGES_CPU2_TAIL
    }
 
    GROUP : > RAMGS10
@@ -134,9 +135,19 @@ SECTIONS
       SHARED_UCANOPEN_CAN1_RSDO_DATA
       SHARED_UCANOPEN_CAN2_RSDO_DATA
       SHARED_SYSLOG_DATA_CPU2
-      SHARED_SYSLOG_MESSAGE_CPU2
+      SHARED_SYSLOG_MESSAGES_CPU2
+      SHARED_FUELCELL_BUS_STATS
+   }
+
+   GROUP : > RAMGS11
+   {
       SHARED_FUELCELL_DATA
    }
+
+   GROUP : > RAMGS12
+   {
+      SHARED_FUELCELL_LINK_STATS
+   }
    // USER END
    RFFTDATA			: > RAMGS4,			PAGE = 1, ALIGN = RFFT_ALIGNMENT
 
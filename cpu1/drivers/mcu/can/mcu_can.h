@@ -190,6 +190,16 @@ public:
 		CAN_sendMessage(m_module.base, objId, dataLen, dataBuf);
 	}
 
+	/**
+	 * @brief Checks if previously sent data of message object is still waiting for transmission.
+	 * @param objId - message object ID
+	 * @return \c true if transmission is pending, \c false otherwise.
+	 */
+	bool isTxPending(uint32_t objId) const
+	{
+		return (CAN_getTxRequests(m_module.base) & (1UL << (objId - 1))) != 0;
+	}
+
 	/**
 	 * @brief Setups message object.
 	 * @param msgObj - message object
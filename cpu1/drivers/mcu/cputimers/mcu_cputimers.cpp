@@ -140,6 +140,15 @@ uint32_t HighResolutionClock::m_period;
 ///
 ///
 void HighResolutionClock::init(uint32_t period_us)
+{
+	initCycles((uint32_t)(mcu::sysclkFreq() / 1000000) * period_us);
+}
+
+
+///
+///
+///
+void HighResolutionClock::initCycles(uint32_t periodCycles)
 {
 	if (initialized()) return;
 
@@ -148,7 +157,7 @@ void HighResolutionClock::init(uint32_t period_us)
 	CPUTimer_setPreScaler(CPUTIMER1_BASE, 0);       	// Initialize pre-scale counter to divide by 1 (SYSCLKOUT)
 	CPUTimer_reloadTimerCounter(CPUTIMER1_BASE);    	// Reload counter register with period value
 
-	m_period = (uint32_t)(mcu::sysclkFreq() / 1000000) * period_us - 1;
+	m_period = periodCycles - 1;
 	CPUTimer_setPeriod(CPUTIMER1_BASE, m_period);
 	CPUTimer_setEmulationMode(CPUTIMER1_BASE, CPUTIMER_EMULATIONMODE_STOPAFTERNEXTDECREMENT);
 
@@ -156,6 +165,27 @@ void HighResolutionClock::init(uint32_t period_us)
 }
 
 
+///
+///
+///
+void HighResolutionClock::setPeriod(uint32_t period_us)
+{
+	setPeriodCycles((uint32_t)(mcu::sysclkFreq() / 1000000) * period_us);
+}
+
+
+///
+///
+///
+void HighResolutionClock::setPeriodCycles(uint32_t periodCycles)
+{
+	CPUTimer_stopTimer(CPUTIMER1_BASE);
+	m_period = periodCycles - 1;
+	CPUTimer_setPeriod(CPUTIMER1_BASE, m_period);
+	CPUTimer_reloadTimerCounter(CPUTIMER1_BASE);
+}
+
+
 } // namespace mcu
 
 
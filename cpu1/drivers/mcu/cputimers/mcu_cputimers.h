@@ -252,6 +252,28 @@ public:
 	 */
 	static void init(uint32_t period_us);
 
+	/**
+	 * @brief Initializes systick timer with period in SYSCLK cycles.
+	 * @param periodCycles - period in SYSCLK cycles
+	 * @return (none)
+	 */
+	static void initCycles(uint32_t periodCycles);
+
+	/**
+	 * @brief Changes systick timer period, timer is stopped. Unlike init(), may be called repeatedly,
+	 * e.g. by tests that use timer as interrupt source and must restore period afterwards.
+	 * @param period_us - period in microseconds
+	 * @return (none)
+	 */
+	static void setPeriod(uint32_t period_us);
+
+	/**
+	 * @brief Changes systick timer period in SYSCLK cycles, timer is stopped.
+	 * @param periodCycles - period in SYSCLK cycles
+	 * @return (none)
+	 */
+	static void setPeriodCycles(uint32_t periodCycles);
+
 	/**
 	 * @brief Returns systick timer counter value.
 	 * @param (none)
@@ -262,6 +284,16 @@ public:
 		return CPUTimer_getTimerCount(CPUTIMER1_BASE);
 	}
 
+	/**
+	 * @brief Returns number of SYSCLK cycles elapsed since counter was reloaded.
+	 * @param (none)
+	 * @return Number of SYSCLK cycles since start of current period.
+	 */
+	static uint32_t elapsedCycles()
+	{
+		return m_period - counter();
+	}
+
 	/**
 	 * @brief Returns a time point representing the current point in time.
 	 * @param (none)
@@ -269,11 +301,11 @@ public:
 	 */
 	static uint64_t now()
 	{
-		return static_cast<uint64_t>(m_period - counter()) * DEVICE_SYSCLK_PERIOD_NS;
+		return static_cast<uint64_t>(elapsedCycles()) * DEVICE_SYSCLK_PERIOD_NS;
 	}
 
 	/**
-	 * @brief Starts systick timer.
+	 * @brief Starts systick timer. Counter is reloaded, so first interrupt occurs one period later.
 	 * @param (none)
 	 * @return (none)
 	 */
@@ -740,6 +740,27 @@ public:
 		EPWM_disableTripZoneInterrupt(m_module.base[0], EPWM_TZ_INTERRUPT_OST);
 	}
 
+	/**
+	 * @brief Masks time-base interrupt in PIE. Interrupt that occurs while masked stays pending
+	 * and is serviced after unmasking, other interrupts of PIE group are not affected.
+	 * @param (none)
+	 * @return (none)
+	 */
+	void maskEventInterrupt() const
+	{
+		Interrupt_disable(m_module.pieEventIntNum);
+	}
+
+	/**
+	 * @brief Unmasks time-base interrupt in PIE.
+	 * @param (none)
+	 * @return (none)
+	 */
+	void unmaskEventInterrupt() const
+	{
+		Interrupt_enable(m_module.pieEventIntNum);
+	}
+
 	/**
 	 * @param Registers time-base interrupt handler
 	 * @param handler - pointer to handler
@@ -147,6 +147,22 @@ public:
 #define CRITICAL_SECTION CriticalSection EMB_UNIQ_ID(__LINE__);
 
 
+/**
+ * @brief Critical Section class that restores previous interrupt state, so it may be used in ISRs.
+ */
+class NestedCriticalSection
+{
+private:
+	uint16_t m_intState;
+public:
+	NestedCriticalSection() : m_intState(__disable_interrupts()) {}	// disable maskable interrupts, save state
+	~NestedCriticalSection() { __restore_interrupts(m_intState); }		// restore maskable interrupts state
+};
+
+
+#define NESTED_CRITICAL_SECTION NestedCriticalSection EMB_UNIQ_ID(__LINE__);
+
+
 /**
  * @brief Returns device SYSCLK frequency.
  * @param (none)
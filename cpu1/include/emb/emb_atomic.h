@@ -0,0 +1,198 @@
+///
+#pragma once
+
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+namespace emb {
+
+
+/*
+ * Atomic bitwise operations on 32-bit words that are shared with interrupt handlers. Interrupts are not masked.
+ *
+ * C28x: word is updated by two single-instruction read-modify-writes of its 16-bit halves (OR/AND loc16,AX),
+ * which cannot be interrupted. So every bit is updated atomically, but mask that spans both halves
+ * may be observed half-applied by an interrupt. Operations are not atomic against other CPU.
+ * Fetch operations return previous value, so that exactly one context observes a transition. C28x has no
+ * read-modify-write instruction that returns old value, so they mask interrupts for a single load-modify-store
+ * (a few cycles, independent of caller). Operations are not atomic against other CPU.
+ * Host: GCC atomic builtins.
+ */
+
+
+#ifdef __TMS320C28XX__
+/**
+ * @brief Atomically sets bits of mask in word.
+ * @param word - 32-bit word
+ * @param mask - bits to be set
+ * @return (none)
+ */
+inline void atomicOr(volatile uint32_t& word, uint32_t mask)
+{
+	int* half = reinterpret_cast<int*>(const_cast<uint32_t*>(&word));
+	if (mask & 0xFFFF)
+	{
+		__or(half, static_cast<int>(mask & 0xFFFF));
+	}
+	if (mask >> 16)
+	{
+		__or(half + 1, static_cast<int>(mask >> 16));
+	}
+}
+
+
+/**
+ * @brief Atomically clears bits of word that are not set in mask.
+ * @param word - 32-bit word
+ * @param mask - bits to be kept
+ * @return (none)
+ */
+inline void atomicAnd(volatile uint32_t& word, uint32_t mask)
+{
+	int* half = reinterpret_cast<int*>(const_cast<uint32_t*>(&word));
+	if ((mask & 0xFFFF) != 0xFFFF)
+	{
+		__and(half, static_cast<int>(mask & 0xFFFF));
+	}
+	if ((mask >> 16) != 0xFFFF)
+	{
+		__and(half + 1, static_cast<int>(mask >> 16));
+	}
+}
+
+
+/**
+ * @brief Atomically sets bits of mask in word and returns previous value of word.
+ * @param word - 32-bit word
+ * @param mask - bits to be set
+ * @return Value of word before operation.
+ */
+inline uint32_t atomicFetchOr(volatile uint32_t& word, uint32_t mask)
+{
+	uint16_t intState = __disable_interrupts();
+	uint32_t prev = word;
+	word = prev | mask;
+	__restore_interrupts(intState);
+	return prev;
+}
+
+
+/**
+ * @brief Atomically adds value to word and returns previous value of word.
+ * @param word - 32-bit word
+ * @param value - value to be added
+ * @return Value of word before operation.
+ */
+inline uint32_t atomicFetchAdd(volatile uint32_t& word, uint32_t value)
+{
+	uint16_t intState = __disable_interrupts();
+	uint32_t prev = word;
+	word = prev + value;
+	__restore_interrupts(intState);
+	return prev;
+}
+#else
+/**
+ * @brief Atomically sets bits of mask in word.
+ * @param word - 32-bit word
+ * @param mask - bits to be set
+ * @return (none)
+ */
+inline void atomicOr(volatile uint32_t& word, uint32_t mask)
+{
+	__sync_fetch_and_or(&word, mask);
+}
+
+
+/**
+ * @brief Atomically clears bits of word that are not set in mask.
+ * @param word - 32-bit word
+ * @param mask - bits to be kept
+ * @return (none)
+ */
+inline void atomicAnd(volatile uint32_t& word, uint32_t mask)
+{
+	__sync_fetch_and_and(&word, mask);
+}
+
+
+/**
+ * @brief Atomically sets bits of mask in word and returns previous value of word.
+ * @param word - 32-bit word
+ * @param mask - bits to be set
+ * @return Value of word before operation.
+ */
+inline uint32_t atomicFetchOr(volatile uint32_t& word, uint32_t mask)
+{
+	return __sync_fetch_and_or(&word, mask);
+}
+
+
+/**
+ * @brief Atomically adds value to word and returns previous value of word.
+ * @param word - 32-bit word
+ * @param value - value to be added
+ * @return Value of word before operation.
+ */
+inline uint32_t atomicFetchAdd(volatile uint32_t& word, uint32_t value)
+{
+	return __sync_fetch_and_add(&word, value);
+}
+#endif
+
+
+/**
+ * @brief Orders memory accesses before and after barrier. C28x accesses memory in program order,
+ * volatile accesses are not reordered by compiler, so barrier is needed only on host.
+ * @param (none)
+ * @return (none)
+ */
+inline void memoryBarrier()
+{
+#ifndef __TMS320C28XX__
+	__sync_synchronize();
+#endif
+}
+
+
+/**
+ * @brief Atomically sets bit in word.
+ * @param word - 32-bit word
+ * @param pos - bit position
+ * @return (none)
+ */
+inline void atomicSetBit(volatile uint32_t& word, size_t pos)
+{
+	atomicOr(word, 1UL << pos);
+}
+
+
+/**
+ * @brief Atomically sets bit in word and checks if it was set before.
+ * @param word - 32-bit word
+ * @param pos - bit position
+ * @return \c true if bit was already set, \c false if this call has set it.
+ */
+inline bool atomicTestAndSetBit(volatile uint32_t& word, size_t pos)
+{
+	return (atomicFetchOr(word, 1UL << pos) & (1UL << pos)) != 0;
+}
+
+
+/**
+ * @brief Atomically clears bit in word.
+ * @param word - 32-bit word
+ * @param pos - bit position
+ * @return (none)
+ */
+inline void atomicClearBit(volatile uint32_t& word, size_t pos)
+{
+	atomicAnd(word, ~(1UL << pos));
+}
+
+
+} // namespace emb
+
+
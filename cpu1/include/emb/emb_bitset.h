@@ -81,6 +81,12 @@ public:
 		return m_data[_whichByte(pos)] & (1U << _whichBit(pos));
 	}
 
+	bool test(size_t pos) const volatile
+	{
+		assert(pos < BitCount);
+		return m_data[_whichByte(pos)] & (1U << _whichBit(pos));
+	}
+
 	bool all() const
 	{
 		// int index is used to suppress "pointless comparison of unsigned integer with zero" warning
@@ -117,9 +123,13 @@ public:
 	size_t count() const
 	{
 		size_t ret = 0;
-		for (size_t i = 0; i < BitCount; ++i)
+		for (size_t i = 0; i < BYTES_COUNT; ++i)
 		{
-			if ((*this)[i]) ++ret;
+			// unused bits are always reset, each iteration clears lowest set bit
+			for (unsigned int word = m_data[i]; word != 0; word &= word - 1)
+			{
+				++ret;
+			}
 		}
 		return ret;
 	}
@@ -142,6 +152,15 @@ public:
 			m_data[_whichByte(pos)] &= ~(1U << _whichBit(pos));
 	}
 
+	void set(size_t pos, bool value = true) volatile
+	{
+		assert(pos < BitCount);
+		if (value)
+			m_data[_whichByte(pos)] |= 1U << _whichBit(pos);
+		else
+			m_data[_whichByte(pos)] &= ~(1U << _whichBit(pos));
+	}
+
 	void reset()
 	{
 		for (size_t i = 0; i < BYTES_COUNT; ++i)
@@ -0,0 +1,122 @@
+///
+#pragma once
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include "emb_common.h"
+#include "emb_atomic.h"
+
+
+namespace emb {
+
+
+/**
+ * @brief Lock-free single-producer single-consumer queue. Producer and consumer may be
+ * ISR and background loop or two CPUs. Each side writes only its own data, so producer data and
+ * consumer data may be placed in shared memory sections owned by different CPUs.
+ * Element type must be scalar, elements are copied via volatile accesses.
+ */
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+	EMB_STATIC_ASSERT((Capacity & (Capacity - 1)) == 0);
+	EMB_STATIC_ASSERT(Capacity <= 0x8000);
+public:
+	/// Written only by producer
+	struct ProducerData
+	{
+		volatile T data[Capacity];
+		volatile uint16_t head;			// free-running, wraps at 2^16
+		volatile uint32_t overflowCount;	// elements rejected because queue was full
+	};
+
+	/// Written only by consumer
+	struct ConsumerData
+	{
+		volatile uint16_t tail;			// free-running, wraps at 2^16
+	};
+
+private:
+	ProducerData* m_producer;
+	ConsumerData* m_consumer;
+
+	static uint16_t _distance(uint16_t head, uint16_t tail) { return static_cast<uint16_t>(head - tail); }
+
+public:
+	SpscQueue(ProducerData* producer, ConsumerData* consumer)
+		: m_producer(producer)
+		, m_consumer(consumer)
+	{}
+
+	/**
+	 * @brief Resets producer data. Must be called only by producer before first push.
+	 */
+	void initProducer()
+	{
+		m_producer->head = 0;
+		m_producer->overflowCount = 0;
+	}
+
+	/**
+	 * @brief Resets consumer data. Must be called only by consumer before first pop.
+	 */
+	void initConsumer()
+	{
+		m_consumer->tail = 0;
+	}
+
+	size_t capacity() const { return Capacity; }
+	size_t size() const { return _distance(m_producer->head, m_consumer->tail); }
+	bool empty() const { return size() == 0; }
+	uint32_t overflowCount() const { return m_producer->overflowCount; }
+
+	/**
+	 * @brief Appends element. Must be called only by producer.
+	 * @return \c true if element is appended, \c false if queue is full.
+	 */
+	bool push(T value)
+	{
+		uint16_t head = m_producer->head;
+		if (_distance(head, m_consumer->tail) >= Capacity)
+		{
+			m_producer->overflowCount = m_producer->overflowCount + 1;
+			return false;
+		}
+		m_producer->data[head & (Capacity - 1)] = value;
+		memoryBarrier();		// element is written before it is published
+		m_producer->head = head + 1;
+		return true;
+	}
+
+	/**
+	 * @brief Removes front element. Must be called only by consumer.
+	 * @return \c true if element is removed, \c false if queue is empty.
+	 */
+	bool pop(T& value)
+	{
+		uint16_t tail = m_consumer->tail;
+		uint16_t head = m_producer->head;
+		uint16_t size = _distance(head, tail);
+		if (size == 0)
+		{
+			return false;
+		}
+		if (size > Capacity)
+		{
+			// producer has been reset independently, queue content is lost
+			m_consumer->tail = head;
+			return false;
+		}
+		memoryBarrier();		// element is read after head
+		value = m_producer->data[tail & (Capacity - 1)];
+		memoryBarrier();		// element is read before slot is released
+		m_consumer->tail = tail + 1;
+		return true;
+	}
+};
+
+
+} // namespace emb
+
+
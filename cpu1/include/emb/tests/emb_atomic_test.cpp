@@ -0,0 +1,52 @@
+///
+#include "emb_test.h"
+
+
+void EmbTest::AtomicTest()
+{
+	volatile uint32_t word = 0;
+
+	emb::atomicSetBit(word, 0);
+	emb::atomicSetBit(word, 15);
+	emb::atomicSetBit(word, 16);
+	emb::atomicSetBit(word, 31);
+	EMB_ASSERT_EQUAL(word, 0x80018001);
+
+	emb::atomicClearBit(word, 15);
+	emb::atomicClearBit(word, 16);
+	EMB_ASSERT_EQUAL(word, 0x80000001);
+	emb::atomicClearBit(word, 16);
+	EMB_ASSERT_EQUAL(word, 0x80000001);
+
+	// masks within one half and spanning both halves
+	emb::atomicOr(word, 0x0000FF00);
+	EMB_ASSERT_EQUAL(word, 0x8000FF01);
+	emb::atomicOr(word, 0x00F000F0);
+	EMB_ASSERT_EQUAL(word, 0x80F0FFF1);
+	emb::atomicAnd(word, 0xFFFF0F0F);
+	EMB_ASSERT_EQUAL(word, 0x80F00F01);
+	emb::atomicAnd(word, 0x00FFFFFF);
+	EMB_ASSERT_EQUAL(word, 0x00F00F01);
+
+	emb::atomicOr(word, 0);
+	EMB_ASSERT_EQUAL(word, 0x00F00F01);
+	emb::atomicAnd(word, 0xFFFFFFFF);
+	EMB_ASSERT_EQUAL(word, 0x00F00F01);
+	emb::atomicOr(word, 0xFFFFFFFF);
+	EMB_ASSERT_EQUAL(word, 0xFFFFFFFF);
+	emb::atomicAnd(word, 0);
+	EMB_ASSERT_EQUAL(word, 0);
+
+	// fetch operations return previous value, only first caller observes transition
+	EMB_ASSERT_TRUE(!emb::atomicTestAndSetBit(word, 17));
+	EMB_ASSERT_TRUE(emb::atomicTestAndSetBit(word, 17));
+	EMB_ASSERT_EQUAL(word, 0x00020000);
+	EMB_ASSERT_EQUAL(emb::atomicFetchOr(word, 0x00000003), 0x00020000);
+	EMB_ASSERT_EQUAL(word, 0x00020003);
+	word = 0x0000FFFF;
+	EMB_ASSERT_EQUAL(emb::atomicFetchAdd(word, 1), 0x0000FFFF);
+	EMB_ASSERT_EQUAL(word, 0x00010000);
+	word = 0;
+}
+
+
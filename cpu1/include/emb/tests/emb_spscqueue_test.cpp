@@ -0,0 +1,67 @@
+///
+#include "emb_test.h"
+
+
+void EmbTest::SpscQueueTest()
+{
+	typedef emb::SpscQueue<uint16_t, 4> Queue;
+	static Queue::ProducerData producerData;
+	static Queue::ConsumerData consumerData;
+	Queue queue(&producerData, &consumerData);
+	queue.initProducer();
+	queue.initConsumer();
+
+	uint16_t value = 0;
+	EMB_ASSERT_TRUE(queue.empty());
+	EMB_ASSERT_TRUE(!queue.pop(value));
+
+	// fill, overflow is counted
+	for (uint16_t i = 0; i < 4; ++i)
+	{
+		EMB_ASSERT_TRUE(queue.push(i));
+	}
+	EMB_ASSERT_EQUAL(queue.size(), 4);
+	EMB_ASSERT_TRUE(!queue.push(4));
+	EMB_ASSERT_TRUE(!queue.push(5));
+	EMB_ASSERT_EQUAL(queue.overflowCount(), 2);
+
+	for (uint16_t i = 0; i < 4; ++i)
+	{
+		EMB_ASSERT_TRUE(queue.pop(value));
+		EMB_ASSERT_EQUAL(value, i);
+	}
+	EMB_ASSERT_TRUE(queue.empty());
+
+	// order is kept across wrap of free-running indices
+	uint32_t pushed = 0;
+	uint32_t popped = 0;
+	for (uint32_t n = 0; n < 30000; ++n)
+	{
+		for (uint32_t k = 0; k < (n % 4) + 1; ++k)
+		{
+			if (queue.push(pushed & 0xFFFF))
+			{
+				++pushed;
+			}
+		}
+		while (queue.pop(value))
+		{
+			EMB_ASSERT_EQUAL(value, popped & 0xFFFF);
+			++popped;
+		}
+	}
+	EMB_ASSERT_EQUAL(popped, pushed);
+	EMB_ASSERT_EQUAL(queue.overflowCount(), 2);
+
+	// producer reset is detected, stale content is dropped
+	queue.push(1);
+	queue.push(2);
+	queue.initProducer();
+	EMB_ASSERT_TRUE(!queue.pop(value));
+	EMB_ASSERT_TRUE(queue.empty());
+	EMB_ASSERT_TRUE(queue.push(3));
+	EMB_ASSERT_TRUE(queue.pop(value));
+	EMB_ASSERT_EQUAL(value, 3);
+}
+
+
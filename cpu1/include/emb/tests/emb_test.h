@@ -14,6 +14,8 @@
 #include "emb/emb_filter.h"
 #include "emb/emb_stack.h"
 #include "emb/emb_bitset.h"
+#include "emb/emb_atomic.h"
+#include "emb/emb_spscqueue.h"
 
 
 class EmbTest
@@ -28,6 +30,8 @@ public:
 	static void FilterTest();
 	static void StackTest();
 	static void BitsetTest();
+	static void AtomicTest();
+	static void SpscQueueTest();
 };
 
 
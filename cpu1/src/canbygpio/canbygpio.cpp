@@ -10,12 +10,7 @@
 namespace canbygpio {
 
 
-const size_t STREAM_SIZE_W_BIT_STUFFING = 200;
-const size_t STREAM_SIZE_WO_BIT_STUFFING = 112;
-static emb::Array<int, STREAM_SIZE_W_BIT_STUFFING> txBitStream;
-static emb::Array<int, STREAM_SIZE_W_BIT_STUFFING> txCanBitStream;
-static emb::Array<int, STREAM_SIZE_W_BIT_STUFFING> rxBitStream;
-static emb::Array<int, STREAM_SIZE_W_BIT_STUFFING> rxCanBitStream;
+static BitStream txCanBitStream;
 
 
 ///
@@ -25,7 +20,7 @@ Transceiver::Transceiver(const mcu::GpioInput& rxPin, const mcu::GpioOutput& txP
 		const mcu::GpioOutput& clkPin, uint32_t bitrate, tag::enable_bit_stuffing)
 	: emb::c28x::Singleton<Transceiver>(this)
 	, BIT_STUFFING_ENABLED(true)
-	, RX_STREAM_SIZE(STREAM_SIZE_W_BIT_STUFFING)
+	, m_rxDecoder(true)
 {
 	_init(rxPin, txPin, clkPin, bitrate);
 }
@@ -38,7 +33,7 @@ Transceiver::Transceiver(const mcu::GpioInput& rxPin, const mcu::GpioOutput& txP
 		const mcu::GpioOutput& clkPin, uint32_t bitrate, tag::disable_bit_stuffing)
 	: emb::c28x::Singleton<Transceiver>(this)
 	, BIT_STUFFING_ENABLED(false)
-	, RX_STREAM_SIZE(STREAM_SIZE_WO_BIT_STUFFING)
+	, m_rxDecoder(false)
 {
 	_init(rxPin, txPin, clkPin, bitrate);
 }
@@ -55,11 +50,16 @@ void Transceiver::_init(const mcu::GpioInput& rxPin, const mcu::GpioOutput& txPi
 	m_clkPin = clkPin;
 	m_rxPin.registerInterruptHandler(GPIO_INT_XINT5, GPIO_INT_TYPE_FALLING_EDGE, onRxStart);
 
-	reset();
+	m_clkGatingEnabled = true;
+	m_clkRunning = false;
+	m_clkInterruptCount = 0;
+	m_clkInterruptCycles = 0;
+
 
-	mcu::HighResolutionClock::init(1000000 / (2 * bitrate));
+	mcu::HighResolutionClock::initCycles(mcu::sysclkFreq() / (2 * bitrate));
 	mcu::HighResolutionClock::registerInterruptHandler(onClockInterrupt);
-	mcu::HighResolutionClock::start();
+
+	reset();
 
 	m_rxPin.enableInterrupts();
 }
@@ -73,17 +73,29 @@ void Transceiver::reset()
 	m_txActive = false;
 	m_txBitCount = 0;
 	m_txIdx = 0;
-	m_txError = 0;
 
 	m_rxActive = false;
 	m_rxSyncFlag = 0;
-	m_rxBitCount = 0;
 	m_rxIdx = 0;
+	m_rxIdleBits = 0;
+	m_rxDecoder.reset();
 	m_rxDataReady = false;
+	m_rxResult = 0;
+
+	m_errors.reset();
 
 	m_clkFlag = 0;
 
 	GPIO_writePin(m_txPin.no(), TX_PIN_IDLE_STATE);
+
+	if (m_clkGatingEnabled)
+	{
+		stopClock();
+	}
+	else if (!m_clkRunning)
+	{
+		startClock();
+	}
 }
 
 
@@ -93,6 +105,7 @@ void Transceiver::reset()
 __interrupt void Transceiver::onClockInterrupt()
 {
 	Transceiver* transceiver = Transceiver::instance();
+	++transceiver->m_clkInterruptCount;
 	transceiver->m_clkFlag = 1 - transceiver->m_clkFlag;
 
 	if ((transceiver->m_txActive) && transceiver->m_clkFlag)
@@ -106,48 +119,67 @@ __interrupt void Transceiver::onClockInterrupt()
 		{
 			GPIO_writePin(transceiver->m_txPin.no(), TX_PIN_IDLE_STATE);
 			transceiver->m_txActive = false;
+			transceiver->m_errors.onTxSuccess();
 		}
 	}
 
 	if ((transceiver->m_rxActive) && (transceiver->m_clkFlag == transceiver->m_rxSyncFlag))
 	{
-		static int prevBit = 0;
-		static int sameBits = 0;
+		transceiver->processRxBit(GPIO_readPin(transceiver->m_rxPin.no()));
+	}
+
+	// counter is reloaded on expiry, so elapsed cycles are time since this interrupt was requested
+	transceiver->m_clkInterruptCycles += mcu::HighResolutionClock::elapsedCycles();
+
+	if (transceiver->m_clkGatingEnabled && !transceiver->m_txActive && !transceiver->m_rxActive)
+	{
+		transceiver->stopClock();
+	}
+}
 
-		if (transceiver->m_rxIdx < transceiver->RX_STREAM_SIZE)
-		{
-			int bit = GPIO_readPin(transceiver->m_rxPin.no());
-			rxCanBitStream[transceiver->m_rxIdx++] = bit;
 
-			if (transceiver->BIT_STUFFING_ENABLED)
+///
+///
+///
+void Transceiver::processRxBit(int bit)
+{
+	if (m_rxDecoder.status() == FrameDecoder::IN_PROGRESS)
+	{
+		switch (m_rxDecoder.push(bit))
+		{
+		case FrameDecoder::IN_PROGRESS:
+		case FrameDecoder::REJECTED:
+			break;
+		case FrameDecoder::COMPLETED:
+		case FrameDecoder::FAILED:
+			m_rxResult = m_rxDecoder.result(m_rxFrame);
+			if (m_rxResult < 0)
+			{
+				m_errors.onRxError();
+			}
+			else
 			{
-				if (bit == prevBit)
-				{
-					if(!sameBits)
-						sameBits = 2;
-					else
-						++sameBits;
-				}
-				else
-				{
-					sameBits = 0;
-				}
-				prevBit = bit;
-				if (sameBits == 10)
-				{
-					prevBit = 0;
-					sameBits = 0;
-					transceiver->terminateRx();
-				}
+				m_errors.onRxSuccess();
 			}
+			m_rxDataReady = true;		// RX data can be read by recv()
+			break;
 		}
-		else
+	}
+	else
+	{
+		// frame is decoded or dropped, wait for bus idle
+		m_rxIdleBits = bit ? m_rxIdleBits + 1 : 0;
+		if (m_rxIdleBits >= RX_IDLE_BITS)
 		{
-			prevBit = 0;
-			sameBits = 0;
-			transceiver->terminateRx();
+			terminateRx();
+			return;
 		}
 	}
+
+	if (++m_rxIdx >= STREAM_SIZE_W_BIT_STUFFING)
+	{
+		terminateRx();
+	}
 }
 
 
@@ -157,9 +189,7 @@ __interrupt void Transceiver::onClockInterrupt()
 void Transceiver::terminateRx()
 {
 	m_rxActive = false;
-	m_rxBitCount = m_rxIdx;
 	m_rxPin.enableInterrupts();	// ready for new frame;
-	m_rxDataReady = true;		// RX data can be read by recv()
 	GPIO_togglePin(m_clkPin.no());
 }
 
@@ -170,8 +200,20 @@ void Transceiver::terminateRx()
 __interrupt void Transceiver::onRxStart()
 {
 	Transceiver* transceiver = Transceiver::instance();
-	transceiver->m_rxSyncFlag = 1 - transceiver->m_clkFlag;	// begin receiving on next CLK INT
+	if (transceiver->m_clkRunning)
+	{
+		transceiver->m_rxSyncFlag = 1 - transceiver->m_clkFlag;	// begin receiving on next CLK INT
+	}
+	else
+	{
+		// timer is restarted from this edge: first CLK INT is in the middle of SOF
+		transceiver->m_clkFlag = 0;
+		transceiver->m_rxSyncFlag = 1;
+		transceiver->startClock();
+	}
 	transceiver->m_rxIdx = 0;
+	transceiver->m_rxIdleBits = 0;
+	transceiver->m_rxDecoder.reset();
 	transceiver->m_rxActive = true;
 	transceiver->m_rxPin.disableInterrupts();		// no interrupts until this frame will be received
 
@@ -183,244 +225,27 @@ __interrupt void Transceiver::onRxStart()
 ///
 ///
 ///
-int Transceiver::generateTxCanFrame(unsigned int frameId, const uint16_t* buf, size_t len, bool bitStuffingEnabled)
+bool Transceiver::_checkTxAllowed()
 {
-	assert(len <= 9);
-	assert(frameId <= 0x7FF);
-
-	size_t idx = 0;
-
-	// init bit streams
-	txBitStream.fill(-1);
-	txCanBitStream.fill(-1);
-
-	// SOF
-	txBitStream[idx++] = 0;
-
-	// ID
-	for (size_t i = 0; i < 11; ++i)
-	{
-		txBitStream[idx++] = ((frameId >> (10 - i)) & 1) ? 1 : 0;
-	}
-
-	// RTR, IDE, r0
-	txBitStream[idx++] = 0;
-	txBitStream[idx++] = 0;
-	txBitStream[idx++] = 0;
-
-	// DLC
-	for (size_t i = 0; i < 4; ++i)
-	{
-		txBitStream[idx++] = ((len >> (3 - i)) & 1) ? 1 : 0;
-	}
-
-	// DATA
-	for (size_t i = 0; i < len; ++i)
+	mcu::CRITICAL_SECTION;
+	if (m_txActive)
 	{
-		for (size_t j = 0; j < 8; ++j)
-		{
-			txBitStream[idx++] = ((buf[i] >> (7 - j)) & 1) ? 1 : 0;
-		}
-	}
-
-	// CRC
-	size_t bitCount = idx;
-	uint16_t crcReg = 0;
-	int16_t crcNext;
-	for (size_t i = 0; i < bitCount; ++i)
-	{
-		crcNext = txBitStream[i] ^ ((crcReg & 0x4000) >> 14);
-		crcReg = (crcReg << 1) & 0x7FFE;
-		if (crcNext)
-		{
-			crcReg = crcReg ^ 0x4599;	// CAN-15 CRC polynomial
-		}
-	}
-
-	for (size_t i = 0; i < 15; ++i)
-	{
-		txBitStream[idx++] = ((crcReg >> (14 - i)) & 1) ? 1 : 0;
+		m_errors.onTxBusy();		// previous frame is still being transmitted, local overrun
+		return false;
 	}
-
-	// CRC delimiter
-	txBitStream[idx++] = 1;
-
-	//Stuff bits: check for 5 consecutive bit states
-	//then insert opposite bit state if this occurs
-	bitCount = idx;
-	size_t canIdx = 0;
-
-	if (bitStuffingEnabled)
-	{
-		int16_t prevBit = txBitStream[0];
-		txCanBitStream[0] = txBitStream[0];
-		++canIdx;
-
-		int sameBits = 0;
-		int stuffBits = 0;
-
-		for (size_t i = 1; i < bitCount; ++i)
-		{
-			txCanBitStream[canIdx++] = txBitStream[i];
-
-			if(prevBit == txBitStream[i])
-			{
-				if (!sameBits)
-					sameBits = 2;
-				else
-					++sameBits;
-
-				if (sameBits == 5)
-				{
-					txCanBitStream[canIdx++] = (txBitStream[i] == 1) ? 0 : 1;
-					sameBits = 0;
-					++stuffBits;
-				}
-			}
-			else
-			{
-				sameBits = 0;
-			}
-
-			prevBit = txCanBitStream[canIdx - 1];
-		}
-	}
-	else
-	{
-		for (size_t i = 0; i < bitCount; ++i)
-		{
-			txCanBitStream[canIdx++] = txBitStream[i];
-		}
-	}
-
-	// Append 14 recessive bits at the end of the bitstream
-	for (size_t i = 0; i < 14; ++i)
-	{
-		txCanBitStream[canIdx++] = 1;
-	}
-
-	return canIdx;
+	return true;
 }
 
 
 ///
 ///
 ///
-int Transceiver::parseRxCanFrame(unsigned int& frameId, uint16_t* buf, bool bitStuffingEnabled)
+int Transceiver::generateTxCanFrame(const Frame& frame)
 {
-	// init bit stream
-	rxBitStream.fill(-1);
-
-	//Destuff bits: check for 5 consecutive bit states
-	//then skip bit if this occurs
-	size_t bitCount = rxCanBitStream.size();
-	size_t canIdx = 0;
-	size_t idx = 0;
-
-	if (bitStuffingEnabled)
-	{
-		int16_t prevBit = rxBitStream[0];
-		rxBitStream[0] = rxCanBitStream[0];
-		++canIdx;
-		++idx;
-
-		int sameBits = 0;
-		int stuffBits = 0;
-
-		while (canIdx < bitCount)
-		{
-			rxBitStream[idx++] = rxCanBitStream[canIdx++];
-
-			if(prevBit == rxCanBitStream[canIdx-1])
-			{
-				if (!sameBits)
-					sameBits = 2;
-				else
-					++sameBits;
-
-				if (sameBits == 5)
-				{
-					++canIdx;
-					sameBits = 0;
-					++stuffBits;
-				}
-			}
-			else
-			{
-				sameBits = 0;
-			}
-
-			prevBit = rxCanBitStream[canIdx - 1];
-		}
-	}
-	else
-	{
-		while (canIdx < bitCount)
-		{
-			rxBitStream[idx++] = rxCanBitStream[canIdx++];
-		}
-	}
-
-	idx = 0;
-
-	// SOF
-	if (rxBitStream[idx++] != 0) return -1;
-
-	// ID
-	frameId = 0;
-	for (size_t i = 0; i < 11; ++i)
-	{
-		frameId |= rxBitStream[idx++] << (10 - i);
-	}
-
-	// RTR, IDE, r0
-	if (rxBitStream[idx++] != 0) return -2;
-	if (rxBitStream[idx++] != 0) return -3;
-	if (rxBitStream[idx++] != 0) return -4;
-
-	// DLC
-	int len = 0;
-	for (size_t i = 0; i < 4; ++i)
-	{
-		len |= rxBitStream[idx++] << (3 - i);
-	}
-
-	// DATA
-	for (size_t i = 0; i < len; ++i)
-	{
-		for (size_t j = 0; j < 8; ++j)
-		{
-			buf[i] |= rxBitStream[idx++] << (7 - j);
-		}
-	}
-
-	// CRC
-	bitCount = idx;
-	uint16_t crcReg = 0;
-	int16_t crcNext;
-	for (size_t i = 0; i < bitCount; ++i)
-	{
-		crcNext = rxBitStream[i] ^ ((crcReg & 0x4000) >> 14);
-		crcReg = (crcReg << 1) & 0x7FFE;
-		if (crcNext)
-		{
-			crcReg = crcReg ^ 0x4599;	// CAN-15 CRC polynomial
-		}
-	}
-
-	uint16_t crcRegRx = 0;
-	for (size_t i = 0; i < 15; ++i)
-	{
-		crcRegRx |= rxBitStream[idx++] << (14 - i);
-	}
-
-	if (crcReg != crcRegRx) return -5;
-
-	return len;
+	return encodeFrame(txCanBitStream, frame, BIT_STUFFING_ENABLED);
 }
 
 
-
 } // namespace canbygpio
 
 
@@ -13,53 +13,20 @@
 #include "emb/emb_array.h"
 #include "emb/emb_math.h"
 
+#include "mcu/system/mcu_system.h"
 #include "mcu/gpio/mcu_gpio.h"
 #include "mcu/cputimers/mcu_cputimers.h"
 #include "profiler/profiler.h"
 
+#include "canbygpio_framing.h"
+#include "canbygpio_errors.h"
+
 
 namespace canbygpio {
 /// @addtogroup can_by_gpio
 /// @{
 
 
-/**
- * @brief CAN frame.
- */
-struct Frame
-{
-	uint16_t IFS : 3;		// Inter-frame spacing, Must be recessive (1)
-	uint16_t EndOfFrame : 7;	// End-of-frame, Must be recessive (1)
-	uint16_t ACK_Delimiter : 1;	// ACK delimiter, Must be recessive (1)
-	uint16_t ACK: 1;		// ACK slot, Transmitter sends recessive (1) and any receiver can assert a dominant (0)
-	uint16_t CRC_Delimiter : 1;	// CRC delimiter, Must be recessive (1)
-	uint16_t CRC : 15;		// Cyclic redundancy check
-	uint16_t D7 : 8;
-	uint16_t D6 : 8;
-	uint16_t D5 : 8;
-	uint16_t D4 : 8;
-	uint16_t D3 : 8;
-	uint16_t D2 : 8;
-	uint16_t D1 : 8;
-	uint16_t D0 : 8;
-	uint16_t DLC : 4;		// Data length code (0-8 bytes)
-	uint16_t r0 : 1;		// Reserved bit, Must be dominant (0)
-	uint16_t IDE : 1;		// Identifier extension bit, Must be dominant (0) for base frame format with 11-bit identifiers
-	uint16_t RTR : 1;		// Must be dominant (0) for data frames
-	uint16_t ID : 11;		// Identifier
-	uint16_t StartOfFrame : 1;	// Start-of-frame = 0
-};
-
-
-/// Tags for tag dispatching
-namespace tag {
-
-struct enable_bit_stuffing {};
-struct disable_bit_stuffing {};
-
-} // namespace tag
-
-
 /**
  * @brief CAN-by-GPIO transceiver.
  * Uses mcu::HighResolutionClock.
@@ -68,9 +35,9 @@ class Transceiver : emb::c28x::Singleton<Transceiver>
 {
 private:
 	const bool BIT_STUFFING_ENABLED;
-	const size_t RX_STREAM_SIZE;
 
 	static const uint32_t TX_PIN_IDLE_STATE = 1;
+	static const unsigned int RX_IDLE_BITS = 10;
 
 	mcu::GpioInput m_rxPin;
 	mcu::GpioOutput m_txPin;
@@ -79,19 +46,23 @@ private:
 	bool m_txActive;
 	int m_txBitCount;
 	int m_txIdx;
-	uint64_t m_txError;
 
 	bool m_rxActive;
 	unsigned int m_rxSyncFlag;
-	int m_rxBitCount;
-	int m_rxIdx;
-	bool m_rxDataReady;
-	uint64_t m_rxError;
+	size_t m_rxIdx;
+	unsigned int m_rxIdleBits;
+	FrameDecoder m_rxDecoder;
+	volatile bool m_rxDataReady;
+	int m_rxResult;
+	Frame m_rxFrame;
 
-	unsigned int m_clkFlag;
+	ErrorCounters m_errors;
 
-	uint16_t txData[8];
-	uint16_t rxData[8];
+	unsigned int m_clkFlag;
+	bool m_clkGatingEnabled;
+	volatile bool m_clkRunning;
+	uint32_t m_clkInterruptCount;
+	uint64_t m_clkInterruptCycles;
 
 public:
 	/**
@@ -99,7 +70,7 @@ public:
 	 * @param rxPin - RX pin
 	 * @param txPin - TX pin
 	 * @param clkPin - aux CLK pin
-	 * @param bitrate - bitrate
+	 * @param bitrate - bitrate, SYSCLK must be divisible by double bitrate for exact bit timing
 	 */
 	Transceiver(const mcu::GpioInput& rxPin, const mcu::GpioOutput& txPin,
 			const mcu::GpioOutput& clkPin, uint32_t bitrate, tag::enable_bit_stuffing);
@@ -109,7 +80,7 @@ public:
 	 * @param rxPin - RX pin
 	 * @param txPin - TX pin
 	 * @param clkPin - aux CLK pin
-	 * @param bitrate - bitrate
+	 * @param bitrate - bitrate, SYSCLK must be divisible by double bitrate for exact bit timing
 	 */
 	Transceiver(const mcu::GpioInput& rxPin, const mcu::GpioOutput& txPin,
 			const mcu::GpioOutput& clkPin, uint32_t bitrate, tag::disable_bit_stuffing);
@@ -121,49 +92,143 @@ public:
 	 */
 	void reset();
 
+	/**
+	 * @brief Adds RX acceptance filter. If no filters are added, all frames are received.
+	 * @param filter - acceptance filter
+	 * @return \c true if filter is added, \c false if there is no free filter slot.
+	 */
+	bool addFilter(const AcceptanceFilter& filter)
+	{
+		mcu::CRITICAL_SECTION;
+		return m_rxDecoder.addFilter(filter);
+	}
+
 	/**
 	 * @brief Sends a CAN frame.
-	 * @param frameId - CAN frame ID
-	 * @param buf - CAN frame data buffer
-	 * @param len - CAN frame data length
-	 * @return Number of bytes sent, or error code if an error occurred.
+	 * @param frame - CAN frame
+	 * @return Number of bytes sent, 0 if transceiver is busy.
 	 */
-	int send(unsigned int frameId, const uint16_t* buf, size_t len)
+	int send(const Frame& frame)
 	{
-		if (m_txActive)
+		if (!_checkTxAllowed())
 		{
-			++m_txError;
 			return 0;
 		}
 
-		m_txBitCount = generateTxCanFrame(frameId, buf, len, BIT_STUFFING_ENABLED);
+		m_txBitCount = generateTxCanFrame(frame);
 		m_txIdx = 0;
+
+		mcu::CRITICAL_SECTION;
 		m_txActive = true;
-		return len;
+		if (!m_clkRunning)
+		{
+			m_clkFlag = 0;			// first bit is written on the first CLK INT
+			startClock();
+		}
+		return frame.len;
 	}
 
 	/**
-	 * @brief Receives a CAN frame.
+	 * @brief Sends a CAN data frame with 11-bit ID.
 	 * @param frameId - CAN frame ID
-	 * @param buf - frame data buffer
+	 * @param buf - CAN frame data buffer
+	 * @param len - CAN frame data length
+	 * @return Number of bytes sent, 0 if transceiver is busy.
+	 */
+	int send(uint32_t frameId, const uint16_t* buf, size_t len)
+	{
+		return send(Frame(frameId, buf, len));
+	}
+
+	/**
+	 * @brief Receives a CAN frame.
+	 * @param frame - CAN frame, only ID and format are valid if an error occurred
 	 * @return Number of bytes received, or error code if an error occurred.
 	 */
-	int recv(unsigned int& frameId, uint16_t* buf)
+	int recv(Frame& frame)
 	{
 		int retval = 0;
 		if (m_rxDataReady)
 		{
-			retval = parseRxCanFrame(frameId, buf, BIT_STUFFING_ENABLED);
+			mcu::CRITICAL_SECTION;
+			retval = m_rxResult;
+			frame = m_rxFrame;
 			m_rxDataReady = false;
 		}
 		return retval;
 	}
 
+	/**
+	 * @brief Returns error counters and frame statistics.
+	 * @param (none)
+	 * @return Error counters.
+	 */
+	const ErrorCounters& errorCounters() const { return m_errors; }
+
+	/**
+	 * @brief Enables stopping of CLK timer while both TX and RX are idle.
+	 * @param (none)
+	 * @return (none)
+	 */
+	void enableClockGating()
+	{
+		mcu::CRITICAL_SECTION;
+		m_clkGatingEnabled = true;
+	}
+
+	/**
+	 * @brief Disables stopping of CLK timer, CLK interrupts run continuously.
+	 * @param (none)
+	 * @return (none)
+	 */
+	void disableClockGating()
+	{
+		mcu::CRITICAL_SECTION;
+		m_clkGatingEnabled = false;
+		if (!m_clkRunning)
+		{
+			startClock();
+		}
+	}
+
+	/**
+	 * @brief Returns number of CLK interrupts since start, can be used to estimate CPU load.
+	 * @param (none)
+	 * @return Number of CLK interrupts.
+	 */
+	uint32_t clockInterruptCount() const { return m_clkInterruptCount; }
+
+	/**
+	 * @brief Returns SYSCLK cycles spent in CLK interrupts since start. Each interrupt is measured
+	 * from CLK timer expiry to handler exit, so entry latency is included. CPU2 load of CLK interrupts
+	 * is increment of this value divided by number of SYSCLK cycles elapsed.
+	 * @param (none)
+	 * @return SYSCLK cycles spent in CLK interrupts.
+	 */
+	uint64_t clockInterruptCycles() const
+	{
+		mcu::CRITICAL_SECTION;
+		return m_clkInterruptCycles;
+	}
+
 protected:
+	void startClock()
+	{
+		m_clkRunning = true;
+		mcu::HighResolutionClock::start();
+	}
+
+	void stopClock()
+	{
+		mcu::HighResolutionClock::stop();
+		m_clkRunning = false;
+	}
+
 	void _init(const mcu::GpioInput& rxPin, const mcu::GpioOutput& txPin,
 			const mcu::GpioOutput& clkPin, uint32_t bitrate);
-	int generateTxCanFrame(unsigned int frameId, const uint16_t* buf, size_t len, bool bitStuffingEnabled);
-	int parseRxCanFrame(unsigned int& frameId, uint16_t* buf, bool bitStuffingEnabled);
+	bool _checkTxAllowed();
+	int generateTxCanFrame(const Frame& frame);
+	void processRxBit(int bit);
 	void terminateRx();
 	static __interrupt void onClockInterrupt();
 	static __interrupt void onRxStart();
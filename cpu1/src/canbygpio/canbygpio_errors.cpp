@@ -0,0 +1,72 @@
+/**
+ * @file
+ * @ingroup can_by_gpio
+ */
+
+
+#include "canbygpio_errors.h"
+
+
+namespace canbygpio {
+
+
+///
+///
+///
+void ErrorCounters::reset()
+{
+	m_rec = 0;
+	m_state = ERROR_ACTIVE;
+
+	m_txFrameCount = 0;
+	m_txBusyCount = 0;
+	m_rxFrameCount = 0;
+	m_rxErrorCount = 0;
+}
+
+
+///
+///
+///
+void ErrorCounters::onRxSuccess()
+{
+	++m_rxFrameCount;
+	if (m_rec >= ERROR_PASSIVE_LIMIT)
+	{
+		m_rec = ERROR_PASSIVE_LIMIT - 1;	// ISO 11898-1 allows any value between 119 and 127
+	}
+	else if (m_rec > 0)
+	{
+		--m_rec;
+	}
+	_updateState();
+}
+
+
+///
+///
+///
+void ErrorCounters::onRxError()
+{
+	++m_rxErrorCount;
+	m_rec += RX_ERROR_INCREMENT;
+	if (m_rec > REC_MAX)
+	{
+		m_rec = REC_MAX;
+	}
+	_updateState();
+}
+
+
+///
+///
+///
+void ErrorCounters::_updateState()
+{
+	m_state = (m_rec >= ERROR_PASSIVE_LIMIT) ? ERROR_PASSIVE : ERROR_ACTIVE;
+}
+
+
+} // namespace canbygpio
+
+
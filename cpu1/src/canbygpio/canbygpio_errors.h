@@ -0,0 +1,138 @@
+/**
+ * @file
+ * @ingroup can_by_gpio
+ */
+
+
+#pragma once
+
+
+#include "emb/emb_common.h"
+
+
+namespace canbygpio {
+/// @addtogroup can_by_gpio
+/// @{
+
+
+/// Transceiver error states
+enum ErrorState
+{
+	ERROR_ACTIVE,
+	ERROR_PASSIVE
+};
+
+
+/**
+ * @brief Receive error counter with CAN (ISO 11898-1) fault confinement semantics:
+ * REC is incremented on RX error and decremented on successful RX, node is error-passive when REC exceeds 127.
+ * Transmitters do not read back transmitted bits and bus does not guarantee ACK (fuel cell nodes run
+ * without bit stuffing), so TX errors are not detected: there is no TEC and no bus-off state.
+ * Also counts frames and RX errors since reset. Frames rejected because previous frame is still being transmitted
+ * are local overruns, they are counted separately.
+ */
+class ErrorCounters
+{
+public:
+	static const uint16_t ERROR_PASSIVE_LIMIT = 128;
+	static const uint16_t RX_ERROR_INCREMENT = 1;
+	static const uint16_t REC_MAX = 255;
+
+private:
+	uint16_t m_rec;
+	ErrorState m_state;
+
+	uint32_t m_txFrameCount;
+	uint32_t m_txBusyCount;
+	uint32_t m_rxFrameCount;
+	uint32_t m_rxErrorCount;
+
+public:
+	ErrorCounters() { reset(); }
+
+	/**
+	 * @brief Resets counters and statistics, node becomes error-active.
+	 * @param (none)
+	 * @return (none)
+	 */
+	void reset();
+
+	/**
+	 * @brief Registers transmitted frame.
+	 * @param (none)
+	 * @return (none)
+	 */
+	void onTxSuccess() { ++m_txFrameCount; }
+
+	/**
+	 * @brief Registers frame that is rejected because previous frame is still being transmitted.
+	 * @param (none)
+	 * @return (none)
+	 */
+	void onTxBusy() { ++m_txBusyCount; }
+
+	/**
+	 * @brief Registers successfully received frame.
+	 * @param (none)
+	 * @return (none)
+	 */
+	void onRxSuccess();
+
+	/**
+	 * @brief Registers reception error.
+	 * @param (none)
+	 * @return (none)
+	 */
+	void onRxError();
+
+	/**
+	 * @brief Returns receive error counter.
+	 * @param (none)
+	 * @return REC value.
+	 */
+	uint16_t rec() const { return m_rec; }
+
+	/**
+	 * @brief Returns error state.
+	 * @param (none)
+	 * @return Error state.
+	 */
+	ErrorState state() const { return m_state; }
+
+	/**
+	 * @brief Returns number of transmitted frames since reset.
+	 * @param (none)
+	 * @return Number of transmitted frames.
+	 */
+	uint32_t txFrameCount() const { return m_txFrameCount; }
+
+	/**
+	 * @brief Returns number of frames rejected because transmitter was busy since reset.
+	 * @param (none)
+	 * @return Number of rejected frames.
+	 */
+	uint32_t txBusyCount() const { return m_txBusyCount; }
+
+	/**
+	 * @brief Returns number of received frames since reset.
+	 * @param (none)
+	 * @return Number of received frames.
+	 */
+	uint32_t rxFrameCount() const { return m_rxFrameCount; }
+
+	/**
+	 * @brief Returns number of reception errors since reset.
+	 * @param (none)
+	 * @return Number of reception errors.
+	 */
+	uint32_t rxErrorCount() const { return m_rxErrorCount; }
+
+private:
+	void _updateState();
+};
+
+
+/// @}
+} // namespace canbygpio
+
+
@@ -0,0 +1,376 @@
+/**
+ * @file
+ * @ingroup can_by_gpio
+ */
+
+
+#include "canbygpio_framing.h"
+
+
+namespace canbygpio {
+
+
+/**
+ * @brief Writes bits to stream inserting stuff bits if required.
+ */
+class StuffingWriter
+{
+private:
+	BitStream& m_stream;
+	const bool BIT_STUFFING_ENABLED;
+	size_t m_idx;
+	int m_prevBit;
+	int m_sameBits;
+public:
+	StuffingWriter(BitStream& stream, bool bitStuffingEnabled)
+		: m_stream(stream)
+		, BIT_STUFFING_ENABLED(bitStuffingEnabled)
+		, m_idx(0)
+		, m_prevBit(-1)
+		, m_sameBits(0)
+	{}
+
+	void write(int bit)
+	{
+		m_stream[m_idx++] = bit;
+		if (!BIT_STUFFING_ENABLED) return;
+
+		if (bit == m_prevBit)
+		{
+			m_sameBits = m_sameBits ? m_sameBits + 1 : 2;
+			if (m_sameBits == 5)
+			{
+				bit = 1 - bit;
+				m_stream[m_idx++] = bit;
+				m_sameBits = 0;
+			}
+		}
+		else
+		{
+			m_sameBits = 0;
+		}
+		m_prevBit = bit;
+	}
+
+	void writeRaw(int bit) { m_stream[m_idx++] = bit; }
+	size_t size() const { return m_idx; }
+};
+
+
+/**
+ * @brief Writes bits to stream inserting stuff bits if required, and calculates CRC.
+ */
+class FrameWriter : public StuffingWriter
+{
+private:
+	uint16_t m_crc;
+public:
+	FrameWriter(BitStream& stream, bool bitStuffingEnabled)
+		: StuffingWriter(stream, bitStuffingEnabled)
+		, m_crc(0)
+	{}
+
+	void writeField(uint32_t value, unsigned int bitCount)
+	{
+		for (unsigned int i = bitCount; i > 0; --i)
+		{
+			int bit = (value >> (i - 1)) & 1;
+			write(bit);
+			m_crc = updateCrc15(m_crc, bit);
+		}
+	}
+
+	uint16_t crc() const { return m_crc; }
+};
+
+
+///
+///
+///
+size_t encodeFrame(BitStream& stream, const Frame& frame, bool bitStuffingEnabled)
+{
+	assert(frame.len <= 8);
+	assert(frame.id <= (frame.extended ? 0x1FFFFFFFUL : 0x7FFUL));
+
+	FrameWriter writer(stream, bitStuffingEnabled);
+
+	writer.writeField(0, 1);				// SOF
+	if (frame.extended)
+	{
+		writer.writeField(frame.id >> 18, 11);		// base ID
+		writer.writeField(1, 1);			// SRR
+		writer.writeField(1, 1);			// IDE
+		writer.writeField(frame.id & 0x3FFFF, 18);	// ID extension
+		writer.writeField(frame.remote ? 1 : 0, 1);	// RTR
+		writer.writeField(0, 2);			// r1, r0
+	}
+	else
+	{
+		writer.writeField(frame.id, 11);		// ID
+		writer.writeField(frame.remote ? 1 : 0, 1);	// RTR
+		writer.writeField(0, 2);			// IDE, r0
+	}
+	writer.writeField(frame.len, 4);			// DLC
+
+	if (!frame.remote)
+	{
+		for (size_t i = 0; i < frame.len; ++i)
+		{
+			writer.writeField(frame.data[i], 8);	// DATA
+		}
+	}
+
+	// CRC
+	uint16_t crc = writer.crc();
+	for (size_t i = 0; i < 15; ++i)
+	{
+		writer.write((crc >> (14 - i)) & 1);
+	}
+
+	// CRC delimiter
+	writer.write(1);
+
+	// Append 14 recessive bits at the end of the bitstream
+	for (size_t i = 0; i < 14; ++i)
+	{
+		writer.writeRaw(1);
+	}
+
+	return writer.size();
+}
+
+
+///
+///
+///
+void FrameDecoder::reset()
+{
+	m_status = IN_PROGRESS;
+	m_error = 0;
+	_enterField(FIELD_SOF, 1);
+
+	m_prevBit = -1;
+	m_sameBits = 0;
+	m_stuffBitExpected = false;
+
+	m_crc = 0;
+	m_crcRx = 0;
+
+	m_frameId = 0;
+	m_idReceived = false;
+	m_extended = false;
+	m_remote = false;
+	m_dlc = 0;
+	m_dataBitIdx = 0;
+	for (size_t i = 0; i < 8; ++i)
+	{
+		m_data[i] = 0;
+	}
+}
+
+
+///
+///
+///
+FrameDecoder::Status FrameDecoder::push(int bit)
+{
+	if (m_status != IN_PROGRESS)
+	{
+		return m_status;
+	}
+
+	bit = bit ? 1 : 0;
+
+	if (BIT_STUFFING_ENABLED)
+	{
+		if (m_stuffBitExpected)
+		{
+			m_stuffBitExpected = false;
+			if (bit == m_prevBit)
+			{
+				return _fail(FRAME_ERROR_STUFF);
+			}
+			m_prevBit = bit;
+			m_sameBits = 0;
+			return m_status;
+		}
+
+		if (bit == m_prevBit)
+		{
+			m_sameBits = m_sameBits ? m_sameBits + 1 : 2;
+			if (m_sameBits == 5)
+			{
+				m_stuffBitExpected = true;
+				m_sameBits = 0;
+			}
+		}
+		else
+		{
+			m_sameBits = 0;
+		}
+		m_prevBit = bit;
+	}
+
+	if (m_field != FIELD_CRC)
+	{
+		m_crc = updateCrc15(m_crc, bit);
+	}
+
+	switch (m_field)
+	{
+	case FIELD_SOF:
+		if (bit != 0) return _fail(FRAME_ERROR_SOF);
+		_enterField(FIELD_ID, 11);
+		break;
+	case FIELD_ID:
+		m_frameId = (m_frameId << 1) | bit;
+		if (--m_fieldBitsLeft == 0) _enterField(FIELD_SRR_RTR, 1);
+		break;
+	case FIELD_SRR_RTR:
+		m_remote = bit;					// RTR of base frame or SRR of extended frame
+		_enterField(FIELD_IDE, 1);
+		break;
+	case FIELD_IDE:
+		m_extended = bit;
+		if (m_extended)
+		{
+			if (!m_remote) return _fail(FRAME_ERROR_SRR);
+			_enterField(FIELD_ID_EXT, 18);
+		}
+		else
+		{
+			m_idReceived = true;
+			if (!_accepted())
+			{
+				m_status = REJECTED;
+				return m_status;
+			}
+			_enterField(FIELD_R0, 1);
+		}
+		break;
+	case FIELD_ID_EXT:
+		m_frameId = (m_frameId << 1) | bit;
+		if (--m_fieldBitsLeft == 0)
+		{
+			m_idReceived = true;
+			if (!_accepted())
+			{
+				m_status = REJECTED;
+				return m_status;
+			}
+			_enterField(FIELD_RTR, 1);
+		}
+		break;
+	case FIELD_RTR:
+		m_remote = bit;
+		_enterField(FIELD_R1, 1);
+		break;
+	case FIELD_R1:
+		if (bit != 0) return _fail(FRAME_ERROR_R0);
+		_enterField(FIELD_R0, 1);
+		break;
+	case FIELD_R0:
+		if (bit != 0) return _fail(FRAME_ERROR_R0);
+		_enterField(FIELD_DLC, 4);
+		break;
+	case FIELD_DLC:
+		m_dlc = (m_dlc << 1) | bit;
+		if (--m_fieldBitsLeft == 0)
+		{
+			if (!m_remote && (_len() != 0))
+			{
+				_enterField(FIELD_DATA, 8 * _len());
+			}
+			else
+			{
+				_enterField(FIELD_CRC, 15);
+			}
+		}
+		break;
+	case FIELD_DATA:
+		m_data[m_dataBitIdx / 8] = (m_data[m_dataBitIdx / 8] << 1) | bit;
+		++m_dataBitIdx;
+		if (--m_fieldBitsLeft == 0) _enterField(FIELD_CRC, 15);
+		break;
+	case FIELD_CRC:
+		m_crcRx = (m_crcRx << 1) | bit;
+		if (--m_fieldBitsLeft == 0)
+		{
+			if (m_crcRx != m_crc) return _fail(FRAME_ERROR_CRC);
+			m_status = COMPLETED;
+		}
+		break;
+	}
+
+	return m_status;
+}
+
+
+///
+///
+///
+bool FrameDecoder::_accepted() const
+{
+	if (m_filterCount == 0) return true;
+
+	for (size_t i = 0; i < m_filterCount; ++i)
+	{
+		if ((m_filters[i].extended == m_extended)
+				&& (((m_frameId ^ m_filters[i].id) & m_filters[i].mask) == 0))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+///
+///
+///
+int FrameDecoder::result(Frame& frame) const
+{
+	switch (m_status)
+	{
+	case COMPLETED:
+		frame.id = m_frameId;
+		frame.extended = m_extended;
+		frame.remote = m_remote;
+		frame.len = _len();
+		if (!m_remote)
+		{
+			for (size_t i = 0; i < _len(); ++i)
+			{
+				frame.data[i] = m_data[i];
+			}
+		}
+		return _len();
+	case FAILED:
+		frame.id = m_idReceived ? m_frameId : UNKNOWN_FRAME_ID;
+		frame.extended = m_extended;
+		frame.remote = false;
+		frame.len = 0;
+		return m_error;
+	default:
+		return FRAME_ERROR_INCOMPLETE;
+	}
+}
+
+
+///
+///
+///
+int decodeFrame(const BitStream& stream, size_t bitCount, Frame& frame, bool bitStuffingEnabled)
+{
+	FrameDecoder decoder(bitStuffingEnabled);
+	for (size_t i = 0; (i < bitCount) && (decoder.status() == FrameDecoder::IN_PROGRESS); ++i)
+	{
+		decoder.push(stream[i]);
+	}
+	return decoder.result(frame);
+}
+
+
+} // namespace canbygpio
+
+
@@ -0,0 +1,296 @@
+/**
+ * @file
+ * @ingroup can_by_gpio
+ */
+
+
+#pragma once
+
+
+#include "emb/emb_common.h"
+#include "emb/emb_array.h"
+
+
+namespace canbygpio {
+/// @addtogroup can_by_gpio
+/// @{
+
+
+/// Tags for tag dispatching
+namespace tag {
+
+struct enable_bit_stuffing {};
+struct disable_bit_stuffing {};
+
+} // namespace tag
+
+
+const size_t STREAM_SIZE_W_BIT_STUFFING = 200;
+
+
+/// CAN bit stream, one element per bit as it appears on the wire
+typedef emb::Array<int, STREAM_SIZE_W_BIT_STUFFING> BitStream;
+
+
+/// Frame ID reported for failed frames whose ID was not received completely
+const uint32_t UNKNOWN_FRAME_ID = 0xFFFFFFFF;
+
+
+/// CAN frame decoding errors
+enum FrameError
+{
+	FRAME_ERROR_SOF = -1,
+	FRAME_ERROR_SRR = -2,
+	FRAME_ERROR_R0 = -4,
+	FRAME_ERROR_CRC = -5,
+	FRAME_ERROR_STUFF = -6,
+	FRAME_ERROR_INCOMPLETE = -7
+};
+
+
+/**
+ * @brief CAN frame.
+ */
+struct Frame
+{
+	uint32_t id;		// 11-bit or 29-bit identifier
+	bool extended;		// 29-bit identifier
+	bool remote;		// remote transmission request, frame has no data
+	size_t len;		// data length (requested data length for remote frames)
+	uint16_t data[8];
+
+	Frame()
+		: id(0)
+		, extended(false)
+		, remote(false)
+		, len(0)
+	{}
+
+	Frame(uint32_t _id, const uint16_t* buf, size_t _len)
+		: id(_id)
+		, extended(false)
+		, remote(false)
+		, len(_len)
+	{
+		for (size_t i = 0; i < _len; ++i)
+		{
+			data[i] = buf[i];
+		}
+	}
+};
+
+
+/**
+ * @brief Acceptance filter: frame is accepted if format matches and (frame.id & mask) == (id & mask).
+ */
+struct AcceptanceFilter
+{
+	uint32_t id;
+	uint32_t mask;
+	bool extended;
+};
+
+
+/**
+ * @brief Shifts one bit into CAN CRC-15 register.
+ * @param crc - CRC register value
+ * @param bit - next bit of frame
+ * @return Updated CRC register value.
+ */
+inline uint16_t updateCrc15(uint16_t crc, int bit)
+{
+	int crcNext = bit ^ ((crc & 0x4000) >> 14);
+	crc = (crc << 1) & 0x7FFE;
+	if (crcNext)
+	{
+		crc = crc ^ 0x4599;	// CAN-15 CRC polynomial
+	}
+	return crc;
+}
+
+
+/**
+ * @brief Converts interval between two edges to number of equal bits.
+ * @param interval - interval between edges in timer ticks
+ * @param bitTicks - bit time in timer ticks
+ * @return Number of bits.
+ */
+inline unsigned int bitRunLength(uint32_t interval, uint32_t bitTicks)
+{
+	return (interval + bitTicks / 2) / bitTicks;
+}
+
+
+/**
+ * @brief Encodes CAN frame into bit stream: SOF...CRC delimiter, optionally stuffed,
+ * followed by 14 recessive bits.
+ * @param stream - output bit stream
+ * @param frame - CAN frame
+ * @param bitStuffingEnabled - bit stuffing flag
+ * @return Number of bits in stream.
+ */
+size_t encodeFrame(BitStream& stream, const Frame& frame, bool bitStuffingEnabled);
+
+
+/**
+ * @brief Incremental CAN frame decoder. Bits are pushed one by one as they are received,
+ * decoding completes right after the last CRC bit. Frames rejected by acceptance filters
+ * are dropped as soon as their ID is received.
+ */
+class FrameDecoder
+{
+public:
+	/// Decoder status
+	enum Status
+	{
+		IN_PROGRESS,
+		COMPLETED,
+		FAILED,
+		REJECTED
+	};
+
+	static const size_t MAX_FILTER_COUNT = 4;
+
+private:
+	enum Field
+	{
+		FIELD_SOF,
+		FIELD_ID,
+		FIELD_SRR_RTR,
+		FIELD_IDE,
+		FIELD_ID_EXT,
+		FIELD_RTR,
+		FIELD_R1,
+		FIELD_R0,
+		FIELD_DLC,
+		FIELD_DATA,
+		FIELD_CRC
+	};
+
+	const bool BIT_STUFFING_ENABLED;
+
+	Status m_status;
+	int m_error;
+
+	Field m_field;
+	unsigned int m_fieldBitsLeft;
+
+	int m_prevBit;
+	int m_sameBits;
+	bool m_stuffBitExpected;
+
+	uint16_t m_crc;
+	uint16_t m_crcRx;
+
+	uint32_t m_frameId;
+	bool m_idReceived;
+	bool m_extended;
+	bool m_remote;
+	unsigned int m_dlc;
+	unsigned int m_dataBitIdx;
+	uint16_t m_data[8];
+
+	AcceptanceFilter m_filters[MAX_FILTER_COUNT];
+	size_t m_filterCount;
+
+public:
+	/**
+	 * @brief Constructs decoder.
+	 * @param bitStuffingEnabled - bit stuffing flag
+	 */
+	explicit FrameDecoder(bool bitStuffingEnabled)
+		: BIT_STUFFING_ENABLED(bitStuffingEnabled)
+		, m_filterCount(0)
+	{
+		reset();
+	}
+
+	/**
+	 * @brief Adds acceptance filter. If no filters are added, all frames are accepted.
+	 * @param filter - acceptance filter
+	 * @return \c true if filter is added, \c false if there is no free filter slot.
+	 */
+	bool addFilter(const AcceptanceFilter& filter)
+	{
+		if (m_filterCount >= MAX_FILTER_COUNT) return false;
+		m_filters[m_filterCount++] = filter;
+		return true;
+	}
+
+	/**
+	 * @brief Removes all acceptance filters.
+	 * @param (none)
+	 * @return (none)
+	 */
+	void clearFilters() { m_filterCount = 0; }
+
+	/**
+	 * @brief Resets decoder, next pushed bit is treated as SOF.
+	 * @param (none)
+	 * @return (none)
+	 */
+	void reset();
+
+	/**
+	 * @brief Pushes next received bit into decoder.
+	 * @param bit - received bit
+	 * @return Decoder status.
+	 */
+	Status push(int bit);
+
+	/**
+	 * @brief Returns decoder status.
+	 * @param (none)
+	 * @return Decoder status.
+	 */
+	Status status() const { return m_status; }
+
+	/**
+	 * @brief Returns decoding error code.
+	 * @param (none)
+	 * @return Decoding error code if decoding failed, 0 otherwise.
+	 */
+	int error() const { return m_error; }
+
+	/**
+	 * @brief Copies decoded frame or returns error code. If decoding failed, only frame ID and format
+	 * are set (ID is UNKNOWN_FRAME_ID if error occurred before ID was received).
+	 * @param frame - decoded frame
+	 * @return Number of data bytes, or error code if an error occurred.
+	 */
+	int result(Frame& frame) const;
+
+private:
+	Status _fail(int error)
+	{
+		m_error = error;
+		m_status = FAILED;
+		return m_status;
+	}
+
+	void _enterField(Field field, unsigned int bitCount)
+	{
+		m_field = field;
+		m_fieldBitsLeft = bitCount;
+	}
+
+	size_t _len() const { return (m_dlc > 8) ? 8 : m_dlc; }
+	bool _accepted() const;
+};
+
+
+/**
+ * @brief Decodes CAN frame from bit stream.
+ * @param stream - input bit stream
+ * @param bitCount - number of bits in stream
+ * @param frame - decoded frame
+ * @param bitStuffingEnabled - bit stuffing flag
+ * @return Number of data bytes, or error code if an error occurred.
+ */
+int decodeFrame(const BitStream& stream, size_t bitCount, Frame& frame, bool bitStuffingEnabled);
+
+
+/// @}
+} // namespace canbygpio
+
+
@@ -0,0 +1,401 @@
+/**
+ * @file
+ * @ingroup can_by_gpio
+ */
+
+
+#include "canbygpio_hwtimed.h"
+
+
+namespace canbygpio {
+
+
+///
+///
+///
+HwTimedTransceiver::HwTimedTransceiver(const HwTimedTransceiverConfig& cfg, tag::enable_bit_stuffing)
+	: emb::c28x::Singleton<HwTimedTransceiver>(this)
+	, BIT_STUFFING_ENABLED(true)
+	, m_rxDecoder(true)
+{
+	_init(cfg);
+}
+
+
+///
+///
+///
+HwTimedTransceiver::HwTimedTransceiver(const HwTimedTransceiverConfig& cfg, tag::disable_bit_stuffing)
+	: emb::c28x::Singleton<HwTimedTransceiver>(this)
+	, BIT_STUFFING_ENABLED(false)
+	, m_rxDecoder(false)
+{
+	_init(cfg);
+}
+
+
+///
+///
+///
+void HwTimedTransceiver::_init(const HwTimedTransceiverConfig& cfg)
+{
+	m_capBase = mcu::detail::capBases[cfg.rxCapModule];
+	m_capPieIntNum = mcu::detail::capPieIntNums[cfg.rxCapModule];
+	m_pwmBase = mcu::detail::pwmBases[cfg.txPwmModule];
+	m_pwmPieIntNum = mcu::detail::pwmPieEventIntNums[cfg.txPwmModule];
+	m_pwmOutput = cfg.txPwmOutput;
+
+	_initTx(cfg);
+	_initRx(cfg);
+	reset();
+
+	Interrupt_register(m_pwmPieIntNum, onTxPwmInterrupt);
+	Interrupt_enable(m_pwmPieIntNum);
+	Interrupt_register(m_capPieIntNum, onRxCaptureInterrupt);
+	Interrupt_enable(m_capPieIntNum);
+}
+
+
+///
+///
+///
+void HwTimedTransceiver::_initRx(const HwTimedTransceiverConfig& cfg)
+{
+	m_rxBitTicks = mcu::sysclkFreq() / cfg.bitrate;
+
+	const uint16_t allSources = ECAP_ISR_SOURCE_CAPTURE_EVENT_1
+			| ECAP_ISR_SOURCE_CAPTURE_EVENT_2
+			| ECAP_ISR_SOURCE_CAPTURE_EVENT_3
+			| ECAP_ISR_SOURCE_CAPTURE_EVENT_4
+			| ECAP_ISR_SOURCE_COUNTER_OVERFLOW
+			| ECAP_ISR_SOURCE_COUNTER_PERIOD
+			| ECAP_ISR_SOURCE_COUNTER_COMPARE;
+	ECAP_disableInterrupt(m_capBase, allSources);
+	ECAP_clearInterrupt(m_capBase, allSources);
+
+	ECAP_disableTimeStampCapture(m_capBase);
+	ECAP_stopCounter(m_capBase);
+	ECAP_enableCaptureMode(m_capBase);
+	ECAP_setCaptureMode(m_capBase, ECAP_CONTINUOUS_CAPTURE_MODE, ECAP_EVENT_4);
+
+	// Edges always alternate, so events with alternating polarity can't get out of sync.
+	// Counter is reset on every edge: each capture holds duration of the preceding bit run.
+	ECAP_setEventPolarity(m_capBase, ECAP_EVENT_1, ECAP_EVNT_FALLING_EDGE);
+	ECAP_setEventPolarity(m_capBase, ECAP_EVENT_2, ECAP_EVNT_RISING_EDGE);
+	ECAP_setEventPolarity(m_capBase, ECAP_EVENT_3, ECAP_EVNT_FALLING_EDGE);
+	ECAP_setEventPolarity(m_capBase, ECAP_EVENT_4, ECAP_EVNT_RISING_EDGE);
+	ECAP_enableCounterResetOnEvent(m_capBase, ECAP_EVENT_1);
+	ECAP_enableCounterResetOnEvent(m_capBase, ECAP_EVENT_2);
+	ECAP_enableCounterResetOnEvent(m_capBase, ECAP_EVENT_3);
+	ECAP_enableCounterResetOnEvent(m_capBase, ECAP_EVENT_4);
+
+	ECAP_setSyncOutMode(m_capBase, ECAP_SYNC_OUT_DISABLED);
+	ECAP_startCounter(m_capBase);
+	ECAP_enableTimeStampCapture(m_capBase);
+	ECAP_reArm(m_capBase);
+
+	ECAP_enableInterrupt(m_capBase, ECAP_ISR_SOURCE_CAPTURE_EVENT_4 | ECAP_ISR_SOURCE_COUNTER_OVERFLOW);
+}
+
+
+///
+///
+///
+void HwTimedTransceiver::_initTx(const HwTimedTransceiverConfig& cfg)
+{
+	// TBPRD must hold the longest bit run
+	uint16_t prescaler = EPWM_CLOCK_DIVIDER_1;
+	while (((PWMCLK_FREQ >> prescaler) / cfg.bitrate > 0xFFFF / TX_MAX_RUN_BITS)
+			&& (prescaler < EPWM_CLOCK_DIVIDER_128))
+	{
+		++prescaler;
+	}
+	m_txBitTicks = (PWMCLK_FREQ >> prescaler) / cfg.bitrate;
+
+	EPWM_setTimeBaseCounterMode(m_pwmBase, EPWM_COUNTER_MODE_STOP_FREEZE);
+	EPWM_setClockPrescaler(m_pwmBase, static_cast<EPWM_ClockDivider>(prescaler), EPWM_HSCLOCK_DIVIDER_1);
+	EPWM_disablePhaseShiftLoad(m_pwmBase);
+	EPWM_setPeriodLoadMode(m_pwmBase, EPWM_PERIOD_DIRECT_LOAD);
+	EPWM_setTimeBaseCounter(m_pwmBase, 0);
+
+	// Every counter wrap is a level change, line is held recessive by continuous force while idle
+	EPWM_setActionQualifierAction(m_pwmBase, m_pwmOutput,
+			EPWM_AQ_OUTPUT_TOGGLE, EPWM_AQ_OUTPUT_ON_TIMEBASE_ZERO);
+	EPWM_setActionQualifierContSWForceShadowMode(m_pwmBase, EPWM_AQ_SW_IMMEDIATE_LOAD);
+	EPWM_setActionQualifierContSWForceAction(m_pwmBase, m_pwmOutput, EPWM_AQ_SW_OUTPUT_HIGH);
+	EPWM_setActionQualifierSWAction(m_pwmBase, m_pwmOutput, EPWM_AQ_OUTPUT_HIGH);
+
+	EPWM_setInterruptSource(m_pwmBase, EPWM_INT_TBCTR_ZERO);
+	EPWM_setInterruptEventCount(m_pwmBase, 1);
+	EPWM_clearEventTriggerInterruptFlag(m_pwmBase);
+	EPWM_enableInterrupt(m_pwmBase);
+}
+
+
+///
+///
+///
+void HwTimedTransceiver::reset()
+{
+	EPWM_setTimeBaseCounterMode(m_pwmBase, EPWM_COUNTER_MODE_STOP_FREEZE);
+	EPWM_setActionQualifierContSWForceAction(m_pwmBase, m_pwmOutput, EPWM_AQ_SW_OUTPUT_HIGH);
+	m_txActive = false;
+	m_txBitCount = 0;
+	m_txIdx = 0;
+
+	m_rxDecoder.reset();
+	m_rxActive = false;
+	m_capNextEvent = ECAP_EVENT_1;
+	m_rxRunBitsPushed = 0;
+	m_rxCounterOverflow = false;
+	m_rxDataReady = false;
+	m_rxResult = 0;
+	ECAP_clearInterrupt(m_capBase, ECAP_ISR_SOURCE_CAPTURE_EVENT_1
+			| ECAP_ISR_SOURCE_CAPTURE_EVENT_2
+			| ECAP_ISR_SOURCE_CAPTURE_EVENT_3
+			| ECAP_ISR_SOURCE_CAPTURE_EVENT_4
+			| ECAP_ISR_SOURCE_COUNTER_OVERFLOW);
+	ECAP_reArm(m_capBase);
+
+	m_errors.reset();
+}
+
+
+///
+///
+///
+bool HwTimedTransceiver::_checkTxAllowed()
+{
+	mcu::CRITICAL_SECTION;
+	if (m_txActive)
+	{
+		m_errors.onTxBusy();		// previous frame is still being transmitted, local overrun
+		return false;
+	}
+	return true;
+}
+
+
+///
+///
+///
+void HwTimedTransceiver::_startTx()
+{
+	// AQ output is set recessive before continuous force is released,
+	// first counter wrap toggles it to dominant SOF
+	EPWM_forceActionQualifierSWAction(m_pwmBase, m_pwmOutput);
+	EPWM_setActionQualifierContSWForceAction(m_pwmBase, m_pwmOutput, EPWM_AQ_SW_DISABLED);
+
+	EPWM_setTimeBasePeriod(m_pwmBase, m_txBitTicks - 1);
+	EPWM_setTimeBaseCounter(m_pwmBase, m_txBitTicks - 1);
+	EPWM_setTimeBaseCounterMode(m_pwmBase, EPWM_COUNTER_MODE_UP);
+}
+
+
+///
+///
+///
+size_t HwTimedTransceiver::_nextTxRun()
+{
+	size_t begin = m_txIdx;
+	int level = m_txStream[m_txIdx];
+	while ((m_txIdx < m_txBitCount) && (m_txStream[m_txIdx] == level))
+	{
+		++m_txIdx;
+	}
+	return m_txIdx - begin;
+}
+
+
+///
+///
+///
+__interrupt void HwTimedTransceiver::onTxPwmInterrupt()
+{
+	HwTimedTransceiver* transceiver = HwTimedTransceiver::instance();
+
+	if (transceiver->m_txIdx < transceiver->m_txBitCount)
+	{
+		// counter has just wrapped and the output toggled: set duration of the run that has begun
+		size_t runLength = transceiver->_nextTxRun();
+		EPWM_setTimeBasePeriod(transceiver->m_pwmBase, runLength * transceiver->m_txBitTicks - 1);
+
+		if (transceiver->m_txIdx >= transceiver->m_txBitCount)
+		{
+			// last run is recessive, keep line recessive after it
+			EPWM_setActionQualifierContSWForceAction(transceiver->m_pwmBase, transceiver->m_pwmOutput,
+					EPWM_AQ_SW_OUTPUT_HIGH);
+		}
+	}
+	else
+	{
+		EPWM_setTimeBaseCounterMode(transceiver->m_pwmBase, EPWM_COUNTER_MODE_STOP_FREEZE);
+		transceiver->m_txActive = false;
+		transceiver->m_errors.onTxSuccess();
+	}
+
+	EPWM_clearEventTriggerInterruptFlag(transceiver->m_pwmBase);
+	Interrupt_clearACKGroup(INTERRUPT_ACK_GROUP3);
+}
+
+
+///
+///
+///
+void HwTimedTransceiver::_processCaptures(int lastEvent)
+{
+	for (; m_capNextEvent <= lastEvent; ++m_capNextEvent)
+	{
+		uint32_t interval = ECAP_getEventTimeStamp(m_capBase, static_cast<ECAP_Events>(m_capNextEvent));
+		// events 1 and 3 are falling edges: preceding run is recessive
+		int levelBefore = ((m_capNextEvent == ECAP_EVENT_1) || (m_capNextEvent == ECAP_EVENT_3)) ? 1 : 0;
+		_processEdge(interval, levelBefore);
+	}
+
+	if (m_capNextEvent > ECAP_EVENT_4)
+	{
+		m_capNextEvent = ECAP_EVENT_1;
+	}
+}
+
+
+///
+///
+///
+void HwTimedTransceiver::_processEdge(uint32_t interval, int levelBefore)
+{
+	if (m_rxCounterOverflow)
+	{
+		// counter has wrapped during this run, captured value is meaningless:
+		// saturated run completes any frame in progress and is longer than bus idle
+		interval = RX_MAX_RUN_BITS * m_rxBitTicks;
+		m_rxCounterOverflow = false;
+	}
+
+	if (m_rxActive)
+	{
+		// beginning of long run may have been pushed already by _processLongRun()
+		unsigned int n = bitRunLength(interval, m_rxBitTicks);
+		n = (n > m_rxRunBitsPushed) ? n - m_rxRunBitsPushed : 0;
+		for (; (n > 0) && m_rxActive; --n)
+		{
+			_pushRxBit(levelBefore);
+		}
+	}
+	m_rxRunBitsPushed = 0;
+
+	// falling edge after bus idle is SOF of the next frame
+	if (!m_rxActive && (levelBefore == 1) && (interval >= RX_IDLE_BITS * m_rxBitTicks))
+	{
+		m_rxDecoder.reset();
+		m_rxActive = true;
+	}
+}
+
+
+///
+///
+///
+void HwTimedTransceiver::_pushRxBit(int bit)
+{
+	switch (m_rxDecoder.push(bit))
+	{
+	case FrameDecoder::IN_PROGRESS:
+		break;
+	case FrameDecoder::REJECTED:
+		m_rxActive = false;		// rest of frame is skipped until bus idle
+		break;
+	case FrameDecoder::COMPLETED:
+	case FrameDecoder::FAILED:
+		m_rxActive = false;
+		m_rxResult = m_rxDecoder.result(m_rxFrame);
+		if (m_rxResult < 0)
+		{
+			m_errors.onRxError();
+		}
+		else
+		{
+			m_errors.onRxSuccess();
+		}
+		m_rxDataReady = true;	// RX data can be read by recv()
+		break;
+	}
+}
+
+
+///
+///
+///
+void HwTimedTransceiver::_processPendingCaptures()
+{
+	// captures of the last edges which did not trigger interrupt yet
+	uint16_t flags = ECAP_getInterruptSource(m_capBase);
+	int lastEvent = m_capNextEvent - 1;
+	while ((lastEvent < ECAP_EVENT_3)
+			&& (flags & (ECAP_ISR_SOURCE_CAPTURE_EVENT_1 << (lastEvent + 1))))
+	{
+		++lastEvent;
+	}
+	if (lastEvent >= m_capNextEvent)
+	{
+		_processCaptures(lastEvent);
+		ECAP_clearInterrupt(m_capBase, flags & (ECAP_ISR_SOURCE_CAPTURE_EVENT_1
+				| ECAP_ISR_SOURCE_CAPTURE_EVENT_2
+				| ECAP_ISR_SOURCE_CAPTURE_EVENT_3));
+	}
+}
+
+
+///
+///
+///
+void HwTimedTransceiver::_processLongRun()
+{
+	mcu::CRITICAL_SECTION;
+	_processPendingCaptures();
+
+	// Run in progress has no edge at its end yet: push bits which have fully elapsed.
+	// Without bit stuffing such runs occur inside frames too, not only after CRC delimiter.
+	int level = ((m_capNextEvent == ECAP_EVENT_1) || (m_capNextEvent == ECAP_EVENT_3)) ? 1 : 0;
+	uint32_t elapsedBits = ECAP_getTimeBaseCounter(m_capBase) / m_rxBitTicks;
+	for (; (m_rxRunBitsPushed < elapsedBits) && m_rxActive; ++m_rxRunBitsPushed)
+	{
+		_pushRxBit(level);
+	}
+}
+
+
+///
+///
+///
+__interrupt void HwTimedTransceiver::onRxCaptureInterrupt()
+{
+	HwTimedTransceiver* transceiver = HwTimedTransceiver::instance();
+	uint16_t flags = ECAP_getInterruptSource(transceiver->m_capBase);
+
+	if (flags & ECAP_ISR_SOURCE_CAPTURE_EVENT_4)
+	{
+		transceiver->_processCaptures(ECAP_EVENT_4);
+		ECAP_clearInterrupt(transceiver->m_capBase, ECAP_ISR_SOURCE_CAPTURE_EVENT_1
+				| ECAP_ISR_SOURCE_CAPTURE_EVENT_2
+				| ECAP_ISR_SOURCE_CAPTURE_EVENT_3
+				| ECAP_ISR_SOURCE_CAPTURE_EVENT_4);
+	}
+
+	if (flags & ECAP_ISR_SOURCE_COUNTER_OVERFLOW)
+	{
+		// No edge for 2^32 ticks (21 s at 200 MHz). Edges captured so far precede overflow,
+		// so they are processed first and the run after them is saturated by next _processEdge().
+		transceiver->_processPendingCaptures();
+		transceiver->m_rxCounterOverflow = true;
+		ECAP_clearInterrupt(transceiver->m_capBase, ECAP_ISR_SOURCE_COUNTER_OVERFLOW);
+	}
+
+	ECAP_clearGlobalInterrupt(transceiver->m_capBase);
+	Interrupt_clearACKGroup(INTERRUPT_ACK_GROUP4);
+}
+
+
+} // namespace canbygpio
+
+
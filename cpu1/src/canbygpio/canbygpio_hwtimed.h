@@ -0,0 +1,198 @@
+/**
+ * @file
+ * @ingroup can_by_gpio
+ */
+
+
+#pragma once
+
+
+//#define CANBYGPIO_HW_TIMED
+
+
+#include "driverlib.h"
+#include "device.h"
+
+#include "emb/emb_common.h"
+#include "mcu/system/mcu_system.h"
+#include "mcu/cputimers/mcu_cputimers.h"
+#include "mcu/cap/mcu_cap.h"
+#include "mcu/pwm/mcu_pwm.h"
+
+#include "canbygpio_framing.h"
+#include "canbygpio_errors.h"
+
+
+namespace canbygpio {
+/// @addtogroup can_by_gpio
+/// @{
+
+
+/**
+ * @brief Hardware-timed CAN-by-GPIO transceiver config.
+ * RX pin must be routed to eCAP module via input X-BAR, TX pin must be muxed to ePWM output.
+ * Both are done on CPU1.
+ */
+struct HwTimedTransceiverConfig
+{
+	mcu::CapModule rxCapModule;
+	mcu::PwmModule txPwmModule;
+	EPWM_ActionQualifierOutputModule txPwmOutput;
+	uint32_t bitrate;
+};
+
+
+/**
+ * @brief CAN-by-GPIO transceiver with hardware bit timing.
+ * RX edges are timestamped by eCAP (interrupt on every 4th edge), TX bit runs are shaped by ePWM
+ * (interrupt on every level change). CPU is not involved while bus is idle, except eCAP counter overflow
+ * interrupt once per 2^32 SYSCLK ticks: run that overflows counter is saturated, so long idle is detected as bus idle.
+ */
+class HwTimedTransceiver : emb::c28x::Singleton<HwTimedTransceiver>
+{
+private:
+	const bool BIT_STUFFING_ENABLED;
+
+	static const uint32_t PWMCLK_FREQ = DEVICE_SYSCLK_FREQ / 2;
+	static const size_t TX_MAX_RUN_BITS = STREAM_SIZE_W_BIT_STUFFING;
+	static const unsigned int RX_IDLE_BITS = 10;
+	static const size_t RX_MAX_RUN_BITS = STREAM_SIZE_W_BIT_STUFFING;	// run of wrapped eCAP counter is saturated to it
+
+	uint32_t m_capBase;
+	uint32_t m_capPieIntNum;
+	uint32_t m_pwmBase;
+	uint32_t m_pwmPieIntNum;
+	EPWM_ActionQualifierOutputModule m_pwmOutput;
+
+	uint32_t m_rxBitTicks;		// eCAP ticks (SYSCLK) per bit
+	uint16_t m_txBitTicks;		// ePWM TBCLK ticks per bit
+
+	BitStream m_txStream;
+	volatile bool m_txActive;
+	size_t m_txBitCount;
+	size_t m_txIdx;
+
+	FrameDecoder m_rxDecoder;
+	volatile bool m_rxActive;
+	int m_capNextEvent;
+	unsigned int m_rxRunBitsPushed;
+	volatile bool m_rxCounterOverflow;	// eCAP counter has wrapped since last processed edge
+	volatile bool m_rxDataReady;
+	int m_rxResult;
+	Frame m_rxFrame;
+
+	ErrorCounters m_errors;
+
+public:
+	/**
+	 * @brief Configures hardware-timed CAN-BY-GPIO transceiver with enabled bit stuffing.
+	 * @param cfg - transceiver config
+	 */
+	HwTimedTransceiver(const HwTimedTransceiverConfig& cfg, tag::enable_bit_stuffing);
+
+	/**
+	 * @brief Configures hardware-timed CAN-BY-GPIO transceiver with disabled bit stuffing.
+	 * @param cfg - transceiver config
+	 */
+	HwTimedTransceiver(const HwTimedTransceiverConfig& cfg, tag::disable_bit_stuffing);
+
+	/**
+	 * @brief Resets transceiver.
+	 * @param (none)
+	 * @return (none)
+	 */
+	void reset();
+
+	/**
+	 * @brief Adds RX acceptance filter. If no filters are added, all frames are received.
+	 * @param filter - acceptance filter
+	 * @return \c true if filter is added, \c false if there is no free filter slot.
+	 */
+	bool addFilter(const AcceptanceFilter& filter)
+	{
+		mcu::CRITICAL_SECTION;
+		return m_rxDecoder.addFilter(filter);
+	}
+
+	/**
+	 * @brief Sends a CAN frame.
+	 * @param frame - CAN frame
+	 * @return Number of bytes sent, 0 if transceiver is busy.
+	 */
+	int send(const Frame& frame)
+	{
+		if (!_checkTxAllowed())
+		{
+			return 0;
+		}
+
+		m_txBitCount = encodeFrame(m_txStream, frame, BIT_STUFFING_ENABLED);
+		m_txIdx = 0;
+		m_txActive = true;
+		_startTx();
+		return frame.len;
+	}
+
+	/**
+	 * @brief Sends a CAN data frame with 11-bit ID.
+	 * @param frameId - CAN frame ID
+	 * @param buf - CAN frame data buffer
+	 * @param len - CAN frame data length
+	 * @return Number of bytes sent, 0 if transceiver is busy.
+	 */
+	int send(uint32_t frameId, const uint16_t* buf, size_t len)
+	{
+		return send(Frame(frameId, buf, len));
+	}
+
+	/**
+	 * @brief Receives a CAN frame.
+	 * @param frame - CAN frame, only ID and format are valid if an error occurred
+	 * @return Number of bytes received, or error code if an error occurred.
+	 */
+	int recv(Frame& frame)
+	{
+		if (m_rxActive && (ECAP_getTimeBaseCounter(m_capBase) > RX_IDLE_BITS * m_rxBitTicks))
+		{
+			_processLongRun();
+		}
+
+		int retval = 0;
+		if (m_rxDataReady)
+		{
+			mcu::CRITICAL_SECTION;
+			retval = m_rxResult;
+			frame = m_rxFrame;
+			m_rxDataReady = false;
+		}
+		return retval;
+	}
+
+	/**
+	 * @brief Returns error counters and frame statistics.
+	 * @param (none)
+	 * @return Error counters.
+	 */
+	const ErrorCounters& errorCounters() const { return m_errors; }
+
+protected:
+	void _init(const HwTimedTransceiverConfig& cfg);
+	void _initRx(const HwTimedTransceiverConfig& cfg);
+	void _initTx(const HwTimedTransceiverConfig& cfg);
+	bool _checkTxAllowed();
+	void _startTx();
+	size_t _nextTxRun();
+	void _processCaptures(int lastEvent);
+	void _processEdge(uint32_t interval, int levelBefore);
+	void _pushRxBit(int bit);
+	void _processPendingCaptures();
+	void _processLongRun();
+	static __interrupt void onRxCaptureInterrupt();
+	static __interrupt void onTxPwmInterrupt();
+};
+
+
+/// @}
+} // namespace canbygpio
+
+
@@ -0,0 +1,59 @@
+/**
+ * @file
+ * @ingroup cli
+ */
+
+
+#pragma once
+
+
+#include "cli/shell/cli_shell.h"
+
+
+#include "fuelcell/controller/fuelcell_controller.h"
+
+
+int cli_fuelcell(int argc, const char** argv)
+{
+	if (argc == 0)
+	{
+		strncpy(CLI_CMD_OUTPUT, "Options not specified.", CLI_CMD_OUTPUT_LENGTH);
+		goto cli_fuelcell_print;
+	}
+
+	/*===== LINK =====*/
+	if (strcmp(argv[0], "link") == 0)
+	{
+		if (argc != 2)
+		{
+			strncpy(CLI_CMD_OUTPUT, "fuelcell-link: cell not specified", CLI_CMD_OUTPUT_LENGTH);
+			goto cli_fuelcell_print;
+		}
+
+		size_t cell = atoi(argv[1]);
+		if (cell >= fuelcell::Controller::data().cells.cellCount())
+		{
+			strncpy(CLI_CMD_OUTPUT, "fuelcell-link: invalid cell", CLI_CMD_OUTPUT_LENGTH);
+			goto cli_fuelcell_print;
+		}
+
+		const fuelcell::LinkStatistics& stats = fuelcell::Controller::linkStatistics();
+		int len = snprintf(CLI_CMD_OUTPUT, CLI_CMD_OUTPUT_LENGTH,
+				"interval min/avg/max: %u/%u/%u ms"CLI_ENDL"histogram (log2 ms):",
+				stats.intervalMin(cell), stats.intervalAvg(cell), stats.intervalMax(cell));
+		for (size_t i = 0; (i < fuelcell::LinkStatistics::BUCKET_COUNT) && (len > 0) && (len < CLI_CMD_OUTPUT_LENGTH); ++i)
+		{
+			len += snprintf(CLI_CMD_OUTPUT + len, CLI_CMD_OUTPUT_LENGTH - len, " %u", stats.histogram(cell, i));
+		}
+		goto cli_fuelcell_print;
+	}
+
+	strncpy(CLI_CMD_OUTPUT, "Invalid options.", CLI_CMD_OUTPUT_LENGTH);
+
+cli_fuelcell_print:
+	cli::nextline();
+	cli::print(CLI_CMD_OUTPUT);
+	return 0;
+}
+
+
@@ -12,6 +12,44 @@
 #include "sys/syslog/syslog.h"
 
 
+// prints mask words most significant first, so that they are read as one hex number
+static int cli_syslog_printMask(char* out, int length, const char* title, uint32_t (*word)(size_t), size_t wordCount)
+{
+	int len = snprintf(out, length, "%s: 0x", title);
+	for (size_t i = wordCount; (i > 0) && (len > 0) && (len < length); --i)
+	{
+		len += snprintf(out + len, length - len, "%08lX", word(i - 1));
+	}
+	return len;
+}
+
+
+static int cli_syslog_printErrors(char* out, int length)
+{
+	return cli_syslog_printMask(out, length, "errors", Syslog::errors, sys::Error::ERROR_WORD_COUNT);
+}
+
+
+static int cli_syslog_printWarnings(char* out, int length)
+{
+	return cli_syslog_printMask(out, length, "warnings", Syslog::warnings, sys::Warning::WARNING_WORD_COUNT);
+}
+
+
+static void cli_syslog_printErrorsWarnings(char* out, int length)
+{
+	int len = cli_syslog_printErrors(out, length);
+	if ((len > 0) && (len < length))
+	{
+		len += snprintf(out + len, length - len, CLI_ENDL);
+	}
+	if ((len > 0) && (len < length))
+	{
+		cli_syslog_printWarnings(out + len, length - len);
+	}
+}
+
+
 int cli_syslog(int argc, const char** argv)
 {
 	if (argc == 0)
@@ -25,21 +63,94 @@ int cli_syslog(int argc, const char** argv)
 	{
 		if (argc == 1)
 		{
-			snprintf(CLI_CMD_OUTPUT, CLI_CMD_OUTPUT_LENGTH, "errors: 0x%08lX"CLI_ENDL"warnings: 0x%08lX",
-					Syslog::errors(),
-					Syslog::warnings());
+			cli_syslog_printErrorsWarnings(CLI_CMD_OUTPUT, CLI_CMD_OUTPUT_LENGTH);
 			goto cli_syslog_print;
 		}
 
 		if (strcmp(argv[1], "errors") == 0)
 		{
-			snprintf(CLI_CMD_OUTPUT, CLI_CMD_OUTPUT_LENGTH, "errors: 0x%08lX", Syslog::errors());
+			int len = cli_syslog_printErrors(CLI_CMD_OUTPUT, CLI_CMD_OUTPUT_LENGTH);
+			for (size_t i = 0; (i < sys::Error::ERROR_COUNT) && (len > 0) && (len < CLI_CMD_OUTPUT_LENGTH); ++i)
+			{
+				if (Syslog::hasError(static_cast<sys::Error::Error>(i)))
+				{
+					len += snprintf(CLI_CMD_OUTPUT + len, CLI_CMD_OUTPUT_LENGTH - len,
+							CLI_ENDL"%s", sys::Error::NAMES[i]);
+				}
+			}
 			goto cli_syslog_print;
 		}
 
 		if (strcmp(argv[1], "warnings") == 0)
 		{
-			snprintf(CLI_CMD_OUTPUT, CLI_CMD_OUTPUT_LENGTH, "warnings: 0x%08lX", Syslog::warnings());
+			int len = cli_syslog_printWarnings(CLI_CMD_OUTPUT, CLI_CMD_OUTPUT_LENGTH);
+			for (size_t i = 0; (i < sys::Warning::WARNING_COUNT) && (len > 0) && (len < CLI_CMD_OUTPUT_LENGTH); ++i)
+			{
+				if (Syslog::hasWarning(static_cast<sys::Warning::Warning>(i)))
+				{
+					len += snprintf(CLI_CMD_OUTPUT + len, CLI_CMD_OUTPUT_LENGTH - len,
+							CLI_ENDL"%s", sys::Warning::NAMES[i]);
+				}
+			}
+			goto cli_syslog_print;
+		}
+
+		if (strcmp(argv[1], "events") == 0)
+		{
+			// first error since reset and latest events: time ms, cpu, type, code, value
+			const size_t EVENT_PRINT_COUNT = 5;
+			const sys::EventLog<64>& events = Syslog::events();
+			int len = snprintf(CLI_CMD_OUTPUT, CLI_CMD_OUTPUT_LENGTH, "events: %lu", events.totalCount());
+			if (Syslog::hasFirstError())
+			{
+				sys::EventRecord record = Syslog::firstError();
+				len += snprintf(CLI_CMD_OUTPUT + len, CLI_CMD_OUTPUT_LENGTH - len,
+						CLI_ENDL"first: %lu cpu%u E%u %.2f",
+						record.timestamp, record.cpu, record.code, record.value);
+			}
+			size_t first = (events.size() > EVENT_PRINT_COUNT) ? events.size() - EVENT_PRINT_COUNT : 0;
+			for (size_t i = first; (i < events.size()) && (len > 0) && (len < CLI_CMD_OUTPUT_LENGTH); ++i)
+			{
+				static const char typeChars[] = "EWMR";
+				sys::EventRecord record = events.at(i);
+				len += snprintf(CLI_CMD_OUTPUT + len, CLI_CMD_OUTPUT_LENGTH - len,
+						CLI_ENDL"%lu cpu%u %c%u %.2f",
+						record.timestamp, record.cpu, typeChars[record.type], record.code, record.value);
+			}
+			goto cli_syslog_print;
+		}
+
+		if (strcmp(argv[1], "stats") == 0)
+		{
+			uint32_t timeNow = static_cast<uint32_t>(mcu::SystemClock::now());
+			if (argc == 3)
+			{
+				// selected error: name, count, last set ms, last cleared ms, rate 1/min
+				size_t error = atoll(argv[2]);
+				if (error >= sys::Error::ERROR_COUNT)
+				{
+					strncpy(CLI_CMD_OUTPUT, "syslog-show: invalid error", CLI_CMD_OUTPUT_LENGTH);
+					goto cli_syslog_print;
+				}
+				sys::ErrorStatistics stats = Syslog::errorStatistics(static_cast<sys::Error::Error>(error));
+				snprintf(CLI_CMD_OUTPUT, CLI_CMD_OUTPUT_LENGTH,
+						"%s count: %u"CLI_ENDL"last set: %lu"CLI_ENDL"last cleared: %lu"CLI_ENDL"rate: %.2f/min",
+						sys::Error::NAMES[error], stats.count(), stats.lastSet(), stats.lastCleared(), stats.ratePerMinute(timeNow));
+				goto cli_syslog_print;
+			}
+
+			// errors that have occurred: name, count, rate 1/min
+			int len = snprintf(CLI_CMD_OUTPUT, CLI_CMD_OUTPUT_LENGTH, "error stats:");
+			for (size_t i = 0; (i < sys::Error::ERROR_COUNT) && (len > 0) && (len < CLI_CMD_OUTPUT_LENGTH); ++i)
+			{
+				sys::ErrorStatistics stats = Syslog::errorStatistics(static_cast<sys::Error::Error>(i));
+				if (stats.count() == 0)
+				{
+					continue;
+				}
+				len += snprintf(CLI_CMD_OUTPUT + len, CLI_CMD_OUTPUT_LENGTH - len,
+						CLI_ENDL"%s %u %.2f/min", sys::Error::NAMES[i], stats.count(), stats.ratePerMinute(timeNow));
+			}
 			goto cli_syslog_print;
 		}
 
@@ -59,14 +170,14 @@ int cli_syslog(int argc, const char** argv)
 		if (strcmp(argv[1], "error") == 0)
 		{
 			Syslog::setError(static_cast<sys::Error::Error>(atoll(argv[2])));
-			snprintf(CLI_CMD_OUTPUT, CLI_CMD_OUTPUT_LENGTH, "errors: 0x%08lX", Syslog::errors());
+			cli_syslog_printErrors(CLI_CMD_OUTPUT, CLI_CMD_OUTPUT_LENGTH);
 			goto cli_syslog_print;
 		}
 
 		if (strcmp(argv[1], "warning") == 0)
 		{
 			Syslog::setWarning(static_cast<sys::Warning::Warning>(atoll(argv[2])));
-			snprintf(CLI_CMD_OUTPUT, CLI_CMD_OUTPUT_LENGTH, "warnings: 0x%08lX", Syslog::warnings());
+			cli_syslog_printWarnings(CLI_CMD_OUTPUT, CLI_CMD_OUTPUT_LENGTH);
 			goto cli_syslog_print;
 		}
 
@@ -80,9 +191,7 @@ int cli_syslog(int argc, const char** argv)
 		if (argc == 1)
 		{
 			Syslog::resetErrorsWarnings();
-			snprintf(CLI_CMD_OUTPUT, CLI_CMD_OUTPUT_LENGTH, "errors: 0x%08lX"CLI_ENDL"warnings: 0x%08lX",
-					Syslog::errors(),
-					Syslog::warnings());
+			cli_syslog_printErrorsWarnings(CLI_CMD_OUTPUT, CLI_CMD_OUTPUT_LENGTH);
 			goto cli_syslog_print;
 		}
 
@@ -95,14 +204,14 @@ int cli_syslog(int argc, const char** argv)
 		if (strcmp(argv[1], "error") == 0)
 		{
 			Syslog::resetError(static_cast<sys::Error::Error>(atoll(argv[2])));
-			snprintf(CLI_CMD_OUTPUT, CLI_CMD_OUTPUT_LENGTH, "errors: 0x%08lX", Syslog::errors());
+			cli_syslog_printErrors(CLI_CMD_OUTPUT, CLI_CMD_OUTPUT_LENGTH);
 			goto cli_syslog_print;
 		}
 
 		if (strcmp(argv[1], "warning") == 0)
 		{
 			Syslog::resetWarning(static_cast<sys::Warning::Warning>(atoll(argv[2])));
-			snprintf(CLI_CMD_OUTPUT, CLI_CMD_OUTPUT_LENGTH, "warnings: 0x%08lX", Syslog::warnings());
+			cli_syslog_printWarnings(CLI_CMD_OUTPUT, CLI_CMD_OUTPUT_LENGTH);
 			goto cli_syslog_print;
 		}
 
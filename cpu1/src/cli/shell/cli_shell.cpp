@@ -15,6 +15,7 @@ int cli_reboot(int argc, const char** argv);
 int cli_uptime(int argc, const char** argv);
 int cli_syslog(int argc, const char** argv);
 int cli_sysctl(int argc, const char** argv);
+int cli_fuelcell(int argc, const char** argv);
 
 
 extern char CLI_CMD_OUTPUT[CLI_CMD_OUTPUT_LENGTH] = {0};
@@ -31,6 +32,7 @@ Cmd Shell::COMMANDS[] =
 {"uptime",		cli_uptime,		"Shows system uptime."},
 {"syslog",		cli_syslog,		"Syslog control utility."},
 {"sysctl",		cli_sysctl,		"System control utility."},
+{"fuelcell",		cli_fuelcell,		"Fuel cell link statistics: fuelcell link <cell>."},
 };
 
 const size_t Shell::COMMANDS_COUNT = sizeof(Shell::COMMANDS) / sizeof(Shell::COMMANDS[0]);
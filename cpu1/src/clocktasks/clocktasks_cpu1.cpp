@@ -54,3 +54,13 @@ mcu::ClockTaskStatus taskCheckFuelcellErrors()
 }
 
 
+///
+///
+///
+mcu::ClockTaskStatus taskSuperviseConverter()
+{
+	fuelcell::Converter::instance()->supervise();
+	return mcu::CLOCK_TASK_SUCCESS;
+}
+
+
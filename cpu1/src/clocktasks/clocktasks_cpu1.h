@@ -43,3 +43,11 @@ mcu::ClockTaskStatus taskStartTempSensors();
  */
 mcu::ClockTaskStatus taskCheckFuelcellErrors();
 
+
+/**
+ * @brief Converter FSM supervisor task.
+ * @param (none)
+ * @return Task execution status.
+ */
+mcu::ClockTaskStatus taskSuperviseConverter();
+
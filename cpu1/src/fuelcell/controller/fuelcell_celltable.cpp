@@ -0,0 +1,193 @@
+/**
+ * @file
+ * @ingroup fuel_cell_controller
+ */
+
+
+#include "fuelcell_celltable.h"
+#include <algorithm>
+
+
+namespace fuelcell {
+
+
+// Cell data is not volatile, so that status queries and filters are not pessimized.
+// Inside sequence lock sections it is accessed through volatile lvalues: compiler neither reorders
+// them relative to sequence counter accesses nor caches them between readCell() retries.
+template <typename T>
+inline T loadVolatile(const T& ref) { return *static_cast<const volatile T*>(&ref); }
+
+template <typename T>
+inline void storeVolatile(T& ref, T value) { *static_cast<volatile T*>(&ref) = value; }
+
+
+///
+///
+///
+void CellTable::init(size_t cellCount, float voltageSmoothFactor)
+{
+	assert((cellCount > 0) && (cellCount <= FUELCELL_MAX_COUNT));
+
+	m_cellCount = cellCount;
+	m_cellMask.reset();
+	for (size_t i = 0; i < cellCount; ++i)
+	{
+		m_cellMask.set(i);
+	}
+
+	temperature.fill(0);
+	cellVoltage.fill(0);
+	battVoltage.fill(0);
+	current.fill(0);
+	recvTimestamp.fill(0);
+
+	statusStart.reset();
+	statusRun.reset();
+	statusOverheat.reset();
+	statusLowCharge.reset();
+
+	m_voltageSmoothFactor = voltageSmoothFactor;
+	for (size_t i = 0; i < VOLTAGE_WINDOW_SIZE; ++i)
+	{
+		m_voltageWindow[i].fill(0);
+	}
+	m_voltageWindowPos.fill(0);
+
+	for (size_t i = 0; i < cellCount; ++i)
+	{
+		m_minTree[cellCount + i] = i;
+	}
+	for (size_t node = cellCount - 1; node > 0; --node)
+	{
+		m_minTree[node] = _minTreeMatch(node);
+	}
+	m_minCellVoltage = 0;
+	m_minCellVoltageIdx = m_minTree[1];
+
+	for (size_t i = 0; i < FUELCELL_MAX_COUNT; ++i)
+	{
+		m_cellSeq[i] = 0;
+	}
+}
+
+
+///
+///
+///
+void CellTable::updateCell(size_t cell, const CellRecord& sample)
+{
+	m_cellSeq[cell] = m_cellSeq[cell] + 1;
+
+	storeVolatile(temperature[cell], sample.temperature);
+	pushCellVoltage(cell, sample.cellVoltage);
+	storeVolatile(battVoltage[cell], sample.battVoltage);
+	storeVolatile(current[cell], sample.current);
+	storeVolatile(recvTimestamp[cell], sample.recvTimestamp);
+	setStatus(cell, sample.statusStart, sample.statusRun, sample.statusOverheat, sample.statusLowCharge);
+
+	m_cellSeq[cell] = m_cellSeq[cell] + 1;
+}
+
+
+///
+///
+///
+bool CellTable::readCell(size_t cell, CellRecord& record) const
+{
+	for (size_t i = 0; i < READ_RETRY_LIMIT; ++i)
+	{
+		uint16_t seq = readBegin(cell);
+		record.temperature = loadVolatile(temperature[cell]);
+		record.cellVoltage = loadVolatile(cellVoltage[cell]);
+		record.battVoltage = loadVolatile(battVoltage[cell]);
+		record.current = loadVolatile(current[cell]);
+		record.recvTimestamp = loadVolatile(recvTimestamp[cell]);
+		record.statusStart = const_cast<const volatile CellMask&>(statusStart).test(cell);
+		record.statusRun = const_cast<const volatile CellMask&>(statusRun).test(cell);
+		record.statusOverheat = const_cast<const volatile CellMask&>(statusOverheat).test(cell);
+		record.statusLowCharge = const_cast<const volatile CellMask&>(statusLowCharge).test(cell);
+		if (!readRetry(cell, seq))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+///
+///
+///
+uint16_t CellTable::readBegin(size_t cell) const
+{
+	return m_cellSeq[cell];
+}
+
+
+///
+///
+///
+bool CellTable::readRetry(size_t cell, uint16_t seq) const
+{
+	return (seq & 1) || (m_cellSeq[cell] != seq);
+}
+
+
+///
+///
+///
+void CellTable::pushCellVoltage(size_t cell, float value)
+{
+	uint16_t pos = m_voltageWindowPos[cell];
+	m_voltageWindow[pos][cell] = value;
+	m_voltageWindowPos[cell] = (pos + 1 == VOLTAGE_WINDOW_SIZE) ? 0 : pos + 1;
+
+	float windowSorted[VOLTAGE_WINDOW_SIZE];
+	for (size_t i = 0; i < VOLTAGE_WINDOW_SIZE; ++i)
+	{
+		windowSorted[i] = m_voltageWindow[i][cell];
+	}
+	std::sort(windowSorted, windowSorted + VOLTAGE_WINDOW_SIZE);
+	float median = windowSorted[VOLTAGE_WINDOW_SIZE/2];
+
+	storeVolatile(cellVoltage[cell], cellVoltage[cell] + m_voltageSmoothFactor * (median - cellVoltage[cell]));
+	_updateMinCellVoltage(cell);
+}
+
+
+///
+///
+///
+void CellTable::_updateMinCellVoltage(size_t cell)
+{
+	for (size_t node = (m_cellCount + cell) / 2; node > 0; node /= 2)
+	{
+		m_minTree[node] = _minTreeMatch(node);
+	}
+
+	uint16_t minIdx = m_minTree[1];
+	m_minCellVoltageIdx = minIdx;
+	m_minCellVoltage = cellVoltage[minIdx];
+}
+
+
+///
+///
+///
+uint16_t CellTable::_minTreeMatch(size_t node) const
+{
+	uint16_t left = m_minTree[2 * node];
+	uint16_t right = m_minTree[2 * node + 1];
+	// on equal voltages cell with lower index wins, as in linear scan
+	if ((cellVoltage[right] < cellVoltage[left])
+			|| ((cellVoltage[right] == cellVoltage[left]) && (right < left)))
+	{
+		return right;
+	}
+	return left;
+}
+
+
+} // namespace fuelcell
+
+
@@ -0,0 +1,220 @@
+/**
+ * @file
+ * @ingroup fuel_cell_controller
+ */
+
+
+#pragma once
+
+
+#include "emb/emb_common.h"
+#include "emb/emb_array.h"
+#include "emb/emb_bitset.h"
+
+
+namespace fuelcell {
+/// @addtogroup fuel_cell_controller
+/// @{
+
+
+/// Max number of fuel cells, cell RPDO IDs are 0x180...0x1FF
+const size_t FUELCELL_MAX_COUNT = 128;
+
+
+/// Number of fuel cells in converter
+const size_t FUELCELL_COUNT = 5;
+
+
+/// Set of cells, bit N corresponds to cell N
+typedef emb::Bitset<FUELCELL_MAX_COUNT> CellMask;
+
+
+/**
+ * @brief Fuel cell record.
+ */
+struct CellRecord
+{
+	float temperature;
+	float cellVoltage;
+	float battVoltage;
+	float current;
+	uint64_t recvTimestamp;
+
+	bool statusStart;
+	bool statusRun;
+	bool statusOverheat;
+	bool statusLowCharge;
+};
+
+
+/**
+ * @brief Fuel cell table. Per-cell values are stored in structure-of-arrays layout,
+ * per-cell status flags are packed into bitmasks, so that status queries over all cells
+ * are single mask comparisons.
+ *
+ * Table is written by CPU2 and read by CPU1. Each cell is protected by sequence lock:
+ * readers of multi-field cell data use readCell(), which retries if cell was updated during read.
+ * Inside read and write sections cell data is accessed only through volatile lvalues, as is sequence counter.
+ * Ordering relies on compiler keeping volatile accesses in program order and on C28x pipeline
+ * performing data memory accesses in program order, so no hardware barrier is needed.
+ */
+class CellTable
+{
+public:
+	static const size_t VOLTAGE_WINDOW_SIZE = 5;
+	static const size_t READ_RETRY_LIMIT = 8;	// writer updates cell in a few microseconds
+
+	emb::Array<float, FUELCELL_MAX_COUNT> temperature;
+	emb::Array<float, FUELCELL_MAX_COUNT> cellVoltage;	// median + exponential filtered
+	emb::Array<float, FUELCELL_MAX_COUNT> battVoltage;
+	emb::Array<float, FUELCELL_MAX_COUNT> current;
+	emb::Array<uint64_t, FUELCELL_MAX_COUNT> recvTimestamp;
+
+	CellMask statusStart;
+	CellMask statusRun;
+	CellMask statusOverheat;
+	CellMask statusLowCharge;
+
+private:
+	size_t m_cellCount;
+	CellMask m_cellMask;		// bits of existing cells are set
+
+	float m_voltageSmoothFactor;
+	emb::Array<emb::Array<float, FUELCELL_MAX_COUNT>, VOLTAGE_WINDOW_SIZE> m_voltageWindow;
+	emb::Array<uint16_t, FUELCELL_MAX_COUNT> m_voltageWindowPos;
+
+	// min filtered cell voltage is tracked on each update by tournament tree: node k holds index of cell
+	// with min voltage among its children 2k and 2k+1, leaf of cell i is node cellCount + i, root is node 1.
+	// Update of one cell replays O(log N) matches on path to root, no rescan of all cells is needed.
+	// Readers get result with single 32-bit load.
+	emb::Array<uint16_t, 2 * FUELCELL_MAX_COUNT> m_minTree;
+	volatile float m_minCellVoltage;
+	volatile uint16_t m_minCellVoltageIdx;
+
+	// cell sequence counter is odd while cell is being updated
+	volatile uint16_t m_cellSeq[FUELCELL_MAX_COUNT];
+
+public:
+	/**
+	 * @brief Resets table.
+	 * @param cellCount - number of cells, must not exceed FUELCELL_MAX_COUNT
+	 * @param voltageSmoothFactor - cell voltage exponential filter smooth factor
+	 * @return (none)
+	 */
+	void init(size_t cellCount, float voltageSmoothFactor);
+
+	/**
+	 * @brief Returns number of cells.
+	 * @param (none)
+	 * @return Number of cells.
+	 */
+	size_t cellCount() const { return m_cellCount; }
+
+	/**
+	 * @brief Updates cell data under sequence lock. Must be called by single writer.
+	 * @param cell - cell index
+	 * @param sample - received cell data, cell voltage is raw sample which is filtered before storing
+	 * @return (none)
+	 */
+	void updateCell(size_t cell, const CellRecord& sample);
+
+	/**
+	 * @brief Reads coherent cell record, retries if cell is updated during read.
+	 * @param cell - cell index
+	 * @param record - cell record
+	 * @return \c true if record is read, \c false if cell was being updated during all READ_RETRY_LIMIT attempts.
+	 */
+	bool readCell(size_t cell, CellRecord& record) const;
+
+	/**
+	 * @brief Begins sequence lock read section. Cell data must be read through volatile lvalues until readRetry().
+	 * @param cell - cell index
+	 * @return Sequence to be passed to readRetry().
+	 */
+	uint16_t readBegin(size_t cell) const;
+
+	/**
+	 * @brief Ends sequence lock read section.
+	 * @param cell - cell index
+	 * @param seq - sequence returned by readBegin()
+	 * @return \c true if cell was being updated during read and data must be read again, \c false otherwise.
+	 */
+	bool readRetry(size_t cell, uint16_t seq) const;
+
+	/**
+	 * @brief Pushes cell voltage sample through median and exponential filters.
+	 * @param cell - cell index
+	 * @param value - cell voltage sample
+	 * @return (none)
+	 */
+	void pushCellVoltage(size_t cell, float value);
+
+	/**
+	 * @brief Sets status flags of cell.
+	 * @param cell - cell index
+	 * @param start - start flag
+	 * @param run - run flag
+	 * @param overheat - overheat flag
+	 * @param lowCharge - low charge flag
+	 * @return (none)
+	 */
+	void setStatus(size_t cell, bool start, bool run, bool overheat, bool lowCharge)
+	{
+		const_cast<volatile CellMask&>(statusStart).set(cell, start);
+		const_cast<volatile CellMask&>(statusRun).set(cell, run);
+		const_cast<volatile CellMask&>(statusOverheat).set(cell, overheat);
+		const_cast<volatile CellMask&>(statusLowCharge).set(cell, lowCharge);
+	}
+
+	/**
+	 * @brief Checks if all cells are starting.
+	 * @param (none)
+	 * @return \c true if all cells are starting, \c false otherwise.
+	 */
+	bool allStarting() const { return statusStart == m_cellMask; }
+
+	/**
+	 * @brief Checks if all cells are running.
+	 * @param (none)
+	 * @return \c true if all cells are running, \c false otherwise.
+	 */
+	bool allRunning() const { return statusRun == m_cellMask; }
+
+	/**
+	 * @brief Checks if any cell is overheated.
+	 * @param (none)
+	 * @return \c true if any cell is overheated, \c false otherwise.
+	 */
+	bool anyOverheat() const { return statusOverheat.any(); }
+
+	/**
+	 * @brief Checks if any cell has low charge.
+	 * @param (none)
+	 * @return \c true if any cell has low charge, \c false otherwise.
+	 */
+	bool anyLowCharge() const { return statusLowCharge.any(); }
+
+	/**
+	 * @brief Returns min filtered cell voltage.
+	 * @param (none)
+	 * @return Min cell voltage.
+	 */
+	float minCellVoltage() const { return m_minCellVoltage; }
+
+	/**
+	 * @brief Returns index of cell with min filtered voltage.
+	 * @param (none)
+	 * @return Index of cell with min voltage.
+	 */
+	size_t minCellVoltageIdx() const { return m_minCellVoltageIdx; }
+
+private:
+	void _updateMinCellVoltage(size_t cell);
+	uint16_t _minTreeMatch(size_t node) const;
+};
+
+
+/// @}
+} // namespace fuelcell
+
+
@@ -13,45 +13,53 @@ namespace fuelcell {
 const mcu::IpcFlag Controller::SIG_START(21);
 const mcu::IpcFlag Controller::SIG_STOP(22);
 
-uint64_t Controller::m_errorRegTimestamp = 0;
-bool Controller::m_isErrorRegistered = false;
 
 
 Data Controller::s_data __attribute__((section("SHARED_FUELCELL_DATA"), retain));
+BusStatistics Controller::s_busStats __attribute__((section("SHARED_FUELCELL_BUS_STATS"), retain));
+LinkStatistics Controller::s_linkStats __attribute__((section("SHARED_FUELCELL_LINK_STATS"), retain));
+
+
+#ifdef CANBYGPIO_HW_TIMED
+// eCAP1 input and EPWM6B output are set up on CPU1
+static const canbygpio::HwTimedTransceiverConfig TRANSCEIVER_CONFIG =
+{
+	.rxCapModule = mcu::CAP1,
+	.txPwmModule = mcu::PWM6,
+	.txPwmOutput = EPWM_AQ_OUTPUT_B,
+	.bitrate = Controller::BITRATE
+};
+#endif
 
 
 ///
 ///
 ///
-Controller::Controller(const Converter* converter,
+Controller::Controller(const Converter* converter, size_t cellCount,
 		const mcu::GpioInput& rxPin, const mcu::GpioOutput& txPin, mcu::GpioOutput& clkPin)
 	: m_converter(converter)
-	, m_transceiver(rxPin, txPin, clkPin, 125000, canbygpio::tag::disable_bit_stuffing()) // TODO disable bit stuffing
+#ifdef CANBYGPIO_HW_TIMED
+	, m_transceiver(TRANSCEIVER_CONFIG, canbygpio::tag::disable_bit_stuffing())
+#else
+	, m_transceiver(rxPin, txPin, clkPin, BITRATE, canbygpio::tag::disable_bit_stuffing()) // TODO disable bit stuffing
+#endif
 {
 	EMB_STATIC_ASSERT(sizeof(TpdoMessage) == 4);
 	EMB_STATIC_ASSERT(sizeof(RpdoMessage) == 4);
 
-	s_data.temperature.fill(0);
-
-	for (size_t i = 0; i < FUELCELL_COUNT; ++i)
-	{
-		s_data.cellVoltage[i].setSmoothFactor(0.1);
-		s_data.cellVoltage[i].reset();
-	}
+	// fuel cell RPDOs: 0x180...0x1FF, other frames are dropped by transceiver
+	canbygpio::AcceptanceFilter rpdoFilter = {0x180, 0x780, false};
+	m_transceiver.addFilter(rpdoFilter);
 
-	s_data.battVoltage.fill(0);
-	s_data.current.fill(0);
+	s_data.cells.init(cellCount, 0.1f);
 
 	s_data.statusError =  false;
-	s_data.statusStart.fill(false);
-	s_data.statusRun.fill(false);
-	s_data.statusOverheat.fill(false);
-	s_data.statusLowCharge.fill(false);
 	s_data.statusNoConnection = false;
 	s_data.statusLowPressure = false;
 	s_data.statusHydroError = false;
 
-	s_data.recvTimestamp.fill(0);
+	memset(&s_busStats, 0, sizeof(BusStatistics));
+	s_linkStats.init(cellCount, mcu::SystemClock::now());
 }
 
 
@@ -61,10 +69,25 @@ Controller::Controller(const Converter* converter,
 void Controller::runTx()
 {
 	static uint64_t timeTxPrev = 0;
+	static uint64_t timeRetry = 0;
+	static uint64_t timeCmdRaised = 0;
+	static bool isCmdPendingPrev = false;
 	TpdoMessage tpdo;
 	uint16_t tpdoBytes[8];
 
-	if (mcu::SystemClock::now() >= (timeTxPrev + TPDO_PERIOD))
+	uint64_t timeNow = mcu::SystemClock::now();
+	bool isCmdPending = mcu::isRemoteIpcFlagSet(SIG_STOP.remote) || mcu::isRemoteIpcFlagSet(SIG_START.remote);
+	if (isCmdPending && !isCmdPendingPrev)
+	{
+		timeCmdRaised = timeNow;
+	}
+	isCmdPendingPrev = isCmdPending;
+
+	// command is sent immediately, periodic frame is keepalive
+	bool isKeepaliveDue = timeNow >= timeTxPrev + TPDO_PERIOD;
+	bool isCmdDue = isCmdPending && (timeNow >= timeTxPrev + TPDO_MIN_INTERVAL);
+
+	if ((isKeepaliveDue || isCmdDue) && (timeNow >= timeRetry))
 	{
 		if (mcu::isRemoteIpcFlagSet(SIG_STOP.remote))
 		{
@@ -85,22 +108,35 @@ void Controller::runTx()
 		// TODO remove this later
 		//tpdo.reserved = mcu::SystemClock::now();
 
-		emb::c28x::to_bytes8<TpdoMessage>(tpdoBytes, tpdo);
+		encodeTpdo(tpdoBytes, tpdo);
 
 		if (m_transceiver.send(TPDO_FRAME_ID, tpdoBytes, 8) == 8)
 		{
 			// transmission begins successfully
-			if (mcu::isRemoteIpcFlagSet(SIG_STOP.remote))
+			if (tpdo.cmd != 0)
+			{
+				++s_busStats.cmdCount;
+				s_busStats.cmdLatency = timeNow - timeCmdRaised;
+			}
+
+			// only sent command is acknowledged, flag raised after frame building stays pending
+			if (tpdo.cmd == 0x69)
 			{
 				mcu::acknowledgeRemoteIpcFlag(SIG_STOP.remote);
 				mcu::acknowledgeRemoteIpcFlag(SIG_START.remote);
 			}
-			else if (mcu::isRemoteIpcFlagSet(SIG_START.remote))
+			else if (tpdo.cmd == 0x96)
 			{
 				mcu::acknowledgeRemoteIpcFlag(SIG_START.remote);
 			}
 
-			timeTxPrev = mcu::SystemClock::now();
+			timeTxPrev = timeNow;
+		}
+		else
+		{
+			// transceiver is busy, retry is delayed to leave bus time for other nodes
+			++s_busStats.txRetryCount;
+			timeRetry = timeNow + TPDO_RETRY_DELAY;
 		}
 	}
 }
@@ -111,35 +147,63 @@ void Controller::runTx()
 ///
 void Controller::runRx()
 {
-	static uint64_t frameCount = 0;
-	static uint64_t errInvalidId = 0;
-	static uint64_t errSOF = 0;
-	static uint64_t errRTR = 0;
-	static uint64_t errIDE = 0;
-	static uint64_t errR0 = 0;
-	static uint64_t errCRC = 0;
-	unsigned int rpdoId;
-	uint16_t rpdoBytes[8] = {0};
+	canbygpio::Frame frame;
 	RpdoMessage rpdo;
 
-	int recvRetval = m_transceiver.recv(rpdoId, rpdoBytes);
+	int recvRetval = m_transceiver.recv(frame);
+	if (recvRetval == 0)
+	{
+		return;
+	}
+
+	// frame ID is valid for failed frames too if error occurred after ID field
+	bool isCellFrame = !frame.extended
+			&& (frame.id >= RPDO_FRAME_ID_BASE) && (frame.id < RPDO_FRAME_ID_BASE + s_data.cells.cellCount());
+	size_t cell = isCellFrame ? frame.id - RPDO_FRAME_ID_BASE : 0;
+
+	if (recvRetval < 0)
+	{
+		if (isCellFrame)
+		{
+			++s_busStats.nodeErrorCount[cell];
+		}
+		else
+		{
+			++s_busStats.errUnknownNode;
+		}
+	}
+
 	switch (recvRetval)
 	{
 	case 8:
 	{
-		if ((rpdoId < 0x180) || (rpdoId > 0x184))
+		if (frame.remote || !isCellFrame)
 		{
-			++errInvalidId;
+			++s_busStats.errInvalidId;
 			return;
 		}
 
-		++frameCount;
-		emb::c28x::from_bytes8<RpdoMessage>(rpdo, rpdoBytes);
-		size_t cell = rpdoId - 0x180;
+		++s_busStats.nodeFrameCount[cell];
+		decodeRpdo(rpdo, frame.data);
 
-		s_data.temperature[cell] = rpdo.temperature;
-		s_data.cellVoltage[cell].push(0.1f * rpdo.cellVoltage);
-		s_data.battVoltage[cell] = 0.1f * rpdo.battVoltage;
+		uint64_t timeNow = mcu::SystemClock::now();
+		uint64_t timePrev = s_data.cells.recvTimestamp[cell];	// CPU2 is the only writer
+		if (timePrev != 0)
+		{
+			s_linkStats.onFrame(cell, timeNow - timePrev);
+		}
+
+		CellRecord sample;
+		sample.temperature = rpdo.temperature;
+		sample.cellVoltage = 0.1f * rpdo.cellVoltage;
+		sample.battVoltage = 0.1f * rpdo.battVoltage;
+		sample.current = 0.1f * float(rpdo.current);
+		sample.recvTimestamp = timeNow;
+		sample.statusStart = rpdo.statusStart;
+		sample.statusRun = rpdo.statusRun;
+		sample.statusOverheat = rpdo.statusOverheat;
+		sample.statusLowCharge = rpdo.statusLowCharge;
+		s_data.cells.updateCell(cell, sample);
 
 		if (cell == 0)
 		{
@@ -148,31 +212,25 @@ void Controller::runRx()
 			s_data.statusLowPressure = rpdo.statusLowPressure;
 			s_data.statusHydroError = rpdo.statusHydroError;
 		}
-
-		s_data.statusStart[cell] = rpdo.statusStart;
-		s_data.statusRun[cell] = rpdo.statusRun;
-		s_data.statusOverheat[cell] = rpdo.statusOverheat;
-		s_data.statusLowCharge[cell] = rpdo.statusLowCharge;
-
-		s_data.current[cell] = 0.1f * float(rpdo.current);
-
-		s_data.recvTimestamp[cell] = mcu::SystemClock::now();
 		break;
 	}
-	case -1:
-		++errSOF;
+	case canbygpio::FRAME_ERROR_SOF:
+		++s_busStats.errSOF;
+		break;
+	case canbygpio::FRAME_ERROR_SRR:
+		++s_busStats.errSRR;
 		break;
-	case -2:
-		++errRTR;
+	case canbygpio::FRAME_ERROR_R0:
+		++s_busStats.errR0;
 		break;
-	case -3:
-		++errIDE;
+	case canbygpio::FRAME_ERROR_CRC:
+		++s_busStats.errCRC;
 		break;
-	case -4:
-		++errR0;
+	case canbygpio::FRAME_ERROR_STUFF:
+		++s_busStats.errStuff;
 		break;
-	case -5:
-		++errCRC;
+	default:
+		++s_busStats.errInvalidId;		// unexpected data length
 		break;
 	}
 }
@@ -181,96 +239,87 @@ void Controller::runRx()
 ///
 ///
 ///
-bool Controller::checkErrors()
+void Controller::updateBusStatistics()
 {
-	static bool errorPrev = false;
-	bool errorDelayExpired = m_isErrorRegistered
-			&& (mcu::SystemClock::now() - m_errorRegTimestamp > ERROR_PROPAGATION_DELAY);
-	bool error = false;
-
-	if (hasError())
+	static uint64_t timeRatePrev = 0;
+	static emb::Array<uint32_t, FUELCELL_MAX_COUNT> nodeFrameCountPrev;
+	static emb::Array<uint32_t, FUELCELL_MAX_COUNT> nodeErrorCountPrev;
+#ifndef CANBYGPIO_HW_TIMED
+	static uint64_t clkCyclesPrev = 0;
+#endif
+
+	const canbygpio::ErrorCounters& errors = m_transceiver.errorCounters();
+	s_busStats.rec = errors.rec();
+	s_busStats.errorState = errors.state();
+	s_busStats.txFrameCount = errors.txFrameCount();
+	s_busStats.txBusyCount = errors.txBusyCount();
+	s_busStats.rxFrameCount = errors.rxFrameCount();
+	s_busStats.rxErrorCount = errors.rxErrorCount();
+
+	uint64_t timeNow = mcu::SystemClock::now();
+	s_linkStats.update(timeNow);
+
+	if (timeNow < timeRatePrev + BUS_STATS_PERIOD)
 	{
-		error = true;
-		if (errorDelayExpired)
-		{
-			Syslog::setError(sys::Error::FUELCELL_ERROR);
-		}
+		return;
 	}
 
-	if (hasOverheat())
+	float dt = float(timeNow - timeRatePrev) / 1000.f;
+	for (size_t i = 0; i < s_data.cells.cellCount(); ++i)
 	{
-		error = true;
-		if (errorDelayExpired)
-		{
-			Syslog::setError(sys::Error::FUELCELL_OVERHEAT);
-		}
+		s_busStats.nodeFrameRate[i] = float(s_busStats.nodeFrameCount[i] - nodeFrameCountPrev[i]) / dt;
+		s_busStats.nodeErrorRate[i] = float(s_busStats.nodeErrorCount[i] - nodeErrorCountPrev[i]) / dt;
+		nodeFrameCountPrev[i] = s_busStats.nodeFrameCount[i];
+		nodeErrorCountPrev[i] = s_busStats.nodeErrorCount[i];
 	}
+#ifndef CANBYGPIO_HW_TIMED
+	uint64_t clkCycles = m_transceiver.clockInterruptCycles();
+	s_busStats.clkLoad = 100.f * float(clkCycles - clkCyclesPrev) / (dt * float(mcu::sysclkFreq()));
+	clkCyclesPrev = clkCycles;
+#endif
+	timeRatePrev = timeNow;
+}
 
-	if (hasLowCharge())
-	{
-		error = true;
-		if (errorDelayExpired)
-		{
-			Syslog::setError(sys::Error::FUELCELL_BATT_LOWCHARGE);
-		}
-	}
 
-	if (hasNoConnection())
-	{
-		error = true;
-		if (errorDelayExpired)
-		{
-			Syslog::setError(sys::Error::FUELCELL_NOCONNECTION);
-		}
-	}
-
-	if (hasLowPressure())
-	{
-		error = true;
-		if (errorDelayExpired)
-		{
-			Syslog::setError(sys::Error::FUELCELL_LOWPRESSURE);
-		}
-	}
-
-	if (hasHydroError())
-	{
-		error = true;
-		if (errorDelayExpired)
-		{
-			Syslog::setError(sys::Error::FUELCELL_HYDROERROR);
-		}
-	}
+///
+///
+///
+bool Controller::checkErrors()
+{
+	bool error = false;
 
-	if (minCellVoltage() < ABSOLUTE_MIN_VOLTAGE)
-	{
-		error = true;
-		if (errorDelayExpired)
-		{
-			Syslog::setError(sys::Error::FUELCELL_UV);
-		}
-	}
+	error |= updateError(sys::Error::FUELCELL_ERROR, hasError());
+	error |= updateError(sys::Error::FUELCELL_OVERHEAT, hasOverheat());
+	error |= updateError(sys::Error::FUELCELL_BATT_LOWCHARGE, hasLowCharge());
+	error |= updateError(sys::Error::FUELCELL_NOCONNECTION, hasNoConnection());
+	error |= updateError(sys::Error::FUELCELL_LOWPRESSURE, hasLowPressure());
+	error |= updateError(sys::Error::FUELCELL_HYDROERROR, hasHydroError());
+	error |= updateError(sys::Error::FUELCELL_UV, minCellVoltage() < ABSOLUTE_MIN_VOLTAGE, minCellVoltage());
 
 	if (!isConnectionOk())
 	{
 		Syslog::setError(sys::Error::RS_CONNECTION_LOST);
 	}
 
-	if (error && !errorPrev)
-	{
-		m_isErrorRegistered = true;
-		m_errorRegTimestamp = mcu::SystemClock::now();
-	}
-	else if (!error)
-	{
-		m_isErrorRegistered = false;
-	}
-
-	errorPrev = error;
 	return error;
 }
 
 
+///
+///
+///
+void Controller::initErrorLatches()
+{
+	Syslog::configureErrorLatch(sys::Error::FUELCELL_ERROR, 1, ERROR_PROPAGATION_DELAY, 1, 0);
+	Syslog::configureErrorLatch(sys::Error::FUELCELL_OVERHEAT, 1, ERROR_PROPAGATION_DELAY, 1, 0);
+	Syslog::configureErrorLatch(sys::Error::FUELCELL_BATT_LOWCHARGE, 1, ERROR_PROPAGATION_DELAY, 1, 0);
+	Syslog::configureErrorLatch(sys::Error::FUELCELL_NOCONNECTION, 1, ERROR_PROPAGATION_DELAY, 1, 0);
+	Syslog::configureErrorLatch(sys::Error::FUELCELL_LOWPRESSURE, 1, ERROR_PROPAGATION_DELAY, 1, 0);
+	Syslog::configureErrorLatch(sys::Error::FUELCELL_HYDROERROR, 1, ERROR_PROPAGATION_DELAY, 1, 0);
+	Syslog::configureErrorLatch(sys::Error::FUELCELL_UV, 1, ERROR_PROPAGATION_DELAY, 1, 0);
+}
+
+
 } // namespace fuelcell
 
 
@@ -15,7 +15,11 @@
 #include "mcu/cputimers/mcu_cputimers.h"
 #include "mcu/ipc/mcu_ipc.h"
 #include "canbygpio/canbygpio.h"
+#include "canbygpio/canbygpio_hwtimed.h"
 #include "../fuelcell_def.h"
+#include "fuelcell_celltable.h"
+#include "fuelcell_linkstats.h"
+#include "fuelcell_pdo.h"
 #include "../converter/fuelcell_converter.h"
 #include "sys/syslog/syslog.h"
 
@@ -25,69 +29,52 @@ namespace fuelcell {
 /// @{
 
 
-/**
- * @brief TPDO message.
- */
-struct TpdoMessage
-{
-	uint64_t cmd : 8;
-	uint64_t voltage : 16;
-	uint64_t current : 16;
-	uint64_t reserved : 24;
-
-	TpdoMessage()
-	{
-		uint64_t rawMsg = 0;
-		memcpy(this, &rawMsg, sizeof(TpdoMessage));
-	}
-};
-
-
-/**
- * @brief RPDO message.
- */
-struct RpdoMessage
-{
-	uint64_t temperature : 8;
-	uint64_t cellVoltage : 16;
-	uint64_t battVoltage : 16;
-
-	uint64_t statusError : 1;
-	uint64_t statusStart : 1;
-	uint64_t statusRun : 1;
-	uint64_t statusOverheat : 1;
-	uint64_t statusLowCharge : 1;
-	uint64_t statusNoConnection : 1;
-	uint64_t statusLowPressure : 1;
-	uint64_t statusHydroError : 1;
-
-	int16_t current : 16;
-};
-
-
-const size_t FUELCELL_COUNT = 5;
-
-
 /**
  * @brief Fuel cell data.
  */
 struct Data
 {
-	emb::Array<float, FUELCELL_COUNT> temperature;
-	emb::Array<emb::ExponentialMedianFilter<float, 5>, FUELCELL_COUNT> cellVoltage;
-	emb::Array<float, FUELCELL_COUNT> battVoltage;
-	emb::Array<float, FUELCELL_COUNT> current;
+	CellTable cells;
 
+	// stack-wide flags are reported by the first cell
 	bool statusError;
-	emb::Array<bool, FUELCELL_COUNT> statusStart;
-	emb::Array<bool, FUELCELL_COUNT> statusRun;
-	emb::Array<bool, FUELCELL_COUNT> statusOverheat;
-	emb::Array<bool, FUELCELL_COUNT> statusLowCharge;
 	bool statusNoConnection;
 	bool statusLowPressure;
 	bool statusHydroError;
+};
+
 
-	emb::Array<uint64_t, FUELCELL_COUNT> recvTimestamp;
+/**
+ * @brief Fuel cell bus statistics: CAN-by-GPIO transceiver error state,
+ * counters since startup and per-node rates over the last second.
+ */
+struct BusStatistics
+{
+	uint16_t rec;
+	uint16_t errorState;
+
+	uint32_t txFrameCount;
+	uint32_t txBusyCount;		// frames rejected because previous frame was still being transmitted
+	uint32_t rxFrameCount;
+	uint32_t rxErrorCount;
+
+	uint32_t errSOF;
+	uint32_t errSRR;
+	uint32_t errR0;
+	uint32_t errCRC;
+	uint32_t errStuff;
+	uint32_t errInvalidId;
+	uint32_t errUnknownNode;	// errors of frames with foreign ID or with ID not received
+
+	uint32_t cmdCount;		// start/stop commands sent
+	uint32_t cmdLatency;	// time from last command raise to its transmission, ms
+	uint32_t txRetryCount;	// TPDO send() failures
+	float clkLoad;		// CPU2 time spent in CLK interrupts over last statistics period, %
+
+	emb::Array<uint32_t, FUELCELL_MAX_COUNT> nodeFrameCount;
+	emb::Array<uint32_t, FUELCELL_MAX_COUNT> nodeErrorCount;
+	emb::Array<float, FUELCELL_MAX_COUNT> nodeFrameRate;	// frames per second
+	emb::Array<float, FUELCELL_MAX_COUNT> nodeErrorRate;	// errors per second
 };
 
 
@@ -95,21 +82,31 @@ class Controller
 {
 private:
 	const Converter* m_converter;
+#ifdef CANBYGPIO_HW_TIMED
+	canbygpio::HwTimedTransceiver m_transceiver;
+#else
 	canbygpio::Transceiver m_transceiver;
+#endif
 	static const mcu::IpcFlag SIG_START;
 	static const mcu::IpcFlag SIG_STOP;
 
 	static Data s_data;
+	static BusStatistics s_busStats;
+	static LinkStatistics s_linkStats;
 
-	static const uint64_t TPDO_PERIOD = 200;
+	static const uint64_t TPDO_PERIOD = 200;		// keepalive period
+	static const uint64_t TPDO_MIN_INTERVAL = 20;	// commands are sent immediately but not more often
+	static const uint64_t TPDO_RETRY_DELAY = 5;
 	static const unsigned int TPDO_FRAME_ID = 0x200;
+	static const unsigned int RPDO_FRAME_ID_BASE = 0x180;
+	static const uint64_t BUS_STATS_PERIOD = 1000;
 
-	static uint64_t m_errorRegTimestamp;
-	static bool m_isErrorRegistered;
-	static const uint64_t ERROR_PROPAGATION_DELAY = 5000;
 	static const uint64_t CONNECTION_WAIT = 5000;
 
 public:
+	static const uint32_t BITRATE = 125000;
+	static const uint32_t ERROR_PROPAGATION_DELAY = 5000;	// fuel cell error must persist to be registered
+
 	static const float MIN_OPERATING_VOLTAGE = 32.5;
 	static const float MAX_OPERATING_VOLTAGE = 42;
 
@@ -117,7 +114,7 @@ public:
 	static const float ABSOLUTE_MAX_VOLTAGE = 45;
 
 public:
-	Controller(const Converter* converter,
+	Controller(const Converter* converter, size_t cellCount,
 			const mcu::GpioInput& rxPin, const mcu::GpioOutput& txPin, mcu::GpioOutput& clkPin);
 
 	/**
@@ -129,6 +126,7 @@ public:
 	{
 		runTx();
 		runRx();
+		updateBusStatistics();
 	}
 
 	/**
@@ -162,6 +160,26 @@ public:
 		return s_data;
 	}
 
+	/**
+	 * @brief Returns fuel cell bus statistics.
+	 * @param (none)
+	 * @return Bus statistics.
+	 */
+	static const BusStatistics& busStatistics()
+	{
+		return s_busStats;
+	}
+
+	/**
+	 * @brief Returns fuel cell link statistics.
+	 * @param (none)
+	 * @return Link statistics.
+	 */
+	static const LinkStatistics& linkStatistics()
+	{
+		return s_linkStats;
+	}
+
 	/**
 	 * @brief
 	 * @param
@@ -179,7 +197,7 @@ public:
 	 */
 	static bool isStarting()
 	{
-		return emb::count(s_data.statusStart.begin(), s_data.statusStart.end(), true) == FUELCELL_COUNT;
+		return s_data.cells.allStarting();
 	}
 
 	/**
@@ -189,7 +207,7 @@ public:
 	 */
 	static bool isRunning()
 	{
-		return emb::count(s_data.statusRun.begin(), s_data.statusRun.end(), true) == FUELCELL_COUNT;
+		return s_data.cells.allRunning();
 	}
 
 	/**
@@ -199,7 +217,7 @@ public:
 	 */
 	static bool hasOverheat()
 	{
-		return emb::count(s_data.statusOverheat.begin(), s_data.statusOverheat.end(), true) > 0;
+		return s_data.cells.anyOverheat();
 	}
 
 	/**
@@ -209,7 +227,7 @@ public:
 	 */
 	static bool hasLowCharge()
 	{
-		return emb::count(s_data.statusLowCharge.begin(), s_data.statusLowCharge.end(), true) > 0;
+		return s_data.cells.anyLowCharge();
 	}
 
 	/**
@@ -254,9 +272,12 @@ public:
 			return false;
 		}
 
-		for (size_t i = 0; i < s_data.recvTimestamp.size(); ++i)
+		CellRecord cell;
+		for (size_t i = 0; i < s_data.cells.cellCount(); ++i)
 		{
-			if (mcu::SystemClock::now() - s_data.recvTimestamp[i] > CONNECTION_WAIT)
+			// 64-bit timestamp is written by CPU2, so it is read under sequence lock
+			if (!s_data.cells.readCell(i, cell)
+					|| (mcu::SystemClock::now() - cell.recvTimestamp > CONNECTION_WAIT))
 			{
 				return false;
 			}
@@ -271,6 +292,14 @@ public:
 	 */
 	static bool checkErrors();
 
+	/**
+	 * @brief Configures debouncing of fuel cell errors. Must be called on CPU that runs checkErrors(),
+	 * error latches are local to CPU.
+	 * @param (none)
+	 * @return (none)
+	 */
+	static void initErrorLatches();
+
 	/**
 	 * @brief
 	 * @param (none)
@@ -278,15 +307,17 @@ public:
 	 */
 	static float minCellVoltage()
 	{
-		float min = s_data.cellVoltage[0].emb::ExponentialMedianFilter<float, 5>::output();
-		for (size_t i = 1; i < FUELCELL_COUNT; ++i)
-		{
-			if (s_data.cellVoltage[i].emb::ExponentialMedianFilter<float, 5>::output() < min)
-			{
-				min = s_data.cellVoltage[i].emb::ExponentialMedianFilter<float, 5>::output();
-			}
-		}
-		return min;
+		return s_data.cells.minCellVoltage();
+	}
+
+	/**
+	 * @brief Returns index of fuel cell with min voltage.
+	 * @param (none)
+	 * @return Index of cell with min voltage.
+	 */
+	static size_t minCellVoltageIdx()
+	{
+		return s_data.cells.minCellVoltageIdx();
 	}
 
 	/**
@@ -337,6 +368,13 @@ public:
 private:
 	void runTx();
 	void runRx();
+	void updateBusStatistics();
+
+	static bool updateError(sys::Error::Error error, bool active, float value = 0)
+	{
+		Syslog::updateError(error, active, value);
+		return active;
+	}
 };
 
 
@@ -0,0 +1,103 @@
+/**
+ * @file
+ * @ingroup fuel_cell_controller
+ */
+
+
+#include "fuelcell_linkstats.h"
+
+
+namespace fuelcell {
+
+
+const uint16_t LinkStatistics::INTERVAL_NONE;
+
+
+///
+///
+///
+void LinkStatistics::init(size_t cellCount, uint64_t timeNow)
+{
+	m_cellCount = cellCount;
+	for (size_t i = 0; i < FUELCELL_MAX_COUNT; ++i)
+	{
+		m_histogram[i].fill(0);
+	}
+
+	m_intervalMin.fill(INTERVAL_NONE);
+	m_intervalAvg.fill(INTERVAL_NONE);
+	m_intervalMax.fill(INTERVAL_NONE);
+
+	m_windowStart = timeNow;
+	m_windowMin.fill(INTERVAL_NONE);
+	m_windowMax.fill(0);
+	m_windowCount.fill(0);
+	m_windowSum.fill(0);
+}
+
+
+///
+///
+///
+void LinkStatistics::onFrame(size_t cell, uint64_t interval)
+{
+	uint16_t& count = m_histogram[cell][bucket(interval)];
+	if (count < COUNT_MAX)
+	{
+		++count;
+	}
+
+	uint16_t value = (interval < INTERVAL_NONE) ? uint16_t(interval) : INTERVAL_NONE - 1;
+	if (value < m_windowMin[cell])
+	{
+		m_windowMin[cell] = value;
+	}
+	if (value > m_windowMax[cell])
+	{
+		m_windowMax[cell] = value;
+	}
+	if (m_windowCount[cell] < COUNT_MAX)
+	{
+		++m_windowCount[cell];
+		m_windowSum[cell] += value;
+	}
+}
+
+
+///
+///
+///
+void LinkStatistics::update(uint64_t timeNow)
+{
+	if (timeNow < m_windowStart + WINDOW)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < m_cellCount; ++i)
+	{
+		if (m_windowCount[i] == 0)
+		{
+			m_intervalMin[i] = INTERVAL_NONE;
+			m_intervalAvg[i] = INTERVAL_NONE;
+			m_intervalMax[i] = INTERVAL_NONE;
+		}
+		else
+		{
+			m_intervalMin[i] = m_windowMin[i];
+			m_intervalAvg[i] = m_windowSum[i] / m_windowCount[i];
+			m_intervalMax[i] = m_windowMax[i];
+		}
+
+		m_windowMin[i] = INTERVAL_NONE;
+		m_windowMax[i] = 0;
+		m_windowCount[i] = 0;
+		m_windowSum[i] = 0;
+	}
+	m_windowStart = timeNow;
+}
+
+
+} // namespace fuelcell
+
+
@@ -0,0 +1,121 @@
+/**
+ * @file
+ * @ingroup fuel_cell_controller
+ */
+
+
+#pragma once
+
+
+#include "emb/emb_common.h"
+#include "emb/emb_array.h"
+#include "fuelcell_celltable.h"
+
+
+namespace fuelcell {
+/// @addtogroup fuel_cell_controller
+/// @{
+
+
+/**
+ * @brief Fuel cell link statistics: per-cell frame inter-arrival histograms with log2 buckets
+ * and min/avg/max interval over the last window. Updated in O(1) per frame.
+ */
+class LinkStatistics
+{
+public:
+	static const size_t BUCKET_COUNT = 12;		// bucket N: [2^N, 2^(N+1)) ms, first bucket also has 0 ms, last is open-ended
+	static const uint64_t WINDOW = 10000;		// min/avg/max window, ms
+	static const uint16_t INTERVAL_NONE = 0xFFFF;	// no frames during window
+	static const uint16_t COUNT_MAX = 0xFFFF;	// histogram counts saturate
+
+private:
+	size_t m_cellCount;
+	emb::Array<emb::Array<uint16_t, BUCKET_COUNT>, FUELCELL_MAX_COUNT> m_histogram;
+
+	// published values of last window
+	emb::Array<uint16_t, FUELCELL_MAX_COUNT> m_intervalMin;
+	emb::Array<uint16_t, FUELCELL_MAX_COUNT> m_intervalAvg;
+	emb::Array<uint16_t, FUELCELL_MAX_COUNT> m_intervalMax;
+
+	// current window
+	uint64_t m_windowStart;
+	emb::Array<uint16_t, FUELCELL_MAX_COUNT> m_windowMin;
+	emb::Array<uint16_t, FUELCELL_MAX_COUNT> m_windowMax;
+	emb::Array<uint16_t, FUELCELL_MAX_COUNT> m_windowCount;
+	emb::Array<uint32_t, FUELCELL_MAX_COUNT> m_windowSum;
+
+public:
+	/**
+	 * @brief Resets statistics.
+	 * @param cellCount - number of cells
+	 * @param timeNow - current time, ms
+	 * @return (none)
+	 */
+	void init(size_t cellCount, uint64_t timeNow);
+
+	/**
+	 * @brief Registers received frame of cell.
+	 * @param cell - cell index
+	 * @param interval - time since previous frame of cell, ms
+	 * @return (none)
+	 */
+	void onFrame(size_t cell, uint64_t interval);
+
+	/**
+	 * @brief Publishes min/avg/max intervals when window expires.
+	 * @param timeNow - current time, ms
+	 * @return (none)
+	 */
+	void update(uint64_t timeNow);
+
+	/**
+	 * @brief Returns histogram bucket of interval.
+	 * @param interval - interval, ms
+	 * @return Bucket index.
+	 */
+	static size_t bucket(uint64_t interval)
+	{
+		size_t ret = 0;
+		for (interval >>= 1; (interval != 0) && (ret < BUCKET_COUNT - 1); interval >>= 1)
+		{
+			++ret;
+		}
+		return ret;
+	}
+
+	/**
+	 * @brief Returns number of cell intervals in histogram bucket.
+	 * @param cell - cell index
+	 * @param bucket - bucket index
+	 * @return Number of intervals.
+	 */
+	uint16_t histogram(size_t cell, size_t bucket) const { return m_histogram[cell][bucket]; }
+
+	/**
+	 * @brief Returns min interval of cell over last window.
+	 * @param cell - cell index
+	 * @return Min interval in ms or INTERVAL_NONE.
+	 */
+	uint16_t intervalMin(size_t cell) const { return m_intervalMin[cell]; }
+
+	/**
+	 * @brief Returns average interval of cell over last window.
+	 * @param cell - cell index
+	 * @return Average interval in ms or INTERVAL_NONE.
+	 */
+	uint16_t intervalAvg(size_t cell) const { return m_intervalAvg[cell]; }
+
+	/**
+	 * @brief Returns max interval of cell over last window.
+	 * @param cell - cell index
+	 * @return Max interval in ms or INTERVAL_NONE.
+	 */
+	uint16_t intervalMax(size_t cell) const { return m_intervalMax[cell]; }
+};
+
+
+/// @}
+} // namespace fuelcell
+
+
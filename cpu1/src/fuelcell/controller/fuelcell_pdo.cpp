@@ -0,0 +1,38 @@
+/**
+ * @file
+ * @ingroup fuel_cell_controller
+ */
+
+
+#include "fuelcell_pdo.h"
+
+
+namespace fuelcell {
+
+
+///
+///
+///
+void decodeRpdoBatch(const RpdoColumns& columns, const uint16_t (*payloads)[8], size_t count)
+{
+	uint16_t* temperature = columns.temperature;
+	uint16_t* cellVoltage = columns.cellVoltage;
+	uint16_t* battVoltage = columns.battVoltage;
+	uint16_t* status = columns.status;
+	int16_t* current = columns.current;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		const uint16_t* payload = payloads[i];
+		temperature[i] = payload[0] & 0xFF;
+		cellVoltage[i] = (payload[1] & 0xFF) | ((payload[2] & 0xFF) << 8);
+		battVoltage[i] = (payload[3] & 0xFF) | ((payload[4] & 0xFF) << 8);
+		status[i] = payload[5] & 0xFF;
+		current[i] = int16_t((payload[6] & 0xFF) | ((payload[7] & 0xFF) << 8));
+	}
+}
+
+
+} // namespace fuelcell
+
+
@@ -0,0 +1,154 @@
+/**
+ * @file
+ * @ingroup fuel_cell_controller
+ */
+
+
+#pragma once
+
+
+#include "emb/emb_common.h"
+#include <string.h>
+
+
+namespace fuelcell {
+/// @addtogroup fuel_cell_controller
+/// @{
+
+
+/**
+ * @brief TPDO message.
+ */
+struct TpdoMessage
+{
+	uint64_t cmd : 8;
+	uint64_t voltage : 16;
+	uint64_t current : 16;
+	uint64_t reserved : 24;
+
+	TpdoMessage()
+	{
+		uint64_t rawMsg = 0;
+		memcpy(this, &rawMsg, sizeof(TpdoMessage));
+	}
+};
+
+
+/**
+ * @brief RPDO message.
+ */
+struct RpdoMessage
+{
+	uint64_t temperature : 8;
+	uint64_t cellVoltage : 16;
+	uint64_t battVoltage : 16;
+
+	uint64_t statusError : 1;
+	uint64_t statusStart : 1;
+	uint64_t statusRun : 1;
+	uint64_t statusOverheat : 1;
+	uint64_t statusLowCharge : 1;
+	uint64_t statusNoConnection : 1;
+	uint64_t statusLowPressure : 1;
+	uint64_t statusHydroError : 1;
+
+	int16_t current : 16;
+};
+
+
+/*
+ * PDO payloads are arrays of 8 bytes, one byte per uint16_t element. Codec uses shifts only,
+ * so it produces the same result on C28x and on host regardless of bitfield layout and CHAR_BIT.
+ * Payload byte map of RPDO: [0] temperature, [1..2] cell voltage, [3..4] battery voltage,
+ * [5] status bits from statusError (bit 0) to statusHydroError (bit 7), [6..7] current.
+ */
+
+
+/// RPDO status bits
+enum RpdoStatusBit
+{
+	RPDO_STATUS_ERROR = 0x01,
+	RPDO_STATUS_START = 0x02,
+	RPDO_STATUS_RUN = 0x04,
+	RPDO_STATUS_OVERHEAT = 0x08,
+	RPDO_STATUS_LOWCHARGE = 0x10,
+	RPDO_STATUS_NOCONNECTION = 0x20,
+	RPDO_STATUS_LOWPRESSURE = 0x40,
+	RPDO_STATUS_HYDROERROR = 0x80
+};
+
+
+/**
+ * @brief Decodes RPDO payload.
+ * @param dest - RPDO message
+ * @param payload - 8 bytes of payload
+ * @return (none)
+ */
+inline void decodeRpdo(RpdoMessage& dest, const uint16_t* payload)
+{
+	uint16_t status = payload[5];
+	dest.temperature = payload[0] & 0xFF;
+	dest.cellVoltage = (payload[1] & 0xFF) | ((payload[2] & 0xFF) << 8);
+	dest.battVoltage = (payload[3] & 0xFF) | ((payload[4] & 0xFF) << 8);
+	dest.statusError = (status & RPDO_STATUS_ERROR) != 0;
+	dest.statusStart = (status & RPDO_STATUS_START) != 0;
+	dest.statusRun = (status & RPDO_STATUS_RUN) != 0;
+	dest.statusOverheat = (status & RPDO_STATUS_OVERHEAT) != 0;
+	dest.statusLowCharge = (status & RPDO_STATUS_LOWCHARGE) != 0;
+	dest.statusNoConnection = (status & RPDO_STATUS_NOCONNECTION) != 0;
+	dest.statusLowPressure = (status & RPDO_STATUS_LOWPRESSURE) != 0;
+	dest.statusHydroError = (status & RPDO_STATUS_HYDROERROR) != 0;
+	dest.current = int16_t((payload[6] & 0xFF) | ((payload[7] & 0xFF) << 8));
+}
+
+
+/**
+ * @brief Encodes TPDO payload.
+ * @param payload - 8 bytes of payload
+ * @param src - TPDO message
+ * @return (none)
+ */
+inline void encodeTpdo(uint16_t* payload, const TpdoMessage& src)
+{
+	uint16_t voltage = src.voltage;
+	uint16_t current = src.current;
+	uint32_t reserved = src.reserved;
+	payload[0] = src.cmd & 0xFF;
+	payload[1] = voltage & 0xFF;
+	payload[2] = (voltage >> 8) & 0xFF;
+	payload[3] = current & 0xFF;
+	payload[4] = (current >> 8) & 0xFF;
+	payload[5] = reserved & 0xFF;
+	payload[6] = (reserved >> 8) & 0xFF;
+	payload[7] = (reserved >> 16) & 0xFF;
+}
+
+
+/**
+ * @brief Column storage of decoded RPDOs, arrays are provided by caller.
+ */
+struct RpdoColumns
+{
+	uint16_t* temperature;
+	uint16_t* cellVoltage;
+	uint16_t* battVoltage;
+	uint16_t* status;		// RpdoStatusBit mask
+	int16_t* current;
+};
+
+
+/**
+ * @brief Decodes array of RPDO payloads into columns. Loop body has no branches and
+ * no dependencies between frames, so it is vectorized by host compilers.
+ * @param columns - destination columns, each must hold count elements
+ * @param payloads - payloads, 8 bytes each
+ * @param count - number of payloads
+ * @return (none)
+ */
+void decodeRpdoBatch(const RpdoColumns& columns, const uint16_t (*payloads)[8], size_t count);
+
+
+/// @}
+} // namespace fuelcell
+
+
@@ -6,6 +6,7 @@
 
 #include "fuelcell_converter.h"
 #include "../controller/fuelcell_controller.h"
+#include "mcu/cputimers/mcu_cputimers.h"
 
 
 namespace fuelcell {
@@ -35,8 +36,8 @@ const mcu::GpioConfig FLT_PIN_CFG(15, GPIO_15_GPIO15, mcu::PIN_INPUT, emb::ACTIV
 Converter::Converter(const ConverterConfig& converterConfig,
 		const mcu::PwmConfig<mcu::PWM_ONE_PHASE>& pwmConfig)
 	: emb::c28x::Singleton<Converter>(this)
-	, m_state(POWERUP_State::instance())
 	, m_stateId(CONVERTER_POWERUP)
+	, m_fsmEnvironment(this)
 	, m_config(converterConfig)
 	, m_voltageInFilter(VDC_SMOOTH_FACTOR)
 	, m_voltageOutFilter(VDC_SMOOTH_FACTOR)
@@ -63,6 +64,8 @@ Converter::Converter(const ConverterConfig& converterConfig,
 	, pwm(pwmConfig)
 	, m_batteryCharge(0)
 {
+	Fsm::init(&m_fsmEnvironment);
+
 #if defined(CRD300) || HARDWARE_REVISION == 2
 	pwm.initTzSubmodule(FLT_PIN, XBAR_INPUT1);
 #endif
@@ -75,6 +78,10 @@ Converter::Converter(const ConverterConfig& converterConfig,
 	mcu::Adc::instance()->registerInterruptHandler(mcu::ADC_IRQ_CURRENT_IN_SECOND, onAdcCurrentInSecondInterrupt);
 	mcu::Adc::instance()->registerInterruptHandler(mcu::ADC_IRQ_TEMP_HEATSINK, onAdcTempHeatsinkInterrupt);
 
+	Syslog::configureErrorLatch(sys::Error::OVP_IN, OVP_DEBOUNCE_SAMPLES, 0, 1, 0);
+	Syslog::configureErrorLatch(sys::Error::OVP_OUT, OVP_DEBOUNCE_SAMPLES, 0, 1, 0);
+	Syslog::configureErrorLatch(sys::Error::OCP_IN, OCP_DEBOUNCE_SAMPLES, 0, 1, 0);
+
 #ifndef CRD300
 #if HARDWARE_REVISION == 1
 	RST_PIN.reset();
@@ -97,6 +104,37 @@ void Converter::reset()
 }
 
 
+///
+///
+///
+void Converter::supervise()
+{
+	// PWM event that occurs while masked stays pending in PIE and is serviced after unmasking
+	pwm.maskEventInterrupt();
+
+	// events posted meanwhile wait for next pass, so that masked time is bounded by queue capacity
+	size_t eventCount;
+	{
+		mcu::NESTED_CRITICAL_SECTION;
+		eventCount = m_events.size();
+	}
+	FsmEvent event;
+	for (; (eventCount > 0) && _popEvent(event); --eventCount)
+	{
+		Fsm::dispatch(m_stateId, event);
+	}
+
+	Fsm::dispatch(m_stateId, FSM_EVENT_SUPERVISE);
+	FsmEvent timerEvent;
+	while (Fsm::popExpiredTimer(timerEvent))
+	{
+		Fsm::dispatch(m_stateId, timerEvent);
+	}
+
+	pwm.unmaskEventInterrupt();
+}
+
+
 ///
 ///
 ///
@@ -128,11 +166,11 @@ __interrupt void Converter::onAdcVoltageInInterrupt()
 	float vIn = converter->inVoltageSensor.read();
 	converter->m_voltageInFilter.push(vIn);
 
-	if (converter->m_voltageInFilter.output() > converter->m_config.ovpVoltageIn)
-	{
-		Syslog::setError(sys::Error::OVP_IN);
-	}
-	else if (converter->m_voltageInFilter.output() < converter->m_config.uvpVoltageIn)
+	Syslog::updateError(sys::Error::OVP_IN,
+			converter->m_voltageInFilter.output() > converter->m_config.ovpVoltageIn,
+			converter->m_voltageInFilter.output());
+
+	if (converter->m_voltageInFilter.output() < converter->m_config.uvpVoltageIn)
 	{
 		// TODO Syslog::setFault(sys::Fault::UVP_IN);
 	}
@@ -150,15 +188,12 @@ __interrupt void Converter::onAdcVoltageOutInterrupt()
 	Converter* converter = Converter::instance();
 
 	float vOut = converter->outVoltageSensor.read();
-	if (vOut > converter->m_config.ovpVoltageOut)
-	{
-		Syslog::setError(sys::Error::OVP_OUT);
-	}
+	Syslog::updateError(sys::Error::OVP_OUT, vOut > converter->m_config.ovpVoltageOut, vOut);
 
 	converter->m_voltageOutFilter.push(vOut);
 	if (converter->m_voltageOutFilter.output() > converter->m_config.batteryMaxVoltage)
 	{
-		Syslog::setWarning(sys::Warning::BATTERY_CHARGED);
+		Syslog::setWarning(sys::Warning::BATTERY_CHARGED, converter->m_voltageOutFilter.output());
 		converter->shutdown();
 	}
 	else if (converter->m_voltageOutFilter.output() < converter->m_config.batteryMinVoltage)
@@ -184,11 +219,6 @@ __interrupt void Converter::onAdcCurrentInFirstInterrupt()
 	converter->m_currentIn.first = converter->inCurrentSensor.read(InCurrentSensor::FIRST);
 #endif
 
-	if (converter->m_currentIn.first > converter->m_config.ocpCurrentIn)
-	{
-		Syslog::setError(sys::Error::OCP_IN);
-	}
-
 	mcu::Adc::instance()->acknowledgeInterrupt(mcu::ADC_IRQ_CURRENT_IN_FIRST);
 }
 
@@ -207,10 +237,10 @@ __interrupt void Converter::onAdcCurrentInSecondInterrupt()
 	converter->m_currentIn.second = converter->inCurrentSensor.read(InCurrentSensor::SECOND);
 #endif
 
-	if (converter->m_currentIn.second > converter->m_config.ocpCurrentIn)
-	{
-		Syslog::setError(sys::Error::OCP_IN);
-	}
+	// both measurements of PWM period are checked at once, so that OCP is debounced by whole periods
+	float currentInMax = (converter->m_currentIn.first > converter->m_currentIn.second)
+			? converter->m_currentIn.first : converter->m_currentIn.second;
+	Syslog::updateError(sys::Error::OCP_IN, currentInMax > converter->m_config.ocpCurrentIn, currentInMax);
 
 	// calculate average inductor current
 	converter->m_currentInFilter.push((converter->m_currentIn.first + converter->m_currentIn.second) / 2);
@@ -261,12 +291,192 @@ void Converter::processTemperatureMeasurements()
 
 		if (m_tempHeatsinkFilter.output() > m_config.otpTempHeatsink)
 		{
-			Syslog::setError(sys::Error::HEATSINK_OVERTEMP);
+			Syslog::setError(sys::Error::HEATSINK_OVERTEMP, m_tempHeatsinkFilter.output());
 		}
 	}
 }
 
 
+///
+///
+///
+uint64_t ConverterFsmEnvironment::now()
+{
+	return mcu::SystemClock::now();
+}
+
+
+///
+///
+///
+bool ConverterFsmEnvironment::hasErrors()
+{
+	return Syslog::hasErrors();
+}
+
+
+///
+///
+///
+bool ConverterFsmEnvironment::batteryCharged()
+{
+	return Syslog::hasWarning(sys::Warning::BATTERY_CHARGED);
+}
+
+
+///
+///
+///
+void ConverterFsmEnvironment::resetErrorsWarnings()
+{
+	Syslog::resetErrorsWarnings();
+}
+
+
+///
+///
+///
+void ConverterFsmEnvironment::resetConnectionError()
+{
+	Syslog::resetError(sys::Error::RS_CONNECTION_LOST);
+}
+
+
+///
+///
+///
+void ConverterFsmEnvironment::setStartupFailedError()
+{
+	Syslog::setError(sys::Error::FUELCELL_STARTUP_FAILED);
+}
+
+
+///
+///
+///
+bool ConverterFsmEnvironment::fuelcellsConnected()
+{
+	return Controller::isConnectionOk();
+}
+
+
+///
+///
+///
+bool ConverterFsmEnvironment::fuelcellsRunning()
+{
+	return Controller::isRunning();
+}
+
+
+///
+///
+///
+void ConverterFsmEnvironment::startFuelcells()
+{
+	Controller::start();
+}
+
+
+///
+///
+///
+void ConverterFsmEnvironment::stopFuelcells()
+{
+	Controller::stop();
+}
+
+
+///
+///
+///
+void ConverterFsmEnvironment::enableFuelcellErrors()
+{
+	Controller::enableErrors();
+}
+
+
+///
+///
+///
+float ConverterFsmEnvironment::voltageIn()
+{
+	return m_converter->voltageIn();
+}
+
+
+///
+///
+///
+float ConverterFsmEnvironment::currentInMin()
+{
+	return m_converter->config().currentInMin;
+}
+
+
+///
+///
+///
+float ConverterFsmEnvironment::currentInMax()
+{
+	return m_converter->config().currentInMax;
+}
+
+
+///
+///
+///
+float ConverterFsmEnvironment::pwmFreq()
+{
+	return m_converter->pwm.freq();
+}
+
+
+///
+///
+///
+void ConverterFsmEnvironment::startConverter()
+{
+	m_converter->start();
+}
+
+
+///
+///
+///
+void ConverterFsmEnvironment::stopConverter()
+{
+	m_converter->stop();
+}
+
+
+///
+///
+///
+void ConverterFsmEnvironment::setCurrentIn(float value)
+{
+	m_converter->setCurrentIn(value);
+}
+
+
+///
+///
+///
+void ConverterFsmEnvironment::turnRelayOn()
+{
+	m_converter->turnRelayOn();
+}
+
+
+///
+///
+///
+void ConverterFsmEnvironment::turnRelayOff()
+{
+	m_converter->turnRelayOff();
+}
+
+
 } // namespace fuelcell
 
 
@@ -58,24 +58,56 @@ struct ConverterConfig
 };
 
 
+/// Forward declaration.
+class Converter;
+
+
+/**
+ * @brief Converter FSM environment on target: system clock, syslog, fuel cell controller and converter hardware.
+ */
+class ConverterFsmEnvironment : public IFsmEnvironment
+{
+private:
+	Converter* const m_converter;
+public:
+	explicit ConverterFsmEnvironment(Converter* converter) : m_converter(converter) {}
+
+	virtual uint64_t now();
+
+	virtual bool hasErrors();
+	virtual bool batteryCharged();
+	virtual void resetErrorsWarnings();
+	virtual void resetConnectionError();
+	virtual void setStartupFailedError();
+
+	virtual bool fuelcellsConnected();
+	virtual bool fuelcellsRunning();
+	virtual void startFuelcells();
+	virtual void stopFuelcells();
+	virtual void enableFuelcellErrors();
+
+	virtual float voltageIn();
+	virtual float currentInMin();
+	virtual float currentInMax();
+	virtual float pwmFreq();
+	virtual void startConverter();
+	virtual void stopConverter();
+	virtual void setCurrentIn(float value);
+	virtual void turnRelayOn();
+	virtual void turnRelayOff();
+};
+
+
 /**
  * @brief Converter class.
  */
 class Converter : public emb::c28x::Singleton<Converter>
 {
-	friend class IState;
-	friend class STANDBY_State;
-	friend class IDLE_State;
-	friend class STARTUP_State;
-	friend class READY_State;
-	friend class CHARGING_START_State;
-	friend class CHARGING_State;
-	friend class CHARGING_STOP_State;
-	friend class SHUTDOWN_State;
-	friend class WAIT_State;
+	friend class ConverterFsmEnvironment;
 private:
-	IState* m_state;
 	ConverterState m_stateId;
+	ConverterFsmEnvironment m_fsmEnvironment;
+	FsmEventQueue<FsmEvent, 8> m_events;	// events posted but not yet dispatched by supervise(), accessed in critical section
 
 	ConverterConfig m_config;
 
@@ -88,6 +120,10 @@ private:
 	static const float TEMP_SMOOTH_FACTOR = 0.001;
 	emb::ExponentialMedianFilter<float, 5> m_tempHeatsinkFilter;
 
+	// consecutive ADC samples over limit to trip protection: single-sample noise must not trip converter
+	static const uint16_t OVP_DEBOUNCE_SAMPLES = 3;
+	static const uint16_t OCP_DEBOUNCE_SAMPLES = 2;
+
 	emb::PiControllerCl<emb::CONTROLLER_DIRECT> m_dutycycleController;
 	emb::PiControllerCl<emb::CONTROLLER_INVERSE> m_currentController;
 
@@ -128,13 +164,41 @@ public:
 	Converter(const ConverterConfig& converterConfig,
 			const mcu::PwmConfig<mcu::PWM_ONE_PHASE>& pwmConfig);
 
-	// FSM methods
-	void startup() { m_state->startup(this); }
-	void shutdown() { m_state->shutdown(this); }
-	void startCharging() { m_state->startCharging(this); }
-	void run() { m_state->run(this); }
-	void stopCharging() { m_state->stopCharging(this); }
-	void emergencyShutdown() { m_state->emergencyShutdown(this); }
+	// FSM methods: FSM is dispatched only by PWM ISR (run) and supervisor (supervise),
+	// command events may be posted from any context and are dispatched by next supervise() in order of arrival
+	void startup() { _postEvent(FSM_EVENT_STARTUP); }
+	void shutdown() { _postEvent(FSM_EVENT_SHUTDOWN); }
+	void startCharging() { _postEvent(FSM_EVENT_START_CHARGING); }
+	void run() { Fsm::dispatch(m_stateId, FSM_EVENT_RUN); }
+	void stopCharging() { _postEvent(FSM_EVENT_STOP_CHARGING); }
+
+	/**
+	 * @brief Stops PWM at once in posting context and posts FSM_EVENT_EMERGENCY_SHUTDOWN before all queued events,
+	 * so that FSM completes shutdown by next supervise() before any other command. May be called from any context.
+	 * @param (none)
+	 * @return (none)
+	 */
+	void emergencyShutdown()
+	{
+		pwm.stop();
+		mcu::NESTED_CRITICAL_SECTION;
+		m_events.pushFront(FSM_EVENT_EMERGENCY_SHUTDOWN);
+	}
+
+	/**
+	 * @brief Returns number of posted events that were lost because event queue was full.
+	 * @param (none)
+	 * @return Number of lost events.
+	 */
+	uint32_t lostEventCount() const { return m_events.lostCount(); }
+
+	/**
+	 * @brief Dispatches posted events, FSM_EVENT_SUPERVISE and expired timer events.
+	 * PWM event interrupt is masked meanwhile, so FSM is never dispatched concurrently. Must be called only by supervisor task.
+	 * @param (none)
+	 * @return (none)
+	 */
+	void supervise();
 
 	/**
 	 * @brief Returns converter state.
@@ -151,7 +215,7 @@ private:
 	 */
 	void start()
 	{
-		if ((Syslog::errors() == 0)
+		if (!Syslog::hasErrors()
 				&& (!Syslog::hasWarning(sys::Warning::BATTERY_CHARGED)
 				&& (pwm.state() == mcu::PWM_OFF)))
 		{
@@ -178,6 +242,28 @@ private:
 	 */
 	void reset();
 
+	/**
+	 * @brief Posts FSM event to be dispatched by supervisor.
+	 * @param event - FSM event
+	 * @return (none)
+	 */
+	void _postEvent(FsmEvent event)
+	{
+		mcu::NESTED_CRITICAL_SECTION;
+		m_events.push(event);
+	}
+
+	/**
+	 * @brief Removes first posted FSM event.
+	 * @param event - FSM event
+	 * @return \c true if event is removed, \c false if there are no posted events.
+	 */
+	bool _popEvent(FsmEvent& event)
+	{
+		mcu::NESTED_CRITICAL_SECTION;
+		return m_events.pop(event);
+	}
+
 public:
 	float voltageIn() const { return m_voltageInFilter.output(); }
 	float voltageOut() const { return m_voltageOutFilter.output(); }
@@ -224,12 +310,6 @@ protected:
 	static __interrupt void onAdcCurrentInSecondInterrupt();
 	static __interrupt void onAdcTempHeatsinkInterrupt();
 
-private:
-	void changeState(IState* state)
-	{
-		m_state = state;
-		m_stateId = state->id();
-	}
 };
 
 
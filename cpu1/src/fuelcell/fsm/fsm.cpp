@@ -5,28 +5,12 @@
 
 
 #include "fsm.h"
-#include "../converter/fuelcell_converter.h"
-#include "../controller/fuelcell_controller.h"
-#include "mcu/cputimers/mcu_cputimers.h"
+#include <math.h>
 
 
 namespace fuelcell {
 
 
-uint64_t IState::s_timestamp = 0;
-
-
-POWERUP_State POWERUP_State::s_instance;
-STANDBY_State STANDBY_State::s_instance;
-STARTUP_State STARTUP_State::s_instance;
-READY_State READY_State::s_instance;
-CHARGING_START_State CHARGING_START_State::s_instance;
-CHARGING_State CHARGING_State::s_instance;
-CHARGING_STOP_State CHARGING_STOP_State::s_instance;
-SHUTDOWN_State SHUTDOWN_State::s_instance;
-WAIT_State WAIT_State::s_instance;
-
-
 const uint64_t POWERUP_TO_STANDBY_DELAY = 5000;
 const uint64_t ERROR_ENABLING_DELAY = 30000;
 const uint64_t FUELCELL_STARTUP_MAX_DURATION = 45000;
@@ -35,232 +19,123 @@ const uint64_t DELAY_BEFORE_SHUTDOWN = 2000;
 const uint64_t DELAY_AFTER_SHUTDOWN = 5000;
 const uint64_t RELAUNCH_DELAY = 10000;
 
+const float STARTUP_VOLTAGE_STEP_MAX = 0.1f;	// V per PWM period, fuel cell voltage is settled below this step
+const float CURRENT_RAMP_DURATION = 60;		// s
+
 
-unsigned int failureCount = 0;
 const unsigned int MAX_FAILURE_COUNT = 3;
 
 
 /* ################################################################################################################## */
-/* ##################### */
-/* ##### INTERFACE ##### */
-/* ##################### */
-///
-///
-///
-void IState::changeState(Converter* converter, IState* state)
+/* ############################ */
+/* ##### TRANSITION TABLE ##### */
+/* ############################ */
+const Fsm::Transition Fsm::TRANSITIONS[] =
 {
-	converter->changeState(state);
-	s_timestamp = mcu::SystemClock::now();
-}
+//	state				event				guard			action			next			wait delay
+{CONVERTER_POWERUP,		FSM_EVENT_SUPERVISE,		_isConnectionOk,	_resetConnectionError,	CONVERTER_STANDBY,	POWERUP_TO_STANDBY_DELAY},
 
+{CONVERTER_STANDBY,		FSM_EVENT_STARTUP,		_canStartFuelcells,	_startFuelcells,	CONVERTER_STARTUP,	0},
+{CONVERTER_STANDBY,		FSM_EVENT_STARTUP,		_canRelaunch,		_relaunch,		CONVERTER_STANDBY,	RELAUNCH_DELAY},
+{CONVERTER_STANDBY,		FSM_EVENT_START_CHARGING,	_canStartFuelcells,	_startFuelcells,	CONVERTER_STARTUP,	0},
+{CONVERTER_STANDBY,		FSM_EVENT_START_CHARGING,	_canRelaunch,		_relaunch,		CONVERTER_STANDBY,	RELAUNCH_DELAY},
 
-///
-///
-///
-void changeStateAfterWait(Converter* converter, IState* nextState, uint64_t delay)
-{
-	WAIT_State::instance()->m_waitTime = delay;
-	WAIT_State::instance()->m_nextState = nextState;
-	WAIT_State::instance()->m_waitStart = mcu::SystemClock::now();
-	IState::changeState(converter, WAIT_State::instance());
-}
+{CONVERTER_STARTUP,		FSM_EVENT_SHUTDOWN,		NULL,			_stopFuelcells,		CONVERTER_SHUTDOWN,	DELAY_BEFORE_SHUTDOWN},
+{CONVERTER_STARTUP,		FSM_EVENT_SUPERVISE,		NULL,			_monitorStartup,	FSM_INTERNAL,		0},
+{CONVERTER_STARTUP,		FSM_EVENT_SUPERVISE,		_fuelcellsStarted,	_completeStartup,	FSM_INTERNAL,		0},
+{CONVERTER_STARTUP,		FSM_EVENT_SUPERVISE,		_hasErrors,		_stopFuelcells,		CONVERTER_SHUTDOWN,	DELAY_BEFORE_SHUTDOWN},
+{CONVERTER_STARTUP,		FSM_EVENT_SUPERVISE,		_fuelcellsStarted,	NULL,			CONVERTER_READY,	STARTUP_TO_READY_DELAY},
+{CONVERTER_STARTUP,		FSM_EVENT_EMERGENCY_SHUTDOWN,	NULL,			_stopFuelcells,		CONVERTER_SHUTDOWN,	DELAY_BEFORE_SHUTDOWN},
+{CONVERTER_STARTUP,		FSM_EVENT_ERROR_ENABLING_TIMEOUT, NULL,			_enableFuelcellErrors,	FSM_INTERNAL,		0},
+{CONVERTER_STARTUP,		FSM_EVENT_STARTUP_TIMEOUT,	NULL,			_failStartup,		CONVERTER_SHUTDOWN,	DELAY_BEFORE_SHUTDOWN},
 
+{CONVERTER_READY,		FSM_EVENT_SHUTDOWN,		NULL,			_stopFuelcells,		CONVERTER_SHUTDOWN,	DELAY_BEFORE_SHUTDOWN},
+{CONVERTER_READY,		FSM_EVENT_START_CHARGING,	_canStartCharging,	_startConverter,	CONVERTER_CHARGING_START, 0},
+{CONVERTER_READY,		FSM_EVENT_SUPERVISE,		_hasErrors,		_stopFuelcells,		CONVERTER_SHUTDOWN,	DELAY_BEFORE_SHUTDOWN},
+{CONVERTER_READY,		FSM_EVENT_EMERGENCY_SHUTDOWN,	NULL,			_stopFuelcells,		CONVERTER_SHUTDOWN,	DELAY_BEFORE_SHUTDOWN},
 
-/* ################################################################################################################## */
-/* ######################### */
-/* ##### POWERUP state ##### */
-/* ######################### */
-///
-///
-///
-void POWERUP_State::startup(Converter* converter)
-{
-	/* DO NOTHING */
-}
+{CONVERTER_CHARGING_START,	FSM_EVENT_SHUTDOWN,		NULL,			_stopAll,		CONVERTER_SHUTDOWN,	DELAY_BEFORE_SHUTDOWN},
+{CONVERTER_CHARGING_START,	FSM_EVENT_RUN,			_hasErrors,		_stopAll,		CONVERTER_SHUTDOWN,	DELAY_BEFORE_SHUTDOWN},
+{CONVERTER_CHARGING_START,	FSM_EVENT_RUN,			NULL,			_rampCurrent,		FSM_INTERNAL,		0},
+{CONVERTER_CHARGING_START,	FSM_EVENT_RUN,			_currentRampCompleted,	_resetCurrentRamp,	CONVERTER_CHARGING,	0},
+{CONVERTER_CHARGING_START,	FSM_EVENT_STOP_CHARGING,	NULL,			_stopConverter,		CONVERTER_READY,	0},
+{CONVERTER_CHARGING_START,	FSM_EVENT_EMERGENCY_SHUTDOWN,	NULL,			_stopAll,		CONVERTER_SHUTDOWN,	DELAY_BEFORE_SHUTDOWN},
 
+{CONVERTER_CHARGING,		FSM_EVENT_SHUTDOWN,		NULL,			_stopAll,		CONVERTER_SHUTDOWN,	DELAY_BEFORE_SHUTDOWN},
+{CONVERTER_CHARGING,		FSM_EVENT_RUN,			_hasErrors,		_stopAll,		CONVERTER_SHUTDOWN,	DELAY_BEFORE_SHUTDOWN},
+{CONVERTER_CHARGING,		FSM_EVENT_STOP_CHARGING,	NULL,			_stopConverter,		CONVERTER_READY,	0},
+{CONVERTER_CHARGING,		FSM_EVENT_EMERGENCY_SHUTDOWN,	NULL,			_stopAll,		CONVERTER_SHUTDOWN,	DELAY_BEFORE_SHUTDOWN},
 
-///
-///
-///
-void POWERUP_State::shutdown(Converter* converter)
-{
-	/* DO NOTHING */
-}
+// TODO CHARGING_STOP state has no transitions yet
 
+{CONVERTER_SHUTDOWN,		FSM_EVENT_SUPERVISE,		NULL,			_completeShutdown,	CONVERTER_STANDBY,	DELAY_AFTER_SHUTDOWN},
 
-///
-///
-///
-void POWERUP_State::startCharging(Converter* converter)
-{
-	/* DO NOTHING */
-}
+{CONVERTER_WAIT,		FSM_EVENT_SHUTDOWN,		NULL,			_stopConverter,		FSM_INTERNAL,		0},
+{CONVERTER_WAIT,		FSM_EVENT_SUPERVISE,		_hasErrors,		_stopConverter,		FSM_INTERNAL,		0},
+{CONVERTER_WAIT,		FSM_EVENT_EMERGENCY_SHUTDOWN,	NULL,			_stopConverter,		FSM_INTERNAL,		0},
+{CONVERTER_WAIT,		FSM_EVENT_WAIT_TIMEOUT,		NULL,			NULL,			FSM_WAIT_TARGET,	0},
+};
 
 
-///
-///
-///
-void POWERUP_State::run(Converter* converter)
-{
-	if (Controller::isConnectionOk())
-	{
-		Syslog::resetError(sys::Error::RS_CONNECTION_LOST);
-		changeStateAfterWait(converter, STANDBY_State::instance(), POWERUP_TO_STANDBY_DELAY);
-	}
-}
+const size_t Fsm::TRANSITION_COUNT = sizeof(Fsm::TRANSITIONS) / sizeof(Fsm::TRANSITIONS[0]);
 
 
-///
-///
-///
-void POWERUP_State::stopCharging(Converter* converter)
-{
-	/* DO NOTHING */
-}
+uint16_t Fsm::s_transitionBegin[CONVERTER_STATE_COUNT][FSM_EVENT_COUNT];
+uint16_t Fsm::s_transitionEnd[CONVERTER_STATE_COUNT][FSM_EVENT_COUNT];
 
+IFsmEnvironment* Fsm::s_env = NULL;
 
-///
-///
-///
-void POWERUP_State::emergencyShutdown(Converter* converter)
-{
-	/* DO NOTHING */
-}
+uint64_t Fsm::s_timestamp = 0;
+ConverterState Fsm::s_waitTarget = CONVERTER_STANDBY;
 
+FsmTimerQueue<FsmEvent, Fsm::TIMER_COUNT> Fsm::s_timers;
 
-/* ################################################################################################################## */
-/* ######################### */
-/* ##### STANDBY state ##### */
-/* ######################### */
-///
-///
-///
-void STANDBY_State::startup(Converter* converter)
-{
-	if (!Syslog::hasWarning(sys::Warning::BATTERY_CHARGED))
-	{
-		if (!Syslog::errors())
-		{
-			Controller::start();
-			changeState(converter, STARTUP_State::instance());
-		}
-		else if (failureCount < MAX_FAILURE_COUNT)
-		{
-			Syslog::resetErrorsWarnings();
-			changeStateAfterWait(converter, STANDBY_State::instance(), RELAUNCH_DELAY);
-		}
-	}
-}
-
-
-///
-///
-///
-void STANDBY_State::shutdown(Converter* converter)
-{
-	/* DO NOTHING */
-}
-
-
-///
-///
-///
-void STANDBY_State::startCharging(Converter* converter)
-{
-	startup(converter);
-}
-
-
-///
-///
-///
-void STANDBY_State::run(Converter* converter)
-{
-	/* DO NOTHING */
-}
-
-
-///
-///
-///
-void STANDBY_State::stopCharging(Converter* converter)
-{
-	/* DO NOTHING */
-}
-
-
-///
-///
-///
-void STANDBY_State::emergencyShutdown(Converter* converter)
-{
-	/* DO NOTHING */
-}
+float Fsm::s_currentInRef = 0;
+float Fsm::s_currentInRefStep = 0;
+float Fsm::s_voltageInPrev = 0;
+bool Fsm::s_fuelcellsStarted = false;
+unsigned int Fsm::s_failureCount = 0;
 
 
 /* ################################################################################################################## */
-/* ######################### */
-/* ##### STARTUP state ##### */
-/* ######################### */
-///
-///
-///
-void STARTUP_State::startup(Converter* converter)
-{
-	/* DO NOTHING */
-}
-
-
-///
-///
-///
-void STARTUP_State::shutdown(Converter* converter)
-{
-	Controller::stop();
-	changeStateAfterWait(converter, SHUTDOWN_State::instance(), DELAY_BEFORE_SHUTDOWN);
-}
-
-
+/* ######################## */
+/* ##### FSM INTERFACE ##### */
+/* ######################## */
 ///
 ///
 ///
-void STARTUP_State::startCharging(Converter* converter)
+void Fsm::init(IFsmEnvironment* env)
 {
-	/* DO NOTHING */
-}
-
-
-///
-///
-///
-void STARTUP_State::run(Converter* converter)
-{
-	static float voltPrev = 0;
-	float voltDiff = fabsf(converter->voltageIn() - voltPrev);
-	voltPrev = converter->voltageIn();
+	assert(checkTable());
+	assert(env != NULL);
 
-	// TODO Controller::start(); // may be needed here to reset errors at fuel cells (multiple start signal sending)
+	s_env = env;
+	s_timestamp = env->now();
+	s_waitTarget = CONVERTER_STANDBY;
+	s_timers.clear();
+	s_currentInRef = 0;
+	s_currentInRefStep = 0;
+	s_voltageInPrev = 0;
+	s_fuelcellsStarted = false;
+	s_failureCount = 0;
 
-	if (mcu::SystemClock::now() - timestamp() > ERROR_ENABLING_DELAY)
+	for (size_t state = 0; state < CONVERTER_STATE_COUNT; ++state)
 	{
-		Controller::enableErrors();
-	}
-
-	if ((fuelcell::Controller::isRunning()) && (voltDiff < 0.1))
-	{
-		failureCount = 0;
-		Controller::enableErrors();
-		converter->turnRelayOn();
-		changeStateAfterWait(converter, READY_State::instance(), STARTUP_TO_READY_DELAY);
-	}
-	else if (mcu::SystemClock::now() - timestamp() > FUELCELL_STARTUP_MAX_DURATION)
-	{
-		Syslog::setError(sys::Error::FUELCELL_STARTUP_FAILED);
+		for (size_t event = 0; event < FSM_EVENT_COUNT; ++event)
+		{
+			s_transitionBegin[state][event] = 0;
+			s_transitionEnd[state][event] = 0;
+		}
 	}
 
-	if (Syslog::errors() != 0)
+	for (size_t i = TRANSITION_COUNT; i > 0; --i)
 	{
-		shutdown(converter);
+		const Transition& transition = TRANSITIONS[i-1];
+		if (s_transitionEnd[transition.state][transition.event] == 0)
+		{
+			s_transitionEnd[transition.state][transition.event] = i;
+		}
+		s_transitionBegin[transition.state][transition.event] = i - 1;
 	}
 }
 
@@ -268,426 +143,328 @@ void STARTUP_State::run(Converter* converter)
 ///
 ///
 ///
-void STARTUP_State::stopCharging(Converter* converter)
-{
-	/* DO NOTHING */
-}
-
-
-///
-///
-///
-void STARTUP_State::emergencyShutdown(Converter* converter)
+bool Fsm::checkTable()
 {
-	shutdown(converter);
-}
-
-
-/* ################################################################################################################## */
-/* ####################### */
-/* ##### READY state ##### */
-/* ####################### */
-///
-///
-///
-void READY_State::startup(Converter* converter)
-{
-	/* DO NOTHING */
-}
+	for (size_t i = 0; i < TRANSITION_COUNT; ++i)
+	{
+		const Transition& transition = TRANSITIONS[i];
 
+		if ((transition.state >= CONVERTER_STATE_COUNT) || (transition.event >= FSM_EVENT_COUNT)) return false;
 
-///
-///
-///
-void READY_State::shutdown(Converter* converter)
-{
-	Controller::stop();
-	changeStateAfterWait(converter, SHUTDOWN_State::instance(), DELAY_BEFORE_SHUTDOWN);
-}
+		if (transition.next == FSM_WAIT_TARGET)
+		{
+			if ((transition.state != CONVERTER_WAIT) || (transition.waitDelay != 0)) return false;
+		}
+		else if (transition.next == FSM_INTERNAL)
+		{
+			if (transition.waitDelay != 0) return false;
+		}
+		else if ((transition.next >= CONVERTER_STATE_COUNT) || (transition.next == CONVERTER_WAIT))
+		{
+			return false;
+		}
 
+		if (i == 0) continue;
 
-///
-///
-///
-void READY_State::startCharging(Converter* converter)
-{
-	if ((Syslog::errors() == 0) && (!Syslog::hasWarning(sys::Warning::BATTERY_CHARGED)))
-	{
-		converter->start();
-		changeState(converter, CHARGING_START_State::instance());
-	}
-}
-
+		const Transition& prev = TRANSITIONS[i-1];
+		bool samePair = (prev.state == transition.state) && (prev.event == transition.event);
+		if (samePair)
+		{
+			// previous transition is always taken, this one is unreachable
+			if ((prev.guard == NULL) && (prev.next != FSM_INTERNAL)) return false;
+			continue;
+		}
 
-///
-///
-///
-void READY_State::run(Converter* converter)
-{
-	if (Syslog::errors() != 0)
-	{
-		shutdown(converter);
+		// first transition of pair, there must be no transitions of this pair before
+		for (size_t j = 0; j < i; ++j)
+		{
+			if ((TRANSITIONS[j].state == transition.state) && (TRANSITIONS[j].event == transition.event)) return false;
+		}
 	}
+	return true;
 }
 
 
 ///
 ///
 ///
-void READY_State::stopCharging(Converter* converter)
-{
-	/* DO NOTHING */
-}
-
-
-///
-///
-///
-void READY_State::emergencyShutdown(Converter* converter)
-{
-	shutdown(converter);
-}
-
-/* ################################################################################################################## */
-/* ############################### */
-/* ##### STARTCHARGING state ##### */
-/* ############################### */
-///
-///
-///
-void CHARGING_START_State::startup(Converter* converter)
+void Fsm::dispatch(ConverterState& state, FsmEvent event)
 {
-	/* DO NOTHING */
-}
+	const Transition* transition = TRANSITIONS + s_transitionBegin[state][event];
+	const Transition* end = TRANSITIONS + s_transitionEnd[state][event];
 
+	for (; transition != end; ++transition)
+	{
+		if (transition->guard && !transition->guard()) continue;
+		if (transition->action) transition->action();
+		if (transition->next == FSM_INTERNAL) continue;
 
-///
-///
-///
-void CHARGING_START_State::shutdown(Converter* converter)
-{
-	converter->stop();
-	Controller::stop();
-	resetState();
-	changeStateAfterWait(converter, SHUTDOWN_State::instance(), DELAY_BEFORE_SHUTDOWN);
+		_changeState(state, *transition);
+		return;
+	}
 }
 
 
 ///
 ///
 ///
-void CHARGING_START_State::startCharging(Converter* converter)
+void Fsm::_changeState(ConverterState& state, const Transition& transition)
 {
-	/* DO NOTHING */
-}
+	uint64_t timeNow = s_env->now();
 
-
-///
-///
-///
-void CHARGING_START_State::run(Converter* converter)
-{
-	if (Syslog::errors() != 0)
+	if (transition.next == FSM_WAIT_TARGET)
 	{
-		shutdown(converter);
+		state = s_waitTarget;
 	}
-
-	float currRefDiff = (converter->config().currentInMax - converter->config().currentInMin) /
-			(60 * converter->pwm.freq());
-	m_currentInRef = emb::clamp(m_currentInRef + currRefDiff,
-			converter->config().currentInMin, converter->config().currentInMax);
-
-	converter->setCurrentIn(m_currentInRef);
-
-	if (m_currentInRef >= converter->config().currentInMax)
+	else if (transition.waitDelay != 0)
 	{
-		resetState();
-		changeState(converter, CHARGING_State::instance());
+		s_waitTarget = transition.next;
+		s_timers.schedule(FSM_EVENT_WAIT_TIMEOUT, timeNow + transition.waitDelay);
+		state = CONVERTER_WAIT;
+	}
+	else
+	{
+		state = transition.next;
 	}
 
+	s_timestamp = timeNow;
 }
 
 
+/* ################################################################################################################## */
+/* ################## */
+/* ##### GUARDS ##### */
+/* ################## */
 ///
 ///
 ///
-void CHARGING_START_State::stopCharging(Converter* converter)
-{
-	converter->stop();
-	resetState();
-	changeState(converter, READY_State::instance());
-}
-
-
-///
-///
-///
-void CHARGING_START_State::emergencyShutdown(Converter* converter)
+bool Fsm::_hasErrors()
 {
-	shutdown(converter);
+	return s_env->hasErrors();
 }
 
 
-/* ################################################################################################################## */
-/* ############################# */
-/* ##### INOPERATION state ##### */
-/* ############################# */
 ///
 ///
 ///
-void CHARGING_State::startup(Converter* converter)
+bool Fsm::_isConnectionOk()
 {
-	/* DO NOTHING */
+	return s_env->fuelcellsConnected();
 }
 
 
 ///
 ///
 ///
-void CHARGING_State::shutdown(Converter* converter)
+bool Fsm::_canStartFuelcells()
 {
-	converter->stop();
-	Controller::stop();
-	changeStateAfterWait(converter, SHUTDOWN_State::instance(), DELAY_BEFORE_SHUTDOWN);
+	return !s_env->batteryCharged() && !s_env->hasErrors();
 }
 
 
 ///
 ///
 ///
-void CHARGING_State::startCharging(Converter* converter)
+bool Fsm::_canRelaunch()
 {
-	/* DO NOTHING */
+	return !s_env->batteryCharged() && s_env->hasErrors() && (s_failureCount < MAX_FAILURE_COUNT);
 }
 
 
 ///
 ///
 ///
-void CHARGING_State::run(Converter* converter)
+bool Fsm::_fuelcellsStarted()
 {
-	if (Syslog::errors() != 0)
-	{
-		shutdown(converter);
-	}
+	return s_fuelcellsStarted;
 }
 
 
 ///
 ///
 ///
-void CHARGING_State::stopCharging(Converter* converter)
+bool Fsm::_canStartCharging()
 {
-	converter->stop();
-	changeState(converter, READY_State::instance());
+	return !s_env->hasErrors() && !s_env->batteryCharged();
 }
 
 
 ///
 ///
 ///
-void CHARGING_State::emergencyShutdown(Converter* converter)
+bool Fsm::_currentRampCompleted()
 {
-	shutdown(converter);
+	return s_currentInRef >= s_env->currentInMax();
 }
 
 
 /* ################################################################################################################## */
-/* ############################## */
-/* ##### STOPCHARGING state ##### */
-/* ############################## */
+/* ################### */
+/* ##### ACTIONS ##### */
+/* ################### */
 ///
 ///
 ///
-void CHARGING_STOP_State::startup(Converter* converter)
+void Fsm::_resetConnectionError()
 {
-	// TODO /* DO NOTHING */
+	s_env->resetConnectionError();
 }
 
 
 ///
 ///
 ///
-void CHARGING_STOP_State::shutdown(Converter* converter)
+void Fsm::_startFuelcells()
 {
-	// TODO /* DO NOTHING */
+	uint64_t timeNow = s_env->now();
+	s_timers.schedule(FSM_EVENT_ERROR_ENABLING_TIMEOUT, timeNow + ERROR_ENABLING_DELAY);
+	s_timers.schedule(FSM_EVENT_STARTUP_TIMEOUT, timeNow + FUELCELL_STARTUP_MAX_DURATION);
+	s_env->startFuelcells();
 }
 
 
 ///
 ///
 ///
-void CHARGING_STOP_State::startCharging(Converter* converter)
+void Fsm::_enableFuelcellErrors()
 {
-	// TODO /* DO NOTHING */
+	s_env->enableFuelcellErrors();
 }
 
 
 ///
 ///
 ///
-void CHARGING_STOP_State::run(Converter* converter)
+void Fsm::_failStartup()
 {
-	// TODO /* DO NOTHING */
+	s_env->setStartupFailedError();
+	s_env->stopFuelcells();
 }
 
 
 ///
 ///
 ///
-void CHARGING_STOP_State::stopCharging(Converter* converter)
+void Fsm::_relaunch()
 {
-	// TODO /* DO NOTHING */
+	s_env->resetErrorsWarnings();
 }
 
 
 ///
 ///
 ///
-void CHARGING_STOP_State::emergencyShutdown(Converter* converter)
+void Fsm::_monitorStartup()
 {
-	// TODO /* DO NOTHING */
-}
+	float voltageIn = s_env->voltageIn();
+	float voltDiff = fabsf(voltageIn - s_voltageInPrev);
+	s_voltageInPrev = voltageIn;
 
+	// TODO Controller::start(); // may be needed here to reset errors at fuel cells (multiple start signal sending)
 
-/* ################################################################################################################## */
-/* ########################### */
-/* ##### SHUTDOWN state ##### */
-/* ########################### */
-///
-///
-///
-void SHUTDOWN_State::startup(Converter* converter)
-{
-	// TODO /* DO NOTHING */
+	// voltage is sampled once per supervisor period, step limit is scaled from PWM period
+	float voltDiffMax = STARTUP_VOLTAGE_STEP_MAX * s_env->pwmFreq() * SUPERVISOR_PERIOD / 1000;
+	s_fuelcellsStarted = s_env->fuelcellsRunning() && (voltDiff < voltDiffMax);
 }
 
 
 ///
 ///
 ///
-void SHUTDOWN_State::shutdown(Converter* converter)
+void Fsm::_completeStartup()
 {
-	// TODO /* DO NOTHING */
+	_cancelStartupTimers();
+	s_failureCount = 0;
+	s_env->enableFuelcellErrors();
+	s_env->turnRelayOn();
 }
 
 
 ///
 ///
 ///
-void SHUTDOWN_State::startCharging(Converter* converter)
+void Fsm::_stopFuelcells()
 {
-	// TODO /* DO NOTHING */
+	_cancelStartupTimers();
+	s_env->stopFuelcells();
 }
 
 
 ///
 ///
 ///
-void SHUTDOWN_State::run(Converter* converter)
+void Fsm::_cancelStartupTimers()
 {
-	converter->turnRelayOff();
-	if (Syslog::errors() != 0)
-	{
-		++failureCount;
-	}
-	changeStateAfterWait(converter, STANDBY_State::instance(), DELAY_AFTER_SHUTDOWN);
+	s_timers.cancel(FSM_EVENT_ERROR_ENABLING_TIMEOUT);
+	s_timers.cancel(FSM_EVENT_STARTUP_TIMEOUT);
 }
 
 
 ///
 ///
 ///
-void SHUTDOWN_State::stopCharging(Converter* converter)
+void Fsm::_startConverter()
 {
-	/* DO NOTHING */
+	s_currentInRefStep = (s_env->currentInMax() - s_env->currentInMin()) /
+			(CURRENT_RAMP_DURATION * s_env->pwmFreq());
+	s_env->startConverter();
 }
 
 
 ///
 ///
 ///
-void SHUTDOWN_State::emergencyShutdown(Converter* converter)
+void Fsm::_rampCurrent()
 {
-	/* DO NOTHING */
+	s_currentInRef = emb::clamp(s_currentInRef + s_currentInRefStep,
+			s_env->currentInMin(), s_env->currentInMax());
+
+	s_env->setCurrentIn(s_currentInRef);
 }
 
 
-/* ################################################################################################################## */
-/* ###################### */
-/* ##### IDLE state ##### */
-/* ###################### */
 ///
 ///
 ///
-void WAIT_State::startup(Converter* converter)
+void Fsm::_resetCurrentRamp()
 {
-	/* DO NOTHING */
+	s_currentInRef = 0;
 }
 
 
 ///
 ///
 ///
-void WAIT_State::shutdown(Converter* converter)
+void Fsm::_stopConverter()
 {
-	converter->stop();
+	s_env->stopConverter();
+	s_currentInRef = 0;
 }
 
 
 ///
 ///
 ///
-void WAIT_State::startCharging(Converter* converter)
+void Fsm::_stopAll()
 {
-	/* DO NOTHING */
+	_stopConverter();
+	s_env->stopFuelcells();
 }
 
 
 ///
 ///
 ///
-void WAIT_State::run(Converter* converter)
+void Fsm::_completeShutdown()
 {
-	if (mcu::SystemClock::now() - m_waitStart > m_waitTime)
-	{
-		if (m_nextState != static_cast<IState*>(NULL))
-		{
-			changeState(converter, m_nextState);
-		}
-		else
-		{
-			converter->stop();
-			Controller::stop();
-			changeState(converter, SHUTDOWN_State::instance());
-		}
-	}
-
-	if (Syslog::errors() != 0)
+	s_env->turnRelayOff();
+	if (s_env->hasErrors())
 	{
-		converter->stop();
+		++s_failureCount;
 	}
 }
 
 
-///
-///
-///
-void WAIT_State::stopCharging(Converter* converter)
-{
-	/* DO NOTHING */
-}
-
-
-///
-///
-///
-void WAIT_State::emergencyShutdown(Converter* converter)
-{
-	shutdown(converter);
-}
-
-
 } // namespace fuelcell
 
 
@@ -11,7 +11,10 @@
 
 #include "stdint.h"
 #include "../fuelcell_def.h"
+#include "emb/emb_common.h"
 #include "emb/emb_algorithm.h"
+#include "fsm_timerqueue.h"
+#include "fsm_eventqueue.h"
 
 
 namespace fuelcell {
@@ -19,219 +22,208 @@ namespace fuelcell {
 /// @{
 
 
-extern unsigned int failureCount;
-
-
-/// Forward declaration.
-class Converter;
+/// Number of converter states
+const size_t CONVERTER_STATE_COUNT = CONVERTER_WAIT + 1;
 
 
 /**
- * @brief
+ * @brief Converter FSM events.
  */
-class IState
+enum FsmEvent
 {
-private:
-	const ConverterState STATE_ID;
-	static uint64_t s_timestamp;
-protected:
-	IState(ConverterState stateId) : STATE_ID(stateId) {}
-	static void changeState(Converter* converter, IState* state);
-public:
-	virtual ~IState() {}
-	ConverterState id() const { return STATE_ID; }
-	uint64_t timestamp() const { return s_timestamp; }
-	virtual void startup(Converter* converter) = 0;
-	virtual void shutdown(Converter* converter) = 0;
-	virtual void startCharging(Converter* converter) = 0;
-	virtual void run(Converter* converter) = 0;
-	virtual void stopCharging(Converter* converter) = 0;
-	virtual void emergencyShutdown(Converter* converter) = 0;
+	FSM_EVENT_STARTUP,
+	FSM_EVENT_SHUTDOWN,
+	FSM_EVENT_START_CHARGING,
+	FSM_EVENT_RUN,			// fast path: every PWM period, handled only in charging states
+	FSM_EVENT_SUPERVISE,		// slow path: every SUPERVISOR_PERIOD from clock task
+	FSM_EVENT_STOP_CHARGING,
+	FSM_EVENT_EMERGENCY_SHUTDOWN,
+	FSM_EVENT_WAIT_TIMEOUT,		// timer events, dispatched by supervisor when expired
+	FSM_EVENT_ERROR_ENABLING_TIMEOUT,
+	FSM_EVENT_STARTUP_TIMEOUT,
+	FSM_EVENT_COUNT
 };
 
 
-/**
- * @brief
- */
-class POWERUP_State : public IState
-{
-private:
-	static POWERUP_State s_instance;
-	POWERUP_State() : IState(CONVERTER_POWERUP) {}
-public:
-	static POWERUP_State* instance() { return &s_instance; }
-	virtual void startup(Converter* converter);
-	virtual void shutdown(Converter* converter);
-	virtual void startCharging(Converter* converter);
-	virtual void run(Converter* converter);
-	virtual void stopCharging(Converter* converter);
-	virtual void emergencyShutdown(Converter* converter);
-};
+/// Period of FSM_EVENT_SUPERVISE, ms
+const uint64_t SUPERVISOR_PERIOD = 1;
 
 
-/**
- * @brief
- */
-class STANDBY_State : public IState
-{
-private:
-	static STANDBY_State s_instance;
-	STANDBY_State() : IState(CONVERTER_STANDBY) {}
-public:
-	static STANDBY_State* instance() { return &s_instance; }
-	virtual void startup(Converter* converter);
-	virtual void shutdown(Converter* converter);
-	virtual void startCharging(Converter* converter);
-	virtual void run(Converter* converter);
-	virtual void stopCharging(Converter* converter);
-	virtual void emergencyShutdown(Converter* converter);
-};
+/// Transition target: state is not changed, action is executed and following transitions are evaluated
+const ConverterState FSM_INTERNAL = static_cast<ConverterState>(CONVERTER_STATE_COUNT);
+/// Transition target: state that was passed to WAIT state by delayed transition
+const ConverterState FSM_WAIT_TARGET = static_cast<ConverterState>(CONVERTER_STATE_COUNT + 1);
 
 
 /**
- * @brief
+ * @brief Everything FSM guards and actions depend on: time, system status, fuel cells and converter hardware.
+ * Converter provides implementation for target, tests inject simulated one.
  */
-class STARTUP_State : public IState
+class IFsmEnvironment
 {
-private:
-	static STARTUP_State s_instance;
-	STARTUP_State() : IState(CONVERTER_STARTUP) {}
 public:
-	static STARTUP_State* instance() { return &s_instance; }
-	virtual void startup(Converter* converter);
-	virtual void shutdown(Converter* converter);
-	virtual void startCharging(Converter* converter);
-	virtual void run(Converter* converter);
-	virtual void stopCharging(Converter* converter);
-	virtual void emergencyShutdown(Converter* converter);
+	virtual ~IFsmEnvironment() {}
+
+	virtual uint64_t now() = 0;
+
+	virtual bool hasErrors() = 0;
+	virtual bool batteryCharged() = 0;
+	virtual void resetErrorsWarnings() = 0;
+	virtual void resetConnectionError() = 0;
+	virtual void setStartupFailedError() = 0;
+
+	virtual bool fuelcellsConnected() = 0;
+	virtual bool fuelcellsRunning() = 0;
+	virtual void startFuelcells() = 0;
+	virtual void stopFuelcells() = 0;
+	virtual void enableFuelcellErrors() = 0;
+
+	virtual float voltageIn() = 0;
+	virtual float currentInMin() = 0;
+	virtual float currentInMax() = 0;
+	virtual float pwmFreq() = 0;
+	virtual void startConverter() = 0;
+	virtual void stopConverter() = 0;
+	virtual void setCurrentIn(float value) = 0;
+	virtual void turnRelayOn() = 0;
+	virtual void turnRelayOff() = 0;
 };
 
 
 /**
- * @brief
+ * @brief Table-driven converter FSM. Transitions of (state, event) pair are evaluated in table order,
+ * first transition with passed guard is taken: its action is executed and state is changed.
  */
-class READY_State : public IState
+class Fsm
 {
-private:
-	static READY_State s_instance;
-	READY_State() : IState(CONVERTER_READY) {}
 public:
-	static READY_State* instance() { return &s_instance; }
-	virtual void startup(Converter* converter);
-	virtual void shutdown(Converter* converter);
-	virtual void startCharging(Converter* converter);
-	virtual void run(Converter* converter);
-	virtual void stopCharging(Converter* converter);
-	virtual void emergencyShutdown(Converter* converter);
-};
-
-
-/**
- * @brief
- */
-class CHARGING_START_State : public IState
-{
-private:
-	static CHARGING_START_State s_instance;
-	CHARGING_START_State() : IState(CONVERTER_CHARGING_START)
+	/**
+	 * @brief FSM transition.
+	 */
+	struct Transition
 	{
-		resetState();
-	}
-public:
-	static CHARGING_START_State* instance() { return &s_instance; }
-	virtual void startup(Converter* converter);
-	virtual void shutdown(Converter* converter);
-	virtual void startCharging(Converter* converter);
-	virtual void run(Converter* converter);
-	virtual void stopCharging(Converter* converter);
-	virtual void emergencyShutdown(Converter* converter);
+		ConverterState state;
+		FsmEvent event;
+		bool (*guard)();			// NULL - transition is unconditional
+		void (*action)();			// NULL - no action
+		ConverterState next;			// real state, FSM_INTERNAL or FSM_WAIT_TARGET
+		uint32_t waitDelay;			// non-zero - next state is entered via WAIT state after delay, ms
+	};
+
 private:
-	void resetState()
-	{
-		m_currentInRef = 0;
-	}
-	float m_currentInRef;
-};
+	static const Transition TRANSITIONS[];
+	static const size_t TRANSITION_COUNT;
 
+	// transitions of (state, event) pair are TRANSITIONS[begin...end), index is built by init()
+	static uint16_t s_transitionBegin[CONVERTER_STATE_COUNT][FSM_EVENT_COUNT];
+	static uint16_t s_transitionEnd[CONVERTER_STATE_COUNT][FSM_EVENT_COUNT];
 
-/**
- * @brief
- */
-class CHARGING_State : public IState
-{
-private:
-	static CHARGING_State s_instance;
-	CHARGING_State() : IState(CONVERTER_CHARGING) {}
-public:
-	static CHARGING_State* instance() { return &s_instance; }
-	virtual void startup(Converter* converter);
-	virtual void shutdown(Converter* converter);
-	virtual void startCharging(Converter* converter);
-	virtual void run(Converter* converter);
-	virtual void stopCharging(Converter* converter);
-	virtual void emergencyShutdown(Converter* converter);
-};
+	static IFsmEnvironment* s_env;
 
+	static uint64_t s_timestamp;
+	static ConverterState s_waitTarget;
 
-/**
- * @brief
- */
-class CHARGING_STOP_State : public IState
-{
-private:
-	static CHARGING_STOP_State s_instance;
-	CHARGING_STOP_State() : IState(CONVERTER_CHARGING_STOP) {}
-public:
-	static CHARGING_STOP_State* instance() { return &s_instance; }
-	virtual void startup(Converter* converter);
-	virtual void shutdown(Converter* converter);
-	virtual void startCharging(Converter* converter);
-	virtual void run(Converter* converter);
-	virtual void stopCharging(Converter* converter);
-	virtual void emergencyShutdown(Converter* converter);
-};
+	static const size_t TIMER_COUNT = 4;
+	static FsmTimerQueue<FsmEvent, TIMER_COUNT> s_timers;
 
+	static float s_currentInRef;
+	static float s_currentInRefStep;	// ramp increment per PWM period, computed at charging start
+	static float s_voltageInPrev;
+	static bool s_fuelcellsStarted;
+	static unsigned int s_failureCount;
 
-/**
- * @brief
- */
-class SHUTDOWN_State : public IState
-{
-private:
-	static SHUTDOWN_State s_instance;
-	SHUTDOWN_State() : IState(CONVERTER_SHUTDOWN) {}
 public:
-	static SHUTDOWN_State* instance() { return &s_instance; }
-	virtual void startup(Converter* converter);
-	virtual void shutdown(Converter* converter);
-	virtual void startCharging(Converter* converter);
-	virtual void run(Converter* converter);
-	virtual void stopCharging(Converter* converter);
-	virtual void emergencyShutdown(Converter* converter);
-};
+	/**
+	 * @brief Checks transition table, builds (state, event) index and resets FSM data. Must be called before dispatch().
+	 * @param env - FSM environment
+	 * @return (none)
+	 */
+	static void init(IFsmEnvironment* env);
+
+	/**
+	 * @brief Checks transition table: targets are valid, WAIT state is entered only by delayed transitions,
+	 * transitions of each (state, event) pair are adjacent and none of them is shadowed by unconditional one.
+	 * @param (none)
+	 * @return \c true if table is valid, \c false otherwise.
+	 */
+	static bool checkTable();
+
+	/**
+	 * @brief Processes event in current converter state.
+	 * @param state - converter state, is changed by taken transition
+	 * @param event - FSM event
+	 * @return (none)
+	 */
+	static void dispatch(ConverterState& state, FsmEvent event);
+
+	/**
+	 * @brief Removes earliest pending timer if it has expired. Must be called by supervisor until it returns \c false,
+	 * returned events must be dispatched.
+	 * @param event - event of expired timer
+	 * @return \c true if timer has expired, \c false otherwise.
+	 */
+	static bool popExpiredTimer(FsmEvent& event) { return s_timers.pop(s_env->now(), event); }
+
+	/**
+	 * @brief Returns number of transitions of (state, event) pair.
+	 * @param state - converter state
+	 * @param event - FSM event
+	 * @return Number of transitions.
+	 */
+	static size_t transitionCount(ConverterState state, FsmEvent event)
+	{
+		return s_transitionEnd[state][event] - s_transitionBegin[state][event];
+	}
 
+	/**
+	 * @brief Returns time of last state change.
+	 * @param (none)
+	 * @return Time of last state change, ms.
+	 */
+	static uint64_t timestamp() { return s_timestamp; }
+
+	/**
+	 * @brief Returns number of consecutive failed fuel cell launches.
+	 * @param (none)
+	 * @return Number of failed launches.
+	 */
+	static unsigned int failureCount() { return s_failureCount; }
+
+	/**
+	 * @brief Resets number of failed fuel cell launches, so that FSM may relaunch fuel cells again.
+	 * @param (none)
+	 * @return (none)
+	 */
+	static void resetFailureCount() { s_failureCount = 0; }
 
-/**
- * @brief
- */
-class WAIT_State : public IState
-{
-	friend void changeStateAfterWait(Converter* converter, IState* nextState, uint64_t delay);
-private:
-	static WAIT_State s_instance;
-	WAIT_State() : IState(CONVERTER_WAIT) {}
-	static WAIT_State* instance() { return &s_instance; }	// waitNgoToState() must be used for going to this state
-public:
-	virtual void startup(Converter* converter);
-	virtual void shutdown(Converter* converter);
-	virtual void startCharging(Converter* converter);
-	virtual void run(Converter* converter);
-	virtual void stopCharging(Converter* converter);
-	virtual void emergencyShutdown(Converter* converter);
 private:
-	uint64_t m_waitStart;
-	uint64_t m_waitTime;
-	IState* m_nextState;
+	static void _changeState(ConverterState& state, const Transition& transition);
+
+	// guards
+	static bool _hasErrors();
+	static bool _isConnectionOk();
+	static bool _canStartFuelcells();
+	static bool _canRelaunch();
+	static bool _fuelcellsStarted();
+	static bool _canStartCharging();
+	static bool _currentRampCompleted();
+
+	// actions
+	static void _resetConnectionError();
+	static void _startFuelcells();
+	static void _enableFuelcellErrors();
+	static void _failStartup();
+	static void _relaunch();
+	static void _monitorStartup();
+	static void _completeStartup();
+	static void _stopFuelcells();
+	static void _cancelStartupTimers();
+	static void _startConverter();
+	static void _rampCurrent();
+	static void _resetCurrentRamp();
+	static void _stopConverter();
+	static void _stopAll();
+	static void _completeShutdown();
 };
 
 
@@ -0,0 +1,136 @@
+/**
+ * @file
+ * @ingroup fuel_cell_fsm
+ */
+
+
+#pragma once
+
+
+#include "stdint.h"
+#include "emb/emb_common.h"
+
+
+namespace fuelcell {
+/// @addtogroup fuel_cell_fsm
+/// @{
+
+
+/**
+ * @brief FIFO of posted events, events are dispatched in order of arrival. Urgent event is inserted
+ * before all queued events. Queue is not synchronized: caller serializes producers and consumer.
+ */
+template <typename Event, size_t Capacity>
+class FsmEventQueue
+{
+	EMB_STATIC_ASSERT(Capacity > 0);
+private:
+	Event m_events[Capacity];
+	size_t m_front;
+	size_t m_size;
+	uint32_t m_lostCount;		// events lost because queue was full
+
+	size_t _index(size_t pos) const { return (m_front + pos) % Capacity; }
+
+public:
+	FsmEventQueue() : m_front(0), m_size(0), m_lostCount(0) {}
+
+	/**
+	 * @brief Removes all events.
+	 * @param (none)
+	 * @return (none)
+	 */
+	void clear()
+	{
+		m_front = 0;
+		m_size = 0;
+	}
+
+	/**
+	 * @brief Returns number of queued events.
+	 * @param (none)
+	 * @return Number of queued events.
+	 */
+	size_t size() const { return m_size; }
+
+	/**
+	 * @brief Checks if there are no queued events.
+	 * @param (none)
+	 * @return \c true if there are no queued events, \c false otherwise.
+	 */
+	bool empty() const { return m_size == 0; }
+
+	/**
+	 * @brief Returns number of events lost because queue was full.
+	 * @param (none)
+	 * @return Number of lost events.
+	 */
+	uint32_t lostCount() const { return m_lostCount; }
+
+	/**
+	 * @brief Appends event. Event equal to last queued event is coalesced with it,
+	 * so that command repeated by level-triggered source does not fill queue.
+	 * @param event - event
+	 * @return \c true if event is queued, \c false if queue is full and event is lost.
+	 */
+	bool push(Event event)
+	{
+		if ((m_size != 0) && (m_events[_index(m_size-1)] == event))
+		{
+			return true;
+		}
+		if (m_size == Capacity)
+		{
+			++m_lostCount;
+			return false;
+		}
+		m_events[_index(m_size)] = event;
+		++m_size;
+		return true;
+	}
+
+	/**
+	 * @brief Inserts urgent event before all queued events. Urgent event is never lost:
+	 * if queue is full, last queued event is dropped.
+	 * @param event - urgent event
+	 * @return (none)
+	 */
+	void pushFront(Event event)
+	{
+		if ((m_size != 0) && (m_events[m_front] == event))
+		{
+			return;
+		}
+		if (m_size == Capacity)
+		{
+			--m_size;
+			++m_lostCount;
+		}
+		m_front = (m_front + Capacity - 1) % Capacity;
+		m_events[m_front] = event;
+		++m_size;
+	}
+
+	/**
+	 * @brief Removes first event.
+	 * @param event - first event
+	 * @return \c true if event is removed, \c false if queue is empty.
+	 */
+	bool pop(Event& event)
+	{
+		if (m_size == 0)
+		{
+			return false;
+		}
+		event = m_events[m_front];
+		m_front = (m_front + 1) % Capacity;
+		--m_size;
+		return true;
+	}
+};
+
+
+/// @}
+} // namespace fuelcell
+
+
@@ -0,0 +1,120 @@
+/**
+ * @file
+ * @ingroup fuel_cell_fsm
+ */
+
+
+#pragma once
+
+
+#include "stdint.h"
+#include "emb/emb_common.h"
+
+
+namespace fuelcell {
+/// @addtogroup fuel_cell_fsm
+/// @{
+
+
+/**
+ * @brief Deadline-ordered queue of pending timed events. Timers are kept sorted by deadline
+ * from latest to earliest, so that expiry check and pop of earliest timer are O(1).
+ * Timers with equal deadlines expire in scheduling order.
+ */
+template <typename Event, size_t Capacity>
+class FsmTimerQueue
+{
+private:
+	struct Timer
+	{
+		uint64_t deadline;
+		Event event;
+	};
+	Timer m_timers[Capacity];	// m_timers[m_size-1] expires first
+	size_t m_size;
+
+public:
+	FsmTimerQueue() : m_size(0) {}
+
+	/**
+	 * @brief Removes all timers.
+	 * @param (none)
+	 * @return (none)
+	 */
+	void clear() { m_size = 0; }
+
+	/**
+	 * @brief Returns number of pending timers.
+	 * @param (none)
+	 * @return Number of pending timers.
+	 */
+	size_t size() const { return m_size; }
+
+	/**
+	 * @brief Checks if there are no pending timers.
+	 * @param (none)
+	 * @return \c true if there are no pending timers, \c false otherwise.
+	 */
+	bool empty() const { return m_size == 0; }
+
+	/**
+	 * @brief Schedules event. Pending timer of same event is restarted with new deadline.
+	 * @param event - event
+	 * @param deadline - time of event
+	 * @return (none)
+	 */
+	void schedule(Event event, uint64_t deadline)
+	{
+		cancel(event);
+		assert(m_size < Capacity);
+
+		size_t pos = m_size;
+		for (; (pos > 0) && (m_timers[pos-1].deadline <= deadline); --pos)
+		{
+			m_timers[pos] = m_timers[pos-1];
+		}
+		m_timers[pos].deadline = deadline;
+		m_timers[pos].event = event;
+		++m_size;
+	}
+
+	/**
+	 * @brief Cancels pending timer of event.
+	 * @param event - event
+	 * @return (none)
+	 */
+	void cancel(Event event)
+	{
+		size_t dst = 0;
+		for (size_t src = 0; src < m_size; ++src)
+		{
+			if (m_timers[src].event != event)
+			{
+				m_timers[dst++] = m_timers[src];
+			}
+		}
+		m_size = dst;
+	}
+
+	/**
+	 * @brief Removes earliest timer if it has expired.
+	 * @param timeNow - current time
+	 * @param event - event of expired timer
+	 * @return \c true if timer has expired, \c false otherwise.
+	 */
+	bool pop(uint64_t timeNow, Event& event)
+	{
+		if ((m_size == 0) || (m_timers[m_size-1].deadline > timeNow))
+		{
+			return false;
+		}
+		event = m_timers[--m_size].event;
+		return true;
+	}
+};
+
+
+/// @}
+} // namespace fuelcell
+
+
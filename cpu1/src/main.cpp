@@ -44,6 +44,7 @@
 #include "fuelcell/converter/fuelcell_converter.h"
 #include "settings/settings.h"
 #include "canbygpio/canbygpio.h"
+#include "canbygpio/canbygpio_hwtimed.h"
 #include "fuelcell/controller/fuelcell_controller.h"
 
 #ifdef CRD300
@@ -119,6 +120,8 @@ void main()
 	MemCfg_setGSRAMMasterSel(MEMCFG_SECT_GS8, MEMCFG_GSRAMMASTER_CPU2);	// CPU2 .bss is placed here
 	MemCfg_setGSRAMMasterSel(MEMCFG_SECT_GS9, MEMCFG_GSRAMMASTER_CPU1);	// CPU1 to CPU2 data is placed here
 	MemCfg_setGSRAMMasterSel(MEMCFG_SECT_GS10, MEMCFG_GSRAMMASTER_CPU2);	// CPU2 to CPU1 data is placed here
+	MemCfg_setGSRAMMasterSel(MEMCFG_SECT_GS11, MEMCFG_GSRAMMASTER_CPU2);	// fuel cell data is placed here
+	MemCfg_setGSRAMMasterSel(MEMCFG_SECT_GS12, MEMCFG_GSRAMMASTER_CPU2);	// fuel cell link statistics are placed here
 
 #ifdef _LAUNCHXL_F28379D
 	mcu::configureLaunchPadLeds(GPIO_CORE_CPU1, GPIO_CORE_CPU1);
@@ -174,12 +177,10 @@ void main()
 	Syslog::IpcFlags syslogIpcFlags =
 	{
 		.RESET_ERRORS_WARNINGS = mcu::IpcFlag(10),
-		.ADD_MESSAGE = mcu::IpcFlag(11),
 		.POP_MESSAGE = mcu::IpcFlag(12)
 	};
 	Syslog::init(syslogIpcFlags);
 	Syslog::addMessage(sys::Message::DEVICE_CPU1_BOOT_SUCCESS);
-	fuelcell::Controller::disableErrors();			// no fuel cell errors registering at startup
 	Syslog::setError(sys::Error::RS_CONNECTION_LOST);	// at powerup - wait for fuel cells ready
 
 // BEGIN of CPU1 PERIPHERY CONFIGURATION and OBJECTS CREATION
@@ -210,12 +211,22 @@ void main()
 	/*# CAN BY GPIO #*/
 	/*###############*/
 	mcu::GpioConfig canbygpioRxCfg(14, GPIO_14_GPIO14, mcu::PIN_INPUT, emb::ACTIVE_HIGH, mcu::PIN_STD, mcu::PIN_QUAL_6SAMPLE, 64, GPIO_CORE_CPU2);
+#ifdef CANBYGPIO_HW_TIMED
+	mcu::GpioConfig canbygpioTxCfg(11, GPIO_11_EPWM6B, mcu::PIN_OUTPUT, emb::ACTIVE_HIGH, mcu::PIN_STD, mcu::PIN_QUAL_ASYNC, 1, GPIO_CORE_CPU2);
+#else
 	mcu::GpioConfig canbygpioTxCfg(11, GPIO_11_GPIO11, mcu::PIN_OUTPUT, emb::ACTIVE_HIGH, mcu::PIN_STD, mcu::PIN_QUAL_ASYNC, 1, GPIO_CORE_CPU2);
+#endif
 	mcu::GpioConfig canbygpioClkCfg(15, GPIO_15_GPIO15, mcu::PIN_OUTPUT, emb::ACTIVE_HIGH, mcu::PIN_STD, mcu::PIN_QUAL_ASYNC, 1, GPIO_CORE_CPU2);
 	mcu::GpioInput canbygpioRx(canbygpioRxCfg);
 	mcu::GpioOutput canbygpioTx(canbygpioTxCfg);
 	mcu::GpioOutput canbygpioClk(canbygpioClkCfg);
+#ifdef CANBYGPIO_HW_TIMED
+	XBAR_setInputPin(XBAR_INPUT7, canbygpioRxCfg.no);	// eCAP1 input
+	SysCtl_selectCPUForPeripheral(SYSCTL_CPUSEL1_ECAP, 1, SYSCTL_CPUSEL_CPU2);
+	SysCtl_selectCPUForPeripheral(SYSCTL_CPUSEL0_EPWM, 6, SYSCTL_CPUSEL_CPU2);
+#else
 	canbygpioRx.setInterrupt(GPIO_INT_XINT5);
+#endif
 
 /*####################################################################################################################*/
 #ifdef CRD300
@@ -306,9 +317,13 @@ void main()
 	mcu::SystemClock::setTaskPeriod(1, 50);
 	mcu::SystemClock::registerTask(1, taskStartTempSensors);
 
+	fuelcell::Controller::initErrorLatches();	// errors are checked on this CPU
 	mcu::SystemClock::setTaskPeriod(2, 200);
 	mcu::SystemClock::registerTask(2, taskCheckFuelcellErrors);
 
+	mcu::SystemClock::setTaskPeriod(3, fuelcell::SUPERVISOR_PERIOD);
+	mcu::SystemClock::registerTask(3, taskSuperviseConverter);
+
 	mcu::SystemClock::setWatchdogPeriod(4000);
 	mcu::SystemClock::registerWatchdogTask(taskWatchdogTimeout);
 
@@ -7,6 +7,47 @@
 #include "syslog.h"
 
 
+namespace sys {
+
+namespace Error {
+
+#define SYS_ERROR_NAME(name, severity, fatal, autoReset, enabled) #name,
+extern const char* const NAMES[ERROR_COUNT] = {SYS_ERROR_TABLE(SYS_ERROR_NAME)};
+#undef SYS_ERROR_NAME
+
+#define SYS_ERROR_SEVERITY(name, severity, fatal, autoReset, enabled) severity,
+extern const Severity SEVERITIES[ERROR_COUNT] = {SYS_ERROR_TABLE(SYS_ERROR_SEVERITY)};
+#undef SYS_ERROR_SEVERITY
+
+#define SYS_ERROR_FATAL(name, severity, fatal, autoReset, enabled) fatal,
+extern const bool FATAL[ERROR_COUNT] = {SYS_ERROR_TABLE(SYS_ERROR_FATAL)};
+#undef SYS_ERROR_FATAL
+
+#define SYS_ERROR_AUTORESET(name, severity, fatal, autoReset, enabled) autoReset,
+extern const bool AUTO_RESET[ERROR_COUNT] = {SYS_ERROR_TABLE(SYS_ERROR_AUTORESET)};
+#undef SYS_ERROR_AUTORESET
+
+#define SYS_ERROR_ENABLED(name, severity, fatal, autoReset, enabled) enabled,
+extern const bool ENABLED_BY_DEFAULT[ERROR_COUNT] = {SYS_ERROR_TABLE(SYS_ERROR_ENABLED)};
+#undef SYS_ERROR_ENABLED
+
+} // namespace Error
+
+namespace Warning {
+
+#define SYS_WARNING_NAME(name, fatal) #name,
+extern const char* const NAMES[WARNING_COUNT] = {SYS_WARNING_TABLE(SYS_WARNING_NAME)};
+#undef SYS_WARNING_NAME
+
+#define SYS_WARNING_FATAL(name, fatal) fatal,
+extern const bool FATAL[WARNING_COUNT] = {SYS_WARNING_TABLE(SYS_WARNING_FATAL)};
+#undef SYS_WARNING_FATAL
+
+} // namespace Warning
+
+} // namespace sys
+
+
 #ifdef DUALCORE
 emb::Queue<sys::Message::Message, 32> Syslog::m_messages __attribute__((section("SHARED_SYSLOG_MESSAGES"), retain));
 #else
@@ -15,7 +56,9 @@ emb::Queue<sys::Message::Message, 32> Syslog::m_messages;
 
 
 #ifdef DUALCORE
-sys::Message::Message Syslog::m_cpu2Message __attribute__((section("SHARED_SYSLOG_MESSAGE_CPU2"), retain)) = sys::Message::NO_MESSAGE;
+Syslog::Cpu2MessageQueue::ProducerData Syslog::m_cpu2MessagesProducer __attribute__((section("SHARED_SYSLOG_MESSAGES_CPU2"), retain));
+Syslog::Cpu2MessageQueue::ConsumerData Syslog::m_cpu2MessagesConsumer __attribute__((section("SHARED_SYSLOG_MESSAGES_CPU2_TAIL"), retain));
+Syslog::Cpu2MessageQueue Syslog::m_cpu2Messages(&Syslog::m_cpu2MessagesProducer, &Syslog::m_cpu2MessagesConsumer);
 #endif
 
 
@@ -30,9 +73,78 @@ Syslog::Data Syslog::m_cpu1Data;
 Syslog::Data* Syslog::m_thisCpuData;
 
 
+sys::EventLog<64> Syslog::m_events;
+sys::EventRecord Syslog::m_firstError;
+volatile uint32_t Syslog::m_firstErrorState = 0;
+sys::ErrorStatistics Syslog::m_errorStats[sys::Error::ERROR_COUNT];
+sys::ErrorLatch Syslog::m_errorLatches[sys::Error::ERROR_COUNT];
+
+
 // IPC flags
 mcu::IpcFlag Syslog::RESET_ERRORS_WARNINGS;
-mcu::IpcFlag Syslog::ADD_MESSAGE;
 mcu::IpcFlag Syslog::POP_MESSAGE;
 
 
+///
+///
+///
+bool Syslog::takeSnapshot(sys::SyslogSnapshot& snapshot)
+{
+	const int MAX_ATTEMPTS = 3;
+	bool consistent = false;
+
+	for (int attempt = 0; (attempt < MAX_ATTEMPTS) && !consistent; ++attempt)
+	{
+		memset(&snapshot, 0, sizeof(snapshot));
+		uint32_t eventCount = m_events.totalCount();
+
+		snapshot.header = (static_cast<uint32_t>(sys::SyslogSnapshot::VERSION) << 16)
+				| sys::SyslogSnapshot::wordCount();
+		snapshot.timestamp = static_cast<uint32_t>(mcu::SystemClock::now());
+		for (size_t i = 0; i < sys::Error::ERROR_WORD_COUNT; ++i)
+		{
+			snapshot.errors[i] = errors(i);
+			snapshot.enabledErrorMask[i] = m_thisCpuData->enabledErrorMask[i];
+			snapshot.fatalErrorMask[i] = m_thisCpuData->fatalErrorMask[i];
+		}
+		for (size_t i = 0; i < sys::Warning::WARNING_WORD_COUNT; ++i)
+		{
+			snapshot.warnings[i] = warnings(i);
+			snapshot.fatalWarningMask[i] = m_thisCpuData->fatalWarningMask[i];
+		}
+#if (defined(CPU1) && defined(DUALCORE))
+		snapshot.cpu2MessagesLost = cpu2MessagesLost();
+#endif
+		snapshot.eventTotalCount = eventCount;
+
+		for (size_t i = 0; i < sys::Error::ERROR_COUNT; ++i)
+		{
+			uint32_t count = errorStatistics(static_cast<sys::Error::Error>(i)).count();
+			snapshot.errorCounts[i / 2] |= count << (16 * (i % 2));
+		}
+
+		if (hasFirstError())
+		{
+			snapshot.flags |= sys::SyslogSnapshot::FLAG_FIRST_ERROR;
+			snapshot.firstError.pack(m_firstError);
+		}
+
+		size_t recordCount = (m_events.size() < sys::SyslogSnapshot::EVENT_COUNT)
+				? m_events.size() : sys::SyslogSnapshot::EVENT_COUNT;
+		size_t first = m_events.size() - recordCount;
+		for (size_t i = 0; i < recordCount; ++i)
+		{
+			snapshot.events[i].pack(m_events.at(first + i));
+		}
+
+		consistent = (m_events.totalCount() == eventCount);
+	}
+
+	if (consistent)
+	{
+		snapshot.flags |= sys::SyslogSnapshot::FLAG_CONSISTENT;
+	}
+	return consistent;
+}
+
+
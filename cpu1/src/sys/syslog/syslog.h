@@ -13,10 +13,17 @@
 #include <stddef.h>
 #include "emb/emb_common.h"
 #include "emb/emb_queue.h"
+#include "emb/emb_atomic.h"
+#include "emb/emb_spscqueue.h"
 #include "mcu/system/mcu_system.h"
 #include "mcu/ipc/mcu_ipc.h"
+#include "mcu/cputimers/mcu_cputimers.h"
 
 #include "syslogdef.h"
+#include "syslogevents.h"
+#include "syslogstats.h"
+#include "syslogsnapshot.h"
+#include "sysloglatch.h"
 
 
 /// @addtogroup syslog
@@ -32,17 +39,18 @@ public:
 	struct IpcFlags
 	{
 		mcu::IpcFlag RESET_ERRORS_WARNINGS;
-		mcu::IpcFlag ADD_MESSAGE;
 		mcu::IpcFlag POP_MESSAGE;
 	};
 
+	// errors and warnings are set from ISRs: masks are modified only with emb atomic operations, single stores
+	// or inside critical section, each mask word is updated independently
 	struct Data
 	{
-		uint32_t errors;
-		uint32_t warnings;
-		uint32_t enabledErrorMask;	// enabled errors
-		uint32_t fatalErrorMask;	// errors that cannot be reseted by reset()
-		uint32_t fatalWarningMask;	// warnings that cannot be reseted by reset()
+		volatile uint32_t errors[sys::Error::ERROR_WORD_COUNT];
+		volatile uint32_t warnings[sys::Warning::WARNING_WORD_COUNT];
+		volatile uint32_t enabledErrorMask[sys::Error::ERROR_WORD_COUNT];	// enabled errors
+		volatile uint32_t fatalErrorMask[sys::Error::ERROR_WORD_COUNT];		// errors that cannot be reseted by reset()
+		volatile uint32_t fatalWarningMask[sys::Warning::WARNING_WORD_COUNT];	// warnings that cannot be reseted by reset()
 	};
 
 private:
@@ -53,7 +61,11 @@ private:
 private:
 	static emb::Queue<sys::Message::Message, 32> m_messages;
 #ifdef DUALCORE
-	static sys::Message::Message m_cpu2Message;
+	// CPU2 -> CPU1 messages: head and data are in CPU2-owned memory, tail is in CPU1-owned memory
+	typedef emb::SpscQueue<sys::Message::Message, 16> Cpu2MessageQueue;
+	static Cpu2MessageQueue::ProducerData m_cpu2MessagesProducer;
+	static Cpu2MessageQueue::ConsumerData m_cpu2MessagesConsumer;
+	static Cpu2MessageQueue m_cpu2Messages;
 #endif
 
 	static Data m_cpu1Data;
@@ -63,9 +75,21 @@ private:
 
 	static Data* m_thisCpuData;
 
+	// event history of this CPU, first error since last reset is kept even if ring is overwritten
+	static sys::EventLog<64> m_events;
+	static sys::EventRecord m_firstError;
+	static volatile uint32_t m_firstErrorState;	// FIRST_ERROR_CLAIMED, FIRST_ERROR_VALID
+	static const uint32_t FIRST_ERROR_CLAIMED = 1UL << 0;
+	static const uint32_t FIRST_ERROR_VALID = 1UL << 1;
+
+	// occurrence statistics of this CPU errors
+	static sys::ErrorStatistics m_errorStats[sys::Error::ERROR_COUNT];
+
+	// debounce latches of this CPU errors that are evaluated by updateError()
+	static sys::ErrorLatch m_errorLatches[sys::Error::ERROR_COUNT];
+
 	// IPC flags
 	static mcu::IpcFlag RESET_ERRORS_WARNINGS;
-	static mcu::IpcFlag ADD_MESSAGE;
 	static mcu::IpcFlag POP_MESSAGE;
 
 public:
@@ -89,39 +113,47 @@ public:
 		m_thisCpuData = &m_cpu2Data;
 #endif
 
-		m_thisCpuData->errors = 0;
-		m_thisCpuData->warnings = 0;
-		m_thisCpuData->enabledErrorMask = 0xFFFFFFFF;
-		m_thisCpuData->fatalErrorMask = sys::Error::FATAL_ERRORS;
-		m_thisCpuData->fatalWarningMask = sys::Warning::FATAL_WARNINGS;
+		_fillMask(m_thisCpuData->errors, false);
+		_fillMask(m_thisCpuData->warnings, false);
+		_makeMask(m_thisCpuData->enabledErrorMask, sys::Error::ENABLED_BY_DEFAULT);
+		_makeMask(m_thisCpuData->fatalErrorMask, sys::Error::FATAL);
+		_makeMask(m_thisCpuData->fatalWarningMask, sys::Warning::FATAL);
+
+		m_events.clear();
+		m_firstErrorState = 0;
+		for (size_t i = 0; i < sys::Error::ERROR_COUNT; ++i)
+		{
+			m_errorStats[i].reset();
+			m_errorLatches[i].reset();
+		}
+
+#if (defined(CPU1) && defined(DUALCORE))
+		m_cpu2Messages.initConsumer();
+#endif
+#if (defined(CPU2) && defined(DUALCORE))
+		m_cpu2Messages.initProducer();
+#endif
 
 		RESET_ERRORS_WARNINGS = ipcFlags.RESET_ERRORS_WARNINGS;
-		ADD_MESSAGE = ipcFlags.ADD_MESSAGE;
 		POP_MESSAGE = ipcFlags.POP_MESSAGE;
 
 		setInitialized();
 	}
 
 	/**
-	 * @brief Adds message to message queue or generates IPC signal (CPU2).
+	 * @brief Adds message to message queue (CPU1) or to CPU2 -> CPU1 message queue (CPU2).
 	 * @param msg - message to be added
 	 * @return (none)
 	 */
 	static void addMessage(sys::Message::Message msg)
 	{
-		mcu::CRITICAL_SECTION;
 #ifdef CPU1
-		if (!m_messages.full())
-		{
-			m_messages.push(msg);
-		}
+		_pushMessage(msg);
+		_logEvent(sys::Event::MESSAGE, msg, 0);
 #else
-		if (mcu::isLocalIpcFlagSet(ADD_MESSAGE.local))
-		{
-			return;
-		}
-		m_cpu2Message = msg;
-		mcu::setLocalIpcFlag(ADD_MESSAGE.local);
+		// serializes local producers: background loop and ISRs
+		mcu::NESTED_CRITICAL_SECTION;
+		m_cpu2Messages.push(msg);
 #endif
 	}
 
@@ -183,10 +215,11 @@ public:
 			mcu::acknowledgeRemoteIpcFlag(POP_MESSAGE.remote);
 		}
 
-		if (mcu::isRemoteIpcFlagSet(ADD_MESSAGE.remote))
+		sys::Message::Message msg;
+		while (m_cpu2Messages.pop(msg))
 		{
-			addMessage(m_cpu2Message);
-			mcu::acknowledgeRemoteIpcFlag(ADD_MESSAGE.remote);
+			_pushMessage(msg);
+			_logEvent(sys::Event::MESSAGE, msg, 0, 2);
 		}
 #endif
 #ifdef CPU2
@@ -206,8 +239,7 @@ public:
 	 */
 	static void enableError(sys::Error::Error error)
 	{
-		mcu::CRITICAL_SECTION;
-		m_thisCpuData->enabledErrorMask = m_thisCpuData->enabledErrorMask | (1UL << error);
+		emb::atomicOr(m_thisCpuData->enabledErrorMask[sys::maskWord(error)], sys::maskBit(error));
 	}
 
 	/**
@@ -217,8 +249,7 @@ public:
 	 */
 	static void enableAllErrors()
 	{
-		mcu::CRITICAL_SECTION;
-		m_thisCpuData->enabledErrorMask = 0xFFFFFFFF;
+		_fillMask(m_thisCpuData->enabledErrorMask, true);
 	}
 
 	/**
@@ -228,8 +259,7 @@ public:
 	 */
 	static void disableError(sys::Error::Error error)
 	{
-		mcu::CRITICAL_SECTION;
-		m_thisCpuData->enabledErrorMask = m_thisCpuData->enabledErrorMask & ((1UL << error) ^ 0xFFFFFFFF);
+		emb::atomicAnd(m_thisCpuData->enabledErrorMask[sys::maskWord(error)], ~sys::maskBit(error));
 	}
 
 	/**
@@ -239,19 +269,88 @@ public:
 	 */
 	static void disableAllErrors()
 	{
-		mcu::CRITICAL_SECTION;
-		m_thisCpuData->enabledErrorMask = 0;
+		_fillMask(m_thisCpuData->enabledErrorMask, false);
 	}
 
 	/**
-	 * @brief Sets specified error.
+	 * @brief Sets specified error. First occurrence since error reset is recorded to event log and error statistics.
+	 * Error bit is set first by atomic fetch-or: only context that observes 0->1 transition records occurrence,
+	 * and it owns error statistics of this error until error is reset. No critical section is entered, but fetch-or
+	 * and event log slot reservation mask interrupts for one load-modify-store each: C28x has no non-masking
+	 * read-modify-write that returns old value of word.
 	 * @param error  - error to be set
+	 * @param value - snapshot value to be recorded, e.g. measured value that caused error
 	 * @return (none)
 	 */
-	static void setError(sys::Error::Error error)
+	static void setError(sys::Error::Error error, float value = 0)
 	{
-		mcu::CRITICAL_SECTION;
-		m_thisCpuData->errors = m_thisCpuData->errors | ((1UL << error) & m_thisCpuData->enabledErrorMask);
+		size_t word = sys::maskWord(error);
+		uint32_t mask = sys::maskBit(error) & m_thisCpuData->enabledErrorMask[word];
+		if ((mask == 0) || (m_thisCpuData->errors[word] & mask))
+		{
+			return;		// fast path of ISRs that keep setting active error
+		}
+		if (emb::atomicFetchOr(m_thisCpuData->errors[word], mask) & mask)
+		{
+			return;		// transition is claimed by other context
+		}
+
+		sys::EventRecord record = _logEvent(sys::Event::ERROR_SET, error, value);
+		m_errorStats[error].onSet(record.timestamp);
+		if (!(emb::atomicFetchOr(m_firstErrorState, FIRST_ERROR_CLAIMED) & FIRST_ERROR_CLAIMED))
+		{
+			m_firstError = record;
+			emb::atomicOr(m_firstErrorState, FIRST_ERROR_VALID);
+		}
+	}
+
+	/**
+	 * @brief Configures debouncing of error that is evaluated by updateError().
+	 * @param error - error
+	 * @param assertCount - number of consecutive samples with active condition to set error
+	 * @param assertTime - time of active condition to set error, ms
+	 * @param clearCount - number of consecutive samples with inactive condition to clear auto-reset error
+	 * @param clearTime - time of inactive condition to clear auto-reset error, ms
+	 * @return (none)
+	 */
+	static void configureErrorLatch(sys::Error::Error error, uint16_t assertCount, uint32_t assertTime,
+			uint16_t clearCount, uint32_t clearTime)
+	{
+		mcu::NESTED_CRITICAL_SECTION;
+		m_errorLatches[error].configure(assertCount, assertTime, clearCount, clearTime);
+	}
+
+	/**
+	 * @brief Samples error condition through error debounce latch: error is set when latch is asserted,
+	 * auto-reset error is reset when latch is cleared. O(1), may be called from ISRs,
+	 * each error must be updated from one context.
+	 * @param error - error
+	 * @param active - error condition
+	 * @param value - snapshot value to be recorded when error is set
+	 * @return (none)
+	 */
+	static void updateError(sys::Error::Error error, bool active, float value = 0)
+	{
+		if (!(m_thisCpuData->enabledErrorMask[sys::maskWord(error)] & sys::maskBit(error)))
+		{
+			m_errorLatches[error].reset();		// disabled error is latched again after enabling
+			return;
+		}
+
+		switch (m_errorLatches[error].update(active, static_cast<uint32_t>(mcu::SystemClock::now())))
+		{
+		case sys::ErrorLatch::LATCH_ASSERTED:
+			setError(error, value);
+			break;
+		case sys::ErrorLatch::LATCH_CLEARED:
+			if (sys::Error::AUTO_RESET[error])
+			{
+				resetError(error);
+			}
+			break;
+		case sys::ErrorLatch::LATCH_UNCHANGED:
+			break;
+		}
 	}
 
 	/**
@@ -261,11 +360,7 @@ public:
 	 */
 	static bool hasError(sys::Error::Error error)
 	{
-#ifdef DUALCORE
-		return (m_cpu1Data.errors | m_cpu2Data.errors) & (1UL << error);
-#else
-		return m_thisCpuData->errors & (1UL << error);
-#endif
+		return errors(sys::maskWord(error)) & sys::maskBit(error);
 	}
 
 	/**
@@ -275,24 +370,41 @@ public:
 	 */
 	static void resetError(sys::Error::Error error)
 	{
-		mcu::CRITICAL_SECTION;
-		m_thisCpuData->errors = m_thisCpuData->errors & ((1UL << error) ^ 0xFFFFFFFF);
+		_clearErrors(sys::maskWord(error), sys::maskBit(error));
 	}
 
 	/**
-	 * @brief Returns current system error code.
-	 * @param (none)
-	 * @return Current system error code.
+	 * @brief Returns word of current system error code.
+	 * @param word - mask word index, word 0 holds errors 0-31
+	 * @return Word of current system error code.
 	 */
-	static uint32_t errors()
+	static uint32_t errors(size_t word = 0)
 	{
+		assert(word < sys::Error::ERROR_WORD_COUNT);
 #ifdef DUALCORE
-		return m_cpu1Data.errors | m_cpu2Data.errors;
+		return m_cpu1Data.errors[word] | m_cpu2Data.errors[word];
 #else
-		return m_thisCpuData->errors;
+		return m_thisCpuData->errors[word];
 #endif
 	}
 
+	/**
+	 * @brief Checks if system has errors.
+	 * @param (none)
+	 * @return \c true if any error is set, \c false otherwise.
+	 */
+	static bool hasErrors()
+	{
+		for (size_t i = 0; i < sys::Error::ERROR_WORD_COUNT; ++i)
+		{
+			if (errors(i) != 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
 	/**
 	 * @brief Checks if system has fatal errors.
 	 * @param (none)
@@ -300,22 +412,39 @@ public:
 	 */
 	static bool hasFatalErrors()
 	{
+		for (size_t i = 0; i < sys::Error::ERROR_WORD_COUNT; ++i)
+		{
 #ifdef DUALCORE
-		return (m_cpu1Data.errors & m_cpu1Data.fatalErrorMask) || (m_cpu2Data.errors & m_cpu2Data.fatalErrorMask);
+			if ((m_cpu1Data.errors[i] & m_cpu1Data.fatalErrorMask[i]) || (m_cpu2Data.errors[i] & m_cpu2Data.fatalErrorMask[i]))
 #else
-		return m_thisCpuData->errors & m_thisCpuData->fatalErrorMask;
+			if (m_thisCpuData->errors[i] & m_thisCpuData->fatalErrorMask[i])
 #endif
+			{
+				return true;
+			}
+		}
+		return false;
 	}
 
 	/**
-	 * @brief Sets specified warning.
+	 * @brief Sets specified warning. First occurrence since warning reset is recorded to event log.
 	 * @param warning - warning to be set
+	 * @param value - snapshot value to be recorded
 	 * @return (none)
 	 */
-	static void setWarning(sys::Warning::Warning warning)
+	static void setWarning(sys::Warning::Warning warning, float value = 0)
 	{
-		mcu::CRITICAL_SECTION;
-		m_thisCpuData->warnings = m_thisCpuData->warnings | (1UL << warning);
+		size_t word = sys::maskWord(warning);
+		uint32_t mask = sys::maskBit(warning);
+		if (m_thisCpuData->warnings[word] & mask)
+		{
+			return;
+		}
+		if (emb::atomicFetchOr(m_thisCpuData->warnings[word], mask) & mask)
+		{
+			return;		// transition is claimed by other context
+		}
+		_logEvent(sys::Event::WARNING_SET, warning, value);
 	}
 
 	/**
@@ -325,11 +454,7 @@ public:
 	 */
 	static bool hasWarning(sys::Warning::Warning warning)
 	{
-#ifdef DUALCORE
-		return (m_cpu1Data.warnings | m_cpu2Data.warnings) & (1UL << warning);
-#else
-		return m_thisCpuData->warnings & (1UL << warning);
-#endif
+		return warnings(sys::maskWord(warning)) & sys::maskBit(warning);
 	}
 
 	/**
@@ -339,24 +464,41 @@ public:
 	 */
 	static void resetWarning(sys::Warning::Warning warning)
 	{
-		mcu::CRITICAL_SECTION;
-		m_thisCpuData->warnings = m_thisCpuData->warnings & ((1UL << warning) ^ 0xFFFFFFFF);
+		emb::atomicAnd(m_thisCpuData->warnings[sys::maskWord(warning)], ~sys::maskBit(warning));
 	}
 
 	/**
-	 * @brief Returns current system warning code.
-	 * @param (none)
-	 * @return Current system warning code.
+	 * @brief Returns word of current system warning code.
+	 * @param word - mask word index, word 0 holds warnings 0-31
+	 * @return Word of current system warning code.
 	 */
-	static uint32_t warnings()
+	static uint32_t warnings(size_t word = 0)
 	{
+		assert(word < sys::Warning::WARNING_WORD_COUNT);
 #ifdef DUALCORE
-		return m_cpu1Data.warnings | m_cpu2Data.warnings;
+		return m_cpu1Data.warnings[word] | m_cpu2Data.warnings[word];
 #else
-		return m_thisCpuData->warnings;
+		return m_thisCpuData->warnings[word];
 #endif
 	}
 
+	/**
+	 * @brief Checks if system has warnings.
+	 * @param (none)
+	 * @return \c true if any warning is set, \c false otherwise.
+	 */
+	static bool hasWarnings()
+	{
+		for (size_t i = 0; i < sys::Warning::WARNING_WORD_COUNT; ++i)
+		{
+			if (warnings(i) != 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
 	/**
 	 * @brief Resets non-fatal errors and warnings.
 	 * @param tag - soft reset tag
@@ -364,9 +506,16 @@ public:
 	 */
 	static void resetErrorsWarnings()
 	{
-		mcu::CRITICAL_SECTION;
-		m_thisCpuData->errors = m_thisCpuData->errors & m_thisCpuData->fatalErrorMask;
-		m_thisCpuData->warnings = m_thisCpuData->warnings & m_thisCpuData->fatalWarningMask;
+		_logEvent(sys::Event::ERRORS_RESET, 0, 0);
+		m_firstErrorState = 0;
+		for (size_t i = 0; i < sys::Error::ERROR_WORD_COUNT; ++i)
+		{
+			_clearErrors(i, ~m_thisCpuData->fatalErrorMask[i]);
+		}
+		for (size_t i = 0; i < sys::Warning::WARNING_WORD_COUNT; ++i)
+		{
+			emb::atomicAnd(m_thisCpuData->warnings[i], m_thisCpuData->fatalWarningMask[i]);
+		}
 #if (defined(CPU1) && defined(DUALCORE))
 		mcu::setLocalIpcFlag(RESET_ERRORS_WARNINGS.local);
 #endif
@@ -379,9 +528,8 @@ public:
 	 */
 	static void clearCriticalMasks()
 	{
-		mcu::CRITICAL_SECTION;
-		m_thisCpuData->fatalErrorMask = 0;
-		m_thisCpuData->fatalWarningMask = 0;
+		_fillMask(m_thisCpuData->fatalErrorMask, false);
+		_fillMask(m_thisCpuData->fatalWarningMask, false);
 	}
 
 	/**
@@ -390,10 +538,155 @@ public:
 	 * @return (none)
 	 */
 	static void enableCriticalMasks()
+	{
+		_makeMask(m_thisCpuData->fatalErrorMask, sys::Error::FATAL);
+		_makeMask(m_thisCpuData->fatalWarningMask, sys::Warning::FATAL);
+	}
+
+	/**
+	 * @brief Returns event log of this CPU.
+	 * @param (none)
+	 * @return Event log.
+	 */
+	static const sys::EventLog<64>& events() { return m_events; }
+
+	/**
+	 * @brief Checks if error has occurred since last reset of errors.
+	 * @param (none)
+	 * @return \c true if first error record is valid, \c false otherwise.
+	 */
+	static bool hasFirstError() { return m_firstErrorState & FIRST_ERROR_VALID; }
+
+	/**
+	 * @brief Returns record of first error since last reset of errors.
+	 * @param (none)
+	 * @return First error record.
+	 */
+	static sys::EventRecord firstError() { return m_firstError; }
+
+	/**
+	 * @brief Writes event log to non-volatile storage.
+	 * @param eeprom - storage
+	 * @param addr - start address
+	 * @param timeoutMs - timeout of each write
+	 * @return Status of operation.
+	 */
+	static emb::EepromStatus flushEvents(emb::IEeprom* eeprom, emb::EepromAddr addr, uint64_t timeoutMs)
+	{
+		return m_events.flush(eeprom, addr, timeoutMs);
+	}
+
+	/**
+	 * @brief Returns occurrence statistics of error of this CPU.
+	 * @param error - error
+	 * @return Copy of error statistics.
+	 */
+	static sys::ErrorStatistics errorStatistics(sys::Error::Error error)
+	{
+		assert(static_cast<size_t>(error) < sys::Error::ERROR_COUNT);
+		mcu::NESTED_CRITICAL_SECTION;
+		return m_errorStats[error];
+	}
+
+	/**
+	 * @brief Assembles snapshot of Syslog state. Interrupts are not disabled for the whole assembly:
+	 * assembly is retried if event log has been changed meanwhile.
+	 * @param snapshot - snapshot to be filled
+	 * @return \c true if snapshot is consistent, \c false if event log kept changing.
+	 */
+	static bool takeSnapshot(sys::SyslogSnapshot& snapshot);
+
+#ifdef DUALCORE
+	/**
+	 * @brief Returns number of CPU2 messages lost because CPU2 -> CPU1 message queue was full.
+	 * @param (none)
+	 * @return Number of lost messages.
+	 */
+	static uint32_t cpu2MessagesLost() { return m_cpu2Messages.overflowCount(); }
+#endif
+
+private:
+	static void _pushMessage(sys::Message::Message msg)
 	{
 		mcu::CRITICAL_SECTION;
-		m_thisCpuData->fatalErrorMask = sys::Error::FATAL_ERRORS;
-		m_thisCpuData->fatalWarningMask = sys::Warning::FATAL_WARNINGS;
+		if (!m_messages.full())
+		{
+			m_messages.push(msg);
+		}
+	}
+
+	// clears errors of mask in one mask word, updates statistics of exactly cleared errors and rearms their latches,
+	// so that persisting condition sets error again. All three steps are one critical section:
+	// error set by ISR meanwhile is either cleared and rearmed or kept with its statistics intact
+	static void _clearErrors(size_t word, uint32_t mask)
+	{
+		mcu::NESTED_CRITICAL_SECTION;
+		uint32_t cleared = m_thisCpuData->errors[word] & mask;
+		if (cleared == 0)
+		{
+			return;
+		}
+		emb::atomicAnd(m_thisCpuData->errors[word], ~cleared);
+
+		uint32_t timeNow = static_cast<uint32_t>(mcu::SystemClock::now());
+		for (size_t i = word * 32; cleared != 0; ++i, cleared >>= 1)
+		{
+			if (cleared & 1)
+			{
+				m_errorStats[i].onClear(timeNow);
+				m_errorLatches[i].reset();
+			}
+		}
+	}
+
+	// stores every mask word with single store
+	template <size_t WordCount>
+	static void _fillMask(volatile uint32_t (&mask)[WordCount], bool value)
+	{
+		for (size_t i = 0; i < WordCount; ++i)
+		{
+			mask[i] = value ? 0xFFFFFFFF : 0;
+		}
+	}
+
+	// builds mask from table of flags generated from error or warning table, every word is stored with single store
+	template <size_t WordCount, size_t BitCount>
+	static void _makeMask(volatile uint32_t (&mask)[WordCount], const bool (&flags)[BitCount])
+	{
+		EMB_STATIC_ASSERT(WordCount == (BitCount + 31) / 32);
+		for (size_t i = 0; i < WordCount; ++i)
+		{
+			uint32_t word = 0;
+			for (size_t bit = i * 32; (bit < BitCount) && (bit < (i + 1) * 32); ++bit)
+			{
+				if (flags[bit])
+				{
+					word |= sys::maskBit(bit);
+				}
+			}
+			mask[i] = word;
+		}
+	}
+
+	static sys::EventRecord _logEvent(sys::Event::Type type, uint16_t code, float value)
+	{
+#ifdef CPU1
+		return _logEvent(type, code, value, 1);
+#else
+		return _logEvent(type, code, value, 2);
+#endif
+	}
+
+	static sys::EventRecord _logEvent(sys::Event::Type type, uint16_t code, float value, uint16_t cpu)
+	{
+		sys::EventRecord record;
+		record.timestamp = static_cast<uint32_t>(mcu::SystemClock::now());
+		record.type = type;
+		record.cpu = cpu;
+		record.code = code;
+		record.value = value;
+		m_events.push(record);
+		return record;
 	}
 };
 
@@ -7,65 +7,149 @@
 #pragma once
 
 
+#include <stdint.h>
+#include <stddef.h>
+#include "emb/emb_common.h"
+
+
 namespace sys {
 /// @addtogroup syslog
 /// @{
 
 
+/// Index of 32-bit mask word that holds bit of error or warning, each mask word is updated atomically
+inline size_t maskWord(size_t bit) { return bit / 32; }
+
+
+/// Bit of error or warning in its mask word
+inline uint32_t maskBit(size_t bit) { return 1UL << (bit % 32); }
+
+
 namespace Error {
 
 
+/// Error severity
+enum Severity
+{
+	SEVERITY_MINOR,		// degraded operation
+	SEVERITY_MAJOR,		// operation is stopped
+	SEVERITY_CRITICAL,	// hardware may be damaged
+};
+
+
+/**
+ * System faults table: X(name, severity, fatal, autoReset, enabled).
+ * fatal - error is not cleared by reset of errors,
+ * autoReset - error is cleared by firmware when its cause has gone,
+ * enabled - error is registered after Syslog initialization.
+ * Enum, flags and names are generated from this table, errors must be appended only to the end.
+ */
+#define SYS_ERROR_TABLE(X) \
+	X(OVP_IN,			SEVERITY_CRITICAL,	false,	false,	true) \
+	X(UVP_IN,			SEVERITY_MAJOR,		false,	false,	true) \
+	X(OVP_OUT,			SEVERITY_CRITICAL,	false,	false,	true) \
+	X(OCP_IN,			SEVERITY_CRITICAL,	false,	false,	true) \
+	X(DRIVER_FLT,			SEVERITY_CRITICAL,	false,	false,	true) \
+	X(MODULE_OVERTEMP,		SEVERITY_CRITICAL,	false,	false,	true) \
+	X(HEATSINK_OVERTEMP,		SEVERITY_CRITICAL,	false,	false,	true) \
+	X(CAN_CONNECTION_LOST,		SEVERITY_MAJOR,		false,	false,	true) \
+	X(CAN_BUS_ERROR,		SEVERITY_MINOR,		false,	false,	true) \
+	X(RUNTIME_ERROR,		SEVERITY_CRITICAL,	false,	false,	true) \
+	X(EMERGENCY_STOP,		SEVERITY_CRITICAL,	false,	false,	true) \
+	X(FUELCELL_ERROR,		SEVERITY_MAJOR,		false,	false,	false) \
+	X(FUELCELL_OVERHEAT,		SEVERITY_MAJOR,		false,	false,	false) \
+	X(FUELCELL_BATT_LOWCHARGE,	SEVERITY_MAJOR,		false,	false,	false) \
+	X(FUELCELL_NOCONNECTION,	SEVERITY_MAJOR,		false,	false,	false) \
+	X(FUELCELL_LOWPRESSURE,		SEVERITY_MAJOR,		false,	false,	false) \
+	X(FUELCELL_HYDROERROR,		SEVERITY_MAJOR,		false,	false,	false) \
+	X(FUELCELL_STARTUP_FAILED,	SEVERITY_MAJOR,		false,	false,	true) \
+	X(FUELCELL_SHUTDOWN_FAILED,	SEVERITY_MAJOR,		false,	false,	true) \
+	X(FUELCELL_UV,			SEVERITY_MAJOR,		false,	false,	false) \
+	X(FUELCELL_OV,			SEVERITY_MAJOR,		false,	false,	false) \
+	X(RS_CONNECTION_LOST,		SEVERITY_MAJOR,		false,	true,	true) \
+	X(BMS_FATAL_ERROR,		SEVERITY_CRITICAL,	false,	false,	true)
+
+
 /// System faults
 enum Error
 {
-	OVP_IN,
-	UVP_IN,
-	OVP_OUT,
-	OCP_IN,
-	DRIVER_FLT,
-	MODULE_OVERTEMP,
-	HEATSINK_OVERTEMP,
-	CAN_CONNECTION_LOST,
-	CAN_BUS_ERROR,
-	RUNTIME_ERROR,
-	EMERGENCY_STOP,
-	FUELCELL_ERROR,
-	FUELCELL_OVERHEAT,
-	FUELCELL_BATT_LOWCHARGE,
-	FUELCELL_NOCONNECTION,
-	FUELCELL_LOWPRESSURE,
-	FUELCELL_HYDROERROR,
-	FUELCELL_STARTUP_FAILED,
-	FUELCELL_SHUTDOWN_FAILED,
-	FUELCELL_UV,
-	FUELCELL_OV,
-	RS_CONNECTION_LOST,
-	BMS_FATAL_ERROR,
+#define SYS_ERROR_ENUM(name, severity, fatal, autoReset, enabled) name,
+	SYS_ERROR_TABLE(SYS_ERROR_ENUM)
+#undef SYS_ERROR_ENUM
+	ERROR_COUNT_
 };
 
 
-const uint32_t FATAL_ERRORS = 0;	//(1UL << DRIVER_FLT)
-					//| (1UL << RUNTIME_ERROR);
+/// Number of system faults
+const size_t ERROR_COUNT = ERROR_COUNT_;
+EMB_STATIC_ASSERT(ERROR_COUNT <= 256);	// error code is packed into 8 bits of snapshot event record
+
+
+/// Number of 32-bit words of error masks
+const size_t ERROR_WORD_COUNT = (ERROR_COUNT + 31) / 32;
+
 
+/// Errors that cannot be reset, generated from table
+extern const bool FATAL[ERROR_COUNT];
 
-} // namespace Fault
+
+/// Errors that are cleared by firmware, generated from table
+extern const bool AUTO_RESET[ERROR_COUNT];
+
+
+/// Errors that are registered after Syslog initialization, generated from table
+extern const bool ENABLED_BY_DEFAULT[ERROR_COUNT];
+
+
+/// Error names, generated from table
+extern const char* const NAMES[ERROR_COUNT];
+/// Error severities, generated from table
+extern const Severity SEVERITIES[ERROR_COUNT];
+
+
+} // namespace Error
 
 
 namespace Warning {
 
 
+/**
+ * System warnings table: X(name, fatal).
+ * fatal - warning is not cleared by reset of warnings.
+ */
+#define SYS_WARNING_TABLE(X) \
+	X(BATTERY_CHARGED,	false) \
+	X(CAN_BUS_WARNING,	false) \
+	X(CAN_BUS_OVERRUN,	false) \
+	X(MODULE_OVERHEATING,	false) \
+	X(CASE_OVERHEATING,	false)
+
+
 /// System warnings
 enum Warning
 {
-	BATTERY_CHARGED,
-	CAN_BUS_WARNING,
-	CAN_BUS_OVERRUN,
-	MODULE_OVERHEATING,
-	CASE_OVERHEATING,
+#define SYS_WARNING_ENUM(name, fatal) name,
+	SYS_WARNING_TABLE(SYS_WARNING_ENUM)
+#undef SYS_WARNING_ENUM
+	WARNING_COUNT_
 };
 
 
-const uint32_t FATAL_WARNINGS = 0;
+/// Number of system warnings
+const size_t WARNING_COUNT = WARNING_COUNT_;
+EMB_STATIC_ASSERT(WARNING_COUNT <= 256);	// warning code is packed into 8 bits of snapshot event record
+
+
+/// Number of 32-bit words of warning masks
+const size_t WARNING_WORD_COUNT = (WARNING_COUNT + 31) / 32;
+
+
+/// Warnings that cannot be reset, generated from table
+extern const bool FATAL[WARNING_COUNT];
+
+
+/// Warning names, generated from table
+extern const char* const NAMES[WARNING_COUNT];
 
 
 } // namespace Warning
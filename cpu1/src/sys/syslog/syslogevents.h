@@ -0,0 +1,148 @@
+/**
+ * @file
+ * @ingroup syslog
+ */
+
+
+#pragma once
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include "emb/emb_common.h"
+#include "emb/emb_atomic.h"
+#include "emb/emb_eeprom.h"
+#include "mcu/system/mcu_system.h"
+
+
+namespace sys {
+/// @addtogroup syslog
+/// @{
+
+
+namespace Event {
+
+
+/// Event types
+enum Type
+{
+	ERROR_SET,
+	WARNING_SET,
+	MESSAGE,
+	ERRORS_RESET,
+};
+
+
+} // namespace Event
+
+
+/**
+ * @brief Compact binary event record.
+ */
+struct EventRecord
+{
+	uint32_t timestamp;	// ms since boot
+	uint16_t type : 4;	// Event::Type
+	uint16_t cpu : 4;	// 1 - CPU1, 2 - CPU2
+	uint16_t code : 8;	// error, warning or message code
+	float value;		// snapshot value at the time of event, e.g. vIn at OVP
+};
+
+
+/**
+ * @brief Fixed-size ring of event records, oldest records are overwritten when ring is full.
+ * Records are appended without allocation and without critical section, push() may be called from ISRs:
+ * slot is reserved by atomic increment of record count, so pushes that preempt each other never share slot.
+ * On C28x the increment masks interrupts for its load-modify-store, record itself is copied with interrupts enabled.
+ * Reserved slot is written after count is incremented, so readers must run in context that cannot preempt
+ * writers (background loop), where every reserved slot is already written.
+ */
+template <size_t Capacity>
+class EventLog
+{
+	EMB_STATIC_ASSERT((Capacity & (Capacity - 1)) == 0);
+private:
+	EventRecord m_records[Capacity];
+	volatile uint32_t m_count;	// number of records pushed since clear(), next record index is m_count % Capacity
+public:
+	EventLog() : m_count(0) {}
+
+	/**
+	 * @brief Removes all records.
+	 * @param (none)
+	 * @return (none)
+	 */
+	void clear()
+	{
+		mcu::NESTED_CRITICAL_SECTION;
+		m_count = 0;
+	}
+
+	/**
+	 * @brief Appends record, oldest record is overwritten if ring is full.
+	 * @param record - event record
+	 * @return (none)
+	 */
+	void push(const EventRecord& record)
+	{
+		uint32_t index = emb::atomicFetchAdd(m_count, 1);
+		m_records[index & (Capacity - 1)] = record;
+	}
+
+	/**
+	 * @brief Returns number of stored records.
+	 * @param (none)
+	 * @return Number of stored records.
+	 */
+	size_t size() const { return (m_count < Capacity) ? m_count : Capacity; }
+
+	/**
+	 * @brief Returns number of records pushed since clear(), including overwritten ones.
+	 * @param (none)
+	 * @return Number of pushed records.
+	 */
+	uint32_t totalCount() const { return m_count; }
+
+	/**
+	 * @brief Returns stored record.
+	 * @param index - record index, 0 - oldest stored record
+	 * @return Copy of record.
+	 */
+	EventRecord at(size_t index) const
+	{
+		assert(index < size());
+		mcu::NESTED_CRITICAL_SECTION;
+		uint32_t first = (m_count < Capacity) ? 0 : m_count - Capacity;
+		return m_records[(first + index) & (Capacity - 1)];
+	}
+
+	/**
+	 * @brief Writes total record count and stored records from oldest to newest to non-volatile storage.
+	 * @param eeprom - storage
+	 * @param addr - start address, records follow count
+	 * @param timeoutMs - timeout of each write
+	 * @return Status of operation.
+	 */
+	emb::EepromStatus flush(emb::IEeprom* eeprom, emb::EepromAddr addr, uint64_t timeoutMs) const
+	{
+		uint32_t count = m_count;
+		emb::EepromStatus status = eeprom->write(addr, reinterpret_cast<const char*>(&count),
+				sizeof(count), timeoutMs);
+		addr.offset += sizeof(count);
+
+		size_t recordCount = (count < Capacity) ? count : Capacity;
+		for (size_t i = 0; (i < recordCount) && (status == emb::EEPROM_SUCCESS); ++i)
+		{
+			EventRecord record = at(i);
+			status = eeprom->write(addr, reinterpret_cast<const char*>(&record), sizeof(record), timeoutMs);
+			addr.offset += sizeof(record);
+		}
+		return status;
+	}
+};
+
+
+/// @}
+} // namespace sys
+
+
@@ -0,0 +1,123 @@
+/**
+ * @file
+ * @ingroup syslog
+ */
+
+
+#pragma once
+
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+namespace sys {
+/// @addtogroup syslog
+/// @{
+
+
+/**
+ * @brief Debounced error latch. Error condition is sampled by update(): latch is asserted when condition
+ * has been active for assertCount consecutive samples and at least assertTime, and is cleared when condition
+ * has been inactive for clearCount consecutive samples and at least clearTime. Default configuration
+ * asserts and clears on first sample. update() is O(1), latch must be updated from one context.
+ */
+class ErrorLatch
+{
+public:
+	/// Result of update()
+	enum Transition
+	{
+		LATCH_UNCHANGED,
+		LATCH_ASSERTED,
+		LATCH_CLEARED,
+	};
+private:
+	uint16_t m_assertCount;
+	uint16_t m_clearCount;
+	uint32_t m_assertTime;	// ms
+	uint32_t m_clearTime;	// ms
+
+	bool m_latched;
+	uint16_t m_sampleCount;	// consecutive samples that differ from latched state
+	uint32_t m_since;	// time of first of these samples
+public:
+	ErrorLatch() { configure(1, 0, 1, 0); }
+
+	/**
+	 * @brief Configures latch and clears it.
+	 * @param assertCount - number of consecutive active samples to assert latch, at least 1
+	 * @param assertTime - time of active condition to assert latch, ms
+	 * @param clearCount - number of consecutive inactive samples to clear latch, at least 1
+	 * @param clearTime - time of inactive condition to clear latch, ms
+	 * @return (none)
+	 */
+	void configure(uint16_t assertCount, uint32_t assertTime, uint16_t clearCount, uint32_t clearTime)
+	{
+		m_assertCount = (assertCount > 0) ? assertCount : 1;
+		m_assertTime = assertTime;
+		m_clearCount = (clearCount > 0) ? clearCount : 1;
+		m_clearTime = clearTime;
+		reset();
+	}
+
+	/**
+	 * @brief Clears latch without transition.
+	 * @param (none)
+	 * @return (none)
+	 */
+	void reset()
+	{
+		m_latched = false;
+		m_sampleCount = 0;
+		m_since = 0;
+	}
+
+	/**
+	 * @brief Processes condition sample.
+	 * @param active - error condition
+	 * @param timeNow - sample time, ms
+	 * @return Transition of latch.
+	 */
+	Transition update(bool active, uint32_t timeNow)
+	{
+		if (active == m_latched)
+		{
+			m_sampleCount = 0;
+			return LATCH_UNCHANGED;
+		}
+
+		if (m_sampleCount == 0)
+		{
+			m_since = timeNow;
+		}
+		if (m_sampleCount < 0xFFFF)
+		{
+			++m_sampleCount;
+		}
+
+		uint16_t requiredCount = active ? m_assertCount : m_clearCount;
+		uint32_t requiredTime = active ? m_assertTime : m_clearTime;
+		if ((m_sampleCount < requiredCount) || (timeNow - m_since < requiredTime))
+		{
+			return LATCH_UNCHANGED;
+		}
+
+		m_latched = active;
+		m_sampleCount = 0;
+		return active ? LATCH_ASSERTED : LATCH_CLEARED;
+	}
+
+	/**
+	 * @brief Returns latch state.
+	 * @param (none)
+	 * @return \c true if latch is asserted, \c false otherwise.
+	 */
+	bool latched() const { return m_latched; }
+};
+
+
+/// @}
+} // namespace sys
+
+
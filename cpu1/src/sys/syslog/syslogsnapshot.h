@@ -0,0 +1,96 @@
+/**
+ * @file
+ * @ingroup syslog
+ */
+
+
+#pragma once
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "emb/emb_common.h"
+#include "syslogdef.h"
+#include "syslogevents.h"
+
+
+namespace sys {
+/// @addtogroup syslog
+/// @{
+
+
+/**
+ * @brief Event record packed into 32-bit words.
+ */
+struct PackedEventRecord
+{
+	uint32_t timestamp;	// ms since boot
+	uint32_t info;		// bits 0-3 - type, 4-7 - cpu, 8-15 - code
+	uint32_t value;		// float bits
+
+	/**
+	 * @brief Packs event record.
+	 * @param record - event record
+	 * @return (none)
+	 */
+	void pack(const EventRecord& record)
+	{
+		timestamp = record.timestamp;
+		info = static_cast<uint32_t>(record.type)
+				| (static_cast<uint32_t>(record.cpu) << 4)
+				| (static_cast<uint32_t>(record.code) << 8);
+		memcpy(&value, &record.value, sizeof(uint32_t));
+	}
+};
+
+
+/**
+ * @brief Versioned snapshot of Syslog state. Consists only of 32-bit words, so that it is read over CAN
+ * word by word in the same layout on any platform. Fields may be appended only with version increment.
+ */
+struct SyslogSnapshot
+{
+	static const uint16_t VERSION = 2;	// 2 - masks are arrays of ERROR_WORD_COUNT and WARNING_WORD_COUNT words
+	static const size_t EVENT_COUNT = 8;
+	static const uint32_t FLAG_CONSISTENT = 1UL << 0;
+	static const uint32_t FLAG_FIRST_ERROR = 1UL << 1;
+
+	uint32_t header;		// bits 0-15 - word count, 16-31 - version
+	uint32_t timestamp;		// ms since boot
+	uint32_t flags;			// bit 0 - snapshot is consistent, bit 1 - first error is valid
+	uint32_t errors[Error::ERROR_WORD_COUNT];
+	uint32_t warnings[Warning::WARNING_WORD_COUNT];
+	uint32_t enabledErrorMask[Error::ERROR_WORD_COUNT];
+	uint32_t fatalErrorMask[Error::ERROR_WORD_COUNT];
+	uint32_t fatalWarningMask[Warning::WARNING_WORD_COUNT];
+	uint32_t cpu2MessagesLost;
+	uint32_t eventTotalCount;	// events since boot, events[] are the latest ones
+	uint32_t errorCounts[(Error::ERROR_COUNT + 1) / 2];	// two 16-bit counters per word, even error in low half
+	PackedEventRecord firstError;
+	PackedEventRecord events[EVENT_COUNT];	// oldest first, unused records are zero
+
+	/**
+	 * @brief Returns snapshot size.
+	 * @param (none)
+	 * @return Number of 32-bit words.
+	 */
+	static size_t wordCount() { return sizeof(SyslogSnapshot) / sizeof(uint32_t); }
+
+	/**
+	 * @brief Returns snapshot word.
+	 * @param index - word index
+	 * @return Snapshot word.
+	 */
+	uint32_t word(size_t index) const
+	{
+		assert(index < wordCount());
+		return reinterpret_cast<const uint32_t*>(this)[index];
+	}
+};
+
+
+/// @}
+} // namespace sys
+
+
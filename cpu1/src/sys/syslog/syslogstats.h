@@ -0,0 +1,133 @@
+/**
+ * @file
+ * @ingroup syslog
+ */
+
+
+#pragma once
+
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+namespace sys {
+/// @addtogroup syslog
+/// @{
+
+
+/**
+ * @brief Occurrence statistics of one error. All updates are O(1), caller must serialize them with readers.
+ * Syslog serializes writers: onSet() is called only by context that has claimed 0->1 transition of error bit,
+ * onClear() is called with interrupts disabled together with clearing of error bit, so that no claim
+ * can be made between them. Readers copy statistics with interrupts disabled in background loop.
+ * Rate is estimated by sliding window: count of previous minute weighted by its overlap with last 60 s
+ * plus count of current minute.
+ */
+class ErrorStatistics
+{
+public:
+	static const uint32_t RATE_WINDOW = 60000;	// ms
+private:
+	uint16_t m_count;		// occurrences since boot, saturating
+	uint16_t m_windowCount;		// occurrences in current window, saturating
+	uint16_t m_prevWindowCount;	// occurrences in previous window
+	uint32_t m_window;		// index of current window
+	uint32_t m_lastSet;		// ms since boot
+	uint32_t m_lastCleared;		// ms since boot
+public:
+	ErrorStatistics() { reset(); }
+
+	/**
+	 * @brief Clears statistics.
+	 * @param (none)
+	 * @return (none)
+	 */
+	void reset()
+	{
+		m_count = 0;
+		m_windowCount = 0;
+		m_prevWindowCount = 0;
+		m_window = 0;
+		m_lastSet = 0;
+		m_lastCleared = 0;
+	}
+
+	/**
+	 * @brief Registers error occurrence.
+	 * @param timeNow - current time, ms
+	 * @return (none)
+	 */
+	void onSet(uint32_t timeNow)
+	{
+		uint32_t window = timeNow / RATE_WINDOW;
+		if (window != m_window)
+		{
+			m_prevWindowCount = (window == m_window + 1) ? m_windowCount : 0;
+			m_windowCount = 0;
+			m_window = window;
+		}
+		if (m_windowCount < 0xFFFF)
+		{
+			++m_windowCount;
+		}
+		if (m_count < 0xFFFF)
+		{
+			++m_count;
+		}
+		m_lastSet = timeNow;
+	}
+
+	/**
+	 * @brief Registers error clearing.
+	 * @param timeNow - current time, ms
+	 * @return (none)
+	 */
+	void onClear(uint32_t timeNow) { m_lastCleared = timeNow; }
+
+	/**
+	 * @brief Returns number of occurrences since boot, saturates at 0xFFFF.
+	 * @param (none)
+	 * @return Number of occurrences.
+	 */
+	uint16_t count() const { return m_count; }
+
+	/**
+	 * @brief Returns time of last occurrence.
+	 * @param (none)
+	 * @return Time of last occurrence, ms since boot. 0 if error has not occurred.
+	 */
+	uint32_t lastSet() const { return m_lastSet; }
+
+	/**
+	 * @brief Returns time of last clearing.
+	 * @param (none)
+	 * @return Time of last clearing, ms since boot. 0 if error has not been cleared.
+	 */
+	uint32_t lastCleared() const { return m_lastCleared; }
+
+	/**
+	 * @brief Estimates occurrence rate over last minute.
+	 * @param timeNow - current time, ms
+	 * @return Occurrences per minute.
+	 */
+	float ratePerMinute(uint32_t timeNow) const
+	{
+		uint32_t window = timeNow / RATE_WINDOW;
+		float current = m_windowCount;
+		float previous = m_prevWindowCount;
+		if (window != m_window)
+		{
+			previous = (window == m_window + 1) ? current : 0;
+			current = 0;
+		}
+		float elapsed = float(timeNow % RATE_WINDOW) / float(RATE_WINDOW);
+		return previous * (1.f - elapsed) + current;
+	}
+};
+
+
+/// @}
+} // namespace sys
+
+
@@ -14,6 +14,12 @@ namespace od {
 
 // APP-SPECIFIC objects
 fuelcell::Converter* converter = static_cast<fuelcell::Converter*>(NULL);
+size_t fuelcellNodeSelected = 0;
+size_t syslogErrorSelected = 0;
+size_t rxQueueSelected = 0;
+sys::SyslogSnapshot syslogSnapshot;
+size_t syslogSnapshotOffset = 0;
+sys::SyslogSnapshot syslogSnapshotDomain;	// read lazily by SDO transfer, so SNAPSHOT_TAKE must not overwrite it
 
 
 /* ========================================================================== */
@@ -53,6 +59,80 @@ inline ODAccessStatus getSyslogMessage(CobSdoData& dest)
 	return OD_ACCESS_SUCCESS;
 }
 
+inline ODAccessStatus takeSyslogSnapshot(CobSdoData& dest)
+{
+	Syslog::takeSnapshot(syslogSnapshot);
+	syslogSnapshotOffset = 0;
+	dest.u32 = TASK_SUCCESS;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getSyslogSnapshotSize(CobSdoData& dest)
+{
+	dest.u32 = sys::SyslogSnapshot::wordCount();
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getSyslogSnapshotOffset(CobSdoData& dest)
+{
+	dest.u32 = syslogSnapshotOffset;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus setSyslogSnapshotOffset(CobSdoData val)
+{
+	if (val.u32 >= sys::SyslogSnapshot::wordCount())
+	{
+		return OD_ACCESS_FAIL;
+	}
+	syslogSnapshotOffset = val.u32;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getSyslogSnapshotData(CobSdoData& dest)
+{
+	if (syslogSnapshotOffset >= sys::SyslogSnapshot::wordCount())
+	{
+		return OD_ACCESS_FAIL;
+	}
+	dest.u32 = syslogSnapshot.word(syslogSnapshotOffset++);
+	return OD_ACCESS_SUCCESS;
+}
+
+/* ========================================================================== */
+/* =================== DOMAINS ====================== */
+/* ========================================================================== */
+inline size_t openDeviceName()
+{
+	return strlen(sys::DEVICE_NAME);
+}
+
+inline uint16_t readDeviceName(size_t offset)
+{
+	return sys::DEVICE_NAME[offset] & 0x00FF;
+}
+
+inline size_t openBuildConfiguration()
+{
+	return strlen(sys::BUILD_CONFIGURATION);
+}
+
+inline uint16_t readBuildConfiguration(size_t offset)
+{
+	return sys::BUILD_CONFIGURATION[offset] & 0x00FF;
+}
+
+inline size_t openSyslogSnapshot()
+{
+	Syslog::takeSnapshot(syslogSnapshotDomain);
+	return 4 * sys::SyslogSnapshot::wordCount();	// snapshot words are sent as 4 bytes, LSB first
+}
+
+inline uint16_t readSyslogSnapshot(size_t offset)
+{
+	return static_cast<uint16_t>(syslogSnapshotDomain.word(offset / 4) >> (8 * (offset % 4))) & 0x00FF;
+}
+
 /* ========================================================================== */
 /* =================== WATCH ====================== */
 /* ========================================================================== */
@@ -104,6 +184,12 @@ inline ODAccessStatus getFuelcellMinVoltage(CobSdoData& dest)
 	return OD_ACCESS_SUCCESS;
 }
 
+inline ODAccessStatus getFuelcellMinVoltageIdx(CobSdoData& dest)
+{
+	dest.u32 = fuelcell::Controller::minCellVoltageIdx();
+	return OD_ACCESS_SUCCESS;
+}
+
 inline ODAccessStatus getBatteryCharge(CobSdoData& dest)
 {
 	float value = converter->batteryCharge();
@@ -111,6 +197,294 @@ inline ODAccessStatus getBatteryCharge(CobSdoData& dest)
 	return OD_ACCESS_SUCCESS;
 }
 
+/* ========================================================================== */
+/* =================== FUEL CELL BUS STATISTICS ====================== */
+/* ========================================================================== */
+inline ODAccessStatus getFuelcellBusRec(CobSdoData& dest)
+{
+	dest.u32 = fuelcell::Controller::busStatistics().rec;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getFuelcellBusErrorState(CobSdoData& dest)
+{
+	dest.u32 = fuelcell::Controller::busStatistics().errorState;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getFuelcellBusTxFrames(CobSdoData& dest)
+{
+	dest.u32 = fuelcell::Controller::busStatistics().txFrameCount;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getFuelcellBusRxFrames(CobSdoData& dest)
+{
+	dest.u32 = fuelcell::Controller::busStatistics().rxFrameCount;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getFuelcellBusRxErrors(CobSdoData& dest)
+{
+	dest.u32 = fuelcell::Controller::busStatistics().rxErrorCount;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getFuelcellBusErrSof(CobSdoData& dest)
+{
+	dest.u32 = fuelcell::Controller::busStatistics().errSOF;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getFuelcellBusErrSrr(CobSdoData& dest)
+{
+	dest.u32 = fuelcell::Controller::busStatistics().errSRR;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getFuelcellBusErrR0(CobSdoData& dest)
+{
+	dest.u32 = fuelcell::Controller::busStatistics().errR0;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getFuelcellBusErrCrc(CobSdoData& dest)
+{
+	dest.u32 = fuelcell::Controller::busStatistics().errCRC;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getFuelcellBusErrStuff(CobSdoData& dest)
+{
+	dest.u32 = fuelcell::Controller::busStatistics().errStuff;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getFuelcellBusErrInvalidId(CobSdoData& dest)
+{
+	dest.u32 = fuelcell::Controller::busStatistics().errInvalidId;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getFuelcellBusErrUnknownNode(CobSdoData& dest)
+{
+	dest.u32 = fuelcell::Controller::busStatistics().errUnknownNode;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getFuelcellBusCmdCount(CobSdoData& dest)
+{
+	dest.u32 = fuelcell::Controller::busStatistics().cmdCount;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getFuelcellBusCmdLatency(CobSdoData& dest)
+{
+	dest.u32 = fuelcell::Controller::busStatistics().cmdLatency;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getFuelcellBusTxRetries(CobSdoData& dest)
+{
+	dest.u32 = fuelcell::Controller::busStatistics().txRetryCount;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getFuelcellBusClkLoad(CobSdoData& dest)
+{
+	dest.f32 = fuelcell::Controller::busStatistics().clkLoad;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getFuelcellNodeSelected(CobSdoData& dest)
+{
+	dest.u32 = fuelcellNodeSelected;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus setFuelcellNodeSelected(CobSdoData val)
+{
+	if (val.u32 >= fuelcell::Controller::data().cells.cellCount())
+	{
+		return OD_ACCESS_FAIL;
+	}
+	fuelcellNodeSelected = val.u32;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getFuelcellNodeFrameRate(CobSdoData& dest)
+{
+	float value = fuelcell::Controller::busStatistics().nodeFrameRate[fuelcellNodeSelected];
+	memcpy(&dest, &value, sizeof(uint32_t));
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getFuelcellNodeErrorRate(CobSdoData& dest)
+{
+	float value = fuelcell::Controller::busStatistics().nodeErrorRate[fuelcellNodeSelected];
+	memcpy(&dest, &value, sizeof(uint32_t));
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getFuelcellNodeRecord(fuelcell::CellRecord& record)
+{
+	if (!fuelcell::Controller::data().cells.readCell(fuelcellNodeSelected, record))
+	{
+		return OD_ACCESS_FAIL;
+	}
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getFuelcellNodeTemperature(CobSdoData& dest)
+{
+	fuelcell::CellRecord record;
+	ODAccessStatus status = getFuelcellNodeRecord(record);
+	memcpy(&dest, &record.temperature, sizeof(uint32_t));
+	return status;
+}
+
+inline ODAccessStatus getFuelcellNodeCellVoltage(CobSdoData& dest)
+{
+	fuelcell::CellRecord record;
+	ODAccessStatus status = getFuelcellNodeRecord(record);
+	memcpy(&dest, &record.cellVoltage, sizeof(uint32_t));
+	return status;
+}
+
+inline ODAccessStatus getFuelcellNodeBattVoltage(CobSdoData& dest)
+{
+	fuelcell::CellRecord record;
+	ODAccessStatus status = getFuelcellNodeRecord(record);
+	memcpy(&dest, &record.battVoltage, sizeof(uint32_t));
+	return status;
+}
+
+inline ODAccessStatus getFuelcellNodeCurrent(CobSdoData& dest)
+{
+	fuelcell::CellRecord record;
+	ODAccessStatus status = getFuelcellNodeRecord(record);
+	memcpy(&dest, &record.current, sizeof(uint32_t));
+	return status;
+}
+
+inline ODAccessStatus getFuelcellNodeStatus(CobSdoData& dest)
+{
+	fuelcell::CellRecord record;
+	ODAccessStatus status = getFuelcellNodeRecord(record);
+	dest.u32 = uint32_t(record.statusStart)
+			| (uint32_t(record.statusRun) << 1)
+			| (uint32_t(record.statusOverheat) << 2)
+			| (uint32_t(record.statusLowCharge) << 3);
+	return status;
+}
+
+inline ODAccessStatus getFuelcellNodeIntervalMin(CobSdoData& dest)
+{
+	dest.u32 = fuelcell::Controller::linkStatistics().intervalMin(fuelcellNodeSelected);
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getFuelcellNodeIntervalAvg(CobSdoData& dest)
+{
+	dest.u32 = fuelcell::Controller::linkStatistics().intervalAvg(fuelcellNodeSelected);
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getFuelcellNodeIntervalMax(CobSdoData& dest)
+{
+	dest.u32 = fuelcell::Controller::linkStatistics().intervalMax(fuelcellNodeSelected);
+	return OD_ACCESS_SUCCESS;
+}
+
+template <size_t Bucket>
+inline ODAccessStatus getFuelcellNodeIntervalHistogram(CobSdoData& dest)
+{
+	dest.u32 = fuelcell::Controller::linkStatistics().histogram(fuelcellNodeSelected, Bucket);
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getSyslogErrorSelected(CobSdoData& dest)
+{
+	dest.u32 = syslogErrorSelected;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus setSyslogErrorSelected(CobSdoData val)
+{
+	if (val.u32 >= sys::Error::ERROR_COUNT)
+	{
+		return OD_ACCESS_FAIL;
+	}
+	syslogErrorSelected = val.u32;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getSyslogErrorCount(CobSdoData& dest)
+{
+	dest.u32 = Syslog::errorStatistics(static_cast<sys::Error::Error>(syslogErrorSelected)).count();
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getSyslogErrorLastSet(CobSdoData& dest)
+{
+	dest.u32 = Syslog::errorStatistics(static_cast<sys::Error::Error>(syslogErrorSelected)).lastSet();
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getSyslogErrorLastCleared(CobSdoData& dest)
+{
+	dest.u32 = Syslog::errorStatistics(static_cast<sys::Error::Error>(syslogErrorSelected)).lastCleared();
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getSyslogErrorSeverity(CobSdoData& dest)
+{
+	dest.u32 = sys::Error::SEVERITIES[syslogErrorSelected];
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getSyslogErrorRate(CobSdoData& dest)
+{
+	float value = Syslog::errorStatistics(static_cast<sys::Error::Error>(syslogErrorSelected)).ratePerMinute(
+			static_cast<uint32_t>(mcu::SystemClock::now()));
+	memcpy(&dest, &value, sizeof(uint32_t));
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getRxQueueSelected(CobSdoData& dest)
+{
+	dest.u32 = rxQueueSelected;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus setRxQueueSelected(CobSdoData val)
+{
+	if (val.u32 >= RDO_COUNT)
+	{
+		return OD_ACCESS_FAIL;
+	}
+	rxQueueSelected = val.u32;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getRxQueueDepth(CobSdoData& dest)
+{
+	dest.u32 = can1RxQueues.stats(rxQueueSelected).depth;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getRxQueueHighWater(CobSdoData& dest)
+{
+	dest.u32 = can1RxQueues.stats(rxQueueSelected).highWater;
+	return OD_ACCESS_SUCCESS;
+}
+
+inline ODAccessStatus getRxQueueOverflowCount(CobSdoData& dest)
+{
+	dest.u32 = can1RxQueues.stats(rxQueueSelected).overflowCount;
+	return OD_ACCESS_SUCCESS;
+}
+
 /*============================================================================*/
 
 
@@ -140,7 +514,7 @@ inline ODAccessStatus resetAllFaults(CobSdoData& dest)
 {
 	mcu::SystemClock::resetWatchdog();
 	Syslog::resetErrorsWarnings();
-	fuelcell::failureCount = 0;
+	fuelcell::Fsm::resetFailureCount();
 	dest.u32 = TASK_SUCCESS;
 	return OD_ACCESS_SUCCESS;
 }
@@ -177,33 +551,185 @@ inline ODAccessStatus fuelcellStop(CobSdoData& dest)
 } // namespace od
 
 
-extern ODEntry OBJECT_DICTIONARY[] = {
-{{0x1008, 0x00}, {"SYSTEM", "INFO", "DEVICE_NAME", "", OD_STRING, OD_ACCESS_RO, OD_NO_DIRECT_ACCESS, od::getDeviceName, OD_NO_INDIRECT_WRITE_ACCESS}},
-{{0x5FFF, 0x00}, {"SYSTEM", "INFO", "FIRMWARE_VERSION", "", OD_UINT32, OD_ACCESS_RO, OD_NO_DIRECT_ACCESS, od::getSoftwareVersion, OD_NO_INDIRECT_WRITE_ACCESS}},
-{{0x5FFF, 0x01}, {"SYSTEM", "INFO", "BUILD_CONFIGURATION", "", OD_STRING, OD_ACCESS_RO, OD_NO_DIRECT_ACCESS, od::getBuildConfiguration, OD_NO_INDIRECT_WRITE_ACCESS}},
+/**
+ * Object dictionary table, sorted by {index, subindex}:
+ * X(index, subindex, category, subcategory, name, unit, dataType, accessRight, dataPtr, readAccessFunc, writeAccessFunc).
+ * Table, entry positions and lookup switch are generated from it at compile time, so duplicate keys don't compile.
+ */
+#define OBJECT_DICTIONARY_TABLE(X) \
+X(0x1008, 0x00,	"SYSTEM",	"INFO",	"DEVICE_NAME",	"",	OD_STRING,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getDeviceName,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x2000, 0x00,	"SYSTEM",	"SYSLOG",	"SYSLOG_MSG",	"",	OD_UINT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getSyslogMessage,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x2000, 0x01,	"SYSTEM",	"SYSLOG",	"SNAPSHOT_TAKE",	"",	OD_TASK,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::takeSyslogSnapshot,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x2000, 0x02,	"SYSTEM",	"SYSLOG",	"SNAPSHOT_SIZE",	"",	OD_UINT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getSyslogSnapshotSize,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x2000, 0x03,	"SYSTEM",	"SYSLOG",	"SNAPSHOT_OFFSET",	"",	OD_UINT32,	OD_ACCESS_RW,	OD_NO_DIRECT_ACCESS,	od::getSyslogSnapshotOffset,	od::setSyslogSnapshotOffset) \
+X(0x2000, 0x04,	"SYSTEM",	"SYSLOG",	"SNAPSHOT_DATA",	"",	OD_UINT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getSyslogSnapshotData,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x2000, 0x05,	"SYSTEM",	"SYSLOG",	"SNAPSHOT",	"",	OD_DOMAIN,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	OD_NO_INDIRECT_READ_ACCESS,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x2001, 0x00,	"CONVERTER",	"CONVERTER",	"RELAY ON",	"",	OD_TASK,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::converterRelayOn,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x2001, 0x01,	"CONVERTER",	"CONVERTER",	"RELAY OFF",	"",	OD_TASK,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::converterRelayOff,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x2002, 0x00,	"SYSCTL",	"SYSCTL",	"RESET DEVICE",	"",	OD_TASK,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::resetDevice,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x2002, 0x01,	"SYSCTL",	"SYSCTL",	"RESET FAULTS",	"",	OD_TASK,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::resetAllFaults,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x2002, 0x02,	"SYSCTL",	"SYSCTL",	"SHUTDOWN",	"",	OD_TASK,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::shutdown,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x2002, 0x03,	"SYSCTL",	"SYSCTL",	"STARTUP",	"",	OD_TASK,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::startup,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5000, 0x00,	"WATCH",	"WATCH",	"UPTIME",	"s",	OD_FLOAT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getUptime,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5000, 0x01,	"WATCH",	"WATCH",	"VOLTAGE_IN",	"V",	OD_FLOAT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getConverterVoltageIn,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5000, 0x02,	"WATCH",	"WATCH",	"VOLTAGE_OUT",	"V",	OD_FLOAT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getConverterVoltageOut,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5000, 0x03,	"WATCH",	"WATCH",	"CURRENT_IN",	"A",	OD_FLOAT32,	OD_ACCESS_RW,	OD_NO_DIRECT_ACCESS,	od::getConverterCurrentIn,	od::setConverterCurrentIn) \
+X(0x5000, 0x04,	"WATCH",	"WATCH",	"TEMP_HEATSINK",	"°C",	OD_FLOAT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getConverterTempHeatsink,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5000, 0x05,	"WATCH",	"WATCH",	"VOLTAGE_CELL_MIN",	"",	OD_FLOAT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellMinVoltage,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5000, 0x06,	"WATCH",	"WATCH",	"BATTERY_CHARGE",	"%",	OD_FLOAT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getBatteryCharge,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5000, 0x07,	"WATCH",	"WATCH",	"CELL_MIN_IDX",	"",	OD_UINT16,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellMinVoltageIdx,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5001, 0x01,	"WATCH",	"FUELCELL_BUS",	"REC",	"",	OD_UINT16,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellBusRec,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5001, 0x02,	"WATCH",	"FUELCELL_BUS",	"ERROR_STATE",	"",	OD_UINT16,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellBusErrorState,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5001, 0x04,	"WATCH",	"FUELCELL_BUS",	"TX_FRAMES",	"",	OD_UINT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellBusTxFrames,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5001, 0x06,	"WATCH",	"FUELCELL_BUS",	"RX_FRAMES",	"",	OD_UINT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellBusRxFrames,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5001, 0x07,	"WATCH",	"FUELCELL_BUS",	"RX_ERRORS",	"",	OD_UINT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellBusRxErrors,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5001, 0x08,	"WATCH",	"FUELCELL_BUS",	"ERR_SOF",	"",	OD_UINT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellBusErrSof,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5001, 0x09,	"WATCH",	"FUELCELL_BUS",	"ERR_SRR",	"",	OD_UINT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellBusErrSrr,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5001, 0x0A,	"WATCH",	"FUELCELL_BUS",	"ERR_R0",	"",	OD_UINT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellBusErrR0,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5001, 0x0B,	"WATCH",	"FUELCELL_BUS",	"ERR_CRC",	"",	OD_UINT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellBusErrCrc,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5001, 0x0C,	"WATCH",	"FUELCELL_BUS",	"ERR_STUFF",	"",	OD_UINT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellBusErrStuff,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5001, 0x0D,	"WATCH",	"FUELCELL_BUS",	"ERR_INVALID_ID",	"",	OD_UINT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellBusErrInvalidId,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5001, 0x0E,	"WATCH",	"FUELCELL_BUS",	"ERR_UNKNOWN_NODE",	"",	OD_UINT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellBusErrUnknownNode,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5001, 0x0F,	"WATCH",	"FUELCELL_BUS",	"CMD_COUNT",	"",	OD_UINT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellBusCmdCount,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5001, 0x10,	"WATCH",	"FUELCELL_BUS",	"CMD_LATENCY",	"ms",	OD_UINT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellBusCmdLatency,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5001, 0x11,	"WATCH",	"FUELCELL_BUS",	"TX_RETRIES",	"",	OD_UINT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellBusTxRetries,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5001, 0x12,	"WATCH",	"FUELCELL_BUS",	"CLK_LOAD",	"%",	OD_FLOAT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellBusClkLoad,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5002, 0x00,	"WATCH",	"FUELCELL_BUS",	"NODE_SELECT",	"",	OD_UINT16,	OD_ACCESS_RW,	OD_NO_DIRECT_ACCESS,	od::getFuelcellNodeSelected,	od::setFuelcellNodeSelected) \
+X(0x5002, 0x01,	"WATCH",	"FUELCELL_BUS",	"NODE_FRAME_RATE",	"1/s",	OD_FLOAT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellNodeFrameRate,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5002, 0x02,	"WATCH",	"FUELCELL_BUS",	"NODE_ERROR_RATE",	"1/s",	OD_FLOAT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellNodeErrorRate,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5003, 0x00,	"WATCH",	"FUELCELL_NODE",	"TEMPERATURE",	"°C",	OD_FLOAT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellNodeTemperature,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5003, 0x01,	"WATCH",	"FUELCELL_NODE",	"VOLTAGE_CELL",	"V",	OD_FLOAT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellNodeCellVoltage,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5003, 0x02,	"WATCH",	"FUELCELL_NODE",	"VOLTAGE_BATT",	"V",	OD_FLOAT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellNodeBattVoltage,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5003, 0x03,	"WATCH",	"FUELCELL_NODE",	"CURRENT",	"A",	OD_FLOAT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellNodeCurrent,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5003, 0x04,	"WATCH",	"FUELCELL_NODE",	"STATUS",	"",	OD_UINT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellNodeStatus,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5003, 0x05,	"WATCH",	"FUELCELL_NODE",	"INTERVAL_MIN",	"ms",	OD_UINT16,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellNodeIntervalMin,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5003, 0x06,	"WATCH",	"FUELCELL_NODE",	"INTERVAL_AVG",	"ms",	OD_UINT16,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellNodeIntervalAvg,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5003, 0x07,	"WATCH",	"FUELCELL_NODE",	"INTERVAL_MAX",	"ms",	OD_UINT16,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellNodeIntervalMax,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5004, 0x00,	"WATCH",	"FUELCELL_NODE",	"INTERVAL_0_2MS",	"",	OD_UINT16,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellNodeIntervalHistogram<0>,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5004, 0x01,	"WATCH",	"FUELCELL_NODE",	"INTERVAL_2_4MS",	"",	OD_UINT16,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellNodeIntervalHistogram<1>,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5004, 0x02,	"WATCH",	"FUELCELL_NODE",	"INTERVAL_4_8MS",	"",	OD_UINT16,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellNodeIntervalHistogram<2>,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5004, 0x03,	"WATCH",	"FUELCELL_NODE",	"INTERVAL_8_16MS",	"",	OD_UINT16,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellNodeIntervalHistogram<3>,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5004, 0x04,	"WATCH",	"FUELCELL_NODE",	"INTERVAL_16_32MS",	"",	OD_UINT16,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellNodeIntervalHistogram<4>,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5004, 0x05,	"WATCH",	"FUELCELL_NODE",	"INTERVAL_32_64MS",	"",	OD_UINT16,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellNodeIntervalHistogram<5>,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5004, 0x06,	"WATCH",	"FUELCELL_NODE",	"INTERVAL_64_128MS",	"",	OD_UINT16,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellNodeIntervalHistogram<6>,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5004, 0x07,	"WATCH",	"FUELCELL_NODE",	"INTERVAL_128_256MS",	"",	OD_UINT16,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellNodeIntervalHistogram<7>,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5004, 0x08,	"WATCH",	"FUELCELL_NODE",	"INTERVAL_256_512MS",	"",	OD_UINT16,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellNodeIntervalHistogram<8>,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5004, 0x09,	"WATCH",	"FUELCELL_NODE",	"INTERVAL_512_1024MS",	"",	OD_UINT16,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellNodeIntervalHistogram<9>,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5004, 0x0A,	"WATCH",	"FUELCELL_NODE",	"INTERVAL_1024_2048MS",	"",	OD_UINT16,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellNodeIntervalHistogram<10>,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5004, 0x0B,	"WATCH",	"FUELCELL_NODE",	"INTERVAL_2048MS_INF",	"",	OD_UINT16,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellNodeIntervalHistogram<11>,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5005, 0x00,	"WATCH",	"SYSLOG",	"ERROR_SELECT",	"",	OD_UINT16,	OD_ACCESS_RW,	OD_NO_DIRECT_ACCESS,	od::getSyslogErrorSelected,	od::setSyslogErrorSelected) \
+X(0x5005, 0x01,	"WATCH",	"SYSLOG",	"ERROR_COUNT",	"",	OD_UINT16,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getSyslogErrorCount,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5005, 0x02,	"WATCH",	"SYSLOG",	"ERROR_LAST_SET",	"ms",	OD_UINT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getSyslogErrorLastSet,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5005, 0x03,	"WATCH",	"SYSLOG",	"ERROR_LAST_CLEARED",	"ms",	OD_UINT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getSyslogErrorLastCleared,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5005, 0x04,	"WATCH",	"SYSLOG",	"ERROR_RATE",	"1/min",	OD_FLOAT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getSyslogErrorRate,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5005, 0x05,	"WATCH",	"SYSLOG",	"ERROR_SEVERITY",	"",	OD_UINT16,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getSyslogErrorSeverity,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5006, 0x00,	"WATCH",	"UCANOPEN",	"RX_QUEUE_SELECT",	"",	OD_UINT16,	OD_ACCESS_RW,	OD_NO_DIRECT_ACCESS,	od::getRxQueueSelected,	od::setRxQueueSelected) \
+X(0x5006, 0x01,	"WATCH",	"UCANOPEN",	"RX_QUEUE_DEPTH",	"",	OD_UINT16,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getRxQueueDepth,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5006, 0x02,	"WATCH",	"UCANOPEN",	"RX_QUEUE_HIGH_WATER",	"",	OD_UINT16,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getRxQueueHighWater,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5006, 0x03,	"WATCH",	"UCANOPEN",	"RX_QUEUE_OVERFLOWS",	"",	OD_UINT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getRxQueueOverflowCount,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5FFF, 0x00,	"SYSTEM",	"INFO",	"FIRMWARE_VERSION",	"",	OD_UINT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getSoftwareVersion,	OD_NO_INDIRECT_WRITE_ACCESS) \
+X(0x5FFF, 0x01,	"SYSTEM",	"INFO",	"BUILD_CONFIGURATION",	"",	OD_STRING,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getBuildConfiguration,	OD_NO_INDIRECT_WRITE_ACCESS)
+
+
+/// Entry positions in OBJECT_DICTIONARY
+enum ODEntryPosition
+{
+#define OD_ENTRY_POSITION(index, subindex, category, subcategory, name, unit, dataType, accessRight, dataPtr, readAccessFunc, writeAccessFunc) \
+	OD_POSITION_##index##_##subindex,
+	OBJECT_DICTIONARY_TABLE(OD_ENTRY_POSITION)
+#undef OD_ENTRY_POSITION
+	OD_POSITION_END
+};
 
-{{0x2000, 0x00}, {"SYSTEM", "SYSLOG", "SYSLOG_MSG", "", OD_UINT32, OD_ACCESS_RO, OD_NO_DIRECT_ACCESS, od::getSyslogMessage, OD_NO_INDIRECT_WRITE_ACCESS}},
 
+extern const ODEntry OBJECT_DICTIONARY[] = {
+#define OD_ENTRY(index, subindex, category, subcategory, name, unit, dataType, accessRight, dataPtr, readAccessFunc, writeAccessFunc) \
+	{{index, subindex}, {category, subcategory, name, unit, dataType, accessRight, dataPtr, readAccessFunc, writeAccessFunc}},
+	OBJECT_DICTIONARY_TABLE(OD_ENTRY)
+#undef OD_ENTRY
+};
 
-{{0x5000, 0x00}, {"WATCH", "WATCH", "UPTIME",		"s",	OD_FLOAT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getUptime,			OD_NO_INDIRECT_WRITE_ACCESS}},
-{{0x5000, 0x01}, {"WATCH", "WATCH", "VOLTAGE_IN",	"V",	OD_FLOAT32, 	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getConverterVoltageIn,	OD_NO_INDIRECT_WRITE_ACCESS}},
-{{0x5000, 0x02}, {"WATCH", "WATCH", "VOLTAGE_OUT",	"V",	OD_FLOAT32, 	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getConverterVoltageOut,	OD_NO_INDIRECT_WRITE_ACCESS}},
-{{0x5000, 0x03}, {"WATCH", "WATCH", "CURRENT_IN",	"A",	OD_FLOAT32, 	OD_ACCESS_RW,	OD_NO_DIRECT_ACCESS,	od::getConverterCurrentIn,	od::setConverterCurrentIn}},
-{{0x5000, 0x04}, {"WATCH", "WATCH", "TEMP_HEATSINK",	"°C",	OD_FLOAT32, 	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getConverterTempHeatsink,	OD_NO_INDIRECT_WRITE_ACCESS}},
-{{0x5000, 0x05}, {"WATCH", "WATCH", "VOLTAGE_CELL_MIN",	"",	OD_FLOAT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getFuelcellMinVoltage,	OD_NO_INDIRECT_WRITE_ACCESS}},
-{{0x5000, 0x06}, {"WATCH", "WATCH", "BATTERY_CHARGE",	"%",	OD_FLOAT32,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::getBatteryCharge,		OD_NO_INDIRECT_WRITE_ACCESS}},
+extern const size_t OD_SIZE = sizeof(OBJECT_DICTIONARY) / sizeof(OBJECT_DICTIONARY[0]);
+extern const ODEntry* const OBJECT_DICTIONARY_END = OBJECT_DICTIONARY + OD_SIZE;
+EMB_STATIC_ASSERT(OD_POSITION_END == sizeof(OBJECT_DICTIONARY) / sizeof(OBJECT_DICTIONARY[0]));
 
-{{0x2001, 0x00}, {"CONVERTER", 	"CONVERTER",	"RELAY ON",	"",	OD_TASK,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::converterRelayOn,	OD_NO_INDIRECT_WRITE_ACCESS}},
-{{0x2001, 0x01}, {"CONVERTER",	"CONVERTER",	"RELAY OFF",	"",	OD_TASK,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::converterRelayOff,	OD_NO_INDIRECT_WRITE_ACCESS}},
 
-{{0x2002, 0x00}, {"SYSCTL", 	"SYSCTL",	"RESET DEVICE",	"",	OD_TASK,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::resetDevice,	OD_NO_INDIRECT_WRITE_ACCESS}},
-{{0x2002, 0x01}, {"SYSCTL", 	"SYSCTL",	"RESET FAULTS",	"",	OD_TASK, 	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::resetAllFaults,	OD_NO_INDIRECT_WRITE_ACCESS}},
-{{0x2002, 0x02}, {"SYSCTL", 	"SYSCTL", 	"SHUTDOWN", 	"",	OD_TASK, 	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::shutdown,		OD_NO_INDIRECT_WRITE_ACCESS}},
-{{0x2002, 0x03}, {"SYSCTL",	"SYSCTL",	"STARTUP",	"",	OD_TASK,	OD_ACCESS_RO,	OD_NO_DIRECT_ACCESS,	od::startup,		OD_NO_INDIRECT_WRITE_ACCESS}},
+///
+///
+///
+const ODEntry* findODEntry(uint32_t index, uint32_t subindex)
+{
+	if (subindex > 0xFF)
+	{
+		return OBJECT_DICTIONARY_END;
+	}
+
+	switch ((index << 8) | subindex)
+	{
+#define OD_ENTRY_CASE(index, subindex, category, subcategory, name, unit, dataType, accessRight, dataPtr, readAccessFunc, writeAccessFunc) \
+	case ((index##UL << 8) | subindex): return &OBJECT_DICTIONARY[OD_POSITION_##index##_##subindex];
+	OBJECT_DICTIONARY_TABLE(OD_ENTRY_CASE)
+#undef OD_ENTRY_CASE
+	default:
+		return OBJECT_DICTIONARY_END;
+	}
+}
+
+
+/**
+ * Domains of OD_STRING and OD_DOMAIN entries, sorted by {index, subindex}:
+ * X(index, subindex, openFunc, readFunc).
+ */
+#define OBJECT_DICTIONARY_DOMAIN_TABLE(X) \
+X(0x1008, 0x00,	od::openDeviceName,	od::readDeviceName) \
+X(0x2000, 0x05,	od::openSyslogSnapshot,	od::readSyslogSnapshot) \
+X(0x5FFF, 0x01,	od::openBuildConfiguration,	od::readBuildConfiguration)
+
+
+/// Domain positions in OD_DOMAINS
+enum ODDomainPosition
+{
+#define OD_DOMAIN_POSITION(index, subindex, openFunc, readFunc) \
+	OD_DOMAIN_POSITION_##index##_##subindex,
+	OBJECT_DICTIONARY_DOMAIN_TABLE(OD_DOMAIN_POSITION)
+#undef OD_DOMAIN_POSITION
+	OD_DOMAIN_POSITION_END
 };
 
-extern const size_t OD_SIZE = sizeof(OBJECT_DICTIONARY) / sizeof(OBJECT_DICTIONARY[0]);
-extern ODEntry* OBJECT_DICTIONARY_END = OBJECT_DICTIONARY + OD_SIZE;
+
+extern const ODDomain OD_DOMAINS[] = {
+#define OD_DOMAIN(index, subindex, openFunc, readFunc) \
+	{index, subindex, openFunc, readFunc},
+	OBJECT_DICTIONARY_DOMAIN_TABLE(OD_DOMAIN)
+#undef OD_DOMAIN
+};
+
+extern const size_t OD_DOMAIN_COUNT = sizeof(OD_DOMAINS) / sizeof(OD_DOMAINS[0]);
+EMB_STATIC_ASSERT(OD_DOMAIN_POSITION_END == sizeof(OD_DOMAINS) / sizeof(OD_DOMAINS[0]));
+
+
+///
+///
+///
+const ODDomain* findODDomain(uint32_t index, uint32_t subindex)
+{
+	if (subindex > 0xFF)
+	{
+		return static_cast<const ODDomain*>(NULL);
+	}
+
+	switch ((index << 8) | subindex)
+	{
+#define OD_DOMAIN_CASE(index, subindex, openFunc, readFunc) \
+	case ((index##UL << 8) | subindex): return &OD_DOMAINS[OD_DOMAIN_POSITION_##index##_##subindex];
+	OBJECT_DICTIONARY_DOMAIN_TABLE(OD_DOMAIN_CASE)
+#undef OD_DOMAIN_CASE
+	default:
+		return static_cast<const ODDomain*>(NULL);
+	}
+}
+
+
 }
 
 
@@ -13,6 +13,7 @@
 #include "device.h"
 
 #include "../ucanopen_def.h"
+#include "../ucanopen_rxqueue.h"
 #include "emb/emb_math.h"
 #include "mcu/system/mcu_system.h"
 #include "mcu/cputimers/mcu_cputimers.h"
@@ -28,9 +29,9 @@ namespace ucanopen {
 
 /**
  * @ingroup ucanopen_od
- * @brief uCANopen object dictionary
+ * @brief uCANopen object dictionary, sorted by {index, subindex} at compile time
  */
-extern ODEntry OBJECT_DICTIONARY[];
+extern const ODEntry OBJECT_DICTIONARY[];
 
 /**
  * @ingroup ucanopen_od
@@ -42,7 +43,37 @@ extern const size_t OD_SIZE;
  * @ingroup ucanopen_od
  * @brief Pointer to uCANopen object dictionary end.
  */
-extern ODEntry* OBJECT_DICTIONARY_END;
+extern const ODEntry* const OBJECT_DICTIONARY_END;
+
+/**
+ * @ingroup ucanopen_od
+ * @brief Finds OD-entry by compile-time generated switch over entry keys, no initialization is required.
+ * @param index - entry index
+ * @param subindex - entry subindex
+ * @return Pointer to OD-entry if it is found, OBJECT_DICTIONARY_END otherwise.
+ */
+const ODEntry* findODEntry(uint32_t index, uint32_t subindex);
+
+/**
+ * @ingroup ucanopen_od
+ * @brief Domains of multi-byte OD-entries, sorted by {index, subindex}
+ */
+extern const ODDomain OD_DOMAINS[];
+
+/**
+ * @ingroup ucanopen_od
+ * @brief Number of domains
+ */
+extern const size_t OD_DOMAIN_COUNT;
+
+/**
+ * @ingroup ucanopen_od
+ * @brief Finds domain of OD-entry that is transferred by segmented or block SDO.
+ * @param index - entry index
+ * @param subindex - entry subindex
+ * @return Pointer to domain if it is found, NULL otherwise.
+ */
+const ODDomain* findODDomain(uint32_t index, uint32_t subindex);
 
 namespace od {
 /// @addtogroup ucanopen_od
@@ -14,13 +14,14 @@
 #include "device.h"
 
 #include <string.h>
-#include <algorithm>
 #include "../ucanopen_def.h"
 #include "../objectdictionary/objectdictionary.h"
 #include "emb/emb_common.h"
 #include "emb/emb_algorithm.h"
 #include "mcu/can/mcu_can.h"
 #include "mcu/ipc/mcu_ipc.h"
+#include "mcu/cputimers/mcu_cputimers.h"
+#include "sdotransfer.h"
 
 // APP-SPECIFIC headers
 #include "sys/syslog/syslog.h"
@@ -58,6 +59,9 @@ private:
 	/// Data-storage for IPC
 	static CobSdo* s_tsdoData;
 
+	/// Segmented or block transfer in progress
+	SdoTransfer m_transfer;
+
 private:
 	SdoService(const SdoService& other);			// no copy constructor
 	SdoService& operator=(const SdoService& other);		// no copy assignment operator
@@ -139,53 +143,6 @@ public:
 		// APP-SPECIFIC BEGIN
 		od::converter = converter;
 		// APP-SPECIFIC END
-
-		std::sort(OBJECT_DICTIONARY, OBJECT_DICTIONARY_END);
-
-		// Check OBJECT DICTIONARY correctness
-		for (size_t i = 0; i < OD_SIZE; ++i)
-		{
-			// OD is sorted
-			if (i < (OD_SIZE - 1))
-			{
-				assert(OBJECT_DICTIONARY[i] < OBJECT_DICTIONARY[i+1]);
-			}
-
-			for (size_t j = i+1; j < OD_SIZE; ++j)
-			{
-				// no od-entries with equal {index, subinex}
-				assert((OBJECT_DICTIONARY[i].key.index != OBJECT_DICTIONARY[j].key.index)
-					|| (OBJECT_DICTIONARY[i].key.subindex != OBJECT_DICTIONARY[j].key.subindex));
-
-				// no od-entries with equal {category, subcategory, name}
-				bool categoryEqual = ((strcmp(OBJECT_DICTIONARY[i].value.category, OBJECT_DICTIONARY[j].value.category) == 0) ? true : false);
-				bool subcategoryEqual = ((strcmp(OBJECT_DICTIONARY[i].value.subcategory, OBJECT_DICTIONARY[j].value.subcategory) == 0) ? true : false);
-				bool nameEqual = ((strcmp(OBJECT_DICTIONARY[i].value.name, OBJECT_DICTIONARY[j].value.name) == 0) ? true : false);
-				assert(!categoryEqual || !subcategoryEqual || !nameEqual);
-			}
-
-			if (OBJECT_DICTIONARY[i].hasReadAccess())
-			{
-				assert((OBJECT_DICTIONARY[i].value.readAccessFunc != OD_NO_INDIRECT_READ_ACCESS)
-						|| (OBJECT_DICTIONARY[i].value.dataPtr != OD_NO_DIRECT_ACCESS));
-			}
-			else
-			{
-				assert(OBJECT_DICTIONARY[i].value.readAccessFunc == OD_NO_INDIRECT_READ_ACCESS
-						&& (OBJECT_DICTIONARY[i].value.dataPtr == OD_NO_DIRECT_ACCESS));
-			}
-
-			if (OBJECT_DICTIONARY[i].hasWriteAccess())
-			{
-				assert(OBJECT_DICTIONARY[i].value.writeAccessFunc != OD_NO_INDIRECT_WRITE_ACCESS
-						|| (OBJECT_DICTIONARY[i].value.dataPtr != OD_NO_DIRECT_ACCESS));
-			}
-			else
-			{
-				assert(OBJECT_DICTIONARY[i].value.writeAccessFunc == OD_NO_INDIRECT_WRITE_ACCESS
-						&& (OBJECT_DICTIONARY[i].value.dataPtr == OD_NO_DIRECT_ACCESS));
-			}
-		}
 	}
 
 public:
@@ -201,7 +158,14 @@ public:
 	}
 
 	/**
-	 * @brief Saves RSDO messages and generates IPC signal. Used by Server's ISR as callback.
+	 * @brief Checks if previous RSDO is consumed, so that next RSDO can be passed to processRsdo().
+	 * @param (none)
+	 * @return \c true if service is ready for next RSDO, \c false otherwise.
+	 */
+	bool isReadyForRsdo() const { return !mcu::isLocalIpcFlagSet(RSDO_RECEIVED.local); }
+
+	/**
+	 * @brief Saves RSDO messages and generates IPC signal. Used by Server's run() for RSDOs queued by ISR.
 	 * @param rawMsg - RSDO message raw data
 	 * @return (none)
 	 */
@@ -228,32 +192,51 @@ public:
 	static const CobSdo& tsdoData() { return *s_tsdoData; }
 
 	/**
-	 * @brief Checks if there is new RSDO message and processes it. Used by Server's run().
+	 * @brief Checks if there is new RSDO message and processes it, makes next segment of block upload
+	 * if there is no request. Produces at most one TSDO per call. Used by Server's run().
 	 * @param (none)
 	 * @return (none)
 	 */
 	void processRequest()
 	{
-		if (!mcu::isIpcFlagSet(RSDO_RECEIVED, Ipc)) return;
+		if (mcu::isLocalIpcFlagSet(TSDO_READY.local)) return;	// previous TSDO is not sent yet
 
-		_processRequest(*s_rsdoData, *s_tsdoData);
+		if (mcu::isIpcFlagSet(RSDO_RECEIVED, Ipc))
+		{
+			_processRequest(*s_rsdoData, *s_tsdoData);
+			mcu::resetIpcFlag(RSDO_RECEIVED, Ipc);
+			return;
+		}
 
-		mcu::resetIpcFlag(RSDO_RECEIVED, Ipc);
+		uint64_t timeNow = mcu::SystemClock::now();
+		if (m_transfer.makeSegment(*s_tsdoData, timeNow)
+				|| m_transfer.checkTimeout(*s_tsdoData, timeNow))
+		{
+			mcu::setLocalIpcFlag(TSDO_READY.local);
+		}
 	}
 
 private:
 	/**
-	 * @brief Processes RSDO and creates TSDO.
+	 * @brief Processes RSDO and creates TSDO. Requests of segmented and block transfers are passed to SdoTransfer.
 	 * @param rsdo - reference to CobSdo structure where SDO request is located
 	 * @param tsdo - reference to CobSdo structure where SDO response should be placed
 	 * @return (none)
 	 */
 	void _processRequest(const CobSdo& rsdo, CobSdo& tsdo)
 	{
+		if (m_transfer.accepts(rsdo))
+		{
+			if (m_transfer.processRequest(rsdo, tsdo, mcu::SystemClock::now()))
+			{
+				mcu::setLocalIpcFlag(TSDO_READY.local);
+			}
+			return;
+		}
+
 		ODAccessStatus status = OD_ACCESS_NO_ACCESS;
 
-		const ODEntry* odEntry = emb::binary_find(OBJECT_DICTIONARY, OBJECT_DICTIONARY_END,
-				ODEntryKeyAux(rsdo.index, rsdo.subindex));
+		const ODEntry* odEntry = findODEntry(rsdo.index, rsdo.subindex);
 
 		if (odEntry == OBJECT_DICTIONARY_END)
 		{
@@ -262,30 +245,11 @@ private:
 
 		if (rsdo.cs == SDO_CCS_READ)
 		{
-			if ((odEntry->value.dataPtr != OD_NO_DIRECT_ACCESS)
-					&& odEntry->hasReadAccess())
-			{
-				tsdo.data.u32 = 0;
-				memcpy(&tsdo.data.u32, odEntry->value.dataPtr, ODEntryDataSizes[odEntry->value.dataType]);
-				status = OD_ACCESS_SUCCESS;
-			}
-			else
-			{
-				status = odEntry->value.readAccessFunc(tsdo.data);
-			}
+			status = odEntry->read(tsdo.data);
 		}
 		else if (rsdo.cs == SDO_CCS_WRITE)
 		{
-			if ((odEntry->value.dataPtr != OD_NO_DIRECT_ACCESS)
-					&& odEntry->hasWriteAccess())
-			{
-				memcpy(odEntry->value.dataPtr, &rsdo.data.u32, ODEntryDataSizes[odEntry->value.dataType]);
-				status = OD_ACCESS_SUCCESS;
-			}
-			else
-			{
-				status = odEntry->value.writeAccessFunc(rsdo.data);
-			}
+			status = odEntry->write(rsdo.data);
 		}
 		else
 		{
@@ -0,0 +1,629 @@
+/**
+ * @file
+ * @ingroup ucanopen ucanopen_sdo_service
+ */
+
+
+#include "sdotransfer.h"
+
+
+namespace ucanopen {
+
+
+/**
+ * @brief Makes SDO frame: command byte, index (or two bytes of block transfer parameters), subindex and data.
+ */
+static CobSdo makeFrame(uint32_t command, uint32_t index, uint32_t subindex, uint32_t data)
+{
+	uint64_t raw = static_cast<uint64_t>(command & 0x00FF)
+			| (static_cast<uint64_t>(index & 0xFFFF) << 8)
+			| (static_cast<uint64_t>(subindex & 0x00FF) << 24)
+			| (static_cast<uint64_t>(data) << 32);
+	return CobSdo(raw);
+}
+
+
+///
+///
+///
+void SdoTransfer::reset()
+{
+	m_state = IDLE;
+	m_index = 0;
+	m_subindex = 0;
+	m_entry = OBJECT_DICTIONARY_END;
+	m_domain = static_cast<const ODDomain*>(NULL);
+	m_value.u32 = 0;
+	m_size = 0;
+	m_sizeIndicated = false;
+	m_offset = 0;
+	m_toggle = 0;
+	m_blockSize = 0;
+	m_seqno = 0;
+	m_blockOffset = 0;
+	m_lastSegment = false;
+	m_crcEnabled = false;
+	m_crc = 0;
+}
+
+
+///
+///
+///
+bool SdoTransfer::accepts(const CobSdo& rsdo) const
+{
+	if (m_state == BLOCK_DOWNLOAD)
+	{
+		return true;	// requests are block segments, their first byte is sequence number
+	}
+
+	switch (rsdo.cs)
+	{
+	case SDO_CCS_READ:
+		return findODDomain(rsdo.index, rsdo.subindex) != NULL;
+	case SDO_CCS_WRITE:
+		// requests without size indication are expedited, existing clients don't set e-bit
+		return (rsdo.expeditedTransfer == 0) && (rsdo.dataSizeIndicated == 1);
+	case SDO_CCS_DOWNLOAD_SEGMENT:
+	case SDO_CCS_UPLOAD_SEGMENT:
+	case SDO_CS_ABORT:
+	case SDO_CCS_BLOCK_UPLOAD:
+	case SDO_CCS_BLOCK_DOWNLOAD:
+		return true;
+	default:
+		return false;
+	}
+}
+
+
+///
+///
+///
+bool SdoTransfer::processRequest(const CobSdo& rsdo, CobSdo& tsdo, uint64_t timeNow)
+{
+	m_timestamp = timeNow;
+
+	if (m_state == BLOCK_DOWNLOAD)
+	{
+		return _blockDownloadSegment(rsdo, tsdo);
+	}
+
+	switch (rsdo.cs)
+	{
+	case SDO_CCS_READ:
+		return _initiateUpload(rsdo, tsdo);
+	case SDO_CCS_UPLOAD_SEGMENT:
+		return _uploadSegment(rsdo, tsdo);
+	case SDO_CCS_WRITE:
+		return _initiateDownload(rsdo, tsdo);
+	case SDO_CCS_DOWNLOAD_SEGMENT:
+		return _downloadSegment(rsdo, tsdo);
+	case SDO_CCS_BLOCK_UPLOAD:
+		return _blockUpload(rsdo, tsdo);
+	case SDO_CCS_BLOCK_DOWNLOAD:
+		return _blockDownload(rsdo, tsdo);
+	case SDO_CS_ABORT:
+		reset();
+		return false;
+	default:
+		return _abort(tsdo, SDO_ABORT_INVALID_CS);
+	}
+}
+
+
+///
+///
+///
+bool SdoTransfer::makeSegment(CobSdo& tsdo, uint64_t timeNow)
+{
+	if (m_state != BLOCK_UPLOAD_STREAMING)
+	{
+		return false;
+	}
+
+	m_timestamp = timeNow;
+	++m_seqno;
+	uint32_t offset = m_blockOffset + (m_seqno - 1) * SDO_SEGMENT_DATA_SIZE;
+	uint32_t count = ((m_size - offset) > SDO_SEGMENT_DATA_SIZE) ? SDO_SEGMENT_DATA_SIZE : (m_size - offset);
+	m_lastSegment = ((offset + count) == m_size);
+
+	uint64_t command = (m_lastSegment ? 0x80 : 0x00) | m_seqno;
+	tsdo = CobSdo(command | _segmentData(offset, count));
+
+	if (m_lastSegment || (m_seqno == m_blockSize))
+	{
+		m_state = BLOCK_UPLOAD_WAIT_ACK;
+	}
+	return true;
+}
+
+
+///
+///
+///
+bool SdoTransfer::checkTimeout(CobSdo& tsdo, uint64_t timeNow)
+{
+	if ((m_state == IDLE) || (m_state == BLOCK_UPLOAD_STREAMING))
+	{
+		return false;
+	}
+
+	if ((timeNow - m_timestamp) <= TIMEOUT)
+	{
+		return false;
+	}
+
+	return _abort(tsdo, SDO_ABORT_TIMEOUT);
+}
+
+
+///
+///
+///
+uint32_t SdoTransfer::_open(const CobSdo& rsdo, bool upload)
+{
+	m_index = rsdo.index;
+	m_subindex = rsdo.subindex;
+	m_entry = findODEntry(m_index, m_subindex);
+	if (m_entry == OBJECT_DICTIONARY_END)
+	{
+		return SDO_ABORT_OBJECT_NOT_FOUND;
+	}
+
+	if (!upload)
+	{
+		// domains are read-only, downloaded data is written to regular OD-entry
+		return m_entry->hasWriteAccess() ? 0 : SDO_ABORT_READ_ONLY;
+	}
+
+	if (!m_entry->hasReadAccess())
+	{
+		return SDO_ABORT_WRITE_ONLY;
+	}
+
+	m_domain = findODDomain(m_index, m_subindex);
+	if (m_domain != NULL)
+	{
+		m_size = m_domain->open();
+		return 0;
+	}
+
+	if (m_entry->read(m_value) != OD_ACCESS_SUCCESS)
+	{
+		return SDO_ABORT_TRANSFER_FAILED;
+	}
+	m_size = 4;	// as in expedited response
+	return 0;
+}
+
+
+///
+///
+///
+uint16_t SdoTransfer::_readByte(uint32_t offset) const
+{
+	if (m_domain != NULL)
+	{
+		return m_domain->read(offset) & 0x00FF;
+	}
+	return static_cast<uint16_t>(m_value.u32 >> (8 * offset)) & 0x00FF;
+}
+
+
+///
+///
+///
+uint64_t SdoTransfer::_segmentData(uint32_t offset, uint32_t count) const
+{
+	uint64_t data = 0;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		data |= static_cast<uint64_t>(_readByte(offset + i)) << (8 * (i + 1));
+	}
+	return data;
+}
+
+
+///
+///
+///
+bool SdoTransfer::_abort(CobSdo& tsdo, uint32_t code)
+{
+	tsdo = makeFrame(SDO_CS_ABORT << 5, m_index, m_subindex, code);
+	reset();
+	return true;
+}
+
+
+///
+///
+///
+bool SdoTransfer::_initiateUpload(const CobSdo& rsdo, CobSdo& tsdo)
+{
+	reset();
+	uint32_t abortCode = _open(rsdo, true);
+	if (abortCode != 0)
+	{
+		return _abort(tsdo, abortCode);
+	}
+
+	if (m_size <= 4)
+	{
+		// short data is sent by expedited response
+		uint32_t data = 0;
+		for (uint32_t i = 0; i < m_size; ++i)
+		{
+			data |= static_cast<uint32_t>(_readByte(i)) << (8 * i);
+		}
+		tsdo = makeFrame((SDO_SCS_READ << 5) | ((4 - m_size) << 2) | 0x03, m_index, m_subindex, data);
+		reset();
+		return true;
+	}
+
+	m_state = SEGMENTED_UPLOAD;
+	tsdo = makeFrame((SDO_SCS_READ << 5) | 0x01, m_index, m_subindex, m_size);	// size is indicated
+	return true;
+}
+
+
+///
+///
+///
+bool SdoTransfer::_uploadSegment(const CobSdo& rsdo, CobSdo& tsdo)
+{
+	if (m_state != SEGMENTED_UPLOAD)
+	{
+		return _abort(tsdo, SDO_ABORT_INVALID_CS);
+	}
+
+	uint16_t toggle = (rsdo.byte(0) >> 4) & 0x01;
+	if (toggle != m_toggle)
+	{
+		return _abort(tsdo, SDO_ABORT_TOGGLE_BIT);
+	}
+
+	uint32_t count = ((m_size - m_offset) > SDO_SEGMENT_DATA_SIZE) ? SDO_SEGMENT_DATA_SIZE : (m_size - m_offset);
+	bool last = ((m_offset + count) == m_size);
+
+	uint64_t command = (SDO_SCS_UPLOAD_SEGMENT << 5) | (toggle << 4) | ((SDO_SEGMENT_DATA_SIZE - count) << 1) | (last ? 1 : 0);
+	tsdo = CobSdo(command | _segmentData(m_offset, count));
+
+	if (last)
+	{
+		reset();
+		return true;
+	}
+
+	m_offset += count;
+	m_toggle ^= 1;
+	return true;
+}
+
+
+///
+///
+///
+bool SdoTransfer::_initiateDownload(const CobSdo& rsdo, CobSdo& tsdo)
+{
+	reset();
+	uint32_t abortCode = _open(rsdo, false);
+	if (abortCode != 0)
+	{
+		return _abort(tsdo, abortCode);
+	}
+
+	if (rsdo.data.u32 > DOWNLOAD_CAPACITY)
+	{
+		return _abort(tsdo, SDO_ABORT_LENGTH_TOO_HIGH);
+	}
+
+	m_size = rsdo.data.u32;
+	m_sizeIndicated = true;
+	m_state = SEGMENTED_DOWNLOAD;
+	tsdo = makeFrame(SDO_SCS_WRITE << 5, m_index, m_subindex, 0);
+	return true;
+}
+
+
+///
+///
+///
+bool SdoTransfer::_downloadSegment(const CobSdo& rsdo, CobSdo& tsdo)
+{
+	if (m_state != SEGMENTED_DOWNLOAD)
+	{
+		return _abort(tsdo, SDO_ABORT_INVALID_CS);
+	}
+
+	uint16_t command = rsdo.byte(0);
+	uint16_t toggle = (command >> 4) & 0x01;
+	if (toggle != m_toggle)
+	{
+		return _abort(tsdo, SDO_ABORT_TOGGLE_BIT);
+	}
+
+	uint32_t count = SDO_SEGMENT_DATA_SIZE - ((command >> 1) & 0x07);
+	if ((m_offset + count) > DOWNLOAD_CAPACITY)
+	{
+		return _abort(tsdo, SDO_ABORT_LENGTH_TOO_HIGH);
+	}
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		m_value.u32 |= static_cast<uint32_t>(rsdo.byte(1 + i)) << (8 * (m_offset + i));
+	}
+	m_offset += count;
+
+	bool last = (command & 0x01) != 0;
+	if (last)
+	{
+		uint32_t abortCode = _completeDownload(m_offset);
+		if (abortCode != 0)
+		{
+			return _abort(tsdo, abortCode);
+		}
+	}
+
+	tsdo = CobSdo(static_cast<uint64_t>((SDO_SCS_DOWNLOAD_SEGMENT << 5) | (toggle << 4)));
+
+	if (last)
+	{
+		reset();
+		return true;
+	}
+
+	m_toggle ^= 1;
+	return true;
+}
+
+
+///
+///
+///
+bool SdoTransfer::_blockUpload(const CobSdo& rsdo, CobSdo& tsdo)
+{
+	uint16_t command = rsdo.byte(0);
+
+	switch (command & 0x03)
+	{
+	case SDO_BLOCK_INITIATE:
+	{
+		reset();
+		uint32_t abortCode = _open(rsdo, true);
+		if (abortCode != 0)
+		{
+			return _abort(tsdo, abortCode);
+		}
+
+		m_blockSize = rsdo.byte(4);
+		if ((m_blockSize == 0) || (m_blockSize > SDO_BLOCK_SIZE_MAX))
+		{
+			return _abort(tsdo, SDO_ABORT_INVALID_BLOCK_SIZE);
+		}
+
+		m_crcEnabled = (command & 0x04) != 0;
+		m_state = BLOCK_UPLOAD_INITIATED;
+		// server supports CRC, size is indicated
+		tsdo = makeFrame((SDO_SCS_BLOCK_UPLOAD << 5) | 0x04 | 0x02 | SDO_BLOCK_INITIATE, m_index, m_subindex, m_size);
+		return true;
+	}
+
+	case SDO_BLOCK_START:
+		if (m_state != BLOCK_UPLOAD_INITIATED)
+		{
+			return _abort(tsdo, SDO_ABORT_INVALID_CS);
+		}
+		m_state = BLOCK_UPLOAD_STREAMING;	// segments are made by makeSegment()
+		return false;
+
+	case SDO_BLOCK_ACK:
+	{
+		if (m_state != BLOCK_UPLOAD_WAIT_ACK)
+		{
+			return _abort(tsdo, SDO_ABORT_INVALID_CS);
+		}
+
+		uint16_t ackseq = rsdo.byte(1);
+		uint16_t blockSize = rsdo.byte(2);
+		if (ackseq > m_seqno)
+		{
+			return _abort(tsdo, SDO_ABORT_INVALID_SEQNO);
+		}
+		if ((blockSize == 0) || (blockSize > SDO_BLOCK_SIZE_MAX))
+		{
+			return _abort(tsdo, SDO_ABORT_INVALID_BLOCK_SIZE);
+		}
+
+		// CRC is calculated over acknowledged data, segments after ackseq are sent again in next block
+		uint32_t ackedOffset = m_blockOffset + ackseq * SDO_SEGMENT_DATA_SIZE;
+		if (ackedOffset > m_size)
+		{
+			ackedOffset = m_size;
+		}
+		for (uint32_t i = m_blockOffset; i < ackedOffset; ++i)
+		{
+			m_crc = updateSdoCrc(m_crc, _readByte(i));
+		}
+
+		bool completed = m_lastSegment && (ackseq == m_seqno);
+		m_offset = ackedOffset;
+		m_blockOffset = ackedOffset;
+		m_blockSize = blockSize;
+		m_seqno = 0;
+		m_lastSegment = false;
+
+		if (!completed)
+		{
+			m_state = BLOCK_UPLOAD_STREAMING;
+			return false;
+		}
+
+		// n - number of bytes in last segment that don't contain data
+		uint32_t lastCount = m_size % SDO_SEGMENT_DATA_SIZE;
+		if ((lastCount == 0) && (m_size != 0))
+		{
+			lastCount = SDO_SEGMENT_DATA_SIZE;
+		}
+		uint32_t n = SDO_SEGMENT_DATA_SIZE - lastCount;
+		m_state = BLOCK_UPLOAD_END;
+		tsdo = makeFrame((SDO_SCS_BLOCK_UPLOAD << 5) | (n << 2) | SDO_BLOCK_END, m_crcEnabled ? m_crc : 0, 0, 0);
+		return true;
+	}
+
+	case SDO_BLOCK_END:
+		if (m_state != BLOCK_UPLOAD_END)
+		{
+			return _abort(tsdo, SDO_ABORT_INVALID_CS);
+		}
+		reset();
+		return false;
+	}
+
+	return false;
+}
+
+
+///
+///
+///
+bool SdoTransfer::_blockDownload(const CobSdo& rsdo, CobSdo& tsdo)
+{
+	uint16_t command = rsdo.byte(0);
+
+	if ((command & 0x01) == SDO_BLOCK_INITIATE)
+	{
+		reset();
+		uint32_t abortCode = _open(rsdo, false);
+		if (abortCode != 0)
+		{
+			return _abort(tsdo, abortCode);
+		}
+
+		m_sizeIndicated = (command & 0x02) != 0;
+		m_size = m_sizeIndicated ? rsdo.data.u32 : 0;
+		if (m_size > DOWNLOAD_CAPACITY)
+		{
+			return _abort(tsdo, SDO_ABORT_LENGTH_TOO_HIGH);
+		}
+
+		m_crcEnabled = (command & 0x04) != 0;
+		m_blockSize = SDO_BLOCK_SIZE_MAX;
+		m_state = BLOCK_DOWNLOAD;
+		// server supports CRC
+		tsdo = makeFrame((SDO_SCS_BLOCK_DOWNLOAD << 5) | 0x04 | SDO_BLOCK_INITIATE, m_index, m_subindex, m_blockSize);
+		return true;
+	}
+
+	if (m_state != BLOCK_DOWNLOAD_END)
+	{
+		return _abort(tsdo, SDO_ABORT_INVALID_CS);
+	}
+
+	// n - number of bytes in last segment that don't contain data
+	uint32_t size = m_offset - ((command >> 2) & 0x07);
+	if (size > DOWNLOAD_CAPACITY)
+	{
+		return _abort(tsdo, SDO_ABORT_LENGTH_TOO_HIGH);
+	}
+
+	if (size < 4)
+	{
+		m_value.u32 &= (1UL << (8 * size)) - 1;		// last segment padding
+	}
+
+	if (m_crcEnabled)
+	{
+		uint16_t crc = 0;
+		for (uint32_t i = 0; i < size; ++i)
+		{
+			crc = updateSdoCrc(crc, static_cast<uint16_t>(m_value.u32 >> (8 * i)));
+		}
+		if (crc != (rsdo.byte(1) | (rsdo.byte(2) << 8)))
+		{
+			return _abort(tsdo, SDO_ABORT_CRC_ERROR);
+		}
+	}
+
+	uint32_t abortCode = _completeDownload(size);
+	if (abortCode != 0)
+	{
+		return _abort(tsdo, abortCode);
+	}
+
+	tsdo = CobSdo(static_cast<uint64_t>((SDO_SCS_BLOCK_DOWNLOAD << 5) | SDO_BLOCK_END));
+	reset();
+	return true;
+}
+
+
+///
+///
+///
+bool SdoTransfer::_blockDownloadSegment(const CobSdo& rsdo, CobSdo& tsdo)
+{
+	uint16_t command = rsdo.byte(0);
+	if (command == (SDO_CS_ABORT << 5))
+	{
+		reset();	// segment sequence numbers start from 1, so it is abort request
+		return false;
+	}
+
+	uint16_t seqno = command & 0x7F;
+	bool last = (command & 0x80) != 0;
+	bool completed = false;
+
+	if (seqno == (m_seqno + 1))
+	{
+		if (m_offset >= DOWNLOAD_CAPACITY)
+		{
+			return _abort(tsdo, SDO_ABORT_LENGTH_TOO_HIGH);	// segment contains at least one byte of data
+		}
+		for (uint32_t i = 0; i < SDO_SEGMENT_DATA_SIZE; ++i)
+		{
+			if ((m_offset + i) < DOWNLOAD_CAPACITY)
+			{
+				m_value.u32 |= static_cast<uint32_t>(rsdo.byte(1 + i)) << (8 * (m_offset + i));
+			}
+		}
+		m_offset += SDO_SEGMENT_DATA_SIZE;
+		m_seqno = seqno;
+		completed = last;
+	}
+	// segments after lost one are ignored until end of block, client sends them again after acknowledge
+
+	if (!last && (seqno != m_blockSize))
+	{
+		return false;
+	}
+
+	tsdo = makeFrame((SDO_SCS_BLOCK_DOWNLOAD << 5) | SDO_BLOCK_ACK, m_seqno | (m_blockSize << 8), 0, 0);
+	m_seqno = 0;
+	if (completed)
+	{
+		m_state = BLOCK_DOWNLOAD_END;
+	}
+	return true;
+}
+
+
+///
+///
+///
+uint32_t SdoTransfer::_completeDownload(uint32_t size)
+{
+	if (m_sizeIndicated && (size != m_size))
+	{
+		return SDO_ABORT_LENGTH_MISMATCH;
+	}
+
+	if (m_entry->write(m_value) != OD_ACCESS_SUCCESS)
+	{
+		return SDO_ABORT_TRANSFER_FAILED;
+	}
+	return 0;
+}
+
+
+} // namespace ucanopen
+
+
@@ -0,0 +1,138 @@
+/**
+ * @file
+ * @ingroup ucanopen ucanopen_sdo_service
+ */
+
+
+#pragma once
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../ucanopen_def.h"
+#include "../objectdictionary/objectdictionary.h"
+
+
+namespace ucanopen {
+/// @addtogroup ucanopen_sdo_service
+/// @{
+
+
+/**
+ * @brief Server side of SDO segmented and block transfers (CiA 301). Transfer advances by one frame per call:
+ * requests are processed by processRequest(), block upload segments are produced by makeSegment() while
+ * there are no requests, so transfer never blocks Server's run().
+ */
+class SdoTransfer
+{
+public:
+	/// Transfer is aborted if client doesn't respond within this time, ms
+	static const uint32_t TIMEOUT = 1000;
+	/// Max size of downloaded data, downloads are written to regular OD-entries
+	static const size_t DOWNLOAD_CAPACITY = 4;
+
+private:
+	enum State
+	{
+		IDLE,
+		SEGMENTED_UPLOAD,
+		SEGMENTED_DOWNLOAD,
+		BLOCK_UPLOAD_INITIATED,
+		BLOCK_UPLOAD_STREAMING,
+		BLOCK_UPLOAD_WAIT_ACK,
+		BLOCK_UPLOAD_END,
+		BLOCK_DOWNLOAD,
+		BLOCK_DOWNLOAD_END
+	};
+
+	State m_state;
+	uint64_t m_timestamp;		// time of last request or sent segment, ms
+
+	uint32_t m_index;
+	uint32_t m_subindex;
+	const ODEntry* m_entry;
+	const ODDomain* m_domain;	// NULL - data of regular OD-entry is transferred through m_value
+	CobSdoData m_value;
+
+	uint32_t m_size;		// data size, bytes
+	bool m_sizeIndicated;
+	uint32_t m_offset;		// number of transferred bytes
+	uint16_t m_toggle;
+
+	uint16_t m_blockSize;
+	uint16_t m_seqno;		// last sent or correctly received segment of block
+	uint32_t m_blockOffset;		// offset of first segment of block
+	bool m_lastSegment;		// last segment of data is sent in block
+	bool m_crcEnabled;
+	uint16_t m_crc;
+
+public:
+	SdoTransfer() : m_timestamp(0) { reset(); }
+
+	/**
+	 * @brief Cancels transfer without notifying client.
+	 * @param (none)
+	 * @return (none)
+	 */
+	void reset();
+
+	/**
+	 * @brief Checks if request belongs to segmented or block transfer and must be processed by processRequest().
+	 * @param rsdo - SDO request
+	 * @return \c true if request must be processed by processRequest(), \c false if it is expedited request.
+	 */
+	bool accepts(const CobSdo& rsdo) const;
+
+	/**
+	 * @brief Processes request of segmented or block transfer.
+	 * @param rsdo - SDO request
+	 * @param tsdo - SDO response
+	 * @param timeNow - current time, ms
+	 * @return \c true if response must be sent, \c false otherwise.
+	 */
+	bool processRequest(const CobSdo& rsdo, CobSdo& tsdo, uint64_t timeNow);
+
+	/**
+	 * @brief Makes next segment of block upload.
+	 * @param tsdo - segment
+	 * @param timeNow - current time, ms
+	 * @return \c true if segment must be sent, \c false if there is no segment to send.
+	 */
+	bool makeSegment(CobSdo& tsdo, uint64_t timeNow);
+
+	/**
+	 * @brief Aborts transfer if client doesn't respond.
+	 * @param tsdo - abort message
+	 * @param timeNow - current time, ms
+	 * @return \c true if transfer is aborted and abort message must be sent, \c false otherwise.
+	 */
+	bool checkTimeout(CobSdo& tsdo, uint64_t timeNow);
+
+	/**
+	 * @brief Checks if transfer is in progress.
+	 * @param (none)
+	 * @return \c true if transfer is in progress, \c false otherwise.
+	 */
+	bool active() const { return m_state != IDLE; }
+
+private:
+	uint32_t _open(const CobSdo& rsdo, bool upload);
+	uint16_t _readByte(uint32_t offset) const;
+	uint64_t _segmentData(uint32_t offset, uint32_t count) const;
+	bool _abort(CobSdo& tsdo, uint32_t code);
+
+	bool _initiateUpload(const CobSdo& rsdo, CobSdo& tsdo);
+	bool _uploadSegment(const CobSdo& rsdo, CobSdo& tsdo);
+	bool _initiateDownload(const CobSdo& rsdo, CobSdo& tsdo);
+	bool _downloadSegment(const CobSdo& rsdo, CobSdo& tsdo);
+	bool _blockUpload(const CobSdo& rsdo, CobSdo& tsdo);
+	bool _blockDownload(const CobSdo& rsdo, CobSdo& tsdo);
+	bool _blockDownloadSegment(const CobSdo& rsdo, CobSdo& tsdo);
+	uint32_t _completeDownload(uint32_t size);
+};
+
+
+/// @}
+} // namespace ucanopen
+
+
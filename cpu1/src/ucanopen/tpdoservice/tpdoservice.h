@@ -263,8 +263,8 @@ public:
 		case UCANOPEN_CAN1:
 			saveState(msg, converter->state());
 			saveRunStatus(msg, converter->pwm.state());
-			saveErrorStatus(msg, Syslog::errors());
-			saveWarningStatus(msg, Syslog::warnings());
+			saveErrorStatus(msg, Syslog::hasErrors());
+			saveWarningStatus(msg, Syslog::hasWarnings());
 			// TODO tpdoService.saveOverheatStatus(msg,
 			//saveReferenceType(msg, TPDO_DRIVE(Module, Ipc, Mode)->model.reference());
 			//saveControlLoopType(msg, TPDO_DRIVE(Module, Ipc, Mode)->model.controlLoopType());
@@ -378,8 +378,8 @@ public:
 		switch (Module)
 		{
 		case UCANOPEN_CAN1:
-			saveFaults(msg, Syslog::errors());
-			saveWarnings(msg, Syslog::warnings());
+			saveFaults(msg, Syslog::errors(0));		// TPDO4 carries first mask word: errors 0-31
+			saveWarnings(msg, Syslog::warnings(0));
 			break;
 		case UCANOPEN_CAN2:
 			// FIXME fuel cell emulation
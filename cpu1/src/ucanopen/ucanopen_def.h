@@ -180,6 +180,8 @@ struct CobSdo
 		memcpy(&data, this, sizeof(CobSdo));
 		return data;
 	}
+	/// Returns frame byte, frames of segmented and block transfers don't match bit fields
+	uint16_t byte(size_t pos) const { return static_cast<uint16_t>(all() >> (8 * pos)) & 0x00FF; }
 };
 
 
@@ -188,6 +190,59 @@ const uint32_t SDO_CCS_WRITE = 1;
 const uint32_t SDO_SCS_WRITE = 3;
 const uint32_t SDO_CCS_READ = 2;
 const uint32_t SDO_SCS_READ = 2;
+const uint32_t SDO_CCS_DOWNLOAD_SEGMENT = 0;
+const uint32_t SDO_SCS_DOWNLOAD_SEGMENT = 1;
+const uint32_t SDO_CCS_UPLOAD_SEGMENT = 3;
+const uint32_t SDO_SCS_UPLOAD_SEGMENT = 0;
+const uint32_t SDO_CS_ABORT = 4;
+const uint32_t SDO_CCS_BLOCK_UPLOAD = 5;
+const uint32_t SDO_SCS_BLOCK_UPLOAD = 6;
+const uint32_t SDO_CCS_BLOCK_DOWNLOAD = 6;
+const uint32_t SDO_SCS_BLOCK_DOWNLOAD = 5;
+
+
+/// SDO block transfer subcommands, bits 1..0 of command byte
+const uint16_t SDO_BLOCK_INITIATE = 0;
+const uint16_t SDO_BLOCK_END = 1;
+const uint16_t SDO_BLOCK_ACK = 2;
+const uint16_t SDO_BLOCK_START = 3;
+
+
+/// Max number of segments in block, number of data bytes in segment
+const uint16_t SDO_BLOCK_SIZE_MAX = 127;
+const size_t SDO_SEGMENT_DATA_SIZE = 7;
+
+
+/// SDO abort codes
+const uint32_t SDO_ABORT_TOGGLE_BIT = 0x05030000;
+const uint32_t SDO_ABORT_TIMEOUT = 0x05040000;
+const uint32_t SDO_ABORT_INVALID_CS = 0x05040001;
+const uint32_t SDO_ABORT_INVALID_BLOCK_SIZE = 0x05040002;
+const uint32_t SDO_ABORT_INVALID_SEQNO = 0x05040003;
+const uint32_t SDO_ABORT_CRC_ERROR = 0x05040004;
+const uint32_t SDO_ABORT_WRITE_ONLY = 0x06010001;
+const uint32_t SDO_ABORT_READ_ONLY = 0x06010002;
+const uint32_t SDO_ABORT_OBJECT_NOT_FOUND = 0x06020000;
+const uint32_t SDO_ABORT_LENGTH_MISMATCH = 0x06070010;
+const uint32_t SDO_ABORT_LENGTH_TOO_HIGH = 0x06070012;
+const uint32_t SDO_ABORT_TRANSFER_FAILED = 0x08000020;
+
+
+/**
+ * @brief Updates CRC of SDO block transfer (CRC-16-CCITT: polynomial 0x1021, initial value 0).
+ * @param crc - CRC value
+ * @param byte - data byte
+ * @return Updated CRC value.
+ */
+inline uint16_t updateSdoCrc(uint16_t crc, uint16_t byte)
+{
+	crc ^= (byte & 0x00FF) << 8;
+	for (int i = 0; i < 8; ++i)
+	{
+		crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+	}
+	return crc & 0xFFFF;
+}
 
 
 /// OD access possible statuses
@@ -210,7 +265,8 @@ enum ODEntryDataType
 	OD_FLOAT32,
 	OD_ENUM16,
 	OD_TASK,
-	OD_STRING
+	OD_STRING,
+	OD_DOMAIN
 };
 
 
@@ -224,8 +280,8 @@ enum ODEntryAccessRight
 
 
 /// OD entry data types sizes
-const size_t ODEntryDataSizes[9] = {sizeof(bool), sizeof(int16_t), sizeof(int32_t),
-		sizeof(uint16_t), sizeof(uint32_t), sizeof(float), sizeof(uint16_t), 0, 0};
+const size_t ODEntryDataSizes[10] = {sizeof(bool), sizeof(int16_t), sizeof(int32_t),
+		sizeof(uint16_t), sizeof(uint32_t), sizeof(float), sizeof(uint16_t), 0, 0, 0};
 
 
 /**
@@ -283,6 +339,39 @@ struct ODEntry
 	{
 		return (value.accessRight == OD_ACCESS_RW) || (value.accessRight == OD_ACCESS_WO);
 	}
+
+
+	/**
+	 * @brief Reads OD-entry data through pointer or access function.
+	 * @param dest - data destination
+	 * @return Status of access.
+	 */
+	ODAccessStatus read(CobSdoData& dest) const
+	{
+		if ((value.dataPtr != static_cast<uint32_t*>(NULL)) && hasReadAccess())
+		{
+			dest.u32 = 0;
+			memcpy(&dest.u32, value.dataPtr, ODEntryDataSizes[value.dataType]);
+			return OD_ACCESS_SUCCESS;
+		}
+		return value.readAccessFunc(dest);
+	}
+
+
+	/**
+	 * @brief Writes OD-entry data through pointer or access function.
+	 * @param val - data
+	 * @return Status of access.
+	 */
+	ODAccessStatus write(CobSdoData val) const
+	{
+		if ((value.dataPtr != static_cast<uint32_t*>(NULL)) && hasWriteAccess())
+		{
+			memcpy(value.dataPtr, &val.u32, ODEntryDataSizes[value.dataType]);
+			return OD_ACCESS_SUCCESS;
+		}
+		return value.writeAccessFunc(val);
+	}
 };
 
 
@@ -317,6 +406,18 @@ inline bool operator==(const ODEntryKeyAux& lhs, const ODEntry& rhs)
 }
 
 
+/**
+ * @brief Access to OD-entry data that doesn't fit into expedited SDO, data is read by segmented or block upload.
+ */
+struct ODDomain
+{
+	uint32_t index;
+	uint32_t subindex;
+	size_t (*open)();			// prepares data for upload, returns data size in bytes
+	uint16_t (*read)(size_t offset);	// returns data byte
+};
+
+
 /// Used in OD-entries which doesn't have direct access to data through pointer.
 #define OD_NO_DIRECT_ACCESS static_cast<uint32_t*>(NULL)
 
@@ -0,0 +1,20 @@
+/**
+ * @file
+ * @ingroup ucanopen ucanopen_server
+ */
+
+
+#include "ucanopen_rxqueue.h"
+
+
+namespace ucanopen {
+
+
+// both ISR and run() that drain queues are executed by CAN master CPU, so queues are not shared
+RxQueues can1RxQueues;
+RxQueues can2RxQueues;
+
+
+} // namespace ucanopen
+
+
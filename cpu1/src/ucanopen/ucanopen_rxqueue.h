@@ -0,0 +1,136 @@
+/**
+ * @file
+ * @ingroup ucanopen ucanopen_server
+ */
+
+
+#pragma once
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include "emb/emb_common.h"
+#include "emb/emb_spscqueue.h"
+#include "ucanopen_def.h"
+
+
+namespace ucanopen {
+/// @addtogroup ucanopen_server
+/// @{
+
+
+/// Number of received COB types that are queued: RPDO1..RPDO4, RSDO
+const size_t RDO_COUNT = 5;
+
+
+/**
+ * @brief RX queue statistics of received COB type.
+ */
+struct RxQueueStats
+{
+	uint16_t depth;			// frames waiting for processing
+	uint16_t highWater;		// max depth since init
+	uint32_t overflowCount;		// frames lost because queue was full
+};
+
+
+/**
+ * @brief Per-COB lock-free RX FIFOs between Server's CAN ISR (producer) and Server's run() (consumer).
+ * Bursts of frames are queued instead of overwriting unprocessed ones.
+ */
+class RxQueues
+{
+public:
+	/// Queue depth of each COB type, frames
+	static const size_t CAPACITY = 16;
+	typedef emb::SpscQueue<uint64_t, CAPACITY> Queue;
+
+private:
+	Queue::ProducerData m_producerData[RDO_COUNT];
+	Queue::ConsumerData m_consumerData[RDO_COUNT];
+	volatile uint16_t m_highWater[RDO_COUNT];	// written only by producer
+
+	Queue _queue(size_t rdoIdx) const
+	{
+		return Queue(const_cast<Queue::ProducerData*>(&m_producerData[rdoIdx]),
+				const_cast<Queue::ConsumerData*>(&m_consumerData[rdoIdx]));
+	}
+
+public:
+	/**
+	 * @brief Returns queue index of received COB type.
+	 * @param rdo - RPDO1..RPDO4 or RSDO
+	 * @return Queue index.
+	 */
+	static size_t rdoIndex(uint32_t rdo) { return (rdo - static_cast<uint32_t>(RPDO1)) / 2; }
+
+	/**
+	 * @brief Empties all queues and resets statistics. Must be called before CAN interrupts are enabled.
+	 * @param (none)
+	 * @return (none)
+	 */
+	void init()
+	{
+		for (size_t i = 0; i < RDO_COUNT; ++i)
+		{
+			Queue queue = _queue(i);
+			queue.initProducer();
+			queue.initConsumer();
+			m_highWater[i] = 0;
+		}
+	}
+
+	/**
+	 * @brief Appends received frame. Must be called only by CAN ISR.
+	 * @param rdoIdx - queue index
+	 * @param rawMsg - frame raw data
+	 * @return \c true if frame is appended, \c false if queue is full and frame is lost.
+	 */
+	bool push(size_t rdoIdx, uint64_t rawMsg)
+	{
+		Queue queue = _queue(rdoIdx);
+		if (!queue.push(rawMsg))
+		{
+			return false;
+		}
+		uint16_t depth = queue.size();
+		if (depth > m_highWater[rdoIdx])
+		{
+			m_highWater[rdoIdx] = depth;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Removes oldest received frame. Must be called only by Server's run().
+	 * @param rdoIdx - queue index
+	 * @param rawMsg - frame raw data
+	 * @return \c true if frame is removed, \c false if queue is empty.
+	 */
+	bool pop(size_t rdoIdx, uint64_t& rawMsg) { return _queue(rdoIdx).pop(rawMsg); }
+
+	/**
+	 * @brief Returns queue statistics.
+	 * @param rdoIdx - queue index
+	 * @return Queue statistics.
+	 */
+	RxQueueStats stats(size_t rdoIdx) const
+	{
+		Queue queue = _queue(rdoIdx);
+		RxQueueStats stats;
+		stats.depth = queue.size();
+		stats.highWater = m_highWater[rdoIdx];
+		stats.overflowCount = queue.overflowCount();
+		return stats;
+	}
+};
+
+
+extern RxQueues can1RxQueues;
+extern RxQueues can2RxQueues;
+
+
+/// @}
+} // namespace ucanopen
+
+
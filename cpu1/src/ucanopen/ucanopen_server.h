@@ -16,6 +16,7 @@
 #include "mcu/ipc/mcu_ipc.h"
 #include "mcu/cputimers/mcu_cputimers.h"
 #include "ucanopen_def.h"
+#include "ucanopen_rxqueue.h"
 #include "rpdoservice/rpdoservice.h"
 #include "tpdoservice/tpdoservice.h"
 #include "sdoservice/sdoservice.h"
@@ -63,8 +64,8 @@ private:
 	uint64_t m_heartbeatPeriod;
 	emb::Array<uint64_t, 4> m_tpdoPeriods;
 
-	// signals from ISR
-	emb::Array<bool, 5> m_hasRawRdo;
+	// frames received by ISR
+	RxQueues* m_rxQueues;
 
 	// IPC flags
 	mcu::IpcFlag RPDO1_RECEIVED;
@@ -90,6 +91,7 @@ public:
 		, m_rpdoService(rpdoService)
 		, m_tpdoService(tpdoService)
 		, m_sdoService(sdoService)
+		, m_rxQueues(static_cast<RxQueues*>(NULL))
 		// IPC flags
 		, RPDO1_RECEIVED(ipcFlags.RPDO1_RECEIVED)
 		, RPDO2_RECEIVED(ipcFlags.RPDO2_RECEIVED)
@@ -104,8 +106,6 @@ public:
 		rpdoService->initIpcFlags(RPDO1_RECEIVED, RPDO2_RECEIVED,
 				RPDO3_RECEIVED, RPDO4_RECEIVED);
 		sdoService->initIpcFlags(RSDO_RECEIVED, TSDO_READY);
-
-		m_hasRawRdo.fill(false);
 	}
 
 	/**
@@ -158,7 +158,16 @@ public:
 		m_heartbeatPeriod = 0;
 		m_tpdoPeriods.fill(0);
 
-		m_hasRawRdo.fill(false);
+		switch (Module)
+		{
+		case UCANOPEN_CAN1:
+			m_rxQueues = &can1RxQueues;
+			break;
+		case UCANOPEN_CAN2:
+			m_rxQueues = &can2RxQueues;
+			break;
+		}
+		m_rxQueues->init();
 
 		m_can->registerInterruptHandler(onFrameReceived);
 		m_state = PRE_OPERATIONAL;
@@ -316,6 +325,7 @@ public:
 	void sendSdoResponse()
 	{
 		if (!mcu::isIpcFlagSet(TSDO_READY, Ipc)) return;
+		if (m_can->isTxPending(TSDO)) return;	// segments of block upload are sent back-to-back
 
 		emb::c28x::to_bytes8<CobSdo>(m_msgObjects[TSDO].data, SdoService<Module, Ipc, Mode>::tsdoData());
 		m_can->send(TSDO, m_msgObjects[TSDO].data, cobDataLen[TSDO]);
@@ -324,44 +334,51 @@ public:
 	}
 
 	/**
-	 * @brief Processes raw RPDO and RSDO received by ISR.
+	 * @brief Processes raw RPDO and RSDO queued by ISR. All queued RPDOs are processed, so that the latest one
+	 * is passed to RPDO service. RSDOs are processed one per call and only when previous request is consumed
+	 * by SDO service, requests that arrive in burst wait in queue.
 	 * @param (none)
 	 * @return (none)
 	 */
 	void processRawRdo()
 	{
-		for (size_t i = 0; i < m_hasRawRdo.size(); ++i)
+		uint64_t rawMsg = 0;
+		for (size_t i = 0; i < RDO_COUNT; ++i)
 		{
-			if (m_hasRawRdo[i])
+			uint32_t rdo = 2 * i + static_cast<uint32_t>(RPDO1);
+			switch (rdo)
 			{
-				uint64_t rawMsg = 0;
-				uint32_t rdo = 2 * i + static_cast<uint32_t>(RPDO1);
-				emb::c28x::from_bytes8<uint64_t>(rawMsg, m_msgObjects[rdo].data);
-				switch (rdo)
+			case RPDO1:
+				while (m_rxQueues->pop(i, rawMsg)) { m_rpdoService->processRpdo1(rawMsg); }
+				break;
+			case RPDO2:
+				while (m_rxQueues->pop(i, rawMsg)) { m_rpdoService->processRpdo2(rawMsg); }
+				break;
+			case RPDO3:
+				while (m_rxQueues->pop(i, rawMsg)) { m_rpdoService->processRpdo3(rawMsg); }
+				break;
+			case RPDO4:
+				while (m_rxQueues->pop(i, rawMsg)) { m_rpdoService->processRpdo4(rawMsg); }
+				break;
+			case RSDO:
+				if (m_sdoService->isReadyForRsdo() && m_rxQueues->pop(i, rawMsg))
 				{
-				case RPDO1:
-					m_rpdoService->processRpdo1(rawMsg);
-					break;
-				case RPDO2:
-					m_rpdoService->processRpdo2(rawMsg);
-					break;
-				case RPDO3:
-					m_rpdoService->processRpdo3(rawMsg);
-					break;
-				case RPDO4:
-					m_rpdoService->processRpdo4(rawMsg);
-					break;
-				case RSDO:
 					m_sdoService->processRsdo(rawMsg);
-					break;
-				default:
-					break;
 				}
-				m_hasRawRdo[i] = false;
+				break;
+			default:
+				break;
 			}
 		}
 	}
 
+	/**
+	 * @brief Returns RX queue statistics of received COB type.
+	 * @param rdo - RPDO1..RPDO4 or RSDO
+	 * @return Queue statistics.
+	 */
+	RxQueueStats rxQueueStats(CobType rdo) const { return m_rxQueues->stats(RxQueues::rdoIndex(rdo)); }
+
 protected:
 	/**
 	 * @brief Initializes message objects.
@@ -467,15 +484,12 @@ protected:
 		case RPDO4:
 		case RSDO:
 		{
-			uint32_t rdoIdx = (interruptCause - static_cast<uint32_t>(RPDO1)) / 2;
-			if (!server->m_hasRawRdo[rdoIdx])
-			{
-				// there is no raw unprocessed data of this type
-				can->recv(interruptCause, server->m_msgObjects[interruptCause].data);
-				server->m_hasRawRdo[rdoIdx] = true;
-			}
-			else
+			uint64_t rawMsg = 0;
+			can->recv(interruptCause, server->m_msgObjects[interruptCause].data);
+			emb::c28x::from_bytes8<uint64_t>(rawMsg, server->m_msgObjects[interruptCause].data);
+			if (!server->m_rxQueues->push(RxQueues::rdoIndex(interruptCause), rawMsg))
 			{
+				// frames arrive faster than run() processes them
 				Syslog::setWarning(sys::Warning::CAN_BUS_OVERRUN);
 			}
 			break;
@@ -0,0 +1,342 @@
+///
+#include "canbygpio_sim.h"
+
+
+namespace canbygpio {
+
+namespace sim {
+
+
+static const unsigned int RX_IDLE_BITS = 10;
+
+
+///
+///
+///
+void Node::send(const Frame& frame, bool bitStuffingEnabled)
+{
+	m_bitCount = encodeFrame(m_stream, frame, bitStuffingEnabled);
+	m_bitIdx = 0;
+	m_tick = 0;
+	m_edgeShift = 0;
+	m_nextEdgeShift = 0;
+}
+
+
+///
+///
+///
+int Node::drive(Random& random, uint32_t jitterTicks)
+{
+	if (!busy())
+	{
+		return 1;
+	}
+
+	if (m_tick == 0)
+	{
+		// bit ends at its ideal boundary displaced by random shift
+		m_nextEdgeShift = (jitterTicks && (m_bitIdx + 1 < m_bitCount)) ? random.spread(jitterTicks) : 0;
+		m_bitTicks = uint32_t(int32_t(TICKS_PER_BIT) - m_edgeShift + m_nextEdgeShift);
+	}
+
+	int level = m_stream[m_bitIdx];
+	if (++m_tick >= m_bitTicks)
+	{
+		++m_bitIdx;
+		m_tick = 0;
+		m_edgeShift = m_nextEdgeShift;
+	}
+	return level;
+}
+
+
+///
+///
+///
+int VirtualWire::tick()
+{
+	int level = 1;
+	for (size_t i = 0; i < m_nodeCount; ++i)
+	{
+		level &= m_nodes[i]->drive(m_random, m_noise.jitterTicks);
+	}
+
+	if (m_noise.flipRate_ppm && m_random.chance(m_noise.flipRate_ppm))
+	{
+		level = 1 - level;
+	}
+	return level;
+}
+
+
+///
+///
+///
+SampledReceiver::SampledReceiver(bool bitStuffingEnabled)
+	: m_decoder(bitStuffingEnabled)
+	, m_active(false)
+	, m_prevLevel(1)
+	, m_tick(0)
+	, m_bitIdx(0)
+	, m_idleBits(0)
+	, m_resultReady(false)
+	, m_result(0)
+{}
+
+
+///
+///
+///
+void SampledReceiver::tick(int level)
+{
+	int prevLevel = m_prevLevel;
+	m_prevLevel = level;
+
+	if (!m_active)
+	{
+		if ((prevLevel == 1) && (level == 0))
+		{
+			// falling edge interrupt
+			m_decoder.reset();
+			m_active = true;
+			m_tick = 0;
+			m_bitIdx = 0;
+			m_idleBits = 0;
+		}
+		return;
+	}
+
+	if (++m_tick % TICKS_PER_BIT != TICKS_PER_BIT / 2)
+	{
+		return;
+	}
+
+	// sample point, same sequence as Transceiver::processRxBit()
+	if (m_decoder.status() == FrameDecoder::IN_PROGRESS)
+	{
+		FrameDecoder::Status status = m_decoder.push(level);
+		if ((status == FrameDecoder::COMPLETED) || (status == FrameDecoder::FAILED))
+		{
+			m_result = m_decoder.result(m_frame);
+			m_resultReady = true;
+		}
+	}
+	else
+	{
+		m_idleBits = level ? m_idleBits + 1 : 0;
+		if (m_idleBits >= RX_IDLE_BITS)
+		{
+			m_active = false;
+			return;
+		}
+	}
+
+	if (++m_bitIdx >= STREAM_SIZE_W_BIT_STUFFING)
+	{
+		m_active = false;
+	}
+}
+
+
+///
+///
+///
+bool SampledReceiver::recv(int& result, Frame& frame)
+{
+	if (!m_resultReady)
+	{
+		return false;
+	}
+	result = m_result;
+	frame = m_frame;
+	m_resultReady = false;
+	return true;
+}
+
+
+///
+///
+///
+EdgeReceiver::EdgeReceiver(bool bitStuffingEnabled)
+	: m_decoder(bitStuffingEnabled)
+	, m_active(false)
+	, m_prevLevel(1)
+	, m_interval(RX_IDLE_BITS * TICKS_PER_BIT)
+	, m_runBitsPushed(0)
+	, m_resultReady(false)
+	, m_result(0)
+{}
+
+
+///
+///
+///
+void EdgeReceiver::tick(int level)
+{
+	if (level == m_prevLevel)
+	{
+		++m_interval;
+
+		// long run without edge, same sequence as HwTimedTransceiver::_processLongRun()
+		if (m_active && (m_interval > RX_IDLE_BITS * TICKS_PER_BIT))
+		{
+			unsigned int elapsedBits = m_interval / TICKS_PER_BIT;
+			_pushRun(elapsedBits - m_runBitsPushed, level);
+			m_runBitsPushed = elapsedBits;
+		}
+		return;
+	}
+
+	// edge, same sequence as HwTimedTransceiver::_processEdge()
+	if (m_active)
+	{
+		unsigned int n = bitRunLength(m_interval, TICKS_PER_BIT);
+		_pushRun((n > m_runBitsPushed) ? n - m_runBitsPushed : 0, m_prevLevel);
+	}
+	m_runBitsPushed = 0;
+
+	if (!m_active && (m_prevLevel == 1) && (m_interval >= RX_IDLE_BITS * TICKS_PER_BIT))
+	{
+		m_decoder.reset();
+		m_active = true;
+	}
+
+	m_prevLevel = level;
+	m_interval = 1;
+}
+
+
+///
+///
+///
+void EdgeReceiver::_pushRun(unsigned int bitCount, int level)
+{
+	for (; (bitCount > 0) && m_active; --bitCount)
+	{
+		switch (m_decoder.push(level))
+		{
+		case FrameDecoder::IN_PROGRESS:
+			break;
+		case FrameDecoder::REJECTED:
+			m_active = false;
+			break;
+		case FrameDecoder::COMPLETED:
+		case FrameDecoder::FAILED:
+			m_active = false;
+			m_result = m_decoder.result(m_frame);
+			m_resultReady = true;
+			break;
+		}
+	}
+}
+
+
+///
+///
+///
+bool EdgeReceiver::recv(int& result, Frame& frame)
+{
+	if (!m_resultReady)
+	{
+		return false;
+	}
+	result = m_result;
+	frame = m_frame;
+	m_resultReady = false;
+	return true;
+}
+
+
+///
+///
+///
+static void updateStatistics(Statistics& stats, bool hasResult, int result, const Frame& rxFrame, const Frame& txFrame)
+{
+	if (!hasResult)
+	{
+		++stats.lost;
+		return;
+	}
+
+	if (result < 0)
+	{
+		++stats.errors;
+		return;
+	}
+
+	bool equal = (result == int(txFrame.len)) && (rxFrame.id == txFrame.id)
+			&& (rxFrame.extended == txFrame.extended) && (rxFrame.remote == txFrame.remote);
+	for (size_t i = 0; equal && (i < txFrame.len); ++i)
+	{
+		equal = (rxFrame.data[i] == txFrame.data[i]);
+	}
+
+	if (equal)
+	{
+		++stats.received;
+	}
+	else
+	{
+		++stats.corrupted;
+	}
+}
+
+
+///
+///
+///
+void runLoopback(size_t nodeCount, size_t framesPerNode, const NoiseConfig& noise, bool bitStuffingEnabled,
+		Statistics& sampledStats, Statistics& edgeStats)
+{
+	assert(nodeCount <= VirtualWire::MAX_NODES);
+
+	Node nodes[VirtualWire::MAX_NODES];
+	VirtualWire wire(noise, 0x2545F491);
+	for (size_t i = 0; i < nodeCount; ++i)
+	{
+		wire.attach(&nodes[i]);
+	}
+
+	SampledReceiver sampledReceiver(bitStuffingEnabled);
+	EdgeReceiver edgeReceiver(bitStuffingEnabled);
+	Random dataRandom(0x9E3779B9);
+
+	for (size_t f = 0; f < framesPerNode; ++f)
+	{
+		for (size_t n = 0; n < nodeCount; ++n)
+		{
+			Frame txFrame;
+			txFrame.id = 0x180 + n;
+			txFrame.len = 8;
+			for (size_t i = 0; i < txFrame.len; ++i)
+			{
+				txFrame.data[i] = dataRandom.next() & 0xFF;
+			}
+			nodes[n].send(txFrame, bitStuffingEnabled);
+			++sampledStats.sent;
+			++edgeStats.sent;
+
+			// frame itself ends with 14 recessive bits, a few more bits of gap cover jitter
+			uint32_t gapTicks = 2 * TICKS_PER_BIT;
+			while (nodes[n].busy() || (gapTicks-- > 0))
+			{
+				int level = wire.tick();
+				sampledReceiver.tick(level);
+				edgeReceiver.tick(level);
+			}
+
+			int result = 0;
+			Frame rxFrame;
+			bool hasResult = sampledReceiver.recv(result, rxFrame);
+			updateStatistics(sampledStats, hasResult, result, rxFrame, txFrame);
+			hasResult = edgeReceiver.recv(result, rxFrame);
+			updateStatistics(edgeStats, hasResult, result, rxFrame, txFrame);
+		}
+	}
+}
+
+
+} // namespace sim
+
+} // namespace canbygpio
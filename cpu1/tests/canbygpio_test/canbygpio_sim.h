@@ -0,0 +1,183 @@
+///
+#pragma once
+
+#include "canbygpio/canbygpio_framing.h"
+
+
+namespace canbygpio {
+
+/// Loopback simulation of CAN-by-GPIO nodes on a shared wire, used by tests and benchmarks
+namespace sim {
+
+
+/// Wire is simulated with this number of ticks per bit
+const unsigned int TICKS_PER_BIT = 8;
+
+
+/**
+ * @brief Deterministic pseudo-random generator (xorshift32).
+ */
+class Random
+{
+private:
+	uint32_t m_state;
+public:
+	explicit Random(uint32_t seed) : m_state(seed ? seed : 1) {}
+
+	uint32_t next()
+	{
+		m_state ^= (m_state << 13) & 0xFFFFFFFF;
+		m_state ^= m_state >> 17;
+		m_state ^= (m_state << 5) & 0xFFFFFFFF;
+		return m_state;
+	}
+
+	/// Returns true with given probability in ppm
+	bool chance(uint32_t ppm) { return (next() % 1000000) < ppm; }
+
+	/// Returns value in range [-range, range]
+	int32_t spread(uint32_t range) { return int32_t(next() % (2 * range + 1)) - int32_t(range); }
+};
+
+
+/**
+ * @brief Wire noise config.
+ */
+struct NoiseConfig
+{
+	uint32_t flipRate_ppm;		// probability of inverted tick
+	uint32_t jitterTicks;		// max displacement of TX bit edges
+};
+
+
+/**
+ * @brief Transmitting node: drives wire with stream produced by encodeFrame().
+ */
+class Node
+{
+private:
+	BitStream m_stream;
+	size_t m_bitCount;
+	size_t m_bitIdx;
+	uint32_t m_tick;
+	uint32_t m_bitTicks;
+	int32_t m_edgeShift;
+	int32_t m_nextEdgeShift;
+public:
+	Node() : m_bitCount(0), m_bitIdx(0), m_tick(0), m_bitTicks(0), m_edgeShift(0), m_nextEdgeShift(0) {}
+
+	void send(const Frame& frame, bool bitStuffingEnabled);
+	bool busy() const { return m_bitIdx < m_bitCount; }
+	int drive(Random& random, uint32_t jitterTicks);
+};
+
+
+/**
+ * @brief Shared wire with wired-AND semantics: dominant (0) level of any node wins.
+ */
+class VirtualWire
+{
+public:
+	static const size_t MAX_NODES = 4;
+private:
+	Node* m_nodes[MAX_NODES];
+	size_t m_nodeCount;
+	NoiseConfig m_noise;
+	Random m_random;
+public:
+	VirtualWire(const NoiseConfig& noise, uint32_t seed)
+		: m_nodeCount(0)
+		, m_noise(noise)
+		, m_random(seed)
+	{}
+
+	void attach(Node* node)
+	{
+		assert(m_nodeCount < MAX_NODES);
+		m_nodes[m_nodeCount++] = node;
+	}
+
+	/// Advances wire by one tick, returns wire level during this tick
+	int tick();
+};
+
+
+/**
+ * @brief Receiver mirroring canbygpio::Transceiver: sync on falling edge,
+ * then wire is sampled in the middle of each bit, frame ends after decoding and bus idle.
+ */
+class SampledReceiver
+{
+private:
+	FrameDecoder m_decoder;
+	bool m_active;
+	int m_prevLevel;
+	uint32_t m_tick;
+	size_t m_bitIdx;
+	unsigned int m_idleBits;
+	bool m_resultReady;
+	int m_result;
+	Frame m_frame;
+public:
+	explicit SampledReceiver(bool bitStuffingEnabled);
+	void tick(int level);
+	bool recv(int& result, Frame& frame);
+};
+
+
+/**
+ * @brief Receiver mirroring canbygpio::HwTimedTransceiver: edges are timestamped,
+ * intervals between them are converted to bit runs.
+ */
+class EdgeReceiver
+{
+private:
+	FrameDecoder m_decoder;
+	bool m_active;
+	int m_prevLevel;
+	uint32_t m_interval;
+	unsigned int m_runBitsPushed;
+	bool m_resultReady;
+	int m_result;
+	Frame m_frame;
+public:
+	explicit EdgeReceiver(bool bitStuffingEnabled);
+	void tick(int level);
+	bool recv(int& result, Frame& frame);
+private:
+	void _pushRun(unsigned int bitCount, int level);
+};
+
+
+/**
+ * @brief Simulation results.
+ */
+struct Statistics
+{
+	uint32_t sent;
+	uint32_t received;	// decoded and equal to sent frame
+	uint32_t errors;	// decoding errors
+	uint32_t corrupted;	// decoded but not equal to sent frame
+	uint32_t lost;		// no result at all
+
+	Statistics() : sent(0), received(0), errors(0), corrupted(0), lost(0) {}
+};
+
+
+/**
+ * @brief Runs loopback simulation: nodes send frames in turn, both receivers listen to the wire.
+ * @param nodeCount - number of transmitting nodes
+ * @param framesPerNode - number of frames sent by each node
+ * @param noise - wire noise config
+ * @param bitStuffingEnabled - bit stuffing flag
+ * @param sampledStats - results of SampledReceiver
+ * @param edgeStats - results of EdgeReceiver
+ * @return (none)
+ */
+void runLoopback(size_t nodeCount, size_t framesPerNode, const NoiseConfig& noise, bool bitStuffingEnabled,
+		Statistics& sampledStats, Statistics& edgeStats);
+
+
+} // namespace sim
+
+} // namespace canbygpio
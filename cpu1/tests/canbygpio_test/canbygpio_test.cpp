@@ -0,0 +1,403 @@
+///
+#include "canbygpio_test.h"
+#include "canbygpio_sim.h"
+
+
+namespace canbygpio {
+
+static BitStream stream;
+
+///
+///
+///
+void CanByGpioTest::FramingTest()
+{
+	Frame frame;
+	const uint16_t data[8] = {0x00, 0xFF, 0xA5, 0x5A, 0x01, 0x80, 0xFF, 0x00};
+
+	// all-dominant header gives zero CRC
+	size_t bitCount = encodeFrame(stream, Frame(0x000, data, 0), false);
+	EMB_ASSERT_EQUAL(bitCount, 19 + 15 + 1 + 14);
+	for (size_t i = 0; i < 34; ++i)
+	{
+		EMB_ASSERT_EQUAL(stream[i], 0);
+	}
+	EMB_ASSERT_EQUAL(stream[34], 1);
+
+	bitCount = encodeFrame(stream, Frame(0x000, data, 0), true);
+	EMB_ASSERT_EQUAL(stream[5], 1);		// stuff bit
+	EMB_ASSERT_EQUAL(stream[6], 0);
+
+	// round trip
+	for (int stuffing = 0; stuffing < 2; ++stuffing)
+	{
+		for (size_t len = 0; len <= 8; ++len)
+		{
+			uint32_t id = 0x180 + len * 0x71;
+			bitCount = encodeFrame(stream, Frame(id, data, len), stuffing);
+			frame = Frame();
+			EMB_ASSERT_EQUAL(decodeFrame(stream, bitCount, frame, stuffing), len);
+			EMB_ASSERT_EQUAL(frame.id, id);
+			EMB_ASSERT_TRUE(!frame.extended);
+			EMB_ASSERT_TRUE(!frame.remote);
+			for (size_t i = 0; i < len; ++i)
+			{
+				EMB_ASSERT_EQUAL(frame.data[i], data[i]);
+			}
+
+			if (stuffing)
+			{
+				int sameBits = 1;
+				for (size_t i = 1; i < bitCount - 15; ++i)
+				{
+					sameBits = (stream[i] == stream[i-1]) ? sameBits + 1 : 1;
+					EMB_ASSERT_TRUE(sameBits <= 5);
+				}
+			}
+		}
+	}
+
+	// errors
+	bitCount = encodeFrame(stream, Frame(0x181, data, 8), false);
+	stream[0] = 1;
+	EMB_ASSERT_EQUAL(decodeFrame(stream, bitCount, frame, false), FRAME_ERROR_SOF);
+	stream[0] = 0;
+	stream[14] = 1;
+	EMB_ASSERT_EQUAL(decodeFrame(stream, bitCount, frame, false), FRAME_ERROR_R0);
+	stream[14] = 0;
+	stream[40] = 1 - stream[40];
+	EMB_ASSERT_EQUAL(decodeFrame(stream, bitCount, frame, false), FRAME_ERROR_CRC);
+	stream[40] = 1 - stream[40];
+	EMB_ASSERT_EQUAL(decodeFrame(stream, 50, frame, false), FRAME_ERROR_INCOMPLETE);
+
+	bitCount = encodeFrame(stream, Frame(0x000, data, 0), true);
+	stream[5] = 0;
+	EMB_ASSERT_EQUAL(decodeFrame(stream, bitCount, frame, true), FRAME_ERROR_STUFF);
+}
+
+
+///
+///
+///
+void CanByGpioTest::ExtendedFrameTest()
+{
+	const uint16_t data[8] = {0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0};
+	Frame frame;
+
+	for (int stuffing = 0; stuffing < 2; ++stuffing)
+	{
+		// extended data frame
+		Frame txFrame(0x18FF50E5UL, data, 8);
+		txFrame.extended = true;
+		size_t bitCount = encodeFrame(stream, txFrame, stuffing);
+		EMB_ASSERT_EQUAL(decodeFrame(stream, bitCount, frame, stuffing), 8);
+		EMB_ASSERT_EQUAL(frame.id, 0x18FF50E5UL);
+		EMB_ASSERT_TRUE(frame.extended);
+		EMB_ASSERT_TRUE(!frame.remote);
+		EMB_ASSERT_EQUAL(frame.data[7], 0xF0);
+
+		// extended remote frame
+		txFrame.remote = true;
+		txFrame.len = 4;
+		bitCount = encodeFrame(stream, txFrame, stuffing);
+		frame = Frame();
+		EMB_ASSERT_EQUAL(decodeFrame(stream, bitCount, frame, stuffing), 4);
+		EMB_ASSERT_TRUE(frame.extended);
+		EMB_ASSERT_TRUE(frame.remote);
+
+		// base remote frame
+		Frame rtrFrame(0x123, data, 2);
+		rtrFrame.remote = true;
+		bitCount = encodeFrame(stream, rtrFrame, stuffing);
+		if (!stuffing)
+		{
+			EMB_ASSERT_EQUAL(bitCount, 1 + 11 + 3 + 4 + 15 + 1 + 14);	// no data field
+		}
+		frame = Frame();
+		EMB_ASSERT_EQUAL(decodeFrame(stream, bitCount, frame, stuffing), 2);
+		EMB_ASSERT_EQUAL(frame.id, 0x123);
+		EMB_ASSERT_TRUE(!frame.extended);
+		EMB_ASSERT_TRUE(frame.remote);
+	}
+
+	// SRR must be recessive
+	Frame txFrame(0x1ABCDEUL, data, 1);
+	txFrame.extended = true;
+	size_t bitCount = encodeFrame(stream, txFrame, false);
+	stream[12] = 0;
+	EMB_ASSERT_EQUAL(decodeFrame(stream, bitCount, frame, false), FRAME_ERROR_SRR);
+}
+
+
+///
+///
+///
+void CanByGpioTest::AcceptanceFilterTest()
+{
+	const uint16_t data[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+	FrameDecoder decoder(false);
+	AcceptanceFilter stdFilter = {0x180, 0x7F8, false};
+	AcceptanceFilter extFilter = {0x18FF5000UL, 0x1FFFFF00UL, true};
+	EMB_ASSERT_TRUE(decoder.addFilter(stdFilter));
+	EMB_ASSERT_TRUE(decoder.addFilter(extFilter));
+
+	struct
+	{
+		uint32_t id;
+		bool extended;
+		FrameDecoder::Status status;
+		size_t rejectedAfter;
+	} cases[6] =
+	{
+		{0x180, false, FrameDecoder::COMPLETED, 0},
+		{0x187, false, FrameDecoder::COMPLETED, 0},
+		{0x188, false, FrameDecoder::REJECTED, 1 + 11 + 1 + 1},
+		{0x180, true, FrameDecoder::REJECTED, 1 + 11 + 1 + 1 + 18},
+		{0x18FF50E5UL, true, FrameDecoder::COMPLETED, 0},
+		{0x18FF51E5UL, true, FrameDecoder::REJECTED, 1 + 11 + 1 + 1 + 18}
+	};
+
+	for (size_t i = 0; i < 6; ++i)
+	{
+		Frame txFrame(cases[i].id, data, 8);
+		txFrame.extended = cases[i].extended;
+		size_t bitCount = encodeFrame(stream, txFrame, false);
+
+		decoder.reset();
+		size_t pushed = 0;
+		while ((pushed < bitCount) && (decoder.status() == FrameDecoder::IN_PROGRESS))
+		{
+			decoder.push(stream[pushed++]);
+		}
+		EMB_ASSERT_EQUAL(decoder.status(), cases[i].status);
+		if (cases[i].status == FrameDecoder::REJECTED)
+		{
+			EMB_ASSERT_EQUAL(pushed, cases[i].rejectedAfter);
+		}
+	}
+
+	decoder.clearFilters();
+	Frame txFrame(0x7FF, data, 8);
+	size_t bitCount = encodeFrame(stream, txFrame, false);
+	decoder.reset();
+	for (size_t i = 0; i < bitCount; ++i)
+	{
+		decoder.push(stream[i]);
+	}
+	EMB_ASSERT_EQUAL(decoder.status(), FrameDecoder::COMPLETED);
+}
+
+
+///
+///
+///
+void CanByGpioTest::EdgeDecodingTest()
+{
+	const uint32_t bitTicks = 1600;	// 125 kbit/s at 200 MHz
+	const int32_t jitter[4] = {0, 300, -300, 150};
+	const uint16_t data[8] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88};
+	Frame frame;
+
+	EMB_ASSERT_EQUAL(bitRunLength(bitTicks, bitTicks), 1);
+	EMB_ASSERT_EQUAL(bitRunLength(5 * bitTicks + bitTicks / 3, bitTicks), 5);
+	EMB_ASSERT_EQUAL(bitRunLength(5 * bitTicks - bitTicks / 3, bitTicks), 5);
+
+	for (int stuffing = 0; stuffing < 2; ++stuffing)
+	{
+		size_t bitCount = encodeFrame(stream, Frame(0x184, data, 8), stuffing);
+
+		// bit stream -> edge intervals with jitter -> bit runs, as done with eCAP captures
+		FrameDecoder decoder(stuffing);
+		size_t idx = 0;
+		size_t edgeCount = 0;
+		while ((idx < bitCount) && (decoder.status() == FrameDecoder::IN_PROGRESS))
+		{
+			size_t begin = idx;
+			while ((idx < bitCount) && (stream[idx] == stream[begin])) ++idx;
+			uint32_t interval = (idx - begin) * bitTicks + jitter[edgeCount++ % 4];
+
+			for (unsigned int n = bitRunLength(interval, bitTicks); n > 0; --n)
+			{
+				decoder.push(stream[begin]);
+			}
+		}
+
+		EMB_ASSERT_EQUAL(decoder.result(frame), 8);
+		EMB_ASSERT_EQUAL(frame.id, 0x184);
+		EMB_ASSERT_EQUAL(frame.data[7], 0x88);
+	}
+}
+
+
+///
+///
+///
+void CanByGpioTest::ErrorCountersTest()
+{
+	ErrorCounters errors;
+	EMB_ASSERT_EQUAL(errors.state(), ERROR_ACTIVE);
+
+	// error-passive by REC, successful RX brings REC back below limit
+	for (size_t i = 0; i < 128; ++i)
+	{
+		errors.onRxError();
+	}
+	EMB_ASSERT_EQUAL(errors.rec(), 128);
+	EMB_ASSERT_EQUAL(errors.state(), ERROR_PASSIVE);
+	errors.onRxSuccess();
+	EMB_ASSERT_EQUAL(errors.rec(), 127);
+	EMB_ASSERT_EQUAL(errors.state(), ERROR_ACTIVE);
+	for (size_t i = 0; i < 1000; ++i)
+	{
+		errors.onRxError();
+	}
+	EMB_ASSERT_EQUAL(errors.rec(), 255);
+	EMB_ASSERT_EQUAL(errors.state(), ERROR_PASSIVE);
+	EMB_ASSERT_EQUAL(errors.rxErrorCount(), 1128);
+	EMB_ASSERT_EQUAL(errors.rxFrameCount(), 1);
+
+	// TX outcome and busy transmitter are counted, but do not affect error state
+	errors.reset();
+	for (size_t i = 0; i < 128; ++i)
+	{
+		errors.onRxError();
+	}
+	for (size_t i = 0; i < 300; ++i)
+	{
+		errors.onTxSuccess();
+		errors.onTxBusy();
+	}
+	EMB_ASSERT_EQUAL(errors.txFrameCount(), 300);
+	EMB_ASSERT_EQUAL(errors.txBusyCount(), 300);
+	EMB_ASSERT_EQUAL(errors.rec(), 128);
+	EMB_ASSERT_EQUAL(errors.state(), ERROR_PASSIVE);
+	errors.reset();
+	EMB_ASSERT_EQUAL(errors.rec(), 0);
+	EMB_ASSERT_EQUAL(errors.state(), ERROR_ACTIVE);
+	EMB_ASSERT_EQUAL(errors.txFrameCount(), 0);
+	EMB_ASSERT_EQUAL(errors.txBusyCount(), 0);
+
+	// failed frame reports its ID if ID field was received
+	const uint16_t data[8] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88};
+	Frame frame;
+	size_t bitCount = encodeFrame(stream, Frame(0x183, data, 8), false);
+	stream[40] = 1 - stream[40];			// data bit
+	EMB_ASSERT_EQUAL(decodeFrame(stream, bitCount, frame, false), FRAME_ERROR_CRC);
+	EMB_ASSERT_EQUAL(frame.id, 0x183);
+	EMB_ASSERT_EQUAL(frame.len, 0);
+	stream[0] = 1;					// SOF
+	EMB_ASSERT_EQUAL(decodeFrame(stream, bitCount, frame, false), FRAME_ERROR_SOF);
+	EMB_ASSERT_EQUAL(frame.id, UNKNOWN_FRAME_ID);
+}
+
+
+///
+///
+///
+void CanByGpioTest::LoopbackSimulationTest()
+{
+	// wired-AND: any dominant node wins
+	{
+		sim::NoiseConfig noise = {0, 0};
+		sim::VirtualWire wire(noise, 1);
+		sim::Node nodes[2];
+		wire.attach(&nodes[0]);
+		wire.attach(&nodes[1]);
+		EMB_ASSERT_EQUAL(wire.tick(), 1);
+		nodes[1].send(Frame(0x7FF, NULL, 0), false);
+		EMB_ASSERT_EQUAL(wire.tick(), 0);		// SOF of node 1
+		for (size_t i = 1; i < sim::TICKS_PER_BIT; ++i) wire.tick();
+		EMB_ASSERT_EQUAL(wire.tick(), 1);		// ID bit of node 1
+		nodes[0].send(Frame(0x000, NULL, 0), false);
+		EMB_ASSERT_EQUAL(wire.tick(), 0);		// SOF of node 0 overrides
+	}
+
+	// clean wire and small jitter: no frames lost in both stuffing modes
+	const sim::NoiseConfig cleanNoise[2] = {{0, 0}, {0, 1}};
+	for (int stuffing = 0; stuffing < 2; ++stuffing)
+	{
+		for (size_t i = 0; i < 2; ++i)
+		{
+			sim::Statistics sampled, edge;
+			sim::runLoopback(3, 20, cleanNoise[i], stuffing, sampled, edge);
+			EMB_ASSERT_EQUAL(sampled.sent, 60);
+			EMB_ASSERT_EQUAL(sampled.received, 60);
+			EMB_ASSERT_EQUAL(edge.received, 60);
+		}
+	}
+
+	// frame loss versus noise
+	const uint32_t flipRates_ppm[4] = {100, 1000, 3000, 10000};
+	printf("CAN-by-GPIO loopback, 3 nodes, jitter 1/%u ticks: stuffing, flips ppm, "
+			"sampled rx/err/bad/lost, edge rx/err/bad/lost\n", sim::TICKS_PER_BIT);
+	for (int stuffing = 0; stuffing < 2; ++stuffing)
+	{
+		for (size_t i = 0; i < 4; ++i)
+		{
+			sim::NoiseConfig noise = {flipRates_ppm[i], 1};
+			sim::Statistics sampled, edge;
+			sim::runLoopback(3, 30, noise, stuffing, sampled, edge);
+			EMB_ASSERT_EQUAL(sampled.received + sampled.errors + sampled.corrupted + sampled.lost, sampled.sent);
+			EMB_ASSERT_EQUAL(edge.received + edge.errors + edge.corrupted + edge.lost, edge.sent);
+			printf("%d %5lu  %3lu/%3lu/%3lu/%3lu  %3lu/%3lu/%3lu/%3lu\n", stuffing, (unsigned long)flipRates_ppm[i],
+					(unsigned long)sampled.received, (unsigned long)sampled.errors,
+					(unsigned long)sampled.corrupted, (unsigned long)sampled.lost,
+					(unsigned long)edge.received, (unsigned long)edge.errors,
+					(unsigned long)edge.corrupted, (unsigned long)edge.lost);
+		}
+	}
+}
+
+
+///
+///
+///
+void CanByGpioTest::DecodingBenchmark()
+{
+	const size_t FRAME_COUNT = 32;
+	uint16_t data[8];
+	sim::Random random(0x1234567);
+
+	mcu::HighResolutionClock::init(1000000);
+	mcu::HighResolutionClock::start();
+
+	for (int stuffing = 0; stuffing < 2; ++stuffing)
+	{
+		FrameDecoder decoder(stuffing);
+		uint32_t bitCountTotal = 0;
+		uint32_t cyclesTotal = 0;
+		size_t completed = 0;
+
+		for (size_t f = 0; f < FRAME_COUNT; ++f)
+		{
+			for (size_t i = 0; i < 8; ++i)
+			{
+				data[i] = random.next() & 0xFF;
+			}
+			size_t bitCount = encodeFrame(stream, Frame(0x180 + f % 8, data, 8), stuffing) - 14;
+			decoder.reset();
+
+			// same work as done in RX ISR for each bit, timer counts down
+			uint32_t start = mcu::HighResolutionClock::counter();
+			for (size_t i = 0; i < bitCount; ++i)
+			{
+				decoder.push(stream[i]);
+			}
+			cyclesTotal += start - mcu::HighResolutionClock::counter();
+
+			bitCountTotal += bitCount;
+			if (decoder.status() == FrameDecoder::COMPLETED) ++completed;
+		}
+
+		EMB_ASSERT_EQUAL(completed, FRAME_COUNT);
+		uint32_t cyclesPerFrame = cyclesTotal / FRAME_COUNT;
+		printf("CAN-by-GPIO decoding, stuffing %d: %lu cycles/bit, %lu cycles/frame, %lu frames/s at full CPU load\n",
+				stuffing, (unsigned long)(cyclesTotal / bitCountTotal), (unsigned long)cyclesPerFrame,
+				(unsigned long)(cyclesPerFrame ? mcu::sysclkFreq() / cyclesPerFrame : 0));
+	}
+
+	mcu::HighResolutionClock::stop();
+}
+
+
+} // namespace canbygpio
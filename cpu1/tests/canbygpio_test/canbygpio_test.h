@@ -0,0 +1,26 @@
+///
+#pragma once
+
+#include "emb/emb_testrunner/emb_testrunner.h"
+#include "canbygpio/canbygpio_framing.h"
+#include "canbygpio/canbygpio_errors.h"
+#include "mcu/system/mcu_system.h"
+#include "mcu/cputimers/mcu_cputimers.h"
+
+
+namespace canbygpio {
+
+class CanByGpioTest
+{
+public:
+	static void FramingTest();
+	static void ExtendedFrameTest();
+	static void AcceptanceFilterTest();
+	static void EdgeDecodingTest();
+	static void ErrorCountersTest();
+	static void LoopbackSimulationTest();
+	static void DecodingBenchmark();
+};
+
+
+} // namespace canbygpio
@@ -0,0 +1,320 @@
+///
+#include "fuelcell_fsm_sim.h"
+
+
+namespace fuelcell {
+
+namespace sim {
+
+
+static const size_t CORPUS_SIZE = 16;
+static Trace corpus[CORPUS_SIZE];
+static Trace fuzzedTrace;
+
+
+///
+///
+///
+void Environment::reset()
+{
+	time = 0;
+	errors = false;
+	batteryIsCharged = false;
+	connected = false;
+	running = false;
+	pwmOn = false;
+	relayOn = false;
+	currentRef = 0;
+}
+
+
+///
+///
+///
+void Environment::startConverter()
+{
+	// same conditions as Converter::start()
+	if (!errors && !batteryIsCharged && !pwmOn)
+	{
+		pwmOn = true;
+	}
+}
+
+
+///
+///
+///
+void Simulator::reset()
+{
+	m_env.reset();
+	m_state = CONVERTER_POWERUP;
+	Fsm::init(&m_env);
+	m_coverage = Coverage();
+	m_violations = 0;
+	m_mismatches = 0;
+}
+
+
+///
+///
+///
+void Simulator::step(const TraceStep& step)
+{
+	for (uint32_t t = 0; t < step.delay; t += TICK_MS)
+	{
+		m_env.time += TICK_MS;
+		_dispatch(FSM_EVENT_RUN);
+		_dispatch(FSM_EVENT_SUPERVISE);
+		FsmEvent timerEvent;
+		while (Fsm::popExpiredTimer(timerEvent))
+		{
+			_dispatch(timerEvent);
+		}
+	}
+
+	switch (step.input)
+	{
+	case INPUT_IDLE:
+		break;
+	case INPUT_STARTUP:
+		_dispatch(FSM_EVENT_STARTUP);
+		break;
+	case INPUT_SHUTDOWN:
+		_dispatch(FSM_EVENT_SHUTDOWN);
+		break;
+	case INPUT_START_CHARGING:
+		_dispatch(FSM_EVENT_START_CHARGING);
+		break;
+	case INPUT_STOP_CHARGING:
+		_dispatch(FSM_EVENT_STOP_CHARGING);
+		break;
+	case INPUT_EMERGENCY_SHUTDOWN:
+		_dispatch(FSM_EVENT_EMERGENCY_SHUTDOWN);
+		break;
+	case INPUT_ERROR:
+		m_env.errors = true;
+		break;
+	case INPUT_RESET_FAULTS:
+		// same as OD reset of all faults
+		m_env.resetErrorsWarnings();
+		Fsm::resetFailureCount();
+		break;
+	case INPUT_CONNECTION_OK:
+		m_env.connected = true;
+		break;
+	case INPUT_CONNECTION_LOST:
+		m_env.connected = false;
+		break;
+	case INPUT_FUELCELLS_RUNNING:
+		m_env.running = true;
+		break;
+	case INPUT_FUELCELLS_STOPPED:
+		m_env.running = false;
+		break;
+	case INPUT_BATTERY_CHARGED:
+		// same as Converter::onAdcVoltageOutInterrupt()
+		m_env.batteryIsCharged = true;
+		_dispatch(FSM_EVENT_SHUTDOWN);
+		break;
+	case INPUT_BATTERY_DISCHARGED:
+		m_env.batteryIsCharged = false;
+		break;
+	case INPUT_COUNT:
+		break;
+	}
+
+	if ((step.expected != ANY_STATE) && (step.expected != m_state))
+	{
+		++m_mismatches;
+	}
+}
+
+
+///
+///
+///
+void Simulator::run(const TraceStep* steps, size_t length)
+{
+	reset();
+	for (size_t i = 0; i < length; ++i)
+	{
+		step(steps[i]);
+	}
+}
+
+
+///
+///
+///
+void Simulator::_dispatch(FsmEvent event)
+{
+	ConverterState prevState = m_state;
+	Fsm::dispatch(m_state, event);
+	m_coverage.set((prevState * FSM_EVENT_COUNT + event) * CONVERTER_STATE_COUNT + m_state);
+	_checkInvariants();
+}
+
+
+///
+///
+///
+void Simulator::_checkInvariants()
+{
+	bool charging = (m_state == CONVERTER_CHARGING_START) || (m_state == CONVERTER_CHARGING);
+
+	if (m_state >= CONVERTER_STATE_COUNT)
+	{
+		++m_violations;
+	}
+	if (m_env.pwmOn && !charging)
+	{
+		++m_violations;
+	}
+	if (charging && !m_env.relayOn)
+	{
+		++m_violations;
+	}
+}
+
+
+///
+///
+///
+static uint32_t randomDelay(Random& random)
+{
+	switch (random.next() % 8)
+	{
+	case 0:
+	case 1:
+	case 2:
+		return 0;
+	case 3:
+	case 4:
+		return TICK_MS * (1 + random.next() % 10);
+	case 5:
+	case 6:
+		return 1000 + random.next() % 10000;
+	default:
+		return 30000 + random.next() % 40000;
+	}
+}
+
+
+///
+///
+///
+static void mutate(Trace& trace, Random& random)
+{
+	size_t mutationCount = 1 + random.next() % 3;
+	for (size_t m = 0; m < mutationCount; ++m)
+	{
+		size_t pos = (trace.length > 0) ? random.next() % trace.length : 0;
+		switch (random.next() % 4)
+		{
+		case 0:		// replace input
+			if (trace.length > 0)
+			{
+				trace.steps[pos].input = Input(random.next() % INPUT_COUNT);
+			}
+			break;
+		case 1:		// replace delay
+			if (trace.length > 0)
+			{
+				trace.steps[pos].delay = randomDelay(random);
+			}
+			break;
+		case 2:		// insert step
+			if (trace.length < TRACE_MAX_LENGTH)
+			{
+				for (size_t i = trace.length; i > pos; --i)
+				{
+					trace.steps[i] = trace.steps[i-1];
+				}
+				trace.steps[pos].delay = randomDelay(random);
+				trace.steps[pos].input = Input(random.next() % INPUT_COUNT);
+				++trace.length;
+			}
+			break;
+		default:	// delete step
+			if (trace.length > 1)
+			{
+				for (size_t i = pos; i < trace.length - 1; ++i)
+				{
+					trace.steps[i] = trace.steps[i+1];
+				}
+				--trace.length;
+			}
+			break;
+		}
+	}
+
+	for (size_t i = 0; i < trace.length; ++i)
+	{
+		trace.steps[i].expected = ANY_STATE;
+	}
+}
+
+
+///
+///
+///
+void fuzz(const TraceStep* seedTrace, size_t seedLength, size_t iterations, uint32_t seed, FuzzStatistics& stats)
+{
+	assert(seedLength <= TRACE_MAX_LENGTH);
+
+	Random random(seed);
+	Simulator simulator;
+	Coverage totalCoverage;
+
+	for (size_t i = 0; i < seedLength; ++i)
+	{
+		corpus[0].steps[i] = seedTrace[i];
+	}
+	corpus[0].length = seedLength;
+	size_t corpusSize = 1;
+
+	for (size_t n = 0; n < iterations; ++n)
+	{
+		fuzzedTrace = corpus[random.next() % corpusSize];
+		if (n > 0)
+		{
+			mutate(fuzzedTrace, random);
+		}
+
+		simulator.run(fuzzedTrace.steps, fuzzedTrace.length);
+		++stats.runs;
+		stats.violations += simulator.violations();
+		stats.simulatedTime += simulator.env().time;
+
+		// keep trace if it covers new transitions
+		bool newCoverage = false;
+		for (size_t bit = 0; bit < totalCoverage.size(); ++bit)
+		{
+			if (simulator.coverage().test(bit) && !totalCoverage.test(bit))
+			{
+				totalCoverage.set(bit);
+				newCoverage = true;
+			}
+		}
+
+		if (newCoverage && (n > 0))
+		{
+			if (corpusSize < CORPUS_SIZE)
+			{
+				corpus[corpusSize++] = fuzzedTrace;
+			}
+			else
+			{
+				corpus[1 + random.next() % (CORPUS_SIZE - 1)] = fuzzedTrace;	// seed trace is kept
+			}
+		}
+	}
+
+	stats.corpusSize = corpusSize;
+	stats.coverage = totalCoverage.count();
+}
+
+
+} // namespace sim
+
+} // namespace fuelcell
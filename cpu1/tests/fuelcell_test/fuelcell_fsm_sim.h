@@ -0,0 +1,183 @@
+///
+#pragma once
+
+#include "emb/emb_bitset.h"
+#include "fuelcell/fsm/fsm.h"
+#include "canbygpio_test/canbygpio_sim.h"
+
+
+namespace fuelcell {
+
+/// Simulation of converter FSM with injected environment: trace replay and coverage-guided fuzzing
+namespace sim {
+
+
+using canbygpio::sim::Random;
+
+
+/// Simulated time step, both FSM paths are dispatched once per tick
+const uint32_t TICK_MS = 10;
+/// Simulated PWM frequency, fast path is dispatched once per PWM period
+const float PWM_FREQ = 1000 / TICK_MS;
+
+
+/// State in trace step that is not checked
+const ConverterState ANY_STATE = static_cast<ConverterState>(CONVERTER_STATE_COUNT);
+
+
+/**
+ * @brief Inputs of simulated converter: commands, fuel cell and system status changes.
+ */
+enum Input
+{
+	INPUT_IDLE,
+	INPUT_STARTUP,
+	INPUT_SHUTDOWN,
+	INPUT_START_CHARGING,
+	INPUT_STOP_CHARGING,
+	INPUT_EMERGENCY_SHUTDOWN,
+	INPUT_ERROR,
+	INPUT_RESET_FAULTS,
+	INPUT_CONNECTION_OK,
+	INPUT_CONNECTION_LOST,
+	INPUT_FUELCELLS_RUNNING,
+	INPUT_FUELCELLS_STOPPED,
+	INPUT_BATTERY_CHARGED,
+	INPUT_BATTERY_DISCHARGED,
+	INPUT_COUNT
+};
+
+
+/**
+ * @brief Trace step: simulated time passes, then input is applied.
+ */
+struct TraceStep
+{
+	uint32_t delay;			// ms
+	Input input;
+	ConverterState expected;	// state after input, ANY_STATE - not checked
+};
+
+
+/// Max number of steps in fuzzed trace
+const size_t TRACE_MAX_LENGTH = 24;
+
+
+/**
+ * @brief Fuzzed trace.
+ */
+struct Trace
+{
+	TraceStep steps[TRACE_MAX_LENGTH];
+	size_t length;
+};
+
+
+/// Covered (state, event, next state) triples
+typedef emb::Bitset<CONVERTER_STATE_COUNT * FSM_EVENT_COUNT * CONVERTER_STATE_COUNT> Coverage;
+
+
+/**
+ * @brief Simulated environment: time, syslog, fuel cells and converter hardware are plain variables.
+ */
+class Environment : public IFsmEnvironment
+{
+public:
+	uint64_t time;
+	bool errors;
+	bool batteryIsCharged;
+	bool connected;
+	bool running;
+	bool pwmOn;
+	bool relayOn;
+	float currentRef;
+
+	Environment() { reset(); }
+	void reset();
+
+	virtual uint64_t now() { return time; }
+
+	virtual bool hasErrors() { return errors; }
+	virtual bool batteryCharged() { return batteryIsCharged; }
+	virtual void resetErrorsWarnings() { errors = false; batteryIsCharged = false; }
+	virtual void resetConnectionError() {}
+	virtual void setStartupFailedError() { errors = true; }
+
+	virtual bool fuelcellsConnected() { return connected; }
+	virtual bool fuelcellsRunning() { return running; }
+	virtual void startFuelcells() {}
+	virtual void stopFuelcells() { running = false; }
+	virtual void enableFuelcellErrors() {}
+
+	virtual float voltageIn() { return 0; }
+	virtual float currentInMin() { return 1; }
+	virtual float currentInMax() { return 10; }
+	virtual float pwmFreq() { return PWM_FREQ; }
+	virtual void startConverter();
+	virtual void stopConverter() { pwmOn = false; }
+	virtual void setCurrentIn(float value) { currentRef = value; }
+	virtual void turnRelayOn() { relayOn = true; }
+	virtual void turnRelayOff() { relayOn = false; }
+};
+
+
+/**
+ * @brief Drives FSM by trace steps, records coverage and checks invariants after each dispatch:
+ * PWM is on only in charging states, relay is on in charging states.
+ */
+class Simulator
+{
+private:
+	Environment m_env;
+	ConverterState m_state;
+	Coverage m_coverage;
+	uint32_t m_violations;
+	uint32_t m_mismatches;
+public:
+	Simulator() { reset(); }
+	void reset();
+	void step(const TraceStep& step);
+	void run(const TraceStep* steps, size_t length);
+
+	ConverterState state() const { return m_state; }
+	const Environment& env() const { return m_env; }
+	const Coverage& coverage() const { return m_coverage; }
+	uint32_t violations() const { return m_violations; }
+	uint32_t mismatches() const { return m_mismatches; }	// expected states of trace steps not reached
+private:
+	void _dispatch(FsmEvent event);
+	void _checkInvariants();
+};
+
+
+/**
+ * @brief Fuzzing results.
+ */
+struct FuzzStatistics
+{
+	uint32_t runs;
+	uint32_t violations;
+	size_t corpusSize;
+	size_t coverage;
+	uint64_t simulatedTime;		// ms
+
+	FuzzStatistics() : runs(0), violations(0), corpusSize(0), coverage(0), simulatedTime(0) {}
+};
+
+
+/**
+ * @brief Runs coverage-guided fuzzing: traces from corpus are mutated and replayed,
+ * traces covering new transitions are added to corpus.
+ * @param seedTrace - initial corpus entry
+ * @param seedLength - number of steps in seed trace
+ * @param iterations - number of fuzzed runs
+ * @param seed - random seed
+ * @param stats - results
+ * @return (none)
+ */
+void fuzz(const TraceStep* seedTrace, size_t seedLength, size_t iterations, uint32_t seed, FuzzStatistics& stats);
+
+
+} // namespace sim
+
+} // namespace fuelcell
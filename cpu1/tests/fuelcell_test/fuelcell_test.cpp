@@ -0,0 +1,963 @@
+///
+#include "fuelcell_test.h"
+
+
+namespace fuelcell {
+
+
+static CellTable cellTable;
+static LinkStatistics linkStats;
+
+
+///
+///
+///
+void FuelcellTest::CellTableTest()
+{
+	const size_t CELL_COUNT = 20;
+	cellTable.init(CELL_COUNT, 1.f);
+
+	EMB_ASSERT_EQUAL(cellTable.cellCount(), CELL_COUNT);
+	EMB_ASSERT_TRUE(!cellTable.allStarting());
+	EMB_ASSERT_TRUE(!cellTable.allRunning());
+	EMB_ASSERT_TRUE(!cellTable.anyOverheat());
+	EMB_ASSERT_TRUE(!cellTable.anyLowCharge());
+
+	for (size_t i = 0; i < CELL_COUNT - 1; ++i)
+	{
+		cellTable.setStatus(i, false, true, false, false);
+	}
+	EMB_ASSERT_TRUE(!cellTable.allRunning());
+	cellTable.setStatus(CELL_COUNT - 1, false, true, false, false);
+	EMB_ASSERT_TRUE(cellTable.allRunning());
+	EMB_ASSERT_EQUAL(cellTable.statusRun.count(), CELL_COUNT);
+
+	cellTable.setStatus(17, false, false, true, false);
+	EMB_ASSERT_TRUE(!cellTable.allRunning());
+	EMB_ASSERT_TRUE(cellTable.anyOverheat());
+	EMB_ASSERT_EQUAL(cellTable.statusOverheat.count(), 1);
+	cellTable.setStatus(17, false, true, false, false);
+	EMB_ASSERT_TRUE(cellTable.allRunning());
+	EMB_ASSERT_TRUE(!cellTable.anyOverheat());
+
+	cellTable.setStatus(3, false, true, false, true);
+	EMB_ASSERT_TRUE(cellTable.anyLowCharge());
+
+	// median of 5 rejects single spike, smooth factor 1 disables exponential filter
+	for (size_t i = 0; i < CELL_COUNT; ++i)
+	{
+		for (size_t j = 0; j < CellTable::VOLTAGE_WINDOW_SIZE; ++j)
+		{
+			cellTable.pushCellVoltage(i, 40.f + float(i));
+		}
+	}
+	cellTable.pushCellVoltage(5, 0.f);
+	EMB_ASSERT_EQUAL(cellTable.cellVoltage[5], 45.f);
+	EMB_ASSERT_EQUAL(cellTable.minCellVoltage(), 40.f);
+	cellTable.pushCellVoltage(0, 50.f);
+	cellTable.pushCellVoltage(0, 50.f);
+	cellTable.pushCellVoltage(0, 50.f);
+	EMB_ASSERT_EQUAL(cellTable.minCellVoltage(), 41.f);
+	EMB_ASSERT_EQUAL(cellTable.minCellVoltageIdx(), 1);
+
+	// incrementally tracked min must match full rescan
+	uint32_t seed = 0x2545F491;
+	for (size_t n = 0; n < 1000; ++n)
+	{
+		seed = seed * 1103515245 + 12345;
+		size_t cell = (seed >> 8) % CELL_COUNT;
+		cellTable.pushCellVoltage(cell, 30.f + float((seed >> 16) % 150) / 10.f);
+
+		size_t minIdx = 0;
+		for (size_t i = 1; i < CELL_COUNT; ++i)
+		{
+			if (cellTable.cellVoltage[i] < cellTable.cellVoltage[minIdx]) minIdx = i;
+		}
+		EMB_ASSERT_EQUAL(cellTable.minCellVoltage(), cellTable.cellVoltage[minIdx]);
+		EMB_ASSERT_EQUAL(cellTable.minCellVoltageIdx(), minIdx);
+	}
+
+	// cells beyond cell count do not exist
+	cellTable.init(CELL_COUNT, 1.f);
+	for (size_t i = 0; i < CELL_COUNT; ++i)
+	{
+		cellTable.setStatus(i, true, false, false, false);
+	}
+	EMB_ASSERT_TRUE(cellTable.allStarting());
+	cellTable.init(FUELCELL_MAX_COUNT, 1.f);
+	for (size_t i = 0; i < FUELCELL_MAX_COUNT; ++i)
+	{
+		cellTable.setStatus(i, true, false, false, false);
+	}
+	EMB_ASSERT_TRUE(cellTable.allStarting());
+	EMB_ASSERT_EQUAL(cellTable.statusStart.count(), FUELCELL_MAX_COUNT);
+}
+
+
+///
+///
+///
+void FuelcellTest::CellTableBenchmark()
+{
+	const size_t CELL_COUNTS[3] = {FUELCELL_COUNT, 32, FUELCELL_MAX_COUNT};
+	const size_t QUERY_COUNT = 100;
+
+	// previous layout: separate bool array per flag
+	static emb::Array<bool, FUELCELL_MAX_COUNT> statusStart;
+	static emb::Array<bool, FUELCELL_MAX_COUNT> statusRun;
+	static emb::Array<bool, FUELCELL_MAX_COUNT> statusOverheat;
+	static emb::Array<bool, FUELCELL_MAX_COUNT> statusLowCharge;
+
+	mcu::HighResolutionClock::init(1000000);
+	mcu::HighResolutionClock::start();
+
+	for (size_t k = 0; k < 3; ++k)
+	{
+		size_t cellCount = CELL_COUNTS[k];
+		cellTable.init(cellCount, 0.1f);
+		for (size_t i = 0; i < cellCount; ++i)
+		{
+			cellTable.setStatus(i, false, true, false, false);
+			statusStart[i] = false;
+			statusRun[i] = true;
+			statusOverheat[i] = false;
+			statusLowCharge[i] = false;
+		}
+
+		// same queries as done by Controller::checkErrors() and fsm, timer counts down
+		size_t resultBitset = 0;
+		uint32_t start = mcu::HighResolutionClock::counter();
+		for (size_t q = 0; q < QUERY_COUNT; ++q)
+		{
+			resultBitset += cellTable.allStarting() + cellTable.allRunning()
+					+ cellTable.anyOverheat() + cellTable.anyLowCharge();
+		}
+		uint32_t cyclesBitset = start - mcu::HighResolutionClock::counter();
+
+		size_t resultArray = 0;
+		start = mcu::HighResolutionClock::counter();
+		for (size_t q = 0; q < QUERY_COUNT; ++q)
+		{
+			resultArray += (emb::count(statusStart.begin(), statusStart.begin() + cellCount, true) == cellCount)
+					+ (emb::count(statusRun.begin(), statusRun.begin() + cellCount, true) == cellCount)
+					+ (emb::count(statusOverheat.begin(), statusOverheat.begin() + cellCount, true) > 0)
+					+ (emb::count(statusLowCharge.begin(), statusLowCharge.begin() + cellCount, true) > 0);
+		}
+		uint32_t cyclesArray = start - mcu::HighResolutionClock::counter();
+
+		EMB_ASSERT_EQUAL(resultBitset, QUERY_COUNT);
+		EMB_ASSERT_EQUAL(resultArray, QUERY_COUNT);
+		printf("Fuel cell status queries, %u cells: bitmask %lu cycles, bool arrays %lu cycles\n",
+				(unsigned int)cellCount, (unsigned long)(cyclesBitset / QUERY_COUNT),
+				(unsigned long)(cyclesArray / QUERY_COUNT));
+	}
+
+	// worst case of min tracking: every update raises current min cell, so that min moves to another cell
+	cellTable.init(FUELCELL_MAX_COUNT, 1.f);
+	for (size_t i = 0; i < FUELCELL_MAX_COUNT; ++i)
+	{
+		for (size_t j = 0; j < CellTable::VOLTAGE_WINDOW_SIZE; ++j)
+		{
+			cellTable.pushCellVoltage(i, 30.f + float(i) / 100.f);
+		}
+	}
+
+	uint32_t cyclesTree = 0;
+	uint32_t cyclesRescan = 0;
+	for (size_t q = 0; q < QUERY_COUNT; ++q)
+	{
+		size_t cell = cellTable.minCellVoltageIdx();
+		float voltage = 40.f + float(q) / 100.f;
+
+		uint32_t start = mcu::HighResolutionClock::counter();
+		for (size_t j = 0; j < CellTable::VOLTAGE_WINDOW_SIZE/2 + 1; ++j)
+		{
+			cellTable.pushCellVoltage(cell, voltage);
+		}
+		cyclesTree += start - mcu::HighResolutionClock::counter();
+
+		// previous implementation: linear rescan of all cells
+		start = mcu::HighResolutionClock::counter();
+		size_t minIdx = 0;
+		for (size_t i = 1; i < FUELCELL_MAX_COUNT; ++i)
+		{
+			if (cellTable.cellVoltage[i] < cellTable.cellVoltage[minIdx]) minIdx = i;
+		}
+		cyclesRescan += start - mcu::HighResolutionClock::counter();
+
+		EMB_ASSERT_EQUAL(cellTable.minCellVoltageIdx(), minIdx);
+	}
+	printf("Fuel cell min voltage, %u cells, min cell raised: update with tournament tree %lu cycles, "
+			"linear rescan alone %lu cycles\n", (unsigned int)FUELCELL_MAX_COUNT,
+			(unsigned long)(cyclesTree / (QUERY_COUNT * (CellTable::VOLTAGE_WINDOW_SIZE/2 + 1))),
+			(unsigned long)(cyclesRescan / QUERY_COUNT));
+
+	mcu::HighResolutionClock::stop();
+}
+
+
+///
+///
+///
+static CellRecord makeRecord(uint32_t k)
+{
+	CellRecord record;
+	record.temperature = float(k);
+	record.cellVoltage = 40.f;
+	record.battVoltage = float(k);
+	record.current = float(k);
+	record.recvTimestamp = k;
+	record.statusStart = k & 1;
+	record.statusRun = (k >> 1) & 1;
+	record.statusOverheat = (k >> 2) & 1;
+	record.statusLowCharge = (k >> 3) & 1;
+	return record;
+}
+
+
+///
+///
+///
+static bool isCoherent(const CellRecord& record)
+{
+	CellRecord expected = makeRecord(uint32_t(record.recvTimestamp));
+	return (record.temperature == expected.temperature)
+			&& (record.battVoltage == expected.battVoltage)
+			&& (record.current == expected.current)
+			&& (record.statusStart == expected.statusStart)
+			&& (record.statusRun == expected.statusRun)
+			&& (record.statusOverheat == expected.statusOverheat)
+			&& (record.statusLowCharge == expected.statusLowCharge);
+}
+
+
+///
+///
+///
+void FuelcellTest::SeqLockTest()
+{
+	const size_t CELL = 7;
+	const size_t READ_COUNT = 2000;
+	const size_t READ_STEPS = 9;
+	cellTable.init(32, 0.1f);
+
+	// writer (CPU2) preempts reader (CPU1) at random step of record copying
+	uint32_t k = 0;
+	uint32_t seed = 0x9E3779B9;
+	size_t tornCount = 0;
+	size_t retryCount = 0;
+	cellTable.updateCell(CELL, makeRecord(++k));
+
+	for (size_t n = 0; n < READ_COUNT; ++n)
+	{
+		seed = seed * 1103515245 + 12345;
+		size_t writeStep = (seed >> 8) % (2 * READ_STEPS);	// no write in half of reads
+
+		CellRecord record;
+		uint16_t seq = cellTable.readBegin(CELL);
+		for (size_t step = 0; step < READ_STEPS; ++step)
+		{
+			if (step == writeStep)
+			{
+				cellTable.updateCell(CELL, makeRecord(++k));
+			}
+			switch (step)
+			{
+			case 0: record.temperature = cellTable.temperature[CELL]; break;
+			case 1: record.cellVoltage = cellTable.cellVoltage[CELL]; break;
+			case 2: record.battVoltage = cellTable.battVoltage[CELL]; break;
+			case 3: record.current = cellTable.current[CELL]; break;
+			case 4: record.recvTimestamp = cellTable.recvTimestamp[CELL]; break;
+			case 5: record.statusStart = cellTable.statusStart.test(CELL); break;
+			case 6: record.statusRun = cellTable.statusRun.test(CELL); break;
+			case 7: record.statusOverheat = cellTable.statusOverheat.test(CELL); break;
+			case 8: record.statusLowCharge = cellTable.statusLowCharge.test(CELL); break;
+			}
+		}
+
+		bool coherent = isCoherent(record);
+		if (!coherent) ++tornCount;
+
+		if (cellTable.readRetry(CELL, seq))
+		{
+			++retryCount;
+			EMB_ASSERT_TRUE(writeStep < READ_STEPS);
+			EMB_ASSERT_TRUE(cellTable.readCell(CELL, record));
+			EMB_ASSERT_TRUE(isCoherent(record));
+		}
+		else
+		{
+			// accepted record must never be torn
+			EMB_ASSERT_TRUE(writeStep >= READ_STEPS);
+			EMB_ASSERT_TRUE(coherent);
+		}
+		EMB_ASSERT_EQUAL(record.recvTimestamp, k);
+	}
+
+	// unprotected reads would be torn
+	EMB_ASSERT_TRUE(tornCount > 0);
+	EMB_ASSERT_TRUE(retryCount >= tornCount);
+
+	// reader overhead, timer counts down
+	const size_t QUERY_COUNT = 100;
+	mcu::HighResolutionClock::init(1000000);
+	mcu::HighResolutionClock::start();
+
+	CellRecord record;
+	uint32_t start = mcu::HighResolutionClock::counter();
+	for (size_t q = 0; q < QUERY_COUNT; ++q)
+	{
+		record.temperature = cellTable.temperature[CELL];
+		record.cellVoltage = cellTable.cellVoltage[CELL];
+		record.battVoltage = cellTable.battVoltage[CELL];
+		record.current = cellTable.current[CELL];
+		record.recvTimestamp = cellTable.recvTimestamp[CELL];
+		record.statusStart = cellTable.statusStart.test(CELL);
+		record.statusRun = cellTable.statusRun.test(CELL);
+		record.statusOverheat = cellTable.statusOverheat.test(CELL);
+		record.statusLowCharge = cellTable.statusLowCharge.test(CELL);
+	}
+	uint32_t cyclesPlain = start - mcu::HighResolutionClock::counter();
+
+	start = mcu::HighResolutionClock::counter();
+	for (size_t q = 0; q < QUERY_COUNT; ++q)
+	{
+		cellTable.readCell(CELL, record);
+	}
+	uint32_t cyclesSeqLock = start - mcu::HighResolutionClock::counter();
+
+	mcu::HighResolutionClock::stop();
+
+	printf("Fuel cell record read: unprotected %lu cycles, sequence lock %lu cycles, %u of %u reads retried\n",
+			(unsigned long)(cyclesPlain / QUERY_COUNT), (unsigned long)(cyclesSeqLock / QUERY_COUNT),
+			(unsigned int)retryCount, (unsigned int)READ_COUNT);
+}
+
+
+///
+///
+///
+void FuelcellTest::LinkStatisticsTest()
+{
+	EMB_ASSERT_EQUAL(LinkStatistics::bucket(0), 0);
+	EMB_ASSERT_EQUAL(LinkStatistics::bucket(1), 0);
+	EMB_ASSERT_EQUAL(LinkStatistics::bucket(2), 1);
+	EMB_ASSERT_EQUAL(LinkStatistics::bucket(3), 1);
+	EMB_ASSERT_EQUAL(LinkStatistics::bucket(200), 7);
+	EMB_ASSERT_EQUAL(LinkStatistics::bucket(2047), 10);
+	EMB_ASSERT_EQUAL(LinkStatistics::bucket(2048), 11);
+	EMB_ASSERT_EQUAL(LinkStatistics::bucket(100000), 11);
+
+	uint64_t timeNow = 1000;
+	linkStats.init(8, timeNow);
+	EMB_ASSERT_EQUAL(linkStats.intervalMax(0), LinkStatistics::INTERVAL_NONE);
+
+	// cell 0 sends every 200 ms, cell 1 link degrades, cell 2 is silent
+	for (size_t n = 0; n < 50; ++n)
+	{
+		linkStats.onFrame(0, 200);
+		linkStats.onFrame(1, 200 + 20 * n);
+	}
+	linkStats.update(timeNow + LinkStatistics::WINDOW - 1);
+	EMB_ASSERT_EQUAL(linkStats.intervalAvg(0), LinkStatistics::INTERVAL_NONE);
+	linkStats.update(timeNow + LinkStatistics::WINDOW);
+
+	EMB_ASSERT_EQUAL(linkStats.intervalMin(0), 200);
+	EMB_ASSERT_EQUAL(linkStats.intervalAvg(0), 200);
+	EMB_ASSERT_EQUAL(linkStats.intervalMax(0), 200);
+	EMB_ASSERT_EQUAL(linkStats.histogram(0, 7), 50);
+
+	EMB_ASSERT_EQUAL(linkStats.intervalMin(1), 200);
+	EMB_ASSERT_EQUAL(linkStats.intervalAvg(1), 690);
+	EMB_ASSERT_EQUAL(linkStats.intervalMax(1), 1180);
+	EMB_ASSERT_EQUAL(linkStats.histogram(1, 7), 3);		// 200...240 ms
+	EMB_ASSERT_EQUAL(linkStats.histogram(1, 10), 8);	// 1040...1180 ms
+
+	EMB_ASSERT_EQUAL(linkStats.intervalMin(2), LinkStatistics::INTERVAL_NONE);
+
+	// next window, histogram is cumulative
+	linkStats.onFrame(0, 5000);
+	linkStats.update(timeNow + 2 * LinkStatistics::WINDOW);
+	EMB_ASSERT_EQUAL(linkStats.intervalMax(0), 5000);
+	EMB_ASSERT_EQUAL(linkStats.histogram(0, 11), 1);
+	EMB_ASSERT_EQUAL(linkStats.histogram(0, 7), 50);
+	EMB_ASSERT_EQUAL(linkStats.intervalMax(1), LinkStatistics::INTERVAL_NONE);
+}
+
+
+///
+///
+///
+void FuelcellTest::PdoCodecTest()
+{
+	const uint16_t payload[8] = {0x19, 0x7D, 0x01, 0x8C, 0x01, 0x06, 0x38, 0xFF};
+	RpdoMessage rpdo;
+	decodeRpdo(rpdo, payload);
+	EMB_ASSERT_EQUAL(rpdo.temperature, 25);
+	EMB_ASSERT_EQUAL(rpdo.cellVoltage, 381);
+	EMB_ASSERT_EQUAL(rpdo.battVoltage, 396);
+	EMB_ASSERT_TRUE(!rpdo.statusError);
+	EMB_ASSERT_TRUE(rpdo.statusStart);
+	EMB_ASSERT_TRUE(rpdo.statusRun);
+	EMB_ASSERT_TRUE(!rpdo.statusOverheat);
+	EMB_ASSERT_TRUE(!rpdo.statusHydroError);
+	EMB_ASSERT_EQUAL(rpdo.current, -200);
+
+	TpdoMessage tpdo;
+	tpdo.cmd = 0x96;
+	tpdo.voltage = 0x1234;
+	tpdo.current = 0xABCD;
+	uint16_t tpdoPayload[8];
+	encodeTpdo(tpdoPayload, tpdo);
+	const uint16_t tpdoExpected[8] = {0x96, 0x34, 0x12, 0xCD, 0xAB, 0, 0, 0};
+	for (size_t i = 0; i < 8; ++i)
+	{
+		EMB_ASSERT_EQUAL(tpdoPayload[i], tpdoExpected[i]);
+	}
+
+	// shift codec must match bitfield layout used by fuel cells
+	uint16_t bytes[8];
+	emb::c28x::to_bytes8<TpdoMessage>(bytes, tpdo);
+	for (size_t i = 0; i < 8; ++i)
+	{
+		EMB_ASSERT_EQUAL(tpdoPayload[i], bytes[i]);
+	}
+
+	// batch and scalar paths, random payloads
+	const size_t FRAME_COUNT = 64;
+	static uint16_t payloads[FRAME_COUNT][8];
+	static uint16_t temperature[FRAME_COUNT];
+	static uint16_t cellVoltage[FRAME_COUNT];
+	static uint16_t battVoltage[FRAME_COUNT];
+	static uint16_t status[FRAME_COUNT];
+	static int16_t current[FRAME_COUNT];
+	RpdoColumns columns = {temperature, cellVoltage, battVoltage, status, current};
+
+	uint32_t seed = 0x12345678;
+	for (size_t i = 0; i < FRAME_COUNT; ++i)
+	{
+		for (size_t j = 0; j < 8; ++j)
+		{
+			seed = seed * 1103515245 + 12345;
+			payloads[i][j] = (seed >> 16) & 0xFF;
+		}
+	}
+	decodeRpdoBatch(columns, payloads, FRAME_COUNT);
+
+	for (size_t i = 0; i < FRAME_COUNT; ++i)
+	{
+		decodeRpdo(rpdo, payloads[i]);
+		EMB_ASSERT_EQUAL(temperature[i], rpdo.temperature);
+		EMB_ASSERT_EQUAL(cellVoltage[i], rpdo.cellVoltage);
+		EMB_ASSERT_EQUAL(battVoltage[i], rpdo.battVoltage);
+		EMB_ASSERT_EQUAL(current[i], rpdo.current);
+		EMB_ASSERT_EQUAL(status[i] & RPDO_STATUS_RUN, rpdo.statusRun ? RPDO_STATUS_RUN : 0);
+		EMB_ASSERT_EQUAL(status[i] & RPDO_STATUS_HYDROERROR, rpdo.statusHydroError ? RPDO_STATUS_HYDROERROR : 0);
+
+		RpdoMessage rpdoBitfield;
+		emb::c28x::from_bytes8<RpdoMessage>(rpdoBitfield, payloads[i]);
+		EMB_ASSERT_TRUE(emb::c28x::is_equal(rpdo, rpdoBitfield));
+	}
+}
+
+
+///
+///
+///
+void FuelcellTest::PdoDecodingBenchmark()
+{
+	const size_t FRAME_COUNT = 64;
+	static uint16_t payloads[FRAME_COUNT][8];
+	static uint16_t temperature[FRAME_COUNT];
+	static uint16_t cellVoltage[FRAME_COUNT];
+	static uint16_t battVoltage[FRAME_COUNT];
+	static uint16_t status[FRAME_COUNT];
+	static int16_t current[FRAME_COUNT];
+	RpdoColumns columns = {temperature, cellVoltage, battVoltage, status, current};
+	static RpdoMessage messages[FRAME_COUNT];
+
+	uint32_t seed = 0x87654321;
+	for (size_t i = 0; i < FRAME_COUNT; ++i)
+	{
+		for (size_t j = 0; j < 8; ++j)
+		{
+			seed = seed * 1103515245 + 12345;
+			payloads[i][j] = (seed >> 16) & 0xFF;
+		}
+	}
+
+	mcu::HighResolutionClock::init(1000000);
+	mcu::HighResolutionClock::start();
+
+	// timer counts down
+	uint32_t start = mcu::HighResolutionClock::counter();
+	for (size_t i = 0; i < FRAME_COUNT; ++i)
+	{
+		emb::c28x::from_bytes8<RpdoMessage>(messages[i], payloads[i]);
+	}
+	uint32_t cyclesBitfield = start - mcu::HighResolutionClock::counter();
+
+	start = mcu::HighResolutionClock::counter();
+	for (size_t i = 0; i < FRAME_COUNT; ++i)
+	{
+		decodeRpdo(messages[i], payloads[i]);
+	}
+	uint32_t cyclesShift = start - mcu::HighResolutionClock::counter();
+
+	start = mcu::HighResolutionClock::counter();
+	decodeRpdoBatch(columns, payloads, FRAME_COUNT);
+	uint32_t cyclesBatch = start - mcu::HighResolutionClock::counter();
+
+	mcu::HighResolutionClock::stop();
+
+	uint32_t cycles[3] = {cyclesBitfield, cyclesShift, cyclesBatch};
+	const char* names[3] = {"from_bytes8", "shift", "batch"};
+	for (size_t i = 0; i < 3; ++i)
+	{
+		uint32_t cyclesPerFrame = cycles[i] / FRAME_COUNT;
+		printf("RPDO decoding, %s: %lu cycles/frame, %lu frames/s\n", names[i], (unsigned long)cyclesPerFrame,
+				(unsigned long)(cyclesPerFrame ? mcu::sysclkFreq() / cyclesPerFrame : 0));
+	}
+}
+
+
+///
+///
+///
+void FuelcellTest::FsmTableTest()
+{
+	EMB_ASSERT_TRUE(Fsm::checkTable());
+	sim::Environment env;
+	Fsm::init(&env);
+
+	EMB_ASSERT_EQUAL(Fsm::transitionCount(CONVERTER_POWERUP, FSM_EVENT_SUPERVISE), 1);
+	EMB_ASSERT_EQUAL(Fsm::transitionCount(CONVERTER_POWERUP, FSM_EVENT_STARTUP), 0);
+	EMB_ASSERT_EQUAL(Fsm::transitionCount(CONVERTER_STANDBY, FSM_EVENT_STARTUP), 2);
+	EMB_ASSERT_EQUAL(Fsm::transitionCount(CONVERTER_STANDBY, FSM_EVENT_SUPERVISE), 0);
+	EMB_ASSERT_EQUAL(Fsm::transitionCount(CONVERTER_STARTUP, FSM_EVENT_SUPERVISE), 4);
+	EMB_ASSERT_EQUAL(Fsm::transitionCount(CONVERTER_CHARGING_START, FSM_EVENT_RUN), 3);
+	EMB_ASSERT_EQUAL(Fsm::transitionCount(CONVERTER_WAIT, FSM_EVENT_SUPERVISE), 1);
+	EMB_ASSERT_EQUAL(Fsm::transitionCount(CONVERTER_WAIT, FSM_EVENT_WAIT_TIMEOUT), 1);
+	EMB_ASSERT_EQUAL(Fsm::transitionCount(CONVERTER_STARTUP, FSM_EVENT_STARTUP_TIMEOUT), 1);
+
+	// PWM ISR fast path is handled only in charging states
+	for (size_t state = 0; state < CONVERTER_STATE_COUNT; ++state)
+	{
+		if ((state == CONVERTER_CHARGING_START) || (state == CONVERTER_CHARGING))
+		{
+			EMB_ASSERT_TRUE(Fsm::transitionCount(ConverterState(state), FSM_EVENT_RUN) > 0);
+		}
+		else
+		{
+			EMB_ASSERT_EQUAL(Fsm::transitionCount(ConverterState(state), FSM_EVENT_RUN), 0);
+		}
+	}
+
+	// every state with active converter must handle shutdown
+	EMB_ASSERT_TRUE(Fsm::transitionCount(CONVERTER_CHARGING_START, FSM_EVENT_SHUTDOWN) > 0);
+	EMB_ASSERT_TRUE(Fsm::transitionCount(CONVERTER_CHARGING, FSM_EVENT_SHUTDOWN) > 0);
+	EMB_ASSERT_TRUE(Fsm::transitionCount(CONVERTER_CHARGING, FSM_EVENT_EMERGENCY_SHUTDOWN) > 0);
+	EMB_ASSERT_TRUE(Fsm::transitionCount(CONVERTER_WAIT, FSM_EVENT_EMERGENCY_SHUTDOWN) > 0);
+
+	for (size_t event = 0; event < FSM_EVENT_COUNT; ++event)
+	{
+		EMB_ASSERT_EQUAL(Fsm::transitionCount(CONVERTER_CHARGING_STOP, FsmEvent(event)), 0);
+	}
+}
+
+
+namespace baseline {
+
+// run() of virtual state classes that were replaced by transition table, kept as ISR cost baseline
+class IState
+{
+public:
+	virtual ~IState() {}
+	virtual void run(IFsmEnvironment* env) = 0;
+};
+
+
+class ReadyState : public IState
+{
+public:
+	virtual void run(IFsmEnvironment* env)
+	{
+		if (env->hasErrors())
+		{
+			env->stopFuelcells();
+		}
+	}
+};
+
+
+class ChargingStartState : public IState
+{
+private:
+	float m_currentInRef;
+public:
+	ChargingStartState() : m_currentInRef(0) {}
+	virtual void run(IFsmEnvironment* env)
+	{
+		if (env->hasErrors())
+		{
+			env->stopConverter();
+			env->stopFuelcells();
+		}
+
+		float currRefDiff = (env->currentInMax() - env->currentInMin()) / (60 * env->pwmFreq());
+		m_currentInRef = emb::clamp(m_currentInRef + currRefDiff, env->currentInMin(), env->currentInMax());
+		env->setCurrentIn(m_currentInRef);
+
+		if (m_currentInRef >= env->currentInMax())
+		{
+			m_currentInRef = 0;
+		}
+	}
+};
+
+
+class ChargingState : public IState
+{
+public:
+	virtual void run(IFsmEnvironment* env)
+	{
+		if (env->hasErrors())
+		{
+			env->stopConverter();
+			env->stopFuelcells();
+		}
+	}
+};
+
+} // namespace baseline
+
+
+///
+///
+///
+void FuelcellTest::FsmDispatchBenchmark()
+{
+	const size_t DISPATCH_COUNT = 100;
+	// PWM ISR cost outside and inside charging, and supervisor cost of startup monitoring that was done by ISR before
+	const ConverterState STATES[4] = {CONVERTER_READY, CONVERTER_CHARGING_START, CONVERTER_CHARGING, CONVERTER_STARTUP};
+	const FsmEvent EVENTS[4] = {FSM_EVENT_RUN, FSM_EVENT_RUN, FSM_EVENT_RUN, FSM_EVENT_SUPERVISE};
+	const char* NAMES[4] = {"READY run", "CHARGING_START run", "CHARGING run", "STARTUP supervise"};
+
+	// run() of the same states through virtual state classes, as ISR called it before transition table
+	static baseline::ReadyState readyState;
+	static baseline::ChargingStartState chargingStartState;
+	static baseline::ChargingState chargingState;
+	baseline::IState* const BASELINE_STATES[3] = {&readyState, &chargingStartState, &chargingState};
+
+	sim::Environment env;
+	Fsm::init(&env);
+
+	mcu::HighResolutionClock::init(1000000);
+	mcu::HighResolutionClock::start();
+
+	for (size_t k = 0; k < 4; ++k)
+	{
+		ConverterState state = STATES[k];
+		uint32_t start = mcu::HighResolutionClock::counter();
+		for (size_t i = 0; i < DISPATCH_COUNT; ++i)
+		{
+			Fsm::dispatch(state, EVENTS[k]);
+		}
+		uint32_t cycles = start - mcu::HighResolutionClock::counter();
+		EMB_ASSERT_EQUAL(state, STATES[k]);
+
+		if (k < 3)
+		{
+			start = mcu::HighResolutionClock::counter();
+			for (size_t i = 0; i < DISPATCH_COUNT; ++i)
+			{
+				BASELINE_STATES[k]->run(&env);
+			}
+			uint32_t baselineCycles = start - mcu::HighResolutionClock::counter();
+			printf("FSM dispatch, %s: %lu cycles, virtual state class: %lu cycles\n", NAMES[k],
+					(unsigned long)(cycles / DISPATCH_COUNT), (unsigned long)(baselineCycles / DISPATCH_COUNT));
+		}
+		else
+		{
+			printf("FSM dispatch, %s: %lu cycles\n", NAMES[k], (unsigned long)(cycles / DISPATCH_COUNT));
+		}
+	}
+
+	mcu::HighResolutionClock::stop();
+}
+
+
+///
+///
+///
+void FuelcellTest::FsmTimerQueueTest()
+{
+	FsmTimerQueue<FsmEvent, 4> timers;
+	FsmEvent event;
+
+	EMB_ASSERT_TRUE(timers.empty());
+	EMB_ASSERT_TRUE(!timers.pop(1000, event));
+
+	timers.schedule(FSM_EVENT_STARTUP_TIMEOUT, 450);
+	timers.schedule(FSM_EVENT_WAIT_TIMEOUT, 50);
+	timers.schedule(FSM_EVENT_ERROR_ENABLING_TIMEOUT, 300);
+	EMB_ASSERT_EQUAL(timers.size(), 3);
+
+	EMB_ASSERT_TRUE(!timers.pop(49, event));
+	EMB_ASSERT_TRUE(timers.pop(50, event));
+	EMB_ASSERT_EQUAL(event, FSM_EVENT_WAIT_TIMEOUT);
+	EMB_ASSERT_TRUE(!timers.pop(299, event));
+
+	// restarted timer keeps single entry
+	timers.schedule(FSM_EVENT_STARTUP_TIMEOUT, 200);
+	EMB_ASSERT_EQUAL(timers.size(), 2);
+	EMB_ASSERT_TRUE(timers.pop(1000, event));
+	EMB_ASSERT_EQUAL(event, FSM_EVENT_STARTUP_TIMEOUT);
+	EMB_ASSERT_TRUE(timers.pop(1000, event));
+	EMB_ASSERT_EQUAL(event, FSM_EVENT_ERROR_ENABLING_TIMEOUT);
+	EMB_ASSERT_TRUE(timers.empty());
+
+	// equal deadlines expire in scheduling order
+	timers.schedule(FSM_EVENT_WAIT_TIMEOUT, 100);
+	timers.schedule(FSM_EVENT_STARTUP_TIMEOUT, 100);
+	timers.cancel(FSM_EVENT_ERROR_ENABLING_TIMEOUT);
+	EMB_ASSERT_EQUAL(timers.size(), 2);
+	EMB_ASSERT_TRUE(timers.pop(100, event));
+	EMB_ASSERT_EQUAL(event, FSM_EVENT_WAIT_TIMEOUT);
+	timers.cancel(FSM_EVENT_STARTUP_TIMEOUT);
+	EMB_ASSERT_TRUE(timers.empty());
+}
+
+
+///
+///
+///
+void FuelcellTest::FsmEventQueueTest()
+{
+	FsmEventQueue<FsmEvent, 4> events;
+	FsmEvent event;
+
+	EMB_ASSERT_TRUE(events.empty());
+	EMB_ASSERT_TRUE(!events.pop(event));
+
+	// events are popped in order of arrival, repeated command is coalesced
+	EMB_ASSERT_TRUE(events.push(FSM_EVENT_STARTUP));
+	EMB_ASSERT_TRUE(events.push(FSM_EVENT_SHUTDOWN));
+	EMB_ASSERT_TRUE(events.push(FSM_EVENT_SHUTDOWN));
+	EMB_ASSERT_TRUE(events.push(FSM_EVENT_STARTUP));
+	EMB_ASSERT_EQUAL(events.size(), 3);
+	EMB_ASSERT_TRUE(events.pop(event));
+	EMB_ASSERT_EQUAL(event, FSM_EVENT_STARTUP);
+	EMB_ASSERT_TRUE(events.pop(event));
+	EMB_ASSERT_EQUAL(event, FSM_EVENT_SHUTDOWN);
+
+	// urgent event overtakes queued events
+	EMB_ASSERT_TRUE(events.push(FSM_EVENT_START_CHARGING));
+	events.pushFront(FSM_EVENT_EMERGENCY_SHUTDOWN);
+	EMB_ASSERT_TRUE(events.pop(event));
+	EMB_ASSERT_EQUAL(event, FSM_EVENT_EMERGENCY_SHUTDOWN);
+	EMB_ASSERT_TRUE(events.pop(event));
+	EMB_ASSERT_EQUAL(event, FSM_EVENT_STARTUP);
+	EMB_ASSERT_TRUE(events.pop(event));
+	EMB_ASSERT_EQUAL(event, FSM_EVENT_START_CHARGING);
+	EMB_ASSERT_TRUE(events.empty());
+
+	// event is lost if queue is full, urgent event drops last queued event
+	EMB_ASSERT_TRUE(events.push(FSM_EVENT_STARTUP));
+	EMB_ASSERT_TRUE(events.push(FSM_EVENT_SHUTDOWN));
+	EMB_ASSERT_TRUE(events.push(FSM_EVENT_STARTUP));
+	EMB_ASSERT_TRUE(events.push(FSM_EVENT_START_CHARGING));
+	EMB_ASSERT_TRUE(!events.push(FSM_EVENT_STOP_CHARGING));
+	EMB_ASSERT_EQUAL(events.lostCount(), 1);
+	events.pushFront(FSM_EVENT_EMERGENCY_SHUTDOWN);
+	EMB_ASSERT_EQUAL(events.lostCount(), 2);
+	EMB_ASSERT_EQUAL(events.size(), 4);
+	EMB_ASSERT_TRUE(events.pop(event));
+	EMB_ASSERT_EQUAL(event, FSM_EVENT_EMERGENCY_SHUTDOWN);
+	events.clear();
+	EMB_ASSERT_TRUE(events.empty());
+}
+
+
+///
+///
+///
+void FuelcellTest::SuperviseBudgetBenchmark()
+{
+	// PWM event interrupt is masked for whole supervise() pass: pass with full event queue must fit in PWM period,
+	// so that PWM event is only delayed and never lost
+	const size_t EVENT_CAPACITY = 8;
+	const size_t PASS_COUNT = 100;
+	const FsmEvent COMMANDS[2] = {FSM_EVENT_START_CHARGING, FSM_EVENT_STOP_CHARGING};
+
+	sim::Environment env;
+	Fsm::init(&env);
+	FsmEventQueue<FsmEvent, EVENT_CAPACITY> events;
+	ConverterState state = CONVERTER_READY;
+
+	mcu::HighResolutionClock::init(1000000);
+	mcu::HighResolutionClock::start();
+
+	uint32_t cycles = 0;
+	for (size_t i = 0; i < PASS_COUNT; ++i)
+	{
+		for (size_t k = 0; k < EVENT_CAPACITY; ++k)
+		{
+			events.push(COMMANDS[k % 2]);
+		}
+
+		uint32_t start = mcu::HighResolutionClock::counter();
+		FsmEvent event;
+		for (;;)
+		{
+			{
+				mcu::NESTED_CRITICAL_SECTION;
+				if (!events.pop(event))
+				{
+					break;
+				}
+			}
+			Fsm::dispatch(state, event);
+		}
+		Fsm::dispatch(state, FSM_EVENT_SUPERVISE);
+		cycles += start - mcu::HighResolutionClock::counter();
+	}
+
+	mcu::HighResolutionClock::stop();
+
+	uint32_t passCycles = cycles / PASS_COUNT;
+	uint32_t pwmPeriodCycles = static_cast<uint32_t>(mcu::sysclkFreq()
+			/ Settings::DEFAULT_CONFIG.PWM_CONFIG.switchingFreq);
+	printf("supervise pass, %lu events: %lu cycles, PWM period: %lu cycles\n",
+			(unsigned long)EVENT_CAPACITY, (unsigned long)passCycles, (unsigned long)pwmPeriodCycles);
+	EMB_ASSERT_TRUE(passCycles < pwmPeriodCycles);
+}
+
+
+///
+///
+///
+static const sim::TraceStep normalSessionTrace[] =
+{
+	{100,	sim::INPUT_IDLE,		CONVERTER_POWERUP},
+	{0,	sim::INPUT_CONNECTION_OK,	CONVERTER_POWERUP},
+	{20,	sim::INPUT_IDLE,		CONVERTER_WAIT},
+	{5100,	sim::INPUT_IDLE,		CONVERTER_STANDBY},
+	{0,	sim::INPUT_STARTUP,		CONVERTER_STARTUP},
+	{1000,	sim::INPUT_FUELCELLS_RUNNING,	CONVERTER_STARTUP},
+	{20,	sim::INPUT_IDLE,		CONVERTER_WAIT},
+	{5100,	sim::INPUT_IDLE,		CONVERTER_READY},
+	{0,	sim::INPUT_START_CHARGING,	CONVERTER_CHARGING_START},
+	{30000,	sim::INPUT_IDLE,		CONVERTER_CHARGING_START},
+	{31000,	sim::INPUT_IDLE,		CONVERTER_CHARGING},
+	{0,	sim::INPUT_STOP_CHARGING,	CONVERTER_READY},
+	{0,	sim::INPUT_ERROR,		CONVERTER_READY},
+	{20,	sim::INPUT_IDLE,		CONVERTER_WAIT},
+	{2100,	sim::INPUT_IDLE,		CONVERTER_WAIT},
+	{5100,	sim::INPUT_IDLE,		CONVERTER_STANDBY},
+	{0,	sim::INPUT_STARTUP,		CONVERTER_WAIT},
+	{10100,	sim::INPUT_IDLE,		CONVERTER_STANDBY},
+};
+
+
+///
+///
+///
+void FuelcellTest::FsmReplayTest()
+{
+	const size_t STEP_COUNT = sizeof(normalSessionTrace) / sizeof(normalSessionTrace[0]);
+	sim::Simulator simulator;
+
+	mcu::HighResolutionClock::init(1000000);
+	mcu::HighResolutionClock::start();
+	uint32_t start = mcu::HighResolutionClock::counter();
+	simulator.run(normalSessionTrace, STEP_COUNT);
+	uint32_t cycles = start - mcu::HighResolutionClock::counter();
+	mcu::HighResolutionClock::stop();
+
+	EMB_ASSERT_EQUAL(simulator.mismatches(), 0);
+	EMB_ASSERT_EQUAL(simulator.violations(), 0);
+	EMB_ASSERT_EQUAL(simulator.env().currentRef, simulator.env().currentInMax());
+	EMB_ASSERT_EQUAL(Fsm::failureCount(), 1);
+	EMB_ASSERT_TRUE(!simulator.env().errors);
+	EMB_ASSERT_TRUE(!simulator.env().pwmOn);
+	EMB_ASSERT_TRUE(!simulator.env().relayOn);
+
+	// same trace twice gives same result
+	sim::Coverage coverage = simulator.coverage();
+	simulator.run(normalSessionTrace, STEP_COUNT);
+	EMB_ASSERT_EQUAL(simulator.coverage().count(), coverage.count());
+	EMB_ASSERT_EQUAL(simulator.mismatches(), 0);
+
+	uint32_t elapsed_ms = cycles / (mcu::sysclkFreq() / 1000);
+	printf("FSM replay: %lu ms simulated in %lu ms\n", (unsigned long)simulator.env().time, (unsigned long)elapsed_ms);
+}
+
+
+///
+///
+///
+void FuelcellTest::FsmFuzzTest()
+{
+	const size_t STEP_COUNT = sizeof(normalSessionTrace) / sizeof(normalSessionTrace[0]);
+	sim::Simulator simulator;
+	simulator.run(normalSessionTrace, STEP_COUNT);
+	size_t seedCoverage = simulator.coverage().count();
+
+	sim::FuzzStatistics stats;
+	sim::fuzz(normalSessionTrace, STEP_COUNT, 100, 0x5EED, stats);
+
+	EMB_ASSERT_EQUAL(stats.runs, 100);
+	EMB_ASSERT_EQUAL(stats.violations, 0);
+	EMB_ASSERT_TRUE(stats.coverage > seedCoverage);
+	EMB_ASSERT_TRUE(stats.corpusSize > 1);
+
+	printf("FSM fuzzing: %lu runs, %lu s simulated, corpus %u traces, %u transitions covered\n",
+			(unsigned long)stats.runs, (unsigned long)(stats.simulatedTime / 1000),
+			(unsigned int)stats.corpusSize, (unsigned int)stats.coverage);
+}
+
+
+
+///
+///
+///
+void FuelcellTest::ErrorLatchTest()
+{
+	// fuel cell errors are checked by CPU1 and are set only if condition persists for propagation delay
+	Syslog::resetErrorsWarnings();
+	Syslog::enableError(sys::Error::FUELCELL_UV);
+	Controller::initErrorLatches();
+
+	uint64_t start = mcu::SystemClock::now();
+	Syslog::updateError(sys::Error::FUELCELL_UV, true);
+	EMB_ASSERT_TRUE(!Syslog::hasError(sys::Error::FUELCELL_UV));
+	while (mcu::SystemClock::now() < start + Controller::ERROR_PROPAGATION_DELAY - 100)
+	{
+		Syslog::updateError(sys::Error::FUELCELL_UV, true);
+		DEVICE_DELAY_US(10000);
+	}
+	EMB_ASSERT_TRUE(!Syslog::hasError(sys::Error::FUELCELL_UV));
+
+	// condition that disappears restarts delay
+	Syslog::updateError(sys::Error::FUELCELL_UV, false);
+	start = mcu::SystemClock::now();
+	Syslog::updateError(sys::Error::FUELCELL_UV, true);
+	DEVICE_DELAY_US(200000);
+	Syslog::updateError(sys::Error::FUELCELL_UV, true);
+	EMB_ASSERT_TRUE(!Syslog::hasError(sys::Error::FUELCELL_UV));
+
+	while (mcu::SystemClock::now() < start + Controller::ERROR_PROPAGATION_DELAY + 10)
+	{
+		DEVICE_DELAY_US(10000);
+	}
+	Syslog::updateError(sys::Error::FUELCELL_UV, true);
+	EMB_ASSERT_TRUE(Syslog::hasError(sys::Error::FUELCELL_UV));
+
+	Syslog::configureErrorLatch(sys::Error::FUELCELL_UV, 1, 0, 1, 0);
+	Syslog::updateError(sys::Error::FUELCELL_UV, false);
+	Syslog::disableError(sys::Error::FUELCELL_UV);
+	Syslog::resetErrorsWarnings();
+}
+
+} // namespace fuelcell
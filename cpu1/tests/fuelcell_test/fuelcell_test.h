@@ -0,0 +1,40 @@
+///
+#pragma once
+
+#include "emb/emb_testrunner/emb_testrunner.h"
+#include "emb/emb_algorithm.h"
+#include "fuelcell/controller/fuelcell_celltable.h"
+#include "fuelcell/controller/fuelcell_linkstats.h"
+#include "fuelcell/controller/fuelcell_pdo.h"
+#include "fuelcell/controller/fuelcell_controller.h"
+#include "sys/syslog/syslog.h"
+#include "fuelcell/fsm/fsm.h"
+#include "settings/settings.h"
+#include "fuelcell_fsm_sim.h"
+#include "mcu/system/mcu_system.h"
+#include "mcu/cputimers/mcu_cputimers.h"
+
+
+namespace fuelcell {
+
+class FuelcellTest
+{
+public:
+	static void CellTableTest();
+	static void CellTableBenchmark();
+	static void SeqLockTest();
+	static void LinkStatisticsTest();
+	static void PdoCodecTest();
+	static void PdoDecodingBenchmark();
+	static void FsmTableTest();
+	static void FsmDispatchBenchmark();
+	static void FsmTimerQueueTest();
+	static void FsmEventQueueTest();
+	static void SuperviseBudgetBenchmark();
+	static void FsmReplayTest();
+	static void FsmFuzzTest();
+	static void ErrorLatchTest();
+};
+
+
+} // namespace fuelcell
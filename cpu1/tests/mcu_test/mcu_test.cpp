@@ -173,3 +173,204 @@ void McuTest::ClockTest()
 
 
 
+
+
+namespace {
+const uint32_t BENCHMARK_CLOCK_PERIOD_US = 1000000;	// period that is used by cycle benchmarks
+const uint32_t ATOMIC_TEST_ISR_MASK = 0x00020002;	// bits in both halves of word
+const uint32_t ATOMIC_TEST_MAIN_MASK = 0x00010001;
+volatile uint32_t atomicTestWord;
+volatile uint32_t atomicTestIsrCount;
+volatile uint32_t atomicTestIsrLostUpdates;
+}
+
+
+///
+///
+///
+__interrupt void onAtomicTestInterrupt()
+{
+	// ISR toggles its bits, lost update is detected if main loop has overwritten them
+	uint32_t expected = (atomicTestIsrCount % 2) ? ATOMIC_TEST_ISR_MASK : 0;
+	if ((atomicTestWord & ATOMIC_TEST_ISR_MASK) != expected)
+	{
+		++atomicTestIsrLostUpdates;
+	}
+
+	if (expected == 0)
+	{
+		emb::atomicOr(atomicTestWord, ATOMIC_TEST_ISR_MASK);
+	}
+	else
+	{
+		emb::atomicAnd(atomicTestWord, ~ATOMIC_TEST_ISR_MASK);
+	}
+	++atomicTestIsrCount;
+}
+
+
+///
+///
+///
+void McuTest::AtomicInterruptTest()
+{
+	const uint32_t ITERATION_COUNT = 20000;
+
+	atomicTestWord = 0;
+	atomicTestIsrCount = 0;
+	atomicTestIsrLostUpdates = 0;
+	uint32_t mainLostUpdates = 0;
+
+	// timer is shared with benchmarks: period is changed for this test and restored afterwards
+	mcu::HighResolutionClock::init(BENCHMARK_CLOCK_PERIOD_US);
+	mcu::HighResolutionClock::setPeriodCycles(997);
+	mcu::HighResolutionClock::registerInterruptHandler(onAtomicTestInterrupt);
+	mcu::HighResolutionClock::start();
+
+	for (uint32_t i = 0; i < ITERATION_COUNT; ++i)
+	{
+		emb::atomicOr(atomicTestWord, ATOMIC_TEST_MAIN_MASK);
+		if ((atomicTestWord & ATOMIC_TEST_MAIN_MASK) != ATOMIC_TEST_MAIN_MASK)
+		{
+			++mainLostUpdates;
+		}
+		emb::atomicAnd(atomicTestWord, ~ATOMIC_TEST_MAIN_MASK);
+		if ((atomicTestWord & ATOMIC_TEST_MAIN_MASK) != 0)
+		{
+			++mainLostUpdates;
+		}
+	}
+
+	uint32_t isrCount = atomicTestIsrCount;
+	uint32_t isrLostUpdates = atomicTestIsrLostUpdates;
+
+	// same load with plain read-modify-write, lost updates are expected and only reported
+	for (uint32_t i = 0; i < ITERATION_COUNT; ++i)
+	{
+		atomicTestWord = atomicTestWord | ATOMIC_TEST_MAIN_MASK;
+		atomicTestWord = atomicTestWord & ~ATOMIC_TEST_MAIN_MASK;
+	}
+
+	mcu::HighResolutionClock::stop();
+	Interrupt_disable(INT_TIMER1);
+	CPUTimer_disableInterrupt(CPUTIMER1_BASE);
+	mcu::HighResolutionClock::setPeriod(BENCHMARK_CLOCK_PERIOD_US);
+
+	EMB_ASSERT_TRUE(isrCount > 100);
+	EMB_ASSERT_EQUAL(isrLostUpdates, 0);
+	EMB_ASSERT_EQUAL(mainLostUpdates, 0);
+	printf("Atomic ops vs ISR: %lu interrupts, 0 lost updates; plain read-modify-write: %lu lost updates\n",
+			(unsigned long)isrCount, (unsigned long)(atomicTestIsrLostUpdates - isrLostUpdates));
+}
+
+
+///
+///
+///
+void McuTest::AtomicBenchmark()
+{
+	const size_t OP_COUNT = 100;
+	static volatile uint32_t word = 0;
+
+	mcu::HighResolutionClock::init(1000000);
+	mcu::HighResolutionClock::start();
+
+	// previous Syslog::setError()/resetError() implementation
+	uint32_t start = mcu::HighResolutionClock::counter();
+	for (size_t i = 0; i < OP_COUNT; ++i)
+	{
+		{
+			mcu::CRITICAL_SECTION;
+			word = word | (1UL << 20);
+		}
+		{
+			mcu::CRITICAL_SECTION;
+			word = word & ((1UL << 20) ^ 0xFFFFFFFF);
+		}
+	}
+	uint32_t cyclesCriticalSection = start - mcu::HighResolutionClock::counter();
+
+	start = mcu::HighResolutionClock::counter();
+	for (size_t i = 0; i < OP_COUNT; ++i)
+	{
+		emb::atomicSetBit(word, 20);
+		emb::atomicClearBit(word, 20);
+	}
+	uint32_t cyclesAtomic = start - mcu::HighResolutionClock::counter();
+
+	mcu::HighResolutionClock::stop();
+
+	EMB_ASSERT_EQUAL(word, 0);
+	printf("Set/reset error bit: critical section %lu cycles, atomic ops %lu cycles\n",
+			(unsigned long)(cyclesCriticalSection / OP_COUNT), (unsigned long)(cyclesAtomic / OP_COUNT));
+}
+
+
+namespace {
+typedef emb::SpscQueue<uint16_t, 16> SpscTestQueue;
+SpscTestQueue::ProducerData spscTestProducerData;
+SpscTestQueue::ConsumerData spscTestConsumerData;
+SpscTestQueue spscTestQueue(&spscTestProducerData, &spscTestConsumerData);
+volatile uint16_t spscTestNextValue;
+}
+
+
+///
+///
+///
+__interrupt void onSpscTestInterrupt()
+{
+	// ISR is producer, sequence number is advanced only by accepted pushes
+	if (spscTestQueue.push(spscTestNextValue))
+	{
+		spscTestNextValue = spscTestNextValue + 1;
+	}
+}
+
+
+///
+///
+///
+void McuTest::SpscQueueInterruptTest()
+{
+	const uint32_t MESSAGE_COUNT = 50000;
+
+	spscTestQueue.initProducer();
+	spscTestQueue.initConsumer();
+	spscTestNextValue = 0;
+
+	uint32_t received = 0;
+	uint32_t outOfOrder = 0;
+	uint16_t expected = 0;
+	uint16_t value;
+
+	// timer is shared with benchmarks: period is changed for this test and restored afterwards
+	mcu::HighResolutionClock::init(BENCHMARK_CLOCK_PERIOD_US);
+	mcu::HighResolutionClock::setPeriodCycles(499);
+	mcu::HighResolutionClock::registerInterruptHandler(onSpscTestInterrupt);
+	uint64_t start = mcu::SystemClock::now();
+	mcu::HighResolutionClock::start();
+
+	while (received < MESSAGE_COUNT)
+	{
+		if (spscTestQueue.pop(value))
+		{
+			if (value != expected)
+			{
+				++outOfOrder;
+			}
+			expected = value + 1;
+			++received;
+		}
+	}
+
+	mcu::HighResolutionClock::stop();
+	uint64_t duration = mcu::SystemClock::now() - start;
+	Interrupt_disable(INT_TIMER1);
+	CPUTimer_disableInterrupt(CPUTIMER1_BASE);
+	mcu::HighResolutionClock::setPeriod(BENCHMARK_CLOCK_PERIOD_US);
+
+	EMB_ASSERT_EQUAL(outOfOrder, 0);
+	printf("SPSC queue, ISR producer: %lu messages in %lu ms, %lu overflows\n",
+			(unsigned long)received, (unsigned long)duration, (unsigned long)spscTestQueue.overflowCount());
+}
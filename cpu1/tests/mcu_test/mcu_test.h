@@ -7,6 +7,8 @@
 #include "mcu/gpio/mcu_gpio.h"
 #include "mcu/cputimers/mcu_cputimers.h"
 #include "mcu/support/mcu_support.h"
+#include "emb/emb_atomic.h"
+#include "emb/emb_spscqueue.h"
 
 
 class McuTest
@@ -14,6 +16,9 @@ class McuTest
 public:
 	static void GpioTest();
 	static void ClockTest();
+	static void AtomicInterruptTest();
+	static void AtomicBenchmark();
+	static void SpscQueueInterruptTest();
 };
 
 
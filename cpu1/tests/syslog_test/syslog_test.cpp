@@ -0,0 +1,285 @@
+///
+#include "syslog_test.h"
+
+
+/// Records writes instead of storing data
+class EepromStub : public emb::IEeprom
+{
+public:
+	unsigned int writeCount;
+	unsigned int byteCount;
+	EepromStub() : writeCount(0), byteCount(0) {}
+	virtual emb::EepromStatus write(emb::EepromAddr addr, const char* data, unsigned int nBytes, uint64_t timeoutMs)
+	{
+		++writeCount;
+		byteCount += nBytes;
+		return emb::EEPROM_SUCCESS;
+	}
+	virtual emb::EepromStatus read(emb::EepromAddr addr, char* data, unsigned int nBytes, uint64_t timeoutMs)
+	{
+		return emb::EEPROM_READ_FAIL;
+	}
+};
+
+
+///
+///
+///
+void SyslogTest::EventLogTest()
+{
+	static sys::EventLog<4> events;
+	events.clear();
+	EMB_ASSERT_EQUAL(events.size(), 0);
+
+	sys::EventRecord record = {};
+	for (uint16_t i = 0; i < 3; ++i)
+	{
+		record.timestamp = 100 + i;
+		record.code = i;
+		events.push(record);
+	}
+	EMB_ASSERT_EQUAL(events.size(), 3);
+	EMB_ASSERT_EQUAL(events.at(0).code, 0);
+	EMB_ASSERT_EQUAL(events.at(2).timestamp, 102);
+
+	// oldest records are overwritten
+	for (uint16_t i = 3; i < 6; ++i)
+	{
+		record.timestamp = 100 + i;
+		record.code = i;
+		events.push(record);
+	}
+	EMB_ASSERT_EQUAL(events.size(), 4);
+	EMB_ASSERT_EQUAL(events.totalCount(), 6);
+	for (size_t i = 0; i < 4; ++i)
+	{
+		EMB_ASSERT_EQUAL(events.at(i).code, i + 2);
+	}
+
+	EepromStub eeprom;
+	EMB_ASSERT_EQUAL(events.flush(&eeprom, emb::EepromAddr(0), 10), emb::EEPROM_SUCCESS);
+	EMB_ASSERT_EQUAL(eeprom.writeCount, 5);
+	EMB_ASSERT_EQUAL(eeprom.byteCount, sizeof(uint32_t) + 4 * sizeof(sys::EventRecord));
+}
+
+
+///
+///
+///
+void SyslogTest::FirstErrorTest()
+{
+	Syslog::resetErrorsWarnings();
+	EMB_ASSERT_TRUE(!Syslog::hasFirstError());
+	uint32_t eventCount = Syslog::events().totalCount();
+
+	Syslog::setError(sys::Error::OVP_IN, 850.f);
+	Syslog::setError(sys::Error::OVP_IN, 900.f);	// already set - not recorded
+	Syslog::setError(sys::Error::OCP_IN, 120.f);
+	EMB_ASSERT_EQUAL(Syslog::events().totalCount(), eventCount + 2);
+
+	EMB_ASSERT_TRUE(Syslog::hasFirstError());
+	EMB_ASSERT_EQUAL(Syslog::firstError().type, sys::Event::ERROR_SET);
+	EMB_ASSERT_EQUAL(Syslog::firstError().code, sys::Error::OVP_IN);
+	EMB_ASSERT_EQUAL(Syslog::firstError().value, 850.f);
+
+	const sys::EventLog<64>& events = Syslog::events();
+	EMB_ASSERT_EQUAL(events.at(events.size() - 1).code, sys::Error::OCP_IN);
+	EMB_ASSERT_EQUAL(events.at(events.size() - 1).value, 120.f);
+
+	// reset is recorded, next error is captured as first one
+	Syslog::resetErrorsWarnings();
+	EMB_ASSERT_EQUAL(events.at(events.size() - 1).type, sys::Event::ERRORS_RESET);
+	Syslog::setError(sys::Error::OCP_IN, 130.f);
+	EMB_ASSERT_EQUAL(Syslog::firstError().code, sys::Error::OCP_IN);
+	Syslog::resetErrorsWarnings();
+}
+
+
+
+
+///
+///
+///
+void SyslogTest::ErrorStatisticsTest()
+{
+	sys::ErrorStatistics stats;
+	EMB_ASSERT_EQUAL(stats.count(), 0);
+	EMB_ASSERT_EQUAL(stats.ratePerMinute(1000), 0.f);
+
+	// 4 occurrences in first minute
+	for (uint32_t t = 10000; t <= 40000; t += 10000)
+	{
+		stats.onSet(t);
+		stats.onClear(t + 500);
+	}
+	EMB_ASSERT_EQUAL(stats.count(), 4);
+	EMB_ASSERT_EQUAL(stats.lastSet(), 40000);
+	EMB_ASSERT_EQUAL(stats.lastCleared(), 40500);
+	EMB_ASSERT_EQUAL(stats.ratePerMinute(59999), 4.f);
+
+	// previous minute is weighted by its overlap with last 60 s
+	EMB_ASSERT_EQUAL(stats.ratePerMinute(90000), 2.f);
+	stats.onSet(90000);
+	EMB_ASSERT_EQUAL(stats.ratePerMinute(90000), 3.f);
+	EMB_ASSERT_EQUAL(stats.ratePerMinute(150000), 0.5f);
+	EMB_ASSERT_EQUAL(stats.ratePerMinute(180000), 0.f);
+
+	// counter saturates
+	for (uint32_t i = 0; i < 0x10000; ++i)
+	{
+		stats.onSet(200000);
+	}
+	EMB_ASSERT_EQUAL(stats.count(), 0xFFFF);
+
+	// Syslog counts only occurrences, not repeated set() of already set error
+	Syslog::resetErrorsWarnings();
+	uint16_t count = Syslog::errorStatistics(sys::Error::OCP_IN).count();
+	Syslog::setError(sys::Error::OCP_IN);
+	Syslog::setError(sys::Error::OCP_IN);
+	EMB_ASSERT_EQUAL(Syslog::errorStatistics(sys::Error::OCP_IN).count(), count + 1);
+	sys::EventRecord record = Syslog::events().at(Syslog::events().size() - 1);
+	EMB_ASSERT_EQUAL(record.type, sys::Event::ERROR_SET);
+	EMB_ASSERT_EQUAL(Syslog::errorStatistics(sys::Error::OCP_IN).lastSet(), record.timestamp);	// set with claimed transition
+	Syslog::resetError(sys::Error::OCP_IN);
+	uint32_t lastCleared = Syslog::errorStatistics(sys::Error::OCP_IN).lastCleared();
+	EMB_ASSERT_TRUE(lastCleared >= Syslog::errorStatistics(sys::Error::OCP_IN).lastSet());
+	Syslog::setError(sys::Error::OCP_IN);
+	EMB_ASSERT_EQUAL(Syslog::errorStatistics(sys::Error::OCP_IN).count(), count + 2);
+	Syslog::resetErrorsWarnings();
+	EMB_ASSERT_TRUE(Syslog::errorStatistics(sys::Error::OCP_IN).lastCleared() > lastCleared);
+
+	// only errors that were actually cleared are registered
+	lastCleared = Syslog::errorStatistics(sys::Error::OCP_IN).lastCleared();
+	Syslog::resetError(sys::Error::OCP_IN);
+	Syslog::resetErrorsWarnings();
+	EMB_ASSERT_EQUAL(Syslog::errorStatistics(sys::Error::OCP_IN).lastCleared(), lastCleared);
+}
+
+
+///
+///
+///
+void SyslogTest::SnapshotTest()
+{
+	Syslog::resetErrorsWarnings();
+	uint16_t ovpCount = Syslog::errorStatistics(sys::Error::OVP_IN).count();
+	uint16_t uvpCount = Syslog::errorStatistics(sys::Error::UVP_IN).count();
+	Syslog::setError(sys::Error::OVP_IN, 850.f);
+	Syslog::setError(sys::Error::UVP_IN, 10.f);
+	Syslog::setWarning(sys::Warning::CAN_BUS_WARNING);
+
+	static sys::SyslogSnapshot snapshot;
+	EMB_ASSERT_TRUE(Syslog::takeSnapshot(snapshot));
+	EMB_ASSERT_EQUAL(snapshot.word(0) >> 16, uint32_t(sys::SyslogSnapshot::VERSION));
+	EMB_ASSERT_EQUAL(snapshot.word(0) & 0xFFFF, sys::SyslogSnapshot::wordCount());
+	EMB_ASSERT_TRUE(snapshot.flags & sys::SyslogSnapshot::FLAG_CONSISTENT);
+	EMB_ASSERT_TRUE(snapshot.flags & sys::SyslogSnapshot::FLAG_FIRST_ERROR);
+	for (size_t i = 0; i < sys::Error::ERROR_WORD_COUNT; ++i)
+	{
+		EMB_ASSERT_EQUAL(snapshot.errors[i], Syslog::errors(i));
+	}
+	EMB_ASSERT_EQUAL(snapshot.warnings[sys::maskWord(sys::Warning::CAN_BUS_WARNING)],
+			sys::maskBit(sys::Warning::CAN_BUS_WARNING));
+	EMB_ASSERT_EQUAL(snapshot.eventTotalCount, Syslog::events().totalCount());
+
+	// OVP_IN = 0 and UVP_IN = 1 share first word
+	EMB_ASSERT_EQUAL(snapshot.errorCounts[0] & 0xFFFF, ovpCount + 1);
+	EMB_ASSERT_EQUAL(snapshot.errorCounts[0] >> 16, uvpCount + 1);
+
+	EMB_ASSERT_EQUAL((snapshot.firstError.info >> 8) & 0xFF, sys::Error::OVP_IN);
+	const sys::PackedEventRecord& last = snapshot.events[sys::SyslogSnapshot::EVENT_COUNT - 1];
+	EMB_ASSERT_EQUAL(last.info & 0xF, sys::Event::WARNING_SET);
+	EMB_ASSERT_EQUAL((last.info >> 8) & 0xFF, sys::Warning::CAN_BUS_WARNING);
+	float value;
+	memcpy(&value, &snapshot.events[sys::SyslogSnapshot::EVENT_COUNT - 2].value, sizeof(float));
+	EMB_ASSERT_EQUAL(value, 10.f);
+
+	Syslog::resetErrorsWarnings();
+}
+
+
+///
+///
+///
+void SyslogTest::ErrorTableTest()
+{
+	EMB_ASSERT_EQUAL(sys::Error::ERROR_COUNT, sys::Error::BMS_FATAL_ERROR + 1);
+	EMB_ASSERT_EQUAL(strcmp(sys::Error::NAMES[sys::Error::OVP_IN], "OVP_IN"), 0);
+	EMB_ASSERT_EQUAL(strcmp(sys::Error::NAMES[sys::Error::BMS_FATAL_ERROR], "BMS_FATAL_ERROR"), 0);
+	EMB_ASSERT_EQUAL(strcmp(sys::Warning::NAMES[sys::Warning::CASE_OVERHEATING], "CASE_OVERHEATING"), 0);
+	EMB_ASSERT_EQUAL(sys::Error::SEVERITIES[sys::Error::OCP_IN], sys::Error::SEVERITY_CRITICAL);
+
+	EMB_ASSERT_TRUE(!sys::Error::FATAL[sys::Error::OVP_IN]);
+	EMB_ASSERT_TRUE(sys::Error::AUTO_RESET[sys::Error::RS_CONNECTION_LOST]);
+	EMB_ASSERT_TRUE(!sys::Error::AUTO_RESET[sys::Error::OVP_IN]);
+	EMB_ASSERT_TRUE(sys::Error::ENABLED_BY_DEFAULT[sys::Error::OVP_IN]);
+	EMB_ASSERT_TRUE(!sys::Error::ENABLED_BY_DEFAULT[sys::Error::FUELCELL_UV]);
+
+	// masks are split into 32-bit words
+	EMB_ASSERT_EQUAL(sys::Error::ERROR_WORD_COUNT, (sys::Error::ERROR_COUNT + 31) / 32);
+	EMB_ASSERT_EQUAL(sys::maskWord(31), 0);
+	EMB_ASSERT_EQUAL(sys::maskWord(32), 1);
+	EMB_ASSERT_EQUAL(sys::maskBit(33), 1UL << 1);
+	Syslog::resetErrorsWarnings();
+	EMB_ASSERT_TRUE(!Syslog::hasErrors());
+	Syslog::setError(sys::Error::BMS_FATAL_ERROR);
+	EMB_ASSERT_TRUE(Syslog::hasErrors());
+	EMB_ASSERT_EQUAL(Syslog::errors(sys::maskWord(sys::Error::BMS_FATAL_ERROR)),
+			sys::maskBit(sys::Error::BMS_FATAL_ERROR));
+
+	// fuel cell errors are not registered until fuel cells are started
+	Syslog::resetErrorsWarnings();
+	Syslog::setError(sys::Error::FUELCELL_UV);
+	EMB_ASSERT_TRUE(!Syslog::hasError(sys::Error::FUELCELL_UV));
+	Syslog::enableError(sys::Error::FUELCELL_UV);
+	Syslog::setError(sys::Error::FUELCELL_UV);
+	EMB_ASSERT_TRUE(Syslog::hasError(sys::Error::FUELCELL_UV));
+	Syslog::disableError(sys::Error::FUELCELL_UV);
+	Syslog::resetErrorsWarnings();
+}
+
+
+///
+///
+///
+void SyslogTest::ErrorLatchTest()
+{
+	sys::ErrorLatch latch;
+	EMB_ASSERT_EQUAL(latch.update(true, 0), sys::ErrorLatch::LATCH_ASSERTED);
+	EMB_ASSERT_EQUAL(latch.update(false, 1), sys::ErrorLatch::LATCH_CLEARED);
+
+	// 3 samples and 10 ms to assert, single noise sample is ignored
+	latch.configure(3, 10, 2, 0);
+	EMB_ASSERT_EQUAL(latch.update(true, 0), sys::ErrorLatch::LATCH_UNCHANGED);
+	EMB_ASSERT_EQUAL(latch.update(false, 1), sys::ErrorLatch::LATCH_UNCHANGED);
+	EMB_ASSERT_EQUAL(latch.update(true, 2), sys::ErrorLatch::LATCH_UNCHANGED);
+	EMB_ASSERT_EQUAL(latch.update(true, 3), sys::ErrorLatch::LATCH_UNCHANGED);
+	EMB_ASSERT_EQUAL(latch.update(true, 4), sys::ErrorLatch::LATCH_UNCHANGED);	// 3 samples, but 2 ms
+	EMB_ASSERT_EQUAL(latch.update(true, 12), sys::ErrorLatch::LATCH_ASSERTED);
+	EMB_ASSERT_TRUE(latch.latched());
+	EMB_ASSERT_EQUAL(latch.update(true, 13), sys::ErrorLatch::LATCH_UNCHANGED);
+
+	// 2 samples to clear
+	EMB_ASSERT_EQUAL(latch.update(false, 14), sys::ErrorLatch::LATCH_UNCHANGED);
+	EMB_ASSERT_EQUAL(latch.update(true, 15), sys::ErrorLatch::LATCH_UNCHANGED);
+	EMB_ASSERT_EQUAL(latch.update(false, 16), sys::ErrorLatch::LATCH_UNCHANGED);
+	EMB_ASSERT_EQUAL(latch.update(false, 17), sys::ErrorLatch::LATCH_CLEARED);
+	EMB_ASSERT_TRUE(!latch.latched());
+
+	// Syslog error is set by latch and is set again after reset while condition persists
+	Syslog::resetErrorsWarnings();
+	Syslog::configureErrorLatch(sys::Error::UVP_IN, 2, 0, 1, 0);
+	Syslog::updateError(sys::Error::UVP_IN, true);
+	EMB_ASSERT_TRUE(!Syslog::hasError(sys::Error::UVP_IN));
+	Syslog::updateError(sys::Error::UVP_IN, true);
+	EMB_ASSERT_TRUE(Syslog::hasError(sys::Error::UVP_IN));
+	Syslog::updateError(sys::Error::UVP_IN, false);
+	EMB_ASSERT_TRUE(Syslog::hasError(sys::Error::UVP_IN));		// not auto-reset error
+	Syslog::resetErrorsWarnings();
+	Syslog::updateError(sys::Error::UVP_IN, true);
+	Syslog::updateError(sys::Error::UVP_IN, true);
+	EMB_ASSERT_TRUE(Syslog::hasError(sys::Error::UVP_IN));
+
+	Syslog::configureErrorLatch(sys::Error::UVP_IN, 1, 0, 1, 0);
+	Syslog::resetErrorsWarnings();
+}
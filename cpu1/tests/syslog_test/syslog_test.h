@@ -0,0 +1,19 @@
+///
+#pragma once
+
+#include "emb/emb_testrunner/emb_testrunner.h"
+#include "sys/syslog/syslog.h"
+
+
+class SyslogTest
+{
+public:
+	static void EventLogTest();
+	static void FirstErrorTest();
+	static void ErrorStatisticsTest();
+	static void SnapshotTest();
+	static void ErrorTableTest();
+	static void ErrorLatchTest();
+};
+
+
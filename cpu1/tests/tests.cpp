@@ -3,10 +3,13 @@
 #include "emb/tests/emb_test.h"
 
 #include "mcu_test/mcu_test.h"
+#include "syslog_test/syslog_test.h"
 #include "mcu/adc/mcu_adc.h"
 #include "ucanopen_test/tpdoservice_test/tpdoservice_test.h"
 #include "ucanopen_test/rpdoservice_test/rpdoservice_test.h"
 #include "ucanopen_test/sdoservice_test/sdoservice_test.h"
+#include "canbygpio_test/canbygpio_test.h"
+#include "fuelcell_test/fuelcell_test.h"
 
 
 void RUN_TESTS()
@@ -43,13 +46,52 @@ void RUN_TESTS()
 	EMB_RUN_TEST(EmbTest::FilterTest);
 	EMB_RUN_TEST(EmbTest::StackTest);
 	EMB_RUN_TEST(EmbTest::BitsetTest);
+	EMB_RUN_TEST(EmbTest::AtomicTest);
+	EMB_RUN_TEST(EmbTest::SpscQueueTest);
 
 	EMB_RUN_TEST(McuTest::GpioTest);
 	EMB_RUN_TEST(McuTest::ClockTest);
+	EMB_RUN_TEST(McuTest::AtomicInterruptTest);
+	EMB_RUN_TEST(McuTest::AtomicBenchmark);
+	EMB_RUN_TEST(McuTest::SpscQueueInterruptTest);
+
+	EMB_RUN_TEST(SyslogTest::EventLogTest);
+	EMB_RUN_TEST(SyslogTest::FirstErrorTest);
+	EMB_RUN_TEST(SyslogTest::ErrorStatisticsTest);
+	EMB_RUN_TEST(SyslogTest::SnapshotTest);
+	EMB_RUN_TEST(SyslogTest::ErrorTableTest);
+	EMB_RUN_TEST(SyslogTest::ErrorLatchTest);
 
 	EMB_RUN_TEST(ucanopen::TpdoServiceTest::MessageProcessingTest);
 	EMB_RUN_TEST(ucanopen::RpdoServiceTest::MessageProcessingTest);
 	EMB_RUN_TEST(ucanopen::SdoServiceTest::MessageProcessingTest);
+	EMB_RUN_TEST(ucanopen::SdoServiceTest::ObjectDictionaryTest);
+	EMB_RUN_TEST(ucanopen::SdoServiceTest::SegmentedTransferTest);
+	EMB_RUN_TEST(ucanopen::SdoServiceTest::BlockTransferTest);
+	EMB_RUN_TEST(ucanopen::SdoServiceTest::RxQueueTest);
+
+	EMB_RUN_TEST(canbygpio::CanByGpioTest::FramingTest);
+	EMB_RUN_TEST(canbygpio::CanByGpioTest::ExtendedFrameTest);
+	EMB_RUN_TEST(canbygpio::CanByGpioTest::AcceptanceFilterTest);
+	EMB_RUN_TEST(canbygpio::CanByGpioTest::EdgeDecodingTest);
+	EMB_RUN_TEST(canbygpio::CanByGpioTest::ErrorCountersTest);
+	EMB_RUN_TEST(canbygpio::CanByGpioTest::LoopbackSimulationTest);
+	EMB_RUN_TEST(canbygpio::CanByGpioTest::DecodingBenchmark);
+
+	EMB_RUN_TEST(fuelcell::FuelcellTest::CellTableTest);
+	EMB_RUN_TEST(fuelcell::FuelcellTest::CellTableBenchmark);
+	EMB_RUN_TEST(fuelcell::FuelcellTest::SeqLockTest);
+	EMB_RUN_TEST(fuelcell::FuelcellTest::LinkStatisticsTest);
+	EMB_RUN_TEST(fuelcell::FuelcellTest::PdoCodecTest);
+	EMB_RUN_TEST(fuelcell::FuelcellTest::PdoDecodingBenchmark);
+	EMB_RUN_TEST(fuelcell::FuelcellTest::FsmTableTest);
+	EMB_RUN_TEST(fuelcell::FuelcellTest::FsmDispatchBenchmark);
+	EMB_RUN_TEST(fuelcell::FuelcellTest::FsmTimerQueueTest);
+	EMB_RUN_TEST(fuelcell::FuelcellTest::FsmEventQueueTest);
+	EMB_RUN_TEST(fuelcell::FuelcellTest::SuperviseBudgetBenchmark);
+	EMB_RUN_TEST(fuelcell::FuelcellTest::FsmReplayTest);
+	EMB_RUN_TEST(fuelcell::FuelcellTest::FsmFuzzTest);
+	EMB_RUN_TEST(fuelcell::FuelcellTest::ErrorLatchTest);
 
 
 	emb::TestRunner::printResult();
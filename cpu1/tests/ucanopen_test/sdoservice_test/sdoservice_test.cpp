@@ -10,14 +10,14 @@ void SdoServiceTest::MessageProcessingTest()
 
 	SdoService<mcu::CANA, mcu::IPC_MODE_SINGLECORE, emb::MODE_MASTER> sdoService(NULL);
 
-	const ODEntry* odEntry1 = emb::binary_find(OBJECT_DICTIONARY, OBJECT_DICTIONARY_END, ODEntryKeyAux(0x1008, 0x00));
+	const ODEntry* odEntry1 = findODEntry(0x1008, 0x00);
 	EMB_ASSERT_TRUE(strcmp(odEntry1->value.name, "DEVICE_NAME") == 0);
 
-	const ODEntry* odEntry2 = emb::binary_find(OBJECT_DICTIONARY, OBJECT_DICTIONARY_END, ODEntryKeyAux(0x5000, 0x00));
+	const ODEntry* odEntry2 = findODEntry(0x5000, 0x00);
 	EMB_ASSERT_TRUE(strcmp(odEntry2->value.name, "UPTIME") == 0);
 
-	const ODEntry* odEntry3 = emb::binary_find(OBJECT_DICTIONARY, OBJECT_DICTIONARY_END, ODEntryKeyAux(0x2001, 0x01));
-	EMB_ASSERT_TRUE(strcmp(odEntry3->value.name, "POWERDOWN") == 0);
+	const ODEntry* odEntry3 = findODEntry(0x2001, 0x01);
+	EMB_ASSERT_TRUE(strcmp(odEntry3->value.name, "RELAY OFF") == 0);
 	EMB_ASSERT_EQUAL(odEntry3->value.dataType, OD_TASK);
 
 	CobSdo rsdo, tsdo;
@@ -43,6 +43,375 @@ void SdoServiceTest::MessageProcessingTest()
 */
 }
 
+
+///
+///
+///
+void SdoServiceTest::ObjectDictionaryTest()
+{
+	for (size_t i = 0; i < OD_SIZE; ++i)
+	{
+		const ODEntry& entry = OBJECT_DICTIONARY[i];
+
+		// OD is sorted and every entry is found by its key
+		if (i < (OD_SIZE - 1))
+		{
+			EMB_ASSERT_TRUE(entry < OBJECT_DICTIONARY[i+1]);
+		}
+		EMB_ASSERT_TRUE(findODEntry(entry.key.index, entry.key.subindex) == &entry);
+
+		// no od-entries with equal {category, subcategory, name}
+		for (size_t j = i+1; j < OD_SIZE; ++j)
+		{
+			EMB_ASSERT_TRUE((strcmp(entry.value.category, OBJECT_DICTIONARY[j].value.category) != 0)
+					|| (strcmp(entry.value.subcategory, OBJECT_DICTIONARY[j].value.subcategory) != 0)
+					|| (strcmp(entry.value.name, OBJECT_DICTIONARY[j].value.name) != 0));
+		}
+
+		// multi-byte entries are read through domains
+		const ODDomain* domain = findODDomain(entry.key.index, entry.key.subindex);
+		if ((entry.value.dataType == OD_STRING) || (entry.value.dataType == OD_DOMAIN))
+		{
+			EMB_ASSERT_TRUE(domain != NULL);
+		}
+		else
+		{
+			EMB_ASSERT_TRUE(domain == NULL);
+		}
+
+		if (entry.value.dataType == OD_DOMAIN)
+		{
+			EMB_ASSERT_TRUE(entry.hasReadAccess() && !entry.hasWriteAccess());
+		}
+		else if (entry.hasReadAccess())
+		{
+			EMB_ASSERT_TRUE((entry.value.readAccessFunc != OD_NO_INDIRECT_READ_ACCESS)
+					|| (entry.value.dataPtr != OD_NO_DIRECT_ACCESS));
+		}
+		else
+		{
+			EMB_ASSERT_TRUE((entry.value.readAccessFunc == OD_NO_INDIRECT_READ_ACCESS)
+					&& (entry.value.dataPtr == OD_NO_DIRECT_ACCESS));
+		}
+
+		if (entry.hasWriteAccess())
+		{
+			EMB_ASSERT_TRUE((entry.value.writeAccessFunc != OD_NO_INDIRECT_WRITE_ACCESS)
+					|| (entry.value.dataPtr != OD_NO_DIRECT_ACCESS));
+		}
+		else
+		{
+			EMB_ASSERT_TRUE((entry.value.writeAccessFunc == OD_NO_INDIRECT_WRITE_ACCESS)
+					&& (entry.value.dataPtr == OD_NO_DIRECT_ACCESS));
+		}
+	}
+
+	EMB_ASSERT_TRUE(findODEntry(0x5000, 0xFF) == OBJECT_DICTIONARY_END);
+	EMB_ASSERT_TRUE(findODEntry(0x1000, 0x00) == OBJECT_DICTIONARY_END);
+	EMB_ASSERT_TRUE(findODEntry(0x5000, 0x100) == OBJECT_DICTIONARY_END);	// must not be found as {0x5001, 0x00}
+
+	for (size_t i = 0; i < OD_DOMAIN_COUNT; ++i)
+	{
+		EMB_ASSERT_TRUE(findODEntry(OD_DOMAINS[i].index, OD_DOMAINS[i].subindex) != OBJECT_DICTIONARY_END);
+		EMB_ASSERT_TRUE(findODDomain(OD_DOMAINS[i].index, OD_DOMAINS[i].subindex) == &OD_DOMAINS[i]);
+	}
+	EMB_ASSERT_TRUE(findODDomain(0x5000, 0x00) == NULL);
+}
+
+
+/**
+ * @brief Makes SDO request: command byte, index (or two bytes of block transfer parameters), subindex and data.
+ */
+static CobSdo makeRequest(uint32_t command, uint32_t index, uint32_t subindex, uint32_t data)
+{
+	return CobSdo(static_cast<uint64_t>(command)
+			| (static_cast<uint64_t>(index) << 8)
+			| (static_cast<uint64_t>(subindex) << 24)
+			| (static_cast<uint64_t>(data) << 32));
+}
+
+
+///
+///
+///
+void SdoServiceTest::SegmentedTransferTest()
+{
+	SdoTransfer transfer;
+	CobSdo tsdo;
+	uint64_t time = 0;
+
+	// expedited requests are not accepted, except initiating upload of domain
+	EMB_ASSERT_TRUE(!transfer.accepts(makeRequest(0x40, 0x5FFF, 0x00, 0)));
+	EMB_ASSERT_TRUE(transfer.accepts(makeRequest(0x40, 0x1008, 0x00, 0)));
+	EMB_ASSERT_TRUE(!transfer.accepts(makeRequest(0x23, 0x5005, 0x00, 0)));
+	EMB_ASSERT_TRUE(!transfer.accepts(makeRequest(0x20, 0x5005, 0x00, 0)));	// client without e-bit
+	EMB_ASSERT_TRUE(transfer.accepts(makeRequest(0x21, 0x5005, 0x00, 2)));
+
+	// upload of full device name
+	size_t nameLength = strlen(sys::DEVICE_NAME);
+	EMB_ASSERT_TRUE(nameLength > 4);
+	EMB_ASSERT_TRUE(transfer.processRequest(makeRequest(0x40, 0x1008, 0x00, 0), tsdo, time));
+	EMB_ASSERT_EQUAL(tsdo.byte(0), 0x41);
+	EMB_ASSERT_EQUAL(tsdo.index, 0x1008);
+	EMB_ASSERT_EQUAL(tsdo.data.u32, nameLength);
+
+	size_t received = 0;
+	uint16_t toggle = 0;
+	bool nameMatches = true;
+	for (size_t segment = 0; segment < 16; ++segment)
+	{
+		EMB_ASSERT_TRUE(transfer.processRequest(makeRequest(0x60 | (toggle << 4), 0, 0, 0), tsdo, time));
+		EMB_ASSERT_EQUAL(tsdo.byte(0) & 0xF0, toggle << 4);
+		size_t count = 7 - ((tsdo.byte(0) >> 1) & 0x07);
+		for (size_t i = 0; i < count; ++i)
+		{
+			nameMatches = nameMatches && (tsdo.byte(1 + i) == (sys::DEVICE_NAME[received + i] & 0x00FF));
+		}
+		received += count;
+		toggle ^= 1;
+		if (tsdo.byte(0) & 0x01)
+		{
+			break;
+		}
+	}
+	EMB_ASSERT_EQUAL(received, nameLength);
+	EMB_ASSERT_TRUE(nameMatches);
+	EMB_ASSERT_TRUE(!transfer.active());
+
+	// toggle bit error
+	transfer.processRequest(makeRequest(0x40, 0x1008, 0x00, 0), tsdo, time);
+	EMB_ASSERT_TRUE(transfer.processRequest(makeRequest(0x70, 0, 0, 0), tsdo, time));
+	EMB_ASSERT_EQUAL(tsdo.byte(0), 0x80);
+	EMB_ASSERT_EQUAL(tsdo.index, 0x1008);
+	EMB_ASSERT_EQUAL(tsdo.data.u32, SDO_ABORT_TOGGLE_BIT);
+	EMB_ASSERT_TRUE(!transfer.active());
+
+	// segment without transfer
+	EMB_ASSERT_TRUE(transfer.processRequest(makeRequest(0x60, 0, 0, 0), tsdo, time));
+	EMB_ASSERT_EQUAL(tsdo.data.u32, SDO_ABORT_INVALID_CS);
+
+	// unknown object and read-only object
+	EMB_ASSERT_TRUE(transfer.processRequest(makeRequest(0x21, 0x1000, 0x00, 2), tsdo, time));
+	EMB_ASSERT_EQUAL(tsdo.data.u32, SDO_ABORT_OBJECT_NOT_FOUND);
+	EMB_ASSERT_TRUE(transfer.processRequest(makeRequest(0x21, 0x5FFF, 0x00, 2), tsdo, time));
+	EMB_ASSERT_EQUAL(tsdo.data.u32, SDO_ABORT_READ_ONLY);
+
+	// download of error selection: 2 bytes in one segment
+	EMB_ASSERT_TRUE(transfer.processRequest(makeRequest(0x21, 0x5005, 0x00, 2), tsdo, time));
+	EMB_ASSERT_EQUAL(tsdo.byte(0), 0x60);
+	EMB_ASSERT_EQUAL(tsdo.index, 0x5005);
+	EMB_ASSERT_TRUE(transfer.processRequest(CobSdo(0x0000000000000300ULL | (5 << 1) | 0x01), tsdo, time));
+	EMB_ASSERT_EQUAL(tsdo.byte(0), 0x20);
+	EMB_ASSERT_TRUE(!transfer.active());
+	CobSdoData value;
+	findODEntry(0x5005, 0x00)->read(value);
+	EMB_ASSERT_EQUAL(value.u32, 3);
+
+	// download that doesn't fit into OD-entry
+	EMB_ASSERT_TRUE(transfer.processRequest(makeRequest(0x21, 0x5005, 0x00, 8), tsdo, time));
+	EMB_ASSERT_EQUAL(tsdo.data.u32, SDO_ABORT_LENGTH_TOO_HIGH);
+
+	// client stops responding
+	transfer.processRequest(makeRequest(0x40, 0x1008, 0x00, 0), tsdo, time);
+	EMB_ASSERT_TRUE(!transfer.checkTimeout(tsdo, time + SdoTransfer::TIMEOUT));
+	EMB_ASSERT_TRUE(transfer.checkTimeout(tsdo, time + SdoTransfer::TIMEOUT + 1));
+	EMB_ASSERT_EQUAL(tsdo.data.u32, SDO_ABORT_TIMEOUT);
+	EMB_ASSERT_TRUE(!transfer.active());
+
+	// client abort
+	transfer.processRequest(makeRequest(0x40, 0x1008, 0x00, 0), tsdo, time);
+	EMB_ASSERT_TRUE(!transfer.processRequest(makeRequest(0x80, 0x1008, 0x00, SDO_ABORT_TIMEOUT), tsdo, time));
+	EMB_ASSERT_TRUE(!transfer.active());
+}
+
+
+///
+///
+///
+void SdoServiceTest::BlockTransferTest()
+{
+	SdoTransfer transfer;
+	CobSdo tsdo;
+	uint64_t time = 0;
+
+	// CRC known answer: CRC-16/XMODEM of "123456789"
+	const char* CRC_CHECK_DATA = "123456789";
+	uint16_t checkCrc = 0;
+	for (size_t i = 0; i < 9; ++i)
+	{
+		checkCrc = updateSdoCrc(checkCrc, CRC_CHECK_DATA[i]);
+	}
+	EMB_ASSERT_EQUAL(checkCrc, 0x31C3);
+
+	// upload of syslog snapshot in blocks of 4 segments with CRC
+	const uint16_t BLOCK_SIZE = 4;
+	EMB_ASSERT_TRUE(transfer.processRequest(makeRequest(0xA4, 0x2000, 0x05, BLOCK_SIZE), tsdo, time));
+	EMB_ASSERT_EQUAL(tsdo.byte(0), 0xC6);
+	uint32_t size = tsdo.data.u32;
+	EMB_ASSERT_EQUAL(size, 4 * sys::SyslogSnapshot::wordCount());
+	sys::SyslogSnapshot snapshotOpened;
+	Syslog::takeSnapshot(snapshotOpened);
+	const size_t EVENT_COUNT_OFFSET = 4 * (offsetof(sys::SyslogSnapshot, eventTotalCount) / sizeof(uint32_t));
+	uint32_t eventTotalCount = 0;
+	EMB_ASSERT_TRUE(!transfer.makeSegment(tsdo, time));		// client hasn't started upload
+
+	EMB_ASSERT_TRUE(!transfer.processRequest(makeRequest(0xA3, 0, 0, 0), tsdo, time));
+
+	uint32_t received = 0;
+	uint32_t header = 0;
+	uint16_t crc = 0;
+	CobSdo segments[BLOCK_SIZE];
+	for (size_t block = 0; block < 64; ++block)
+	{
+		size_t segmentCount = 0;
+		while ((segmentCount < BLOCK_SIZE) && transfer.makeSegment(tsdo, time))
+		{
+			segments[segmentCount++] = tsdo;
+		}
+		EMB_ASSERT_TRUE(segmentCount > 0);
+		EMB_ASSERT_TRUE(!transfer.makeSegment(tsdo, time));	// server waits for acknowledge
+
+		if (block == 0)
+		{
+			// new event and SNAPSHOT_TAKE during upload must not change uploaded snapshot
+			Syslog::setWarning(sys::Warning::CAN_BUS_WARNING);
+			Syslog::resetWarning(sys::Warning::CAN_BUS_WARNING);
+			CobSdoData data;
+			findODEntry(0x2000, 0x01)->read(data);
+		}
+
+		// segments after first one of second block are lost, they must be sent again in next block
+		size_t ackseq = ((block == 1) && (segmentCount > 1)) ? 1 : segmentCount;
+		for (size_t seg = 0; seg < ackseq; ++seg)
+		{
+			EMB_ASSERT_EQUAL(segments[seg].byte(0) & 0x7F, seg + 1);
+			size_t count = ((size - received) > 7) ? 7 : (size - received);
+			for (size_t i = 0; i < count; ++i)
+			{
+				if ((received + i) < 4)
+				{
+					header |= static_cast<uint32_t>(segments[seg].byte(1 + i)) << (8 * (received + i));
+				}
+				if (((received + i) >= EVENT_COUNT_OFFSET) && ((received + i) < EVENT_COUNT_OFFSET + 4))
+				{
+					eventTotalCount |= static_cast<uint32_t>(segments[seg].byte(1 + i))
+							<< (8 * (received + i - EVENT_COUNT_OFFSET));
+				}
+				crc = updateSdoCrc(crc, segments[seg].byte(1 + i));
+			}
+			received += count;
+		}
+
+		if (transfer.processRequest(makeRequest(0xA2, ackseq | (BLOCK_SIZE << 8), 0, 0), tsdo, time))
+		{
+			break;
+		}
+	}
+	EMB_ASSERT_EQUAL(received, size);
+	EMB_ASSERT_EQUAL(tsdo.byte(0) & 0xE3, 0xC1);
+	EMB_ASSERT_EQUAL((tsdo.byte(0) >> 2) & 0x07, (7 - size % 7) % 7);
+	EMB_ASSERT_EQUAL(tsdo.byte(1) | (tsdo.byte(2) << 8), crc);
+	EMB_ASSERT_EQUAL(header, (uint32_t(sys::SyslogSnapshot::VERSION) << 16) | sys::SyslogSnapshot::wordCount());
+	EMB_ASSERT_EQUAL(eventTotalCount, snapshotOpened.eventTotalCount);
+	EMB_ASSERT_TRUE(!transfer.processRequest(makeRequest(0xA1, 0, 0, 0), tsdo, time));
+	EMB_ASSERT_TRUE(!transfer.active());
+
+	// invalid block size
+	EMB_ASSERT_TRUE(transfer.processRequest(makeRequest(0xA4, 0x2000, 0x05, 0), tsdo, time));
+	EMB_ASSERT_EQUAL(tsdo.data.u32, SDO_ABORT_INVALID_BLOCK_SIZE);
+
+	// download of error selection: 2 bytes in one segment with CRC
+	uint16_t value = 5;
+	EMB_ASSERT_TRUE(transfer.processRequest(makeRequest(0xC6, 0x5005, 0x00, 2), tsdo, time));
+	EMB_ASSERT_EQUAL(tsdo.byte(0), 0xA4);
+	EMB_ASSERT_EQUAL(tsdo.byte(4), SDO_BLOCK_SIZE_MAX);
+	EMB_ASSERT_TRUE(transfer.accepts(makeRequest(0x81, value, 0, 0)));
+	EMB_ASSERT_TRUE(!transfer.processRequest(makeRequest(0x02, value, 0, 0), tsdo, time));	// segment 1 is lost
+	EMB_ASSERT_TRUE(transfer.processRequest(makeRequest(0x83, value, 0, 0), tsdo, time));
+	EMB_ASSERT_EQUAL(tsdo.byte(0), 0xA2);
+	EMB_ASSERT_EQUAL(tsdo.byte(1), 0);				// client must send block again
+	EMB_ASSERT_TRUE(transfer.processRequest(makeRequest(0x81, value, 0, 0), tsdo, time));
+	EMB_ASSERT_EQUAL(tsdo.byte(0), 0xA2);
+	EMB_ASSERT_EQUAL(tsdo.byte(1), 1);
+	EMB_ASSERT_EQUAL(tsdo.byte(2), SDO_BLOCK_SIZE_MAX);
+	crc = updateSdoCrc(updateSdoCrc(0, value), 0);
+	EMB_ASSERT_TRUE(transfer.processRequest(makeRequest(0xC1 | (5 << 2), crc, 0, 0), tsdo, time));
+	EMB_ASSERT_EQUAL(tsdo.byte(0), 0xA1);
+	EMB_ASSERT_TRUE(!transfer.active());
+	CobSdoData data;
+	findODEntry(0x5005, 0x00)->read(data);
+	EMB_ASSERT_EQUAL(data.u32, value);
+
+	// CRC error
+	transfer.processRequest(makeRequest(0xC6, 0x5005, 0x00, 2), tsdo, time);
+	transfer.processRequest(makeRequest(0x81, 1, 0, 0), tsdo, time);
+	EMB_ASSERT_TRUE(transfer.processRequest(makeRequest(0xC1 | (5 << 2), crc, 0, 0), tsdo, time));
+	EMB_ASSERT_EQUAL(tsdo.byte(0), 0x80);
+	EMB_ASSERT_EQUAL(tsdo.data.u32, SDO_ABORT_CRC_ERROR);
+	findODEntry(0x5005, 0x00)->read(data);
+	EMB_ASSERT_EQUAL(data.u32, value);
+}
+
+
+///
+///
+///
+void SdoServiceTest::RxQueueTest()
+{
+	EMB_ASSERT_EQUAL(RxQueues::rdoIndex(RPDO1), 0);
+	EMB_ASSERT_EQUAL(RxQueues::rdoIndex(RPDO4), 3);
+	EMB_ASSERT_EQUAL(RxQueues::rdoIndex(RSDO), 4);
+
+	RxQueues queues;
+	queues.init();
+	size_t rsdoIdx = RxQueues::rdoIndex(RSDO);
+
+	// burst of requests is queued in order of arrival
+	for (uint32_t i = 0; i < RxQueues::CAPACITY; ++i)
+	{
+		EMB_ASSERT_TRUE(queues.push(rsdoIdx, (uint64_t(i) << 32) | 0x40));
+	}
+	EMB_ASSERT_TRUE(!queues.push(rsdoIdx, 0));
+	RxQueueStats stats = queues.stats(rsdoIdx);
+	EMB_ASSERT_EQUAL(stats.depth, uint32_t(RxQueues::CAPACITY));
+	EMB_ASSERT_EQUAL(stats.highWater, uint32_t(RxQueues::CAPACITY));
+	EMB_ASSERT_EQUAL(stats.overflowCount, 1);
+
+	uint64_t rawMsg = 0;
+	for (uint32_t i = 0; i < RxQueues::CAPACITY; ++i)
+	{
+		EMB_ASSERT_TRUE(queues.pop(rsdoIdx, rawMsg));
+		EMB_ASSERT_EQUAL(CobSdo(rawMsg).data.u32, i);
+	}
+	EMB_ASSERT_TRUE(!queues.pop(rsdoIdx, rawMsg));
+	stats = queues.stats(rsdoIdx);
+	EMB_ASSERT_EQUAL(stats.depth, 0);
+	EMB_ASSERT_EQUAL(stats.highWater, uint32_t(RxQueues::CAPACITY));
+
+	// queues of other COB types are independent
+	stats = queues.stats(RxQueues::rdoIndex(RPDO1));
+	EMB_ASSERT_EQUAL(stats.highWater, 0);
+	EMB_ASSERT_EQUAL(stats.overflowCount, 0);
+
+	// statistics in OD
+	can1RxQueues.init();
+	can1RxQueues.push(rsdoIdx, 0);
+	can1RxQueues.push(rsdoIdx, 0);
+	can1RxQueues.pop(rsdoIdx, rawMsg);
+	CobSdoData data;
+	data.u32 = RDO_COUNT;
+	EMB_ASSERT_EQUAL(findODEntry(0x5006, 0x00)->write(data), OD_ACCESS_FAIL);
+	data.u32 = rsdoIdx;
+	EMB_ASSERT_EQUAL(findODEntry(0x5006, 0x00)->write(data), OD_ACCESS_SUCCESS);
+	findODEntry(0x5006, 0x01)->read(data);
+	EMB_ASSERT_EQUAL(data.u32, 1);
+	findODEntry(0x5006, 0x02)->read(data);
+	EMB_ASSERT_EQUAL(data.u32, 2);
+	findODEntry(0x5006, 0x03)->read(data);
+	EMB_ASSERT_EQUAL(data.u32, 0);
+	can1RxQueues.init();
+}
+
 } // namespace ucanopen
 
 
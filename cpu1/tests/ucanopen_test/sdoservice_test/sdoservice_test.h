@@ -11,6 +11,10 @@ class SdoServiceTest
 {
 public:
 	static void MessageProcessingTest();
+	static void ObjectDictionaryTest();
+	static void SegmentedTransferTest();
+	static void BlockTransferTest();
+	static void RxQueueTest();
 };
 
 
@@ -53,6 +53,8 @@ PAGE 1 :
    RAMGS8      : origin = 0x014000, length = 0x001000
    RAMGS9      : origin = 0x015000, length = 0x001000
    RAMGS10     : origin = 0x016000, length = 0x001000
+   RAMGS11     : origin = 0x017000, length = 0x001000
+   RAMGS12     : origin = 0x018000, length = 0x001000
    // USER END
    CPU2TOCPU1RAM   : origin = 0x03F800, length = 0x000400
    CPU1TOCPU2RAM   : origin = 0x03FC00, length = 0x000400
@@ -106,6 +108,7 @@ SECTIONS
       SHARED_UCANOPEN_CAN2_TSDO_DATA
       SHARED_SYSLOG_DATA_CPU1
       SHARED_SYSLOG_MESSAGES
+      SHARED_SYSLOG_MESSAGES_CPU2_TAIL
    }
 
    GROUP : > RAMGS10
@@ -114,9 +117,19 @@ SECTIONS
       SHARED_UCANOPEN_CAN1_RSDO_DATA
       SHARED_UCANOPEN_CAN2_RSDO_DATA
       SHARED_SYSLOG_DATA_CPU2
-      SHARED_SYSLOG_MESSAGE_CPU2
+      SHARED_SYSLOG_MESSAGES_CPU2
+      SHARED_FUELCELL_BUS_STATS
+   }
+
+   GROUP : > RAMGS11
+   {
       SHARED_FUELCELL_DATA
    }
+
+   GROUP : > RAMGS12
+   {
+      SHARED_FUELCELL_LINK_STATS
+   }
    // USER END
 
 #ifdef __TI_COMPILER_VERSION__
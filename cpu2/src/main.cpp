@@ -47,7 +47,6 @@ void main()
 	Syslog::IpcFlags syslogIpcFlags =
 	{
 		.RESET_ERRORS_WARNINGS = mcu::IpcFlag(10),
-		.ADD_MESSAGE = mcu::IpcFlag(11),
 		.POP_MESSAGE = mcu::IpcFlag(12)
 	};
 	Syslog::init(syslogIpcFlags);
@@ -86,7 +85,7 @@ void main()
 	mcu::GpioInput canbygpioRx(canbygpioRxCfg);
 	mcu::GpioOutput canbygpioTx(canbygpioTxCfg);
 	mcu::GpioOutput canbygpioClk(canbygpioClkCfg);
-	fuelcell::Controller fcController(converter, canbygpioRx, canbygpioTx, canbygpioClk);
+	fuelcell::Controller fcController(converter, fuelcell::FUELCELL_COUNT, canbygpioRx, canbygpioTx, canbygpioClk);
 
 /*####################################################################################################################*/
 	/*##################*/